@@ -1,4 +1,8 @@
-APPS = vkvm keyTest
+APPS = vkvm keyTest vkvmBench
+ifeq (,$(strip $(WINDRES)))
+ APPS += vkmEmulator
+endif
+BENCHES = crc16Bench captureBench
 COMMA = ,
 
 vkvm_version = 1.3.0
@@ -18,9 +22,11 @@ vkvm_obj = \
 	libpcf/natcmps \
 	libpcf/serial \
 	pcf/color/SplitColor \
+	pcf/image/Convert \
 	pcf/image/Draw \
 	pcf/image/Filter \
 	pcf/image/Svg \
+	pcf/image/Tiles \
 	pcf/gui/HoverButton \
 	pcf/gui/HoverChoice \
 	pcf/gui/HoverDropDown \
@@ -34,6 +40,7 @@ vkvm_obj = \
 	pcf/serial/Port \
 	pcf/serial/Vkvm \
 	pcf/video/Capture \
+	pcf/video/CaptureTest \
 	pcf/UtilityLinux \
 	vkvm
 
@@ -49,6 +56,34 @@ keyTest_obj = \
 
 keyTest_lib = $(OSLIBS)
 
+vkvmBench_obj = \
+	libpcf/serial \
+	pcf/serial/Vkvm \
+	vkvmBench
+
+vkvmBench_lib = $(OSLIBS)
+
+vkmEmulator_obj = \
+	vkm-emulator/Arduino \
+	vkm-emulator/PluggableUSB \
+	vkm-periphery/arduino \
+	vkmEmulator
+
+vkmEmulator_lib =
+
+crc16Bench_obj = \
+	crc16Bench
+
+crc16Bench_lib =
+
+captureBench_obj = \
+	pcf/image/Convert \
+	pcf/image/Tiles \
+	pcf/video/CaptureTest \
+	captureBench
+
+captureBench_lib = $(OSLIBS)
+
 
 all: $(DSTDIR) $(addprefix $(DSTDIR)/,$(addsuffix $(BINEXT),$(APPS)))
 
@@ -56,6 +91,9 @@ all: $(DSTDIR) $(addprefix $(DSTDIR)/,$(addsuffix $(BINEXT),$(APPS)))
 $(DSTDIR):
 	mkdir -p $(DSTDIR)
 
+.PHONY: bench
+bench: $(DSTDIR) $(addprefix $(DSTDIR)/,$(addsuffix $(BINEXT),$(BENCHES)))
+
 .PHONY: clean
 clean:
 	$(RM) -r $(DSTDIR)/*
@@ -74,6 +112,26 @@ $(DSTDIR)/keyTest$(BINEXT): $(addprefix $(DSTDIR)/,$(addsuffix $(OBJEXT),$(keyTe
 	$(AR) rs $(DSTDIR)/keyTest.a $+
 	$(LD) $(LDFLAGS) -o $@ $(DSTDIR)/keyTest.a $(keyTest_lib:lib%=-l%)
 
+$(DSTDIR)/vkvmBench$(BINEXT): $(addprefix $(DSTDIR)/,$(addsuffix $(OBJEXT),$(vkvmBench_obj)))
+	$(AR) rs $(DSTDIR)/vkvmBench.a $+
+	$(LD) $(LDFLAGS) -o $@ $(DSTDIR)/vkvmBench.a $(vkvmBench_lib:lib%=-l%)
+
+$(DSTDIR)/vkmEmulator$(BINEXT): $(addprefix $(DSTDIR)/,$(addsuffix $(OBJEXT),$(vkmEmulator_obj)))
+	$(AR) rs $(DSTDIR)/vkmEmulator.a $+
+	$(LD) $(LDFLAGS) -o $@ $(DSTDIR)/vkmEmulator.a $(vkmEmulator_lib:lib%=-l%)
+
+$(DSTDIR)/crc16Bench$(BINEXT): $(addprefix $(DSTDIR)/,$(addsuffix $(OBJEXT),$(crc16Bench_obj)))
+	$(AR) rs $(DSTDIR)/crc16Bench.a $+
+	$(LD) $(LDFLAGS) -o $@ $(DSTDIR)/crc16Bench.a $(crc16Bench_lib:lib%=-l%)
+
+$(DSTDIR)/captureBench$(BINEXT): $(addprefix $(DSTDIR)/,$(addsuffix $(OBJEXT),$(captureBench_obj)))
+	$(AR) rs $(DSTDIR)/captureBench.a $+
+	$(LD) $(LDFLAGS) -o $@ $(DSTDIR)/captureBench.a $(captureBench_lib:lib%=-l%)
+
+# the periphery firmware is built against the emulated Arduino core in vkm-emulator
+$(DSTDIR)/vkm-periphery/arduino$(OBJEXT): CPPFLAGS += -DARDUINO -I$(SRCDIR)/vkm-emulator
+$(DSTDIR)/vkm-periphery/arduino$(OBJEXT): CXXFLAGS += -Wno-old-style-cast
+
 $(DSTDIR)/%$(OBJEXT): $(SRCDIR)/%$(CEXT)
 	mkdir -p "$(dir $@)"
 	$(CC) $(CWFLAGS) $(CPPFLAGS) $(CFLAGS) -o $@ -c $<
@@ -112,6 +170,26 @@ $(DSTDIR)/keyTest$(OBJEXT): \
 	$(SRCDIR)/libpcf/serial.h \
 	$(SRCDIR)/libpcf/target.h \
 	$(SRCDIR)/pcf/serial/Vkvm.hpp
+$(DSTDIR)/vkvmBench$(OBJEXT): \
+	$(SRCDIR)/vkm-periphery/UsbKeys.hpp \
+	$(SRCDIR)/libpcf/serial.h \
+	$(SRCDIR)/libpcf/target.h \
+	$(SRCDIR)/pcf/serial/Vkvm.hpp
+$(DSTDIR)/crc16Bench$(OBJEXT): \
+	$(SRCDIR)/vkm-periphery/Crc16.hpp
+$(DSTDIR)/captureBench$(OBJEXT): \
+	$(SRCDIR)/libpcf/target.h \
+	$(SRCDIR)/pcf/color/Utility.hpp \
+	$(SRCDIR)/pcf/image/Convert.hpp \
+	$(SRCDIR)/pcf/image/Tiles.hpp \
+	$(SRCDIR)/pcf/video/Capture.hpp \
+	$(SRCDIR)/pcf/video/CaptureTest.hpp \
+	$(SRCDIR)/pcf/video/MjpegBandDecoder.hpp \
+	$(SRCDIR)/pcf/Cloneable.hpp
+$(DSTDIR)/vkmEmulator$(OBJEXT): \
+	$(SRCDIR)/vkm-emulator/Arduino.h \
+	$(SRCDIR)/vkm-emulator/PluggableUSB.h \
+	$(SRCDIR)/vkm-periphery/Protocol.hpp
 $(DSTDIR)/libpcf/cvutf8$(OBJEXT): \
 	$(SRCDIR)/libpcf/cvutf8.h
 $(DSTDIR)/libpcf/natcmps$(OBJEXT): \
@@ -175,9 +253,13 @@ $(DSTDIR)/pcf/gui/VkvmView$(OBJEXT): \
 	$(SRCDIR)/pcf/color/Utility.hpp \
 	$(SRCDIR)/pcf/gui/Utility.hpp \
 	$(SRCDIR)/pcf/gui/VkvmView.hpp \
+	$(SRCDIR)/pcf/image/Convert.hpp \
+	$(SRCDIR)/pcf/image/Tiles.hpp \
 	$(SRCDIR)/pcf/video/Capture.hpp \
 	$(SRCDIR)/pcf/Cloneable.hpp \
 	$(SRCDIR)/pcf/Utility.hpp
+$(DSTDIR)/pcf/image/Convert$(OBJEXT): \
+	$(SRCDIR)/pcf/image/Convert.hpp
 $(DSTDIR)/pcf/image/Draw$(OBJEXT): \
 	$(SRCDIR)/pcf/color/SplitColor.hpp \
 	$(SRCDIR)/pcf/image/Draw.hpp
@@ -188,6 +270,8 @@ $(DSTDIR)/pcf/image/Svg$(OBJEXT): \
 	$(SRCDIR)/extern/nanosvg.h \
 	$(SRCDIR)/extern/nanosvgrast.h \
 	$(SRCDIR)/pcf/image/Svg.hpp
+$(DSTDIR)/pcf/image/Tiles$(OBJEXT): \
+	$(SRCDIR)/pcf/image/Tiles.hpp
 $(DSTDIR)/pcf/serial/Port$(OBJEXT): \
 	$(SRCDIR)/vkm-periphery/Meta.hpp \
 	$(SRCDIR)/libpcf/cvutf8.h \
@@ -212,15 +296,43 @@ $(DSTDIR)/pcf/video/Capture$(OBJEXT): \
 	$(SRCDIR)/pcf/gui/HoverChoice.hpp \
 	$(SRCDIR)/pcf/gui/ScrollableValueInput.hpp \
 	$(SRCDIR)/pcf/gui/Utility.hpp \
+	$(SRCDIR)/pcf/image/Convert.hpp \
 	$(SRCDIR)/pcf/video/Capture.hpp \
 	$(SRCDIR)/pcf/video/CaptureDirectShow.ipp \
+	$(SRCDIR)/pcf/video/CaptureTest.hpp \
 	$(SRCDIR)/pcf/video/CaptureVideo4Linux2.ipp \
+	$(SRCDIR)/pcf/video/MjpegBandDecoder.hpp \
 	$(SRCDIR)/pcf/Cloneable.hpp \
 	$(SRCDIR)/pcf/ScopeExit.hpp \
 	$(SRCDIR)/pcf/Utility.hpp \
 	$(SRCDIR)/pcf/UtilityLinux.hpp \
 	$(SRCDIR)/pcf/UtilityWindows.hpp
+$(DSTDIR)/pcf/video/CaptureTest$(OBJEXT): \
+	$(SRCDIR)/libpcf/target.h \
+	$(SRCDIR)/pcf/color/Utility.hpp \
+	$(SRCDIR)/pcf/video/Capture.hpp \
+	$(SRCDIR)/pcf/video/CaptureTest.hpp \
+	$(SRCDIR)/pcf/Cloneable.hpp
 $(DSTDIR)/pcf/UtilityLinux$(OBJEXT): \
 	$(SRCDIR)/libpcf/target.h \
 	$(SRCDIR)/pcf/UtilityLinux.hpp \
 	$(SRCDIR)/pcf/Utility.hpp
+$(DSTDIR)/vkm-emulator/Arduino$(OBJEXT): \
+	$(SRCDIR)/vkm-emulator/Arduino.h \
+	$(SRCDIR)/vkm-emulator/PluggableUSB.h
+$(DSTDIR)/vkm-emulator/PluggableUSB$(OBJEXT): \
+	$(SRCDIR)/vkm-emulator/Arduino.h \
+	$(SRCDIR)/vkm-emulator/PluggableUSB.h \
+	$(SRCDIR)/vkm-periphery/UsbKeys.hpp
+$(DSTDIR)/vkm-periphery/arduino$(OBJEXT): \
+	$(SRCDIR)/vkm-emulator/Arduino.h \
+	$(SRCDIR)/vkm-emulator/HidDescriptor.hpp \
+	$(SRCDIR)/vkm-emulator/PluggableUSB.h \
+	$(SRCDIR)/vkm-periphery/arduino.hpp \
+	$(SRCDIR)/vkm-periphery/Crc16.hpp \
+	$(SRCDIR)/vkm-periphery/Debug.hpp \
+	$(SRCDIR)/vkm-periphery/Framing.hpp \
+	$(SRCDIR)/vkm-periphery/Meta.hpp \
+	$(SRCDIR)/vkm-periphery/Protocol.hpp \
+	$(SRCDIR)/vkm-periphery/UsbKeys.hpp \
+	$(SRCDIR)/vkm-periphery/Vkm.hpp
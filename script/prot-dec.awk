@@ -2,9 +2,10 @@
 # @file prot-dec.awk
 # @author Daniel Starke
 # @date 2022-08-05
-# @version 2026-06-14
+# @version 2026-10-16
 #
 # VKVM (src/pcf/serial/Vkvm.cpp) trace decoder.
+# Use trace-dec.awk to decode the output of `VkvmDevice::dumpTrace()`.
 
 # print a single frame field value
 function printValue(value, size, fields, idx,   subIdx, field, i, first) {
@@ -106,6 +107,7 @@ function processRequest(time, dir, frame,   name) {
 		if (frame[2] in REQ) {
 			split(REQ[frame[2]], name, ",");
 			R[frame[1]] = frame[2]; # remember request type for this sequence number
+			T[frame[1]] = time; # remember request time for this sequence number
 			printf("\ttype:%s", name[1]);
 			split(name[2], fields, ";");
 			printValues(frame, fields, REQw[frame[2]]);
@@ -134,6 +136,11 @@ function processResponse(time, dir, frame,   name, fields) {
 					split(name[3], fields, ";");
 				}
 				printValues(frame, fields, REQw[R[frame[1]]]);
+				if (frame[1] in T) {
+					# round-trip time of the request with this sequence number
+					printf("\tlatency:%.3fms", time - T[frame[1]]);
+					delete T[frame[1]];
+				}
 			} else {
 				printf("\tvalues:<ERROR:missing request>");
 			}
@@ -193,6 +200,7 @@ BEGIN {
 	REQ[0x0D] = "SET_MOUSE_MOVE_ABS,-x;-y,";
 	REQ[0x0E] = "SET_MOUSE_MOVE_REL,-x;-y,";
 	REQ[0x0F] = "SET_MOUSE_SCROLL,-wheel,";
+	REQ[0x10] = "SET_BATCH,$data#,$resMap#";
 	# responses
 	RES[0x00] = "S_OK";
 	RES[0x40] = "I_USB_STATE_UPDATE,$usb";
@@ -456,7 +464,7 @@ BEGIN {
 	delete resData;
 }
 
-/^[0-9]+\t/ {
+/^[0-9]+(\.[0-9]+)?\t/ {
 	gsub(/\r/, "");
 	if ($2 == "in") {
 		reqEsc = processData(reqData, $1, $2, $3, 0, reqEsc);
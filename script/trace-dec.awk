@@ -0,0 +1,77 @@
+#!/usr/bin/gawk -f
+# @file trace-dec.awk
+# @author Daniel Starke
+# @date 2026-10-16
+# @version 2026-10-16
+#
+# VKVM (src/pcf/serial/Vkvm.cpp) binary trace converter.
+# Converts the output of `VkvmDevice::dumpTrace()` into the text trace format
+# which is decoded by prot-dec.awk. The timestamps are given in milliseconds
+# with microsecond resolution.
+#
+# Usage: od -An -v -tx1 vkvm.trc | gawk -f trace-dec.awk | gawk -f prot-dec.awk
+
+# print the current record
+function printRecord(   i) {
+	printf("%.3f\t%s\t", time / 1000, (dir == 0) ? "in" : "out");
+	for (i = 1; i <= size; i++) {
+		if (i > 1) printf(" ");
+		printf("%s", data[i]);
+	}
+	printf("\n");
+}
+
+BEGIN {
+	# record field parser state
+	MAGIC = "56 4B 56 4D 54 52 43 31";
+	magic = "";
+	field = "magic";
+	pos = 0;
+	time = 0;
+	dir = 0;
+	size = 0;
+	delete data;
+}
+
+{
+	for (n = 1; n <= NF; n++) {
+		byte = toupper($n);
+		if (field == "magic") {
+			magic = (pos == 0) ? byte : magic " " byte;
+			if (++pos == 8) {
+				if (magic != MAGIC) {
+					printf("error: invalid trace file format\n") > "/dev/stderr";
+					exit 1;
+				}
+				field = "time";
+				pos = 0;
+				time = 0;
+			}
+		} else if (field == "time") {
+			# 64-bit little-endian value
+			time += strtonum("0x" byte) * (2 ^ (8 * pos));
+			if (++pos == 8) field = "dir";
+		} else if (field == "dir") {
+			dir = strtonum("0x" byte);
+			field = "size";
+		} else if (field == "size") {
+			size = strtonum("0x" byte);
+			delete data;
+			pos = 0;
+			field = "data";
+			if (size == 0) {
+				printRecord();
+				field = "time";
+				time = 0;
+			}
+		} else {
+			data[++pos] = byte;
+			if (pos == size) {
+				printRecord();
+				field = "time";
+				pos = 0;
+				time = 0;
+			}
+		}
+	}
+}
@@ -0,0 +1,684 @@
+/**
+ * @file captureBench.cpp
+ * @author Daniel Starke
+ * @date 2026-10-16
+ * @version 2026-10-16
+ *
+ * Measures the stages of the video path against synthetic frames from
+ * `PatternCaptureDevice`. Needs neither a capture device nor a display.
+ */
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <libpcf/target.h>
+#include <pcf/image/Convert.hpp>
+#include <pcf/image/Tiles.hpp>
+#include <pcf/video/CaptureTest.hpp>
+#ifdef PCF_IS_LINUX
+#include <pcf/video/MjpegBandDecoder.hpp>
+extern "C" {
+#include <libv4lconvert.h>
+#include <linux/videodev2.h>
+#include <turbojpeg.h>
+}
+#endif /* PCF_IS_LINUX */
+
+
+/** Minimum measurement time per variant in milliseconds. */
+#define BENCH_MIN_TIME 200
+/** Number of distinct synthetic frames per measurement. */
+#define BENCH_FRAMES 16
+
+
+using pcf::video::TestCaptureFormat;
+using pcf::video::TestCaptureDevice;
+
+
+namespace {
+
+
+/** Benchmarked frame size. */
+struct Resolution {
+	const char * name; /**< Resolution name. */
+	size_t width; /**< Frame width in pixels. */
+	size_t height; /**< Frame height in pixels. */
+};
+
+
+/** Benchmarked frame format. */
+struct Format {
+	const char * name; /**< Format name as used by the test capture device configuration. */
+	TestCaptureFormat format; /**< Frame format. */
+	uint32_t fourcc; /**< V4L2 pixel format or 0 if not supported by libv4lconvert. */
+};
+
+
+/** All resolutions. */
+const Resolution resolutions[] = {
+	{"640x480", 640, 480},
+	{"1280x720", 1280, 720},
+	{"1920x1080", 1920, 1080}
+};
+
+
+#ifdef PCF_IS_LINUX
+#define BENCH_FOURCC(x) x
+#else /* ! PCF_IS_LINUX */
+#define BENCH_FOURCC(x) 0
+#endif /* PCF_IS_LINUX */
+
+
+/** All uncompressed formats. */
+const Format formats[] = {
+	{"rgb24", pcf::video::TCF_RGB24, BENCH_FOURCC(V4L2_PIX_FMT_RGB24)},
+	{"bgr24", pcf::video::TCF_BGR24, BENCH_FOURCC(V4L2_PIX_FMT_BGR24)},
+	{"yuyv", pcf::video::TCF_YUYV, BENCH_FOURCC(V4L2_PIX_FMT_YUYV)},
+	{"uyvy", pcf::video::TCF_UYVY, BENCH_FOURCC(V4L2_PIX_FMT_UYVY)},
+	{"nv12", pcf::video::TCF_NV12, BENCH_FOURCC(V4L2_PIX_FMT_NV12)},
+	{"i420", pcf::video::TCF_I420, BENCH_FOURCC(V4L2_PIX_FMT_YUV420)}
+};
+
+
+/** Sequence of synthetic frames. */
+typedef std::vector<std::vector<uint8_t>> Frames;
+
+
+/** Set if a stage found a wrong result. */
+bool failed = false;
+
+
+/**
+ * Capture callback which records a fixed number of frames.
+ */
+class FrameRecorder : public pcf::video::CaptureCallback {
+private:
+	size_t frameSize; /**< Bytes per frame. */
+	size_t count; /**< Number of frames to record. */
+	Frames frames; /**< Recorded frames. */
+	std::mutex mutex; /**< Guards `frames`. */
+	std::condition_variable done; /**< Signaled once all frames were recorded. */
+public:
+	/**
+	 * Constructor.
+	 *
+	 * @param[in] size - bytes per frame
+	 * @param[in] n - number of frames to record
+	 */
+	explicit FrameRecorder(const size_t size, const size_t n):
+		frameSize(size),
+		count(n)
+	{}
+
+	/**
+	 * Waits until all frames were recorded and returns them.
+	 *
+	 * @return recorded frames
+	 */
+	Frames wait() {
+		std::unique_lock<std::mutex> lock(this->mutex);
+		this->done.wait(lock, [this]() { return this->frames.size() >= this->count; });
+		return this->frames;
+	}
+
+	virtual void onCapture(const pcf::color::Rgb24 * image, const size_t, const size_t, const pcf::video::CaptureOrientation) {
+		this->record(image);
+	}
+
+	virtual void onCapture(const pcf::color::Bgr24 * image, const size_t, const size_t, const pcf::video::CaptureOrientation) {
+		this->record(image);
+	}
+
+	virtual void onCapture(const pcf::color::Yuyv * image, const size_t, const size_t, const pcf::video::CaptureYuvMatrix, const pcf::video::CaptureYuvRange, const pcf::video::CaptureOrientation) {
+		this->record(image);
+	}
+
+	virtual void onCapture(const pcf::color::Uyvy * image, const size_t, const size_t, const pcf::video::CaptureYuvMatrix, const pcf::video::CaptureYuvRange, const pcf::video::CaptureOrientation) {
+		this->record(image);
+	}
+
+	virtual void onCapture(const uint8_t * y, const uint8_t *, const size_t, const size_t, const pcf::video::CaptureYuvMatrix, const pcf::video::CaptureYuvRange, const pcf::video::CaptureOrientation) {
+		/* the test capture device passes planes back-to-back */
+		this->record(y);
+	}
+
+	virtual void onCapture(const uint8_t * y, const uint8_t *, const uint8_t *, const size_t, const size_t, const pcf::video::CaptureYuvMatrix, const pcf::video::CaptureYuvRange, const pcf::video::CaptureOrientation) {
+		this->record(y);
+	}
+private:
+	/**
+	 * Records the given frame if more frames are needed.
+	 *
+	 * @param[in] image - frame data with `frameSize` bytes
+	 */
+	void record(const void * image) {
+		std::lock_guard<std::mutex> lock(this->mutex);
+		if (this->frames.size() >= this->count) return;
+		const uint8_t * ptr = static_cast<const uint8_t *>(image);
+		this->frames.emplace_back(ptr, ptr + this->frameSize);
+		if (this->frames.size() >= this->count) this->done.notify_all();
+	}
+};
+
+
+/**
+ * Generates synthetic frames with the test pattern capture device.
+ *
+ * @param[in] format - frame format
+ * @param[in] res - frame size
+ * @param[in] pattern - test pattern name
+ * @return generated frames
+ */
+Frames generateFrames(const Format & format, const Resolution & res, const char * pattern) {
+	char config[128];
+	snprintf(config, sizeof(config), "width=%u;height=%u;fps=0;format=%s;pattern=%s", unsigned(res.width), unsigned(res.height), format.name, pattern);
+	pcf::video::PatternCaptureDevice device;
+	if (device.setConfiguration(config, NULL) != pcf::video::CaptureDevice::RC_SUCCESS) {
+		fprintf(stderr, "Error: invalid test pattern configuration \"%s\".\n", config);
+		exit(EXIT_FAILURE);
+	}
+	FrameRecorder recorder(TestCaptureDevice::getFrameSize(format.format, res.width, res.height), BENCH_FRAMES);
+	if ( ! device.start(0, recorder) ) {
+		fprintf(stderr, "Error: failed to start the test pattern capture device.\n");
+		exit(EXIT_FAILURE);
+	}
+	Frames frames = recorder.wait();
+	device.stop();
+	return frames;
+}
+
+
+/**
+ * Calls the given function with increasing frame indices until the minimum
+ * measurement time elapsed.
+ *
+ * @param[in] fn - function to measure
+ * @return nanoseconds per call
+ * @tparam Fn - function type `void (size_t)`
+ */
+template <typename Fn>
+double measure(Fn fn) {
+	typedef std::chrono::steady_clock Clock;
+	size_t calls = 0;
+	const Clock::time_point start = Clock::now();
+	Clock::duration elapsed;
+	do {
+		for (size_t i = 0; i < BENCH_FRAMES; i++) fn(i);
+		calls += BENCH_FRAMES;
+		elapsed = Clock::now() - start;
+	} while (elapsed < std::chrono::milliseconds(BENCH_MIN_TIME));
+	return double(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / double(calls);
+}
+
+
+/**
+ * Outputs a single result line.
+ *
+ * @param[in] stage - pipeline stage
+ * @param[in] variant - implementation variant
+ * @param[in] format - frame format name
+ * @param[in] res - frame size
+ * @param[in] bytes - source bytes per frame
+ * @param[in] ns - nanoseconds per frame
+ */
+void report(const char * stage, const char * variant, const char * format, const Resolution & res, const size_t bytes, const double ns) {
+	printf("%s\t%s\t%s\t%s\t%.0f\t%.1f\n", stage, variant, format, res.name, ns, double(bytes) * 1000.0 / ns);
+	fflush(stdout);
+}
+
+
+/**
+ * Returns the location of the YUV components of the given frame like VkvmView does
+ * for its CPU conversion.
+ *
+ * @param[in] format - YUV frame format
+ * @param[in] data - frame data
+ * @param[in] w - frame width
+ * @param[in] h - frame height
+ * @return YUV component locations
+ */
+pcf::image::YuvImage getYuvImage(const TestCaptureFormat format, const uint8_t * data, const size_t w, const size_t h) {
+	const size_t lumaSize = w * h;
+	const size_t cw = (w + 1) / 2;
+	const size_t chromaSize = cw * ((h + 1) / 2);
+	switch (format) {
+	case pcf::video::TCF_YUYV:
+		return pcf::image::YuvImage{data, 2, w * 2, data + 1, data + 3, 4, w * 2, 0};
+	case pcf::video::TCF_UYVY:
+		return pcf::image::YuvImage{data + 1, 2, w * 2, data, data + 2, 4, w * 2, 0};
+	case pcf::video::TCF_NV12:
+		return pcf::image::YuvImage{data, 1, w, data + lumaSize, data + lumaSize + 1, 2, cw * 2, 1};
+	default: /* TCF_I420 */
+		return pcf::image::YuvImage{data, 1, w, data + lumaSize, data + lumaSize + chromaSize, 1, cw, 1};
+	}
+}
+
+
+/**
+ * Describes the tile planes of the given frame format like VkvmView does.
+ *
+ * @param[in] format - frame format
+ * @param[in] w - frame width
+ * @param[in] h - frame height
+ * @param[out] planes - receives the tile planes
+ * @return number of planes
+ */
+size_t getTilePlanes(const TestCaptureFormat format, const size_t w, const size_t h, pcf::image::TilePlane (& planes)[3]) {
+	const size_t tile = PCF_IMAGE_TILE_SIZE;
+	switch (format) {
+	case pcf::video::TCF_RGB24:
+	case pcf::video::TCF_BGR24:
+		planes[0] = pcf::image::TilePlane{0, w * 3, h, tile * 3, tile};
+		return 1;
+	case pcf::video::TCF_YUYV:
+	case pcf::video::TCF_UYVY:
+		planes[0] = pcf::image::TilePlane{0, w * 2, h, tile * 2, tile};
+		return 1;
+	case pcf::video::TCF_NV12:
+		planes[0] = pcf::image::TilePlane{0, w, h, tile, tile};
+		planes[1] = pcf::image::TilePlane{w * h, w, h / 2, tile, tile / 2};
+		return 2;
+	default: /* TCF_I420 */
+		planes[0] = pcf::image::TilePlane{0, w, h, tile, tile};
+		planes[1] = pcf::image::TilePlane{w * h, w / 2, h / 2, tile / 2, tile / 2};
+		planes[2] = pcf::image::TilePlane{(w * h) + ((w / 2) * (h / 2)), w / 2, h / 2, tile / 2, tile / 2};
+		return 3;
+	}
+}
+
+
+/**
+ * Returns the number of tiles covering the given number of pixels.
+ *
+ * @param[in] size - width or height in pixels
+ * @return number of tiles
+ */
+inline size_t tileCount(const size_t size) {
+	return (size + PCF_IMAGE_TILE_SIZE - 1) / PCF_IMAGE_TILE_SIZE;
+}
+
+
+/**
+ * Measures the conversion of BGR24, YUV and MJPEG frames to RGB24 with the native
+ * implementation and libv4lconvert.
+ */
+void benchConvert() {
+	for (const Resolution & res : resolutions) {
+		std::vector<uint8_t> rgb(res.width * res.height * 3);
+		for (const Format & format : formats) {
+			if (format.format == pcf::video::TCF_RGB24) continue;
+			const Frames frames = generateFrames(format, res, "moving");
+			const size_t bytes = frames[0].size();
+			if (format.format == pcf::video::TCF_BGR24) {
+				report("convert", "native", format.name, res, bytes, measure([&](const size_t i) {
+					pcf::image::convertBgr24ToRgb24(frames[i].data(), res.width * 3, res.width, res.height, rgb.data());
+				}));
+			} else {
+				const pcf::image::YuvCoefficients c = pcf::image::getYuvCoefficients(false, false);
+				report("convert", "native", format.name, res, bytes, measure([&](const size_t i) {
+					pcf::image::convertYuvToRgb24(getYuvImage(format.format, frames[i].data(), res.width, res.height), res.width, res.height, c, rgb.data());
+				}));
+			}
+#ifdef PCF_IS_LINUX
+			struct v4lconvert_data * converter = v4lconvert_create(-1);
+			if (converter == NULL) {
+				fprintf(stderr, "Warning: skipping libv4lconvert for %s (initialization failed)\n", format.name);
+				continue;
+			}
+			struct v4l2_format srcFmt, dstFmt;
+			memset(&srcFmt, 0, sizeof(srcFmt));
+			srcFmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+			srcFmt.fmt.pix.width = __u32(res.width);
+			srcFmt.fmt.pix.height = __u32(res.height);
+			srcFmt.fmt.pix.pixelformat = format.fourcc;
+			srcFmt.fmt.pix.field = V4L2_FIELD_NONE;
+			srcFmt.fmt.pix.bytesperline = __u32(bytes / res.height);
+			if (format.format == pcf::video::TCF_NV12 || format.format == pcf::video::TCF_I420) srcFmt.fmt.pix.bytesperline = __u32(res.width);
+			srcFmt.fmt.pix.sizeimage = __u32(bytes);
+			dstFmt = srcFmt;
+			dstFmt.fmt.pix.pixelformat = V4L2_PIX_FMT_RGB24;
+			dstFmt.fmt.pix.bytesperline = __u32(res.width * 3);
+			dstFmt.fmt.pix.sizeimage = __u32(rgb.size());
+			if (v4lconvert_convert(converter, &srcFmt, &dstFmt, const_cast<unsigned char *>(frames[0].data()), int(bytes), rgb.data(), int(rgb.size())) < 0) {
+				fprintf(stderr, "Warning: v4lconvert_convert failed for %s (%s)\n", format.name, v4lconvert_get_error_message(converter));
+			} else {
+				report("convert", "v4lconvert", format.name, res, bytes, measure([&](const size_t i) {
+					v4lconvert_convert(converter, &srcFmt, &dstFmt, const_cast<unsigned char *>(frames[i].data()), int(bytes), rgb.data(), int(rgb.size()));
+				}));
+			}
+			v4lconvert_destroy(converter);
+#endif /* PCF_IS_LINUX */
+		}
+#ifdef PCF_IS_LINUX
+		/* MJPEG frames encoded from the RGB24 test pattern with 4:2:2 chroma subsampling like common UVC devices */
+		const Frames rgbFrames = generateFrames(formats[0], res, "moving");
+		tjhandle encoder = tjInitCompress();
+		tjhandle decoder = tjInitDecompress();
+		struct v4lconvert_data * converter = v4lconvert_create(-1);
+		if (encoder == NULL || decoder == NULL || converter == NULL) {
+			fprintf(stderr, "Warning: skipping MJPEG conversion (initialization failed)\n");
+		} else {
+			Frames jpegFrames;
+			size_t jpegBytes = 0;
+			for (const std::vector<uint8_t> & frame : rgbFrames) {
+				unsigned char * jpegData = NULL;
+				unsigned long jpegSize = 0;
+				if (tjCompress2(encoder, frame.data(), int(res.width), 0, int(res.height), TJPF_RGB, &jpegData, &jpegSize, TJSAMP_422, 90, TJFLAG_FASTDCT) == 0) {
+					jpegFrames.emplace_back(jpegData, jpegData + jpegSize);
+					jpegBytes += size_t(jpegSize);
+				}
+				tjFree(jpegData);
+			}
+			if (jpegFrames.size() == BENCH_FRAMES) {
+				jpegBytes /= BENCH_FRAMES;
+				report("convert", "turbojpeg", "mjpeg", res, jpegBytes, measure([&](const size_t i) {
+					tjDecompress2(decoder, jpegFrames[i].data(), static_cast<unsigned long>(jpegFrames[i].size()), rgb.data(), int(res.width), 0, int(res.height), TJPF_RGB, TJFLAG_FASTDCT);
+				}));
+				struct v4l2_format srcFmt, dstFmt;
+				memset(&srcFmt, 0, sizeof(srcFmt));
+				srcFmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+				srcFmt.fmt.pix.width = __u32(res.width);
+				srcFmt.fmt.pix.height = __u32(res.height);
+				srcFmt.fmt.pix.pixelformat = V4L2_PIX_FMT_MJPEG;
+				srcFmt.fmt.pix.field = V4L2_FIELD_NONE;
+				dstFmt = srcFmt;
+				dstFmt.fmt.pix.pixelformat = V4L2_PIX_FMT_RGB24;
+				dstFmt.fmt.pix.bytesperline = __u32(res.width * 3);
+				dstFmt.fmt.pix.sizeimage = __u32(rgb.size());
+				report("convert", "v4lconvert", "mjpeg", res, jpegBytes, measure([&](const size_t i) {
+					v4lconvert_convert(converter, &srcFmt, &dstFmt, jpegFrames[i].data(), int(jpegFrames[i].size()), rgb.data(), int(rgb.size()));
+				}));
+			}
+		}
+		if (converter != NULL) v4lconvert_destroy(converter);
+		if (decoder != NULL) tjDestroy(decoder);
+		if (encoder != NULL) tjDestroy(encoder);
+#endif /* PCF_IS_LINUX */
+	}
+}
+
+
+#ifdef PCF_IS_LINUX
+/**
+ * Encodes the given RGB24 frame as JPEG with a restart marker after each MCU row like
+ * common UVC devices. TurboJPEG cannot emit restart markers. Hence, each MCU row is
+ * encoded as separate image and the entropy coded data is joined with restart markers.
+ *
+ * @param[in] encoder - TurboJPEG compressor
+ * @param[in] frame - RGB24 frame
+ * @param[in] res - frame size
+ * @param[in] subsamp - TurboJPEG chroma subsampling
+ * @param[out] out - receives the JPEG image
+ * @return true on success, else false
+ */
+bool encodeWithRestarts(tjhandle encoder, const std::vector<uint8_t> & frame, const Resolution & res, const int subsamp, std::vector<uint8_t> & out) {
+	const size_t mcuWidth = size_t(tjMCUWidth[subsamp]);
+	const size_t mcuHeight = size_t(tjMCUHeight[subsamp]);
+	const size_t interval = (res.width + mcuWidth - 1) / mcuWidth;
+	const size_t pitch = res.width * 3;
+	bool ok = true;
+	out.clear();
+	for (size_t row = 0; row < res.height && ok; row += mcuHeight) {
+		unsigned char * jpegData = NULL;
+		unsigned long jpegSize = 0;
+		ok = tjCompress2(encoder, frame.data() + (row * pitch), int(res.width), int(pitch), int(std::min(mcuHeight, res.height - row)), TJPF_RGB, &jpegData, &jpegSize, subsamp, 90, TJFLAG_FASTDCT) == 0;
+		/* locate the frame header and the entropy coded data up to the end of image marker */
+		const size_t size = size_t(jpegSize);
+		size_t pos = 2;
+		size_t sof = 0;
+		size_t sos = 0;
+		while (ok && sos == 0 && (pos + 4) <= size && jpegData[pos] == 0xFF) {
+			if (jpegData[pos + 1] == 0xC0) sof = pos;
+			if (jpegData[pos + 1] == 0xDA) sos = pos;
+			pos += 2 + ((size_t(jpegData[pos + 2]) << 8) | size_t(jpegData[pos + 3]));
+		}
+		ok = ok && sof != 0 && sos != 0 && (pos + 2) <= size && jpegData[size - 2] == 0xFF && jpegData[size - 1] == 0xD9;
+		if (ok && row == 0) {
+			/* header with the full image height and a restart interval of one MCU row */
+			const uint8_t dri[] = {0xFF, 0xDD, 0x00, 0x04, uint8_t(interval >> 8), uint8_t(interval)};
+			out.assign(jpegData, jpegData + sos);
+			out[sof + 5] = uint8_t(res.height >> 8);
+			out[sof + 6] = uint8_t(res.height);
+			out.insert(out.end(), dri, dri + sizeof(dri));
+			out.insert(out.end(), jpegData + sos, jpegData + size - 2);
+		} else if ( ok ) {
+			out.push_back(0xFF);
+			out.push_back(uint8_t(0xD0 + (((row / mcuHeight) - 1) & 7)));
+			out.insert(out.end(), jpegData + pos, jpegData + size - 2);
+		}
+		tjFree(jpegData);
+	}
+	out.push_back(0xFF);
+	out.push_back(0xD9);
+	return ok;
+}
+#endif /* PCF_IS_LINUX */
+
+
+/**
+ * Verifies that the multi-threaded band decoding of MJPEG frames with restart markers
+ * yields the same image as a single TurboJPEG call for 4:2:2 and 4:2:0 chroma subsampling
+ * at every scaling denominator and measures both variants at full size.
+ */
+void benchBand() {
+#ifdef PCF_IS_LINUX
+	static const struct {
+		const char * name;
+		int subsamp;
+	} samplings[] = {
+		{"mjpeg422", TJSAMP_422},
+		{"mjpeg420", TJSAMP_420}
+	};
+	static const size_t denoms[] = {1, 2, 4};
+	/* use at least two threads to verify the split on single core machines, too */
+	const size_t threads = std::max(std::min(size_t(std::thread::hardware_concurrency()), size_t(PCF_V4L2_MJPEG_MAX_THREADS)), size_t(2));
+	pcf::video::MjpegBandDecoder bandDecoder;
+	tjhandle encoder = tjInitCompress();
+	tjhandle decoder = tjInitDecompress();
+	if (encoder == NULL || decoder == NULL || ( ! bandDecoder.start(threads) )) {
+		fprintf(stderr, "Error: failed to initialize the MJPEG band decoding.\n");
+		failed = true;
+	} else {
+		for (const Resolution & res : resolutions) {
+			if ((res.width * res.height) < PCF_V4L2_MJPEG_MIN_PIXELS) continue;
+			const Frames rgbFrames = generateFrames(formats[0], res, "moving");
+			for (const auto & sampling : samplings) {
+				Frames jpegFrames(rgbFrames.size());
+				size_t jpegBytes = 0;
+				bool encoded = true;
+				for (size_t i = 0; i < rgbFrames.size() && encoded; i++) {
+					encoded = encodeWithRestarts(encoder, rgbFrames[i], res, sampling.subsamp, jpegFrames[i]);
+					jpegBytes += jpegFrames[i].size();
+				}
+				if ( ! encoded ) {
+					fprintf(stderr, "Error: failed to encode the %s test frames.\n", sampling.name);
+					failed = true;
+					continue;
+				}
+				jpegBytes /= BENCH_FRAMES;
+				std::vector<uint8_t> single(res.width * res.height * 3);
+				std::vector<uint8_t> banded(single.size());
+				const char * err = NULL;
+				for (const size_t denom : denoms) {
+					const tjscalingfactor factor = {1, int(denom)};
+					const int w = TJSCALED(int(res.width), factor);
+					const int h = TJSCALED(int(res.height), factor);
+					const size_t bytes = size_t(w) * size_t(h) * 3;
+					for (const std::vector<uint8_t> & jpeg : jpegFrames) {
+						tjDecompress2(decoder, jpeg.data(), static_cast<unsigned long>(jpeg.size()), single.data(), w, 0, h, TJPF_RGB, TJFLAG_FASTDCT);
+						if (( ! bandDecoder.decode(jpeg.data(), jpeg.size(), res.width, res.height, denom, banded.data(), err) ) || err != NULL || memcmp(single.data(), banded.data(), bytes) != 0) {
+							fprintf(stderr, "Error: band decoding of %s %s at 1/%u differs from a single decoder call.\n", sampling.name, res.name, unsigned(denom));
+							failed = true;
+							break;
+						}
+					}
+				}
+				report("band", "turbojpeg", sampling.name, res, jpegBytes, measure([&](const size_t i) {
+					tjDecompress2(decoder, jpegFrames[i].data(), static_cast<unsigned long>(jpegFrames[i].size()), single.data(), int(res.width), 0, int(res.height), TJPF_RGB, TJFLAG_FASTDCT);
+				}));
+				report("band", "bands", sampling.name, res, jpegBytes, measure([&](const size_t i) {
+					bandDecoder.decode(jpegFrames[i].data(), jpegFrames[i].size(), res.width, res.height, 1, banded.data(), err);
+				}));
+			}
+		}
+	}
+	if (decoder != NULL) tjDestroy(decoder);
+	if (encoder != NULL) tjDestroy(encoder);
+#endif /* PCF_IS_LINUX */
+}
+
+
+/**
+ * Measures the copy of each captured frame into the triple buffer of VkvmView
+ * as done by `VkvmView::updateImage()`.
+ */
+void benchCopy() {
+	for (const Resolution & res : resolutions) {
+		for (const Format & format : formats) {
+			const Frames frames = generateFrames(format, res, "moving");
+			const size_t bytes = frames[0].size();
+			std::vector<uint8_t> slots[3];
+			for (std::vector<uint8_t> & slot : slots) slot.resize(bytes);
+			report("copy", "memcpy", format.name, res, bytes, measure([&](const size_t i) {
+				memcpy(slots[i % 3].data(), frames[i].data(), bytes);
+			}));
+		}
+	}
+}
+
+
+/**
+ * Measures the CPU side of the texture upload strategies: copying the whole frame into
+ * the mapped pixel buffer object versus copying only the changed tiles of a moving test
+ * pattern as read via `GL_UNPACK_ROW_LENGTH`. The throughput refers to the whole frame.
+ */
+void benchUpload() {
+	for (const Resolution & res : resolutions) {
+		for (const Format & format : formats) {
+			const Frames frames = generateFrames(format, res, "moving");
+			const size_t bytes = frames[0].size();
+			std::vector<uint8_t> staging(bytes);
+			report("upload", "full", format.name, res, bytes, measure([&](const size_t i) {
+				memcpy(staging.data(), frames[i].data(), bytes);
+			}));
+			/* changed tiles of each frame against its predecessor */
+			pcf::image::TilePlane planes[3];
+			const size_t planeCount = getTilePlanes(format.format, res.width, res.height, planes);
+			const size_t tilesX = tileCount(res.width);
+			const size_t tilesY = tileCount(res.height);
+			std::vector<uint8_t> reference(frames[BENCH_FRAMES - 1]);
+			std::vector<std::vector<uint8_t>> dirty(BENCH_FRAMES, std::vector<uint8_t>(tilesX * tilesY));
+			size_t changed = 0;
+			for (size_t i = 0; i < BENCH_FRAMES; i++) {
+				changed += pcf::image::markChangedTiles(frames[i].data(), reference.data(), planes, planeCount, tilesX, tilesY, 0, dirty[i].data());
+			}
+			char variant[32];
+			snprintf(variant, sizeof(variant), "tiles-%u%%", unsigned((changed * 100) / (BENCH_FRAMES * tilesX * tilesY)));
+			report("upload", variant, format.name, res, bytes, measure([&](const size_t i) {
+				const uint8_t * mask = dirty[i].data();
+				for (size_t n = 0; n < planeCount; n++) {
+					const pcf::image::TilePlane & plane = planes[n];
+					for (size_t ty = 0; ty < tilesY; ty++) {
+						const size_t y = ty * plane.tileHeight;
+						if (y >= plane.height) break;
+						const size_t rows = std::min(plane.tileHeight, plane.height - y);
+						for (size_t tx = 0; tx < tilesX; tx++) {
+							if (mask[(ty * tilesX) + tx] == 0) continue;
+							/* merge horizontally adjacent changed tiles into a single run */
+							size_t last = tx;
+							while ((last + 1) < tilesX && mask[(ty * tilesX) + last + 1] != 0) last++;
+							const size_t x = tx * plane.tileWidth;
+							if (x < plane.width) {
+								const size_t runBytes = std::min((last + 1 - tx) * plane.tileWidth, plane.width - x);
+								for (size_t row = 0; row < rows; row++) {
+									const size_t offset = plane.offset + ((y + row) * plane.width) + x;
+									memcpy(staging.data() + offset, frames[i].data() + offset, runBytes);
+								}
+							}
+							tx = last;
+						}
+					}
+				}
+			}));
+		}
+	}
+}
+
+
+/**
+ * Measures the detection of changed tiles for static, moving and fully changing
+ * test patterns.
+ */
+void benchDiff() {
+	static const char * const patterns[] = {"static", "moving", "full"};
+	for (const Resolution & res : resolutions) {
+		for (const Format & format : formats) {
+			if (format.format == pcf::video::TCF_BGR24 || format.format == pcf::video::TCF_UYVY) continue; /* same as RGB24 and YUYV */
+			pcf::image::TilePlane planes[3];
+			const size_t planeCount = getTilePlanes(format.format, res.width, res.height, planes);
+			const size_t tilesX = tileCount(res.width);
+			const size_t tilesY = tileCount(res.height);
+			std::vector<uint8_t> changed(tilesX * tilesY);
+			for (const char * pattern : patterns) {
+				const Frames frames = generateFrames(format, res, pattern);
+				const size_t bytes = frames[0].size();
+				std::vector<uint8_t> reference(frames[0]);
+				report("diff", pattern, format.name, res, bytes, measure([&](const size_t i) {
+					/* uncompressed frames are compared exactly (see `CaptureTiming::noise`) */
+					pcf::image::markChangedTiles(frames[i].data(), reference.data(), planes, planeCount, tilesX, tilesY, 0, changed.data());
+				}));
+			}
+		}
+	}
+}
+
+
+/** Benchmarked pipeline stage. */
+struct Stage {
+	const char * name; /**< Stage name. */
+	void (* fn)(); /**< Benchmark function. */
+};
+
+
+/** All stages in pipeline order. */
+const Stage stages[] = {
+	{"convert", benchConvert},
+	{"band", benchBand},
+	{"copy", benchCopy},
+	{"upload", benchUpload},
+	{"diff", benchDiff}
+};
+
+
+} /* anonymous namespace */
+
+
+/**
+ * Main entry point.
+ *
+ * @param[in] argc - number of command-line arguments
+ * @param[in] argv - command-line arguments; optional list of stages to run
+ * @return program exit code
+ */
+int main(int argc, char * argv[]) {
+	for (int n = 1; n < argc; n++) {
+		bool found = false;
+		for (const Stage & stage : stages) found = found || strcmp(argv[n], stage.name) == 0;
+		if ( ! found ) {
+			fprintf(stderr, "Error: unknown stage \"%s\". Possible stages are: convert, band, copy, upload, diff\n", argv[n]);
+			return EXIT_FAILURE;
+		}
+	}
+	printf("stage\tvariant\tformat\tsize\tns/frame\tMB/s\n");
+	for (const Stage & stage : stages) {
+		bool selected = (argc < 2);
+		for (int n = 1; n < argc; n++) selected = selected || strcmp(argv[n], stage.name) == 0;
+		if ( selected ) stage.fn();
+	}
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,123 @@
+/**
+ * @file crc16Bench.cpp
+ * @author Daniel Starke
+ * @date 2026-10-16
+ * @version 2026-10-16
+ *
+ * Cross-checks the host CRC16 variants bit-exact against the nibble table
+ * implementation used by the periphery and measures their throughput.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <vkm-periphery/Crc16.hpp>
+
+
+/** Minimum measurement time per variant and size in milliseconds. */
+#define BENCH_MIN_TIME 200
+
+
+namespace {
+
+
+/** CRC16 update function over a byte range. */
+typedef uint16_t (* UpdateFn)(uint16_t, const uint8_t *, const uint8_t *);
+
+
+/**
+ * Updates the given intermediate CRC16 value via nibble table.
+ *
+ * @param[in] crc - intermediate CRC16 value
+ * @param[in] first - beginning of the data
+ * @param[in] last - one past the end of the data
+ * @return updated intermediate CRC16 value
+ */
+uint16_t updateNibble(uint16_t crc, const uint8_t * first, const uint8_t * last) {
+	while (first != last) crc = crc16UpdateNibble(crc, *first++);
+	return crc;
+}
+
+
+/** Benchmarked variant. */
+struct Variant {
+	const char * name; /**< Variant name. */
+	UpdateFn fn; /**< Update function. */
+};
+
+
+/** All variants. The first one is the reference. */
+const Variant variants[] = {
+	{"nibble", updateNibble},
+	{"table", crc16UpdateTable},
+	{"slicing8", crc16UpdateSlicing}
+};
+
+
+/**
+ * Compares all variants against the reference for all lengths and alignments
+ * up to the given size.
+ *
+ * @param[in] data - random test data
+ * @param[in] size - test data size
+ * @return true if all variants match, else false
+ */
+bool crossCheck(const std::vector<uint8_t> & data, const size_t size) {
+	for (size_t offset = 0; offset < 8; offset++) {
+		for (size_t len = 0; (offset + len) <= size; len++) {
+			const uint8_t * first = data.data() + offset;
+			const uint16_t init = uint16_t(0xFFFF ^ (len * 0x9E37));
+			const uint16_t expected = variants[0].fn(init, first, first + len);
+			for (size_t v = 1; v < (sizeof(variants) / sizeof(*variants)); v++) {
+				const uint16_t res = variants[v].fn(init, first, first + len);
+				if (res != expected) {
+					fprintf(stderr, "Error: %s returned 0x%04X instead of 0x%04X for %u bytes at offset %u.\n", variants[v].name, unsigned(res), unsigned(expected), unsigned(len), unsigned(offset));
+					return false;
+				}
+			}
+		}
+	}
+	/* check value from RFC 1662 appendix C.2 */
+	static const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+	const uint16_t crc = uint16_t(Crc16(check, check + sizeof(check)));
+	if (crc != 0x906E) {
+		fprintf(stderr, "Error: Crc16 returned 0x%04X instead of 0x906E for the check sequence.\n", unsigned(crc));
+		return false;
+	}
+	return true;
+}
+
+
+} /* anonymous namespace */
+
+
+/**
+ * Main entry point.
+ */
+int main() {
+	typedef std::chrono::steady_clock Clock;
+	static const size_t sizes[] = {8, 64, 256, 4096};
+	std::vector<uint8_t> data(4096 + 8);
+	srand(1);
+	for (uint8_t & b : data) b = uint8_t(rand());
+	if ( ! crossCheck(data, 512) ) return EXIT_FAILURE;
+	printf("variant\tbytes\tns/call\tMB/s\n");
+	for (const Variant & variant : variants) {
+		for (const size_t size : sizes) {
+			volatile uint16_t sink = 0;
+			size_t calls = 0;
+			const Clock::time_point start = Clock::now();
+			Clock::duration elapsed;
+			do {
+				for (size_t i = 0; i < 1000; i++) {
+					sink = variant.fn(uint16_t(sink ^ 0xFFFF), data.data(), data.data() + size);
+				}
+				calls += 1000;
+				elapsed = Clock::now() - start;
+			} while (elapsed < std::chrono::milliseconds(BENCH_MIN_TIME));
+			const double ns = double(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+			printf("%s\t%u\t%.1f\t%.1f\n", variant.name, unsigned(size), ns / double(calls), double(calls * size) * 1000.0 / ns);
+		}
+	}
+	return EXIT_SUCCESS;
+}
@@ -2,7 +2,7 @@
  * @file keyTest.cpp
  * @author Daniel Starke
  * @date 2019-11-03
- * @version 2023-10-08
+ * @version 2026-10-16
  */
 #include <cstdio>
 #include <cstring>
@@ -79,6 +79,18 @@ public:
 		return true;
 	}
 
+	/**
+	 * Writes the binary protocol trace of the device to the given file.
+	 *
+	 * @param[in] tracePath - output file path
+	 * @return true on success, else false
+	 */
+	bool dumpTrace(const char * tracePath) const {
+		if ( this->device.dumpTrace(tracePath) ) return true;
+		fprintf(stderr, "Error: Failed to write protocol trace \"%s\".\n", tracePath);
+		return false;
+	}
+
 	/**
 	 * Waits for all operations to finish.
 	 */
@@ -468,9 +480,10 @@ static bool startWith(const char * start, const char * str) {
  */
 static void printHelp() {
 	printf(
-		"keyTest <serial>\n"
+		"keyTest [-t <file>] <serial>\n"
 		"\n"
-		"serial - path to the serial connected VKVM device\n"
+		"-t <file> - write the protocol trace to this file on exit\n"
+		"serial    - path to the serial connected VKVM device\n"
 	);
 }
 
@@ -487,13 +500,24 @@ int main(int argc, char ** argv) {
 		printHelp();
 		return EXIT_SUCCESS;
 	}
+	const char * trace = NULL;
+	int i = 1;
+	if (strcmp(argv[i], "-t") == 0) {
+		if ((i + 2) >= argc) {
+			fprintf(stderr, "Error: Missing protocol trace file path or serial device path.\n");
+			return EXIT_FAILURE;
+		}
+		trace = argv[i + 1];
+		i += 2;
+	}
 	try {
 		KeyTest tester;
-		if ( ! tester.start(argv[1]) ) {
-			fprintf(stderr, "Error: Failed to open serial device \"%s\". Invalid port?\n", argv[1]);
+		if ( ! tester.start(argv[i]) ) {
+			fprintf(stderr, "Error: Failed to open serial device \"%s\". Invalid port?\n", argv[i]);
 			return EXIT_FAILURE;
 		}
 		tester.join();
+		if (trace != NULL && ( ! tester.dumpTrace(trace) )) return EXIT_FAILURE;
 	} catch (const std::exception & e) {
 		fprintf(stderr, "Error: %s\n", e.what());
 		return EXIT_FAILURE;
@@ -2,7 +2,7 @@
  * @file serial.c
  * @author Daniel Starke
  * @date 2019-03-26
- * @version 2026-06-14
+ * @version 2026-10-16
  */
 #include <stdio.h>
 #include <string.h>
@@ -1161,6 +1161,24 @@ int ser_clear(tSerial * ser) {
 }
 
 
+/**
+ * Returns the file descriptor of the given serial interface. This can be used
+ * to wait for incoming data via `poll()`, `epoll_wait()` or similar functions.
+ * Use `ser_read()` and `ser_write()` for the actual data transfer.
+ *
+ * @param[in] ser - serial interface context
+ * @return file descriptor or -1 on error
+ */
+int ser_getFd(tSerial * ser) {
+	if (ser == NULL) {
+		ser_lastErrorValue = SE_INVALID_ARG;
+		return -1;
+	}
+	ser_lastErrorValue = SE_SUCCESS;
+	return ser->port;
+}
+
+
 /**
  * Frees the given serial interface context. The context is invalid after this call.
  *
@@ -2,7 +2,7 @@
  * @file serial.h
  * @author Daniel Starke
  * @date 2019-03-26
- * @version 2023-06-06
+ * @version 2026-10-16
  */
 #ifndef __LIBPCF_SERIAL_H__
 #define __LIBPCF_SERIAL_H__
@@ -91,6 +91,9 @@ ssize_t ser_write(tSerial * ser, const uint8_t * buf, const size_t size, const s
 int ser_clear(tSerial * ser);
 void ser_delete(tSerial * ser);
 tSerError ser_lastError(void);
+#ifdef PCF_IS_LINUX
+int ser_getFd(tSerial * ser);
+#endif /* PCF_IS_LINUX */
 
 
 #ifdef __cplusplus
@@ -2,7 +2,7 @@
  * @file Utility.hpp
  * @author Daniel Starke
  * @date 2019-10-01
- * @version 2023-10-03
+ * @version 2026-10-16
  */
 #ifndef __PCF_COLOR_UTILITY_HPP__
 #define __PCF_COLOR_UTILITY_HPP__
@@ -317,6 +317,58 @@ struct Bgr32 {
 };
 
 
+/**
+ * Helper class to handle the packed YUYV (YUY2) color format. One value
+ * holds two horizontally adjacent pixels which share their chroma.
+ */
+struct Yuyv {
+	uint8_t y0;
+	uint8_t u;
+	uint8_t y1;
+	uint8_t v;
+
+	explicit inline Yuyv():
+		y0(0),
+		u(0x80),
+		y1(0),
+		v(0x80)
+	{}
+
+	explicit inline Yuyv(const uint8_t y0Val, const uint8_t uVal, const uint8_t y1Val, const uint8_t vVal):
+		y0(y0Val),
+		u(uVal),
+		y1(y1Val),
+		v(vVal)
+	{}
+};
+
+
+/**
+ * Helper class to handle the packed UYVY color format. One value
+ * holds two horizontally adjacent pixels which share their chroma.
+ */
+struct Uyvy {
+	uint8_t u;
+	uint8_t y0;
+	uint8_t v;
+	uint8_t y1;
+
+	explicit inline Uyvy():
+		u(0x80),
+		y0(0),
+		v(0x80),
+		y1(0)
+	{}
+
+	explicit inline Uyvy(const uint8_t y0Val, const uint8_t uVal, const uint8_t y1Val, const uint8_t vVal):
+		u(uVal),
+		y0(y0Val),
+		v(vVal),
+		y1(y1Val)
+	{}
+};
+
+
 } /* namespace color */
 } /* namespace pcf */
 
@@ -2,9 +2,9 @@
  * @file VkvmControl.cpp
  * @author Daniel Starke
  * @date 2019-10-06
- * @version 2026-06-14
+ * @version 2026-10-16
  *
- * @todo reconnect last capture/serial device if temporary lost (with old settings)
+ * @todo reconnect last serial device if temporary lost (with old settings)
  */
 #include <algorithm>
 #include <condition_variable>
@@ -35,6 +35,10 @@
 #define SERIAL_SPEED 115200
 #define SERIAL_FRAMING SFR_8N1
 #define SERIAL_FLOW SFC_NONE
+#define SERIAL_TIMEOUT 1000 /* ms */
+#define SERIAL_TICK_DURATION 100 /* ms */
+#define SERIAL_REQUEST_WINDOW 4 /* outstanding requests */
+#define SERIAL_TRACE_FILE "vkvm.trc"
 
 
 namespace pcf {
@@ -1062,6 +1066,7 @@ void VkvmControl::init() {
 	int y1 = 0;
 	int x1 = 1;
 
+	lostVideoDevice = NULL;
 	serialSend = NULL;
 	serialOn = false;
 	serialChange = false;
@@ -1091,6 +1096,8 @@ void VkvmControl::init() {
 	Fl::get_mouse(lastMouseX, lastMouseY);
 	lastReason = DisconnectReason::COUNT;
 	licenseWin = NULL;
+	/* serve the periphery connection by the event driven reactor if supported (no periodic wake ups) */
+	pcf::serial::VkvmDevice::setSharedReactor(true);
 
 	/* changes here need to be done also in VkvmControl::onSendKey() and VkvmControl::onPaste() */
 	static const Fl_Menu_Item sendKeyDropDownMenu[] = {
@@ -1208,6 +1215,8 @@ void VkvmControl::init() {
 		video = new VkvmView(0, y1, W, H - sizeV - y1);
 		video->captureResizeCallback(PCF_GUI_CALLBACK(onVideoResize), this);
 		video->clickCallback(PCF_GUI_CALLBACK(onVideoClick), this);
+		video->statisticsCallback(PCF_GUI_CALLBACK(onVideoStatistics), this);
+		video->interruptCallback(PCF_GUI_CALLBACK(onVideoInterrupt), this);
 	}
 	videoFrame->end();
 
@@ -1297,6 +1306,7 @@ VkvmControl::~VkvmControl() {
 	stopInputCapture();
 	videoSource.removeNotificationCallback(*this);
 	videoSource.freeDeviceList(videoDevices);
+	if (lostVideoDevice != NULL) delete lostVideoDevice;
 	/* containing widgets are deleted by the base class */
 	if (licenseWin != NULL) delete licenseWin;
 	if (rotationPopup != NULL) delete rotationPopup;
@@ -1361,6 +1371,27 @@ int VkvmControl::handle(int e) {
 				this->startInputCapture();
 				res = 1;
 				break;
+			case 't':
+				/* write the binary serial protocol trace */
+				if ( this->serialDevice.dumpTrace(SERIAL_TRACE_FILE) ) {
+					this->setStatusLine("Serial trace written to " SERIAL_TRACE_FILE ".");
+				} else {
+					this->setStatusLine("Failed to write serial trace to " SERIAL_TRACE_FILE ".");
+				}
+				res = 1;
+				break;
+			case 'i':
+				/* toggle frame timing statistics */
+				if (this->video != NULL) {
+					this->video->showStatistics( ! this->video->showStatistics() );
+					if ( this->video->showStatistics() ) {
+						this->onVideoStatistics(this->video);
+					} else {
+						this->setStatusLine();
+					}
+				}
+				res = 1;
+				break;
 			default:
 				break;
 			}
@@ -1429,15 +1460,25 @@ void VkvmControl::resize(int X, int Y, int W, int H) {
 
 void VkvmControl::onVideoSource(Fl_Window * /* w */) {
 	const int index = this->sourceList->value();
+	/* an explicit selection replaces a removed video source which was waiting for re-arrival */
+	if (this->lostVideoDevice != NULL) {
+		delete this->lostVideoDevice;
+		this->lostVideoDevice = NULL;
+	}
 	if (index <= 0 || (index - 1) >= int(this->videoDevices.size())) {
 		/* first item is a dummy -> remove capture device */
 		this->video->captureDevice(NULL);
 	} else {
-		if ( ! this->video->captureDevice(this->videoDevices[size_t(index - 1)]) ) {
+		pcf::video::CaptureDevice * device = this->videoDevices[size_t(index - 1)];
+		/* holding SHIFT while selecting the source asks for the capture format again */
+		this->restoreVideoConfig(device, w != NULL && Fl::event_shift() != 0);
+		if ( ! this->video->captureDevice(device) ) {
 			this->setStatusLine("Failed to start video capture.");
 			/* first item is a dummy -> remove capture device */
 			this->sourceList->value(0);
 			this->video->captureDevice(NULL);
+		} else {
+			this->storeVideoConfig(device);
 		}
 	}
 	this->onCaptureViewChange();
@@ -1673,6 +1714,39 @@ void VkvmControl::onVideoClick(VkvmView * /* view */) {
 }
 
 
+void VkvmControl::onVideoStatistics(VkvmView * /* view */) {
+	if (this->video == NULL || this->status1 == NULL || ( ! this->video->showStatistics() )) return;
+	/* frequent update; not recorded in the status history */
+	const VkvmView::Statistics & stats = this->video->statistics();
+	char buf[160];
+	snprintf(buf, sizeof(buf), "Capture %.1f fps, display %.1f fps, %lu dropped, decode %.1f ms, latency %.1f ms",
+		double(stats.captureFps),
+		double(stats.displayFps),
+		stats.dropped,
+		double(stats.decodeMs),
+		double(stats.latencyMs)
+	);
+	this->status1->copy_label(buf);
+}
+
+
+void VkvmControl::onVideoInterrupt(VkvmView * /* view */) {
+	if (this->video == NULL) return;
+	pcf::video::CaptureDevice * lastDevice = this->video->captureDevice();
+	if (lastDevice == NULL) return;
+	this->setStatusLine("Selected video source was interrupted.");
+	/* the device is still present -> take the reconnect path to restart it with its last state */
+	if (this->lostVideoDevice != NULL) delete this->lostVideoDevice;
+	this->lostVideoDevice = lastDevice->clone();
+	this->video->captureDevice(NULL);
+	this->onCaptureDeviceChange();
+	if (this->video->captureDevice() == NULL) {
+		this->onCaptureViewChange();
+		this->stopInputCapture();
+	}
+}
+
+
 void VkvmControl::onStatusClick(Fl_Box * status) {
 	if (status != NULL && this->statusHistory != NULL && Fl::event_button() == FL_RIGHT_MOUSE) {
 		this->statusHistory->show(this->x() + status->x(), this->y() + status->y() + status->h(), status->w());
@@ -1710,7 +1784,10 @@ void VkvmControl::onCaptureDeviceChange() {
 	if (this->sourceList == NULL || this->video == NULL) return;
 	pcf::video::CaptureDevice * lastDevice = this->video->captureDevice();
 	const char * lastDevicePath = (lastDevice != NULL) ? lastDevice->getPath() : NULL;
+	const char * lostDeviceName = (lastDevice == NULL && this->lostVideoDevice != NULL) ? this->lostVideoDevice->getName() : NULL;
+	const char * lostDevicePath = (lostDeviceName != NULL) ? this->lostVideoDevice->getPath() : NULL;
 	int selectedIndex = -1;
+	int reconnectIndex = -1;
 	/* create drop down list */
 	this->sourceList->clear();
 	this->sourceList->addRaw("Video Source", 0, PCF_GUI_CALLBACK(onVideoSource), this, FL_MENU_DIVIDER);
@@ -1737,12 +1814,30 @@ void VkvmControl::onCaptureDeviceChange() {
 		if (lastDevicePath != NULL && path != NULL && strcmp(lastDevicePath, path) == 0) {
 			selectedIndex = int(this->sourceList->size() - 1);
 		}
+		if (lostDeviceName != NULL && name != NULL && strcmp(lostDeviceName, name) == 0) {
+			/* the device path may change on re-arrival; prefer the old one if it is still the same */
+			if (reconnectIndex == -1 || (lostDevicePath != NULL && path != NULL && strcmp(lostDevicePath, path) == 0)) {
+				reconnectIndex = int(this->sourceList->size() - 1);
+			}
+		}
+	}
+	if (reconnectIndex != -1) {
+		/* the removed video source arrived again -> resume capturing with its last state */
+		this->sourceList->value(reconnectIndex);
+		this->onVideoSource(NULL);
+		if (this->video->captureDevice() != NULL) {
+			this->setStatusLine("Selected video source was reconnected.");
+		}
+		return;
 	}
 	/* select current video source item in source list and viewer widget */
 	if (lastDevice == NULL || selectedIndex == -1) {
 		/* no device selected for output */
 		if (lastDevice != NULL) {
 			this->setStatusLine("Selected video source was removed.");
+			/* remember it to resume capturing once it arrives again */
+			if (this->lostVideoDevice != NULL) delete this->lostVideoDevice;
+			this->lostVideoDevice = lastDevice->clone();
 		}
 		this->sourceList->value(0);
 		this->video->captureDevice(NULL);
@@ -2054,6 +2149,26 @@ void VkvmControl::setRotation(const VkvmView::Rotation val) {
 }
 
 
+void VkvmControl::restoreVideoConfig(pcf::video::CaptureDevice * device, const bool ask) {
+	if (device == NULL || device->getName() == NULL) return;
+	const auto it = this->videoConfigs.find(device->getName());
+	if (it != this->videoConfigs.end() && device->setConfiguration(it->second.c_str(), NULL) != pcf::video::CaptureDevice::RC_SUCCESS) {
+		this->videoConfigs.erase(it);
+	}
+	/* not every capture device knows this key; those keep their configuration as is */
+	if ( ask ) device->setConfiguration("mode=ask", NULL);
+}
+
+
+void VkvmControl::storeVideoConfig(pcf::video::CaptureDevice * device) {
+	if (device == NULL || device->getName() == NULL) return;
+	char * config = device->getConfiguration();
+	if (config == NULL) return;
+	this->videoConfigs[device->getName()] = config;
+	free(config);
+}
+
+
 bool VkvmControl::setStatusLine(const char * text, const bool copy) {
 	if (this->status1 == NULL) return false;
 	if (this->statusHistory != NULL && text != NULL) {
@@ -2082,7 +2197,7 @@ void VkvmControl::connectPeriphery() {
 			self->setStatusLine("No serial device selected.");
 			self->serialOn = false;
 			if (self->serialList != NULL) self->serialList->value(0);
-		} else if ( ! self->serialDevice.open(*self, serialPortPath) ) {
+		} else if ( ! self->serialDevice.open(*self, serialPortPath, SERIAL_TIMEOUT, SERIAL_TICK_DURATION, SERIAL_REQUEST_WINDOW) ) {
 			self->setStatusLine("Failed to open serial connection. Insufficient permissions?");
 			self->serialOn = false;
 			if (self->serialList != NULL) self->serialList->value(0);
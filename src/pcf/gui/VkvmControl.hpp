@@ -2,7 +2,7 @@
  * @file VkvmControl.hpp
  * @author Daniel Starke
  * @date 2019-10-06
- * @version 2026-06-13
+ * @version 2026-10-16
  */
 #ifndef __PCF_GUI_VKVMCONTROL_HPP__
 #define __PCF_GUI_VKVMCONTROL_HPP__
@@ -12,6 +12,8 @@
 #include <FL/Fl_Double_Window.H>
 #include <FL/fl_draw.H>
 #include <FL/Fl_Group.H>
+#include <map>
+#include <string>
 #include <pcf/gui/HoverChoice.hpp>
 #include <pcf/gui/HoverDropDown.hpp>
 #include <pcf/gui/SvgButton.hpp>
@@ -53,6 +55,8 @@ private:
 
 	pcf::video::NativeVideoCaptureProvider videoSource;
 	pcf::video::CaptureDeviceList videoDevices;
+	pcf::video::CaptureDevice * lostVideoDevice;
+	std::map<std::string, std::string> videoConfigs; /**< last capture device configuration by device name */
 	pcf::serial::NativeSerialPortProvider serialPortSource;
 	pcf::serial::SerialPortList serialPorts;
 	pcf::serial::SerialPort serialPort;
@@ -116,6 +120,8 @@ private:
 	PCF_GUI_BIND(VkvmControl, onLicense, SvgButton)
 	PCF_GUI_BIND(VkvmControl, onVideoResize, VkvmView)
 	PCF_GUI_BIND(VkvmControl, onVideoClick, VkvmView)
+	PCF_GUI_BIND(VkvmControl, onVideoStatistics, VkvmView)
+	PCF_GUI_BIND(VkvmControl, onVideoInterrupt, VkvmView)
 	PCF_GUI_BIND(VkvmControl, onStatusClick, Fl_Box)
 	PCF_GUI_BIND(VkvmControl, onQuit, Fl_Window)
 
@@ -134,6 +140,8 @@ private:
 	void onLicense(SvgButton * tool);
 	void onVideoResize(VkvmView * view);
 	void onVideoClick(VkvmView * view);
+	void onVideoStatistics(VkvmView * view);
+	void onVideoInterrupt(VkvmView * view);
 	void onStatusClick(Fl_Box * status);
 	void onQuit(Fl_Window * w);
 
@@ -156,6 +164,8 @@ private:
 	virtual void onVkvmDisconnected(const DisconnectReason reason);
 
 	void setRotation(const VkvmView::Rotation val);
+	void restoreVideoConfig(pcf::video::CaptureDevice * device, const bool ask);
+	void storeVideoConfig(pcf::video::CaptureDevice * device);
 	bool setStatusLine(const char * text = NULL, const bool copy = false);
 
 	void connectPeriphery();
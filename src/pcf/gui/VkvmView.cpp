@@ -2,23 +2,321 @@
  * @file VkvmView.cpp
  * @author Daniel Starke
  * @date 2019-10-07
- * @version 2026-06-14
+ * @version 2026-10-16
  */
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <FL/fl_ask.H>
 #include <libpcf/target.h>
 #include <pcf/gui/VkvmView.hpp>
+#include <pcf/image/Convert.hpp>
+#include <pcf/image/Tiles.hpp>
 #include <pcf/Utility.hpp>
+#include <GL/glext.h>
+#ifndef PCF_IS_WIN
+#include <GL/glx.h>
+#endif
 
 
-#ifndef GL_BGR
-#define GL_BGR 0x80E0
-#endif
+/** Frame timing statistics interval in seconds. */
+#define PCF_VKVM_VIEW_STATS_INTERVAL 1.0
 
 
 namespace pcf {
 namespace gui {
+namespace {
+
+
+/**
+ * Resolves the given OpenGL function for the current context.
+ *
+ * @param[out] fn - receives the function pointer
+ * @param[in] name - function name
+ * @return true if the function is available, else false
+ * @tparam Fn - function pointer type
+ */
+template <typename Fn>
+bool loadGlProc(Fn & fn, const char * name) {
+#ifdef PCF_IS_WIN
+	const PROC proc = wglGetProcAddress(name);
+	/* some drivers return small integers or -1 instead of NULL for unsupported functions */
+	const intptr_t value = reinterpret_cast<intptr_t>(proc);
+	if (value >= -1 && value <= 3) {
+		fn = NULL;
+		return false;
+	}
+	fn = reinterpret_cast<Fn>(proc);
+#else
+	fn = reinterpret_cast<Fn>(glXGetProcAddressARB(reinterpret_cast<const GLubyte *>(name)));
+#endif
+	return fn != NULL;
+}
+
+
+/**
+ * Checks whether the version of the current OpenGL context is at least the given one.
+ *
+ * @param[in] major - required major version
+ * @param[in] minor - required minor version
+ * @return true if supported, else false
+ */
+bool hasGlVersion(const int major, const int minor) {
+	const char * version = reinterpret_cast<const char *>(glGetString(GL_VERSION));
+	int vMajor = 0;
+	int vMinor = 0;
+	if (version == NULL || sscanf(version, "%d.%d", &vMajor, &vMinor) != 2) return false;
+	return vMajor > major || (vMajor == major && vMinor >= minor);
+}
+
+
+/**
+ * Checks whether the current OpenGL context supports the given extension.
+ *
+ * @param[in] name - extension name (e.g. "GL_ARB_pixel_buffer_object")
+ * @return true if supported, else false
+ */
+bool hasGlExtension(const char * name) {
+	const char * list = reinterpret_cast<const char *>(glGetString(GL_EXTENSIONS));
+	if (list == NULL) return false;
+	const size_t len = strlen(name);
+	for (const char * ptr = strstr(list, name); ptr != NULL; ptr = strstr(ptr + len, name)) {
+		/* only accept complete entries of the space separated list */
+		if ((ptr == list || ptr[-1] == ' ') && (ptr[len] == ' ' || ptr[len] == 0)) return true;
+	}
+	return false;
+}
+
+
+/**
+ * OpenGL 2.0/2.1 functions which are not exported by every OpenGL library.
+ */
+struct GlFunctions {
+	bool shaders; /**< shader functions are available */
+	bool buffers; /**< pixel buffer object functions are available */
+	PFNGLACTIVETEXTUREPROC activeTexture;
+	PFNGLCREATESHADERPROC createShader;
+	PFNGLSHADERSOURCEPROC shaderSource;
+	PFNGLCOMPILESHADERPROC compileShader;
+	PFNGLGETSHADERIVPROC getShaderiv;
+	PFNGLGETSHADERINFOLOGPROC getShaderInfoLog;
+	PFNGLDELETESHADERPROC deleteShader;
+	PFNGLCREATEPROGRAMPROC createProgram;
+	PFNGLATTACHSHADERPROC attachShader;
+	PFNGLLINKPROGRAMPROC linkProgram;
+	PFNGLGETPROGRAMIVPROC getProgramiv;
+	PFNGLGETPROGRAMINFOLOGPROC getProgramInfoLog;
+	PFNGLDELETEPROGRAMPROC deleteProgram;
+	PFNGLUSEPROGRAMPROC useProgram;
+	PFNGLGETUNIFORMLOCATIONPROC getUniformLocation;
+	PFNGLUNIFORM1IPROC uniform1i;
+	PFNGLUNIFORM2FPROC uniform2f;
+	PFNGLUNIFORM3FPROC uniform3f;
+	PFNGLUNIFORMMATRIX3FVPROC uniformMatrix3fv;
+	PFNGLGENBUFFERSPROC genBuffers;
+	PFNGLBINDBUFFERPROC bindBuffer;
+	PFNGLBUFFERDATAPROC bufferData;
+	PFNGLMAPBUFFERPROC mapBuffer;
+	PFNGLUNMAPBUFFERPROC unmapBuffer;
+
+	/**
+	 * Loads all functions for the current OpenGL context and updates
+	 * `shaders` and `buffers` accordingly. Shaders are only used with
+	 * OpenGL 2.0 or GL_ARB_shader_objects and GL_ARB_fragment_shader.
+	 * Pixel buffer objects are only used with OpenGL 2.1 or
+	 * GL_ARB_pixel_buffer_object. The function pointers may also resolve
+	 * if the context does not support them.
+	 */
+	void load() {
+		this->shaders = (hasGlVersion(2, 0) || (hasGlExtension("GL_ARB_shader_objects") && hasGlExtension("GL_ARB_fragment_shader")))
+			&& loadGlProc(this->activeTexture, "glActiveTexture")
+			&& loadGlProc(this->createShader, "glCreateShader")
+			&& loadGlProc(this->shaderSource, "glShaderSource")
+			&& loadGlProc(this->compileShader, "glCompileShader")
+			&& loadGlProc(this->getShaderiv, "glGetShaderiv")
+			&& loadGlProc(this->getShaderInfoLog, "glGetShaderInfoLog")
+			&& loadGlProc(this->deleteShader, "glDeleteShader")
+			&& loadGlProc(this->createProgram, "glCreateProgram")
+			&& loadGlProc(this->attachShader, "glAttachShader")
+			&& loadGlProc(this->linkProgram, "glLinkProgram")
+			&& loadGlProc(this->getProgramiv, "glGetProgramiv")
+			&& loadGlProc(this->getProgramInfoLog, "glGetProgramInfoLog")
+			&& loadGlProc(this->deleteProgram, "glDeleteProgram")
+			&& loadGlProc(this->useProgram, "glUseProgram")
+			&& loadGlProc(this->getUniformLocation, "glGetUniformLocation")
+			&& loadGlProc(this->uniform1i, "glUniform1i")
+			&& loadGlProc(this->uniform2f, "glUniform2f")
+			&& loadGlProc(this->uniform3f, "glUniform3f")
+			&& loadGlProc(this->uniformMatrix3fv, "glUniformMatrix3fv");
+		this->buffers = (hasGlVersion(2, 1) || hasGlExtension("GL_ARB_pixel_buffer_object"))
+			&& loadGlProc(this->genBuffers, "glGenBuffers")
+			&& loadGlProc(this->bindBuffer, "glBindBuffer")
+			&& loadGlProc(this->bufferData, "glBufferData")
+			&& loadGlProc(this->mapBuffer, "glMapBuffer")
+			&& loadGlProc(this->unmapBuffer, "glUnmapBuffer");
+	}
+};
+
+
+/** OpenGL functions of the current context. */
+GlFunctions gl;
+
+
+/** Fragment shader header for the YUV to RGB conversion. */
+const char * const yuvShaderVersion = "#version 110\n";
+
+
+/** Fragment shader function for the YUV to RGB conversion shared by all layouts. */
+const char * const yuvShaderCommon =
+	"uniform mat3 yuvMatrix;\n"
+	"uniform vec3 yuvOffset;\n"
+	"vec3 toRgb(vec3 yuv) {\n"
+	"	return clamp(yuvMatrix * (yuv - yuvOffset), 0.0, 1.0);\n"
+	"}\n";
+
+
+/**
+ * Fragment shader for packed YUYV and UYVY. The image is uploaded as RGBA texture
+ * with half the width and nearest filtering. Luma is interpolated bilinear within
+ * the shader. `LUMA0`, `LUMA1` and `CHROMA` select the texel components.
+ */
+const char * const yuvShaderPacked =
+	"uniform sampler2D tex0;\n"
+	"uniform vec2 imageSize;\n"
+	"float lumaAt(vec2 p) {\n"
+	"	p = clamp(p, vec2(0.0), imageSize - 1.0);\n"
+	"	vec4 t = texture2D(tex0, vec2((floor(p.x * 0.5) + 0.5) / (imageSize.x * 0.5), (p.y + 0.5) / imageSize.y));\n"
+	"	return (mod(p.x, 2.0) < 0.5) ? t.LUMA0 : t.LUMA1;\n"
+	"}\n"
+	"void main() {\n"
+	"	vec2 p = gl_TexCoord[0].st * imageSize - 0.5;\n"
+	"	vec2 p0 = floor(p);\n"
+	"	vec2 f = p - p0;\n"
+	"	float y = mix(\n"
+	"		mix(lumaAt(p0), lumaAt(p0 + vec2(1.0, 0.0)), f.x),\n"
+	"		mix(lumaAt(p0 + vec2(0.0, 1.0)), lumaAt(p0 + vec2(1.0, 1.0)), f.x),\n"
+	"		f.y\n"
+	"	);\n"
+	"	vec4 c = texture2D(tex0, gl_TexCoord[0].st);\n"
+	"	gl_FragColor = vec4(toRgb(vec3(y, c.CHROMA)), 1.0);\n"
+	"}\n";
+
+
+/** Fragment shader for NV12 with a luminance and a luminance/alpha chroma texture. */
+const char * const yuvShaderNv12 =
+	"uniform sampler2D tex0;\n"
+	"uniform sampler2D tex1;\n"
+	"void main() {\n"
+	"	vec2 t = gl_TexCoord[0].st;\n"
+	"	gl_FragColor = vec4(toRgb(vec3(texture2D(tex0, t).r, texture2D(tex1, t).ra)), 1.0);\n"
+	"}\n";
+
+
+/** Fragment shader for I420 with three luminance textures. */
+const char * const yuvShaderI420 =
+	"uniform sampler2D tex0;\n"
+	"uniform sampler2D tex1;\n"
+	"uniform sampler2D tex2;\n"
+	"void main() {\n"
+	"	vec2 t = gl_TexCoord[0].st;\n"
+	"	gl_FragColor = vec4(toRgb(vec3(texture2D(tex0, t).r, texture2D(tex1, t).r, texture2D(tex2, t).r)), 1.0);\n"
+	"}\n";
+
+
+/**
+ * Compiles and links a fragment shader program from the given sources.
+ *
+ * @param[in] sources - shader source parts
+ * @param[in] count - number of shader source parts
+ * @return shader program or 0 on error
+ */
+GLuint createYuvProgram(const GLchar ** sources, const GLsizei count) {
+	char log[512];
+	GLint ok = GL_FALSE;
+	const GLuint shader = gl.createShader(GL_FRAGMENT_SHADER);
+	if (shader == 0) return 0;
+	gl.shaderSource(shader, count, sources, NULL);
+	gl.compileShader(shader);
+	gl.getShaderiv(shader, GL_COMPILE_STATUS, &ok);
+	if (ok != GL_TRUE) {
+		log[0] = 0;
+		gl.getShaderInfoLog(shader, GLsizei(sizeof(log)), NULL, log);
+		fprintf(stderr, "Error: failed to compile YUV conversion shader (%s)\n", log);
+		gl.deleteShader(shader);
+		return 0;
+	}
+	GLuint program = gl.createProgram();
+	if (program != 0) {
+		gl.attachShader(program, shader);
+		gl.linkProgram(program);
+		gl.getProgramiv(program, GL_LINK_STATUS, &ok);
+		if (ok != GL_TRUE) {
+			log[0] = 0;
+			gl.getProgramInfoLog(program, GLsizei(sizeof(log)), NULL, log);
+			fprintf(stderr, "Error: failed to link YUV conversion shader (%s)\n", log);
+			gl.deleteProgram(program);
+			program = 0;
+		}
+	}
+	/* only flagged for deletion while attached to the program */
+	gl.deleteShader(shader);
+	return program;
+}
+
+
+/**
+ * Binds the given texture to the active texture unit and sets its parameters.
+ *
+ * @param[in] texId - texture ID
+ * @param[in] filter - minification and magnification filter
+ */
+void bindTexture(const GLuint texId, const GLint filter) {
+	glBindTexture(GL_TEXTURE_2D, texId);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+
+/**
+ * Returns the given buffer offset as pointer argument for OpenGL functions
+ * which read from the bound pixel buffer object.
+ *
+ * @param[in] offset - offset within the buffer
+ * @return offset as pointer
+ */
+inline const GLvoid * bufferOffset(const size_t offset) {
+	return reinterpret_cast<const GLvoid *>(offset);
+}
+
+
+/**
+ * Returns the number of tiles needed to cover the given image size.
+ *
+ * @param[in] size - image width or height in pixels
+ * @return number of tiles
+ */
+inline size_t tileCount(const GLsizei size) {
+	return (size_t(size) + PCF_IMAGE_TILE_SIZE - 1) / PCF_IMAGE_TILE_SIZE;
+}
+
+
+/**
+ * Returns the tile extent of an image plane in texels.
+ *
+ * @param[in] planeSize - plane width or height in texels
+ * @param[in] imageSize - image width or height in pixels
+ * @return tile width or height in texels
+ */
+inline GLsizei tileExtent(const GLsizei planeSize, const GLsizei imageSize) {
+	return (planeSize < imageSize) ? (PCF_IMAGE_TILE_SIZE / 2) : PCF_IMAGE_TILE_SIZE;
+}
+
+
+} /* anonymous namespace */
 
 
 /**
@@ -32,21 +330,59 @@ namespace gui {
 VkvmView::VkvmView(const int X, const int Y, const int W, const int H):
 	Fl_Gl_Window(X, Y, W, H),
 	capDev(NULL),
-	lastImage(NULL),
-	lastImageSize(0),
-	lastWidth(0),
-	lastHeight(0),
-	lastFormat(0),
-	lastType(0),
-	lastOrientation(pcf::video::CO_BOTTOM_UP),
+	writeFrame(0),
+	readFrame(1),
+	readyFrame(2),
+	lastSrcWidth(0),
+	lastSrcHeight(0),
+	frameSequence(0),
 	capResizeCb(NULL),
 	capResizeCbArg(NULL),
 	clickCb(NULL),
 	clickCbArg(NULL),
-	curRotation(ROT_DEFAULT)
+	curRotation(ROT_DEFAULT),
+	displayWidth(0),
+	displayHeight(0),
+	glReady(false),
+	rgbImage(NULL),
+	rgbImageSize(0),
+	uploadPending(false),
+	uploadedSequence(0),
+	texValid(false),
+	texLayout(LAYOUT_RGB),
+	texWidth(0),
+	texHeight(0),
+	texFormat(0),
+	texType(0),
+	pboIndex(0),
+	hasNextTiming(false),
+	statCaptured(0),
+	statDropped(0),
+	statDecoded(0),
+	statDecodeUs(0),
+	statPipelineUs(0),
+	statPresented(0),
+	statDisplayUs(0),
+	statLatencyUs(0),
+	statTime(pcf::video::getCaptureTime()),
+	presentCaptureTime(0),
+	presentReceiveTime(0),
+	stats{0.0f, 0.0f, 0, 0.0f, 0.0f, 0.0f, 0.0f},
+	statsVisible(false),
+	statsCb(NULL),
+	statsCbArg(NULL),
+	interruptCb(NULL),
+	interruptCbArg(NULL)
 {
+	for (Frame * frame : {&(this->frames[0]), &(this->frames[1]), &(this->frames[2]), &(this->refFrame)}) {
+		*frame = Frame{NULL, 0, 0, 0, 0, 0, 0, LAYOUT_RGB, pcf::video::CYM_BT601, pcf::video::CYR_LIMITED, pcf::video::CO_BOTTOM_UP, 0, 0, 0, 0, std::vector<uint8_t>()};
+	}
+	for (GLuint & program : this->yuvProgram) program = 0;
+	for (GLuint & texId : this->texIds) texId = 0;
+	for (GLuint & pboId : this->pboIds) pboId = 0;
 	this->set_visible_focus();
 	this->end();
+	Fl::add_timeout(PCF_VKVM_VIEW_STATS_INTERVAL, VkvmView::onStatisticsTimer, this);
 }
 
 
@@ -54,11 +390,18 @@ VkvmView::VkvmView(const int X, const int Y, const int W, const int H):
  * Destructor.
  */
 VkvmView::~VkvmView() {
+	Fl::remove_timeout(VkvmView::onStatisticsTimer, this);
 	if (this->capDev != NULL) {
 		delete this->capDev;
 	}
-	if (this->lastImage != NULL) {
-		free(this->lastImage);
+	for (Frame & frame : this->frames) {
+		if (frame.data != NULL) free(frame.data);
+	}
+	if (this->refFrame.data != NULL) {
+		free(this->refFrame.data);
+	}
+	if (this->rgbImage != NULL) {
+		free(this->rgbImage);
 	}
 }
 
@@ -74,16 +417,10 @@ bool VkvmView::captureDevice(pcf::video::CaptureDevice * dev) {
 	if (this->capDev != NULL) {
 		this->capDev->stop();
 		delete this->capDev;
-		if (this->lastImage != NULL) {
-			free(this->lastImage);
-			this->lastImage = NULL;
-			this->lastImageSize = 0;
-			this->lastWidth = 0;
-			this->lastHeight = 0;
-			this->lastFormat = 0;
-			this->lastType = 0;
-			this->doCaptureResizeCallback();
-		}
+		/* the capture thread is stopped; the frames can be accessed without synchronization */
+		const bool hadImage = this->lastSrcWidth.load() != 0;
+		this->clearFrames();
+		if ( hadImage ) this->doCaptureResizeCallback();
 	}
 	this->capDev = (dev != NULL) ? dev->clone() : NULL;
 	if (this->capDev != NULL) {
@@ -124,6 +461,9 @@ void VkvmView::draw() {
 	if ( ! visible() ) return;
 	const int pw = pixel_w();
 	const int ph = pixel_h();
+	const bool rotated = (int(this->rotation()) & 1) != 0;
+	this->displayWidth.store(rotated ? ph : pw, std::memory_order_relaxed);
+	this->displayHeight.store(rotated ? pw : ph, std::memory_order_relaxed);
 	/* initialize OpenGL */
 	if ( ! valid() ) {
 		valid(1);
@@ -133,18 +473,22 @@ void VkvmView::draw() {
 		glOrtho(0, pw, 0, ph, 1, 0);
 		glDisable(GL_LIGHTING);
 	}
-	/* create texture */
-	GLuint texId;
-	glGenTextures(1, &texId);
-	glBindTexture(GL_TEXTURE_2D, texId);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	this->captureMutex.lock();
-	if (this->lastImage != NULL) {
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, this->lastWidth, this->lastHeight, 0, this->lastFormat, this->lastType, this->lastImage);
-	}
-	const bool topDown = (this->lastOrientation == pcf::video::CO_TOP_DOWN);
-	this->captureMutex.unlock();
+	if ( ! context_valid() ) {
+		/* all OpenGL objects are gone with the previous context */
+		this->glReady = false;
+	}
+	if ( ! this->glReady ) this->initGl();
+	/* take over the latest published frame without blocking the capture thread */
+	if ((this->readyFrame.load(std::memory_order_acquire) & FRAME_FRESH) != 0) {
+		this->readFrame = this->readyFrame.exchange(this->readFrame, std::memory_order_acq_rel) & FRAME_INDEX;
+		this->uploadPending = true;
+		this->presentCaptureTime = this->frames[this->readFrame].captureTime;
+		this->presentReceiveTime = this->frames[this->readFrame].receiveTime;
+	}
+	const Frame & frame = this->frames[this->readFrame];
+	const bool hasImage = (frame.size > 0);
+	const GLuint program = hasImage ? this->uploadImage(frame) : 0;
+	const bool topDown = (frame.orientation == pcf::video::CO_TOP_DOWN);
 	/* update view port */
 	if (damage() & FL_DAMAGE_ALL) {
 		const int tx = this->mirrorRight() ? 1 : 0;
@@ -153,56 +497,549 @@ void VkvmView::draw() {
 		const int txr[4] = {tx, tx, tx ^ 1, tx ^ 1};
 		const int tyr[4] = {ty, ty ^ 1, ty ^ 1, ty};
 		const int idx = rot ^ ((rot & 1) << 1);
-		glEnable(GL_TEXTURE_2D);
+		if (program != 0) {
+			gl.useProgram(program);
+			for (GLenum unit = 3; unit-- > 0; ) {
+				gl.activeTexture(GLenum(GL_TEXTURE0 + unit));
+				glBindTexture(GL_TEXTURE_2D, this->texIds[unit]);
+			}
+		} else if ( hasImage ) {
+			glBindTexture(GL_TEXTURE_2D, this->texIds[0]);
+			glEnable(GL_TEXTURE_2D);
+		}
 		glBegin(GL_QUADS);
 			glTexCoord2i(txr[(idx + 0) % 4], tyr[(idx + 0) % 4]); glVertex2i(0,  0);
 			glTexCoord2i(txr[(idx + 1) % 4], tyr[(idx + 1) % 4]); glVertex2i(0,  ph);
 			glTexCoord2i(txr[(idx + 2) % 4], tyr[(idx + 2) % 4]); glVertex2i(pw, ph);
 			glTexCoord2i(txr[(idx + 3) % 4], tyr[(idx + 3) % 4]); glVertex2i(pw, 0);
 		glEnd();
-		glDisable(GL_TEXTURE_2D);
-		glBindTexture(GL_TEXTURE_2D, 0);
+		if (program != 0) {
+			gl.useProgram(0);
+			for (GLenum unit = 3; unit-- > 0; ) {
+				gl.activeTexture(GLenum(GL_TEXTURE0 + unit));
+				glBindTexture(GL_TEXTURE_2D, 0);
+			}
+		} else if ( hasImage ) {
+			glDisable(GL_TEXTURE_2D);
+			glBindTexture(GL_TEXTURE_2D, 0);
+		}
+		if ( this->statsVisible ) this->drawStatistics(pw, ph);
+	}
+}
+
+
+/**
+ * Draws and presents the widget. The time of presentation is recorded for the frame
+ * timing statistics.
+ */
+void VkvmView::flush() {
+	this->Fl_Gl_Window::flush();
+	if (this->presentCaptureTime != 0) {
+		const uint64_t now = pcf::video::getCaptureTime();
+		this->statPresented++;
+		this->statLatencyUs += (now > this->presentCaptureTime) ? (now - this->presentCaptureTime) : 0;
+		this->statDisplayUs += (now > this->presentReceiveTime) ? (now - this->presentReceiveTime) : 0;
+		this->presentCaptureTime = 0;
+	}
+}
+
+
+/**
+ * Draws the frame timing statistics overlay in the upper left corner.
+ *
+ * @param[in] pw - width in pixels
+ * @param[in] ph - height in pixels
+ */
+void VkvmView::drawStatistics(const int pw, const int ph) {
+	const Statistics & s = this->stats;
+	char lines[4][96];
+	snprintf(lines[0], sizeof(lines[0]), "capture %6.1f fps, %lu dropped", double(s.captureFps), s.dropped);
+	snprintf(lines[1], sizeof(lines[1]), "display %6.1f fps", double(s.displayFps));
+	snprintf(lines[2], sizeof(lines[2]), "decode  %6.1f ms", double(s.decodeMs));
+	snprintf(lines[3], sizeof(lines[3]), "latency %6.1f ms (pipeline %.1f ms, display %.1f ms)", double(s.latencyMs), double(s.pipelineMs), double(s.displayMs));
+	gl_font(FL_COURIER, std::max(1, int((float(FL_NORMAL_SIZE) * this->pixels_per_unit()) + 0.5f)));
+	const int lineHeight = gl_height();
+	const int margin = lineHeight / 2;
+	int textWidth = 0;
+	for (const char * line : lines) textWidth = std::max(textWidth, int(gl_width(line) + 0.5));
+	const int boxWidth = std::min(pw, textWidth + (2 * margin));
+	const int boxHeight = std::min(ph, (4 * lineHeight) + (2 * margin));
+	/* translucent background for readability on any capture content */
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glColor4f(0.0f, 0.0f, 0.0f, 0.6f);
+	glRecti(0, ph - boxHeight, boxWidth, ph);
+	glDisable(GL_BLEND);
+	gl_color(FL_WHITE);
+	for (int n = 0; n < 4; n++) {
+		gl_draw(lines[n], margin, ph - margin - ((n + 1) * lineHeight) + gl_descent());
 	}
-	/* delete texture */
-	glDeleteTextures(1, &texId);
+	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+}
+
+
+/**
+ * Computes the frame timing statistics of the elapsed interval and starts a new one.
+ */
+void VkvmView::updateStatistics() {
+	const uint64_t now = pcf::video::getCaptureTime();
+	const float seconds = float(now - this->statTime) / 1000000.0f;
+	this->statTime = now;
+	if (seconds <= 0.0f) return;
+	const unsigned long captured = this->statCaptured.exchange(0);
+	const unsigned long decoded = this->statDecoded.exchange(0);
+	const uint64_t decodeUs = this->statDecodeUs.exchange(0);
+	const uint64_t pipelineUs = this->statPipelineUs.exchange(0);
+	Statistics & s = this->stats;
+	s.captureFps = float(captured) / seconds;
+	s.displayFps = float(this->statPresented) / seconds;
+	s.dropped = this->statDropped.exchange(0);
+	s.decodeMs = (decoded > 0) ? (float(decodeUs) / float(decoded) / 1000.0f) : 0.0f;
+	s.pipelineMs = (captured > 0) ? (float(pipelineUs) / float(captured) / 1000.0f) : 0.0f;
+	s.displayMs = (this->statPresented > 0) ? (float(this->statDisplayUs) / float(this->statPresented) / 1000.0f) : 0.0f;
+	s.latencyMs = (this->statPresented > 0) ? (float(this->statLatencyUs) / float(this->statPresented) / 1000.0f) : 0.0f;
+	this->statPresented = 0;
+	this->statDisplayUs = 0;
+	this->statLatencyUs = 0;
+	if ( this->statsVisible ) this->redraw();
+	this->doStatisticsCallback();
+}
+
+
+/**
+ * Periodically updates the frame timing statistics of the given view.
+ *
+ * @param[in] viewPtr - VkvmView object
+ */
+void VkvmView::onStatisticsTimer(void * viewPtr) {
+	if (viewPtr == NULL) return;
+	VkvmView * view = static_cast<VkvmView *>(viewPtr);
+	view->updateStatistics();
+	Fl::repeat_timeout(PCF_VKVM_VIEW_STATS_INTERVAL, VkvmView::onStatisticsTimer, viewPtr);
 }
 
 
 void VkvmView::onCapture(const pcf::color::Rgb24 * img, const size_t width, const size_t height, const pcf::video::CaptureOrientation orientation) {
-	this->updateImage(GL_RGB, GL_UNSIGNED_BYTE, static_cast<const GLvoid *>(img), width, height, sizeof(*img) * width * height, orientation);
+	const Plane plane = {img, sizeof(*img) * width * height};
+	this->updateImage(LAYOUT_RGB, GL_RGB, GL_UNSIGNED_BYTE, &plane, 1, width, height, width, height, pcf::video::CYM_BT601, pcf::video::CYR_FULL, orientation);
 }
 
 
 void VkvmView::onCapture(const pcf::color::Bgr24 * img, const size_t width, const size_t height, const pcf::video::CaptureOrientation orientation) {
-	this->updateImage(GL_BGR, GL_UNSIGNED_BYTE, static_cast<const GLvoid *>(img), width, height, sizeof(*img) * width * height, orientation);
+	/* swap to RGB while copying to the slot as GL_BGR uploads are slow on some drivers */
+	const size_t byteSize = sizeof(*img) * width * height;
+	void * slot = (img != NULL) ? this->getCaptureBuffer(byteSize) : NULL;
+	if (slot == NULL) return;
+	pcf::image::convertBgr24ToRgb24(reinterpret_cast<const uint8_t *>(img), width * sizeof(*img), width, height, static_cast<uint8_t *>(slot));
+	const Plane plane = {slot, byteSize};
+	this->updateImage(LAYOUT_RGB, GL_RGB, GL_UNSIGNED_BYTE, &plane, 1, width, height, width, height, pcf::video::CYM_BT601, pcf::video::CYR_FULL, orientation);
 }
 
 
-void VkvmView::updateImage(const GLenum format, const GLenum datType, const GLvoid * img, const size_t width, const size_t height, const size_t byteSize, const pcf::video::CaptureOrientation orientation) {
-	if (img == NULL || width <= 0 || height <= 0) return;
-	std::lock_guard<std::mutex> guard(this->captureMutex);
-	if (this->lastImageSize != byteSize) {
-		if (this->lastImage != NULL) free(this->lastImage);
-		this->lastImage = malloc(byteSize);
-	}
-	if (this->lastImage == NULL) {
-		return;
+void VkvmView::onCapture(const pcf::color::Yuyv * img, const size_t width, const size_t height, const pcf::video::CaptureYuvMatrix matrix, const pcf::video::CaptureYuvRange range, const pcf::video::CaptureOrientation orientation) {
+	const Plane plane = {img, sizeof(*img) * (width / 2) * height};
+	this->updateImage(LAYOUT_YUYV, GL_RGBA, GL_UNSIGNED_BYTE, &plane, 1, width, height, width, height, matrix, range, orientation);
+}
+
+
+void VkvmView::onCapture(const pcf::color::Uyvy * img, const size_t width, const size_t height, const pcf::video::CaptureYuvMatrix matrix, const pcf::video::CaptureYuvRange range, const pcf::video::CaptureOrientation orientation) {
+	const Plane plane = {img, sizeof(*img) * (width / 2) * height};
+	this->updateImage(LAYOUT_UYVY, GL_RGBA, GL_UNSIGNED_BYTE, &plane, 1, width, height, width, height, matrix, range, orientation);
+}
+
+
+void VkvmView::onCapture(const uint8_t * y, const uint8_t * uv, const size_t width, const size_t height, const pcf::video::CaptureYuvMatrix matrix, const pcf::video::CaptureYuvRange range, const pcf::video::CaptureOrientation orientation) {
+	const size_t chromaSize = ((width + 1) / 2) * ((height + 1) / 2);
+	const Plane planes[2] = {{y, width * height}, {uv, chromaSize * 2}};
+	this->updateImage(LAYOUT_NV12, GL_LUMINANCE, GL_UNSIGNED_BYTE, planes, 2, width, height, width, height, matrix, range, orientation);
+}
+
+
+void VkvmView::onCapture(const uint8_t * y, const uint8_t * u, const uint8_t * v, const size_t width, const size_t height, const pcf::video::CaptureYuvMatrix matrix, const pcf::video::CaptureYuvRange range, const pcf::video::CaptureOrientation orientation) {
+	const size_t chromaSize = ((width + 1) / 2) * ((height + 1) / 2);
+	const Plane planes[3] = {{y, width * height}, {u, chromaSize}, {v, chromaSize}};
+	this->updateImage(LAYOUT_I420, GL_LUMINANCE, GL_UNSIGNED_BYTE, planes, 3, width, height, width, height, matrix, range, orientation);
+}
+
+
+void VkvmView::onCaptureScaled(const pcf::color::Rgb24 * img, const size_t width, const size_t height, const size_t srcWidth, const size_t srcHeight, const pcf::video::CaptureOrientation orientation) {
+	const Plane plane = {img, sizeof(*img) * width * height};
+	this->updateImage(LAYOUT_RGB, GL_RGB, GL_UNSIGNED_BYTE, &plane, 1, width, height, srcWidth, srcHeight, pcf::video::CYM_BT601, pcf::video::CYR_FULL, orientation);
+}
+
+
+void VkvmView::onCaptureTiming(const pcf::video::CaptureTiming & timing) {
+	this->nextTiming = timing;
+	this->hasNextTiming = true;
+}
+
+
+void VkvmView::getDisplaySize(size_t & width, size_t & height) const {
+	width = size_t(std::max(0, this->displayWidth.load(std::memory_order_relaxed)));
+	height = size_t(std::max(0, this->displayHeight.load(std::memory_order_relaxed)));
+}
+
+
+/**
+ * Returns the image data buffer of the slot filled next so that the capture device can
+ * decode into it directly. updateImage() detects this and publishes the slot without copy.
+ *
+ * @param[in] size - needed buffer size in bytes
+ * @return buffer or NULL on allocation error
+ */
+void * VkvmView::getCaptureBuffer(const size_t size) {
+	Frame & frame = this->frames[this->writeFrame];
+	if (frame.capacity < size) {
+		if (frame.data != NULL) free(frame.data);
+		frame.data = static_cast<unsigned char *>(malloc(size));
+		frame.capacity = (frame.data != NULL) ? size : 0;
+		frame.size = 0;
 	}
-	const bool resized = this->lastWidth != GLsizei(width) || this->lastHeight != GLsizei(height);
-	/* copy image data to internal buffer */
-	memcpy(this->lastImage, img, byteSize);
-	this->lastImageSize = byteSize;
-	this->lastWidth = GLsizei(width);
-	this->lastHeight = GLsizei(height);
-	this->lastFormat = format;
-	this->lastType = datType;
-	this->lastOrientation = orientation;
-	/* update view in event thread */
-	Fl::awake([](void * viewPtr){
+	return frame.data;
+}
+
+
+/**
+ * Forwards the interruption of the capture device to the interrupt callback within the
+ * event thread.
+ */
+void VkvmView::onCaptureInterrupted() {
+	Fl::awake([](void * viewPtr) {
 		if (viewPtr == NULL) return;
 		VkvmView * view = static_cast<VkvmView *>(viewPtr);
-		view->redraw();
+		view->doInterruptCallback();
 	}, this);
+}
+
+
+/**
+ * Empties all frame slots and resets the frame exchange. This may only be called while
+ * no capture device is running.
+ */
+void VkvmView::clearFrames() {
+	for (Frame & frame : this->frames) {
+		frame.size = 0;
+		frame.sequence = 0;
+	}
+	this->refFrame.size = 0;
+	for (std::vector<uint8_t> & changes : this->slotChanges) changes.clear();
+	this->uploadedSequence = 0;
+	this->writeFrame = 0;
+	this->readFrame = 1;
+	this->readyFrame.store(2);
+	this->lastSrcWidth.store(0);
+	this->lastSrcHeight.store(0);
+	this->uploadPending = false;
+}
+
+
+/**
+ * Loads the OpenGL functions, compiles the YUV conversion shaders and creates the persistent
+ * textures and pixel buffer objects for the current context. Layouts without shader program
+ * are converted on the CPU.
+ */
+void VkvmView::initGl() {
+	this->glReady = true;
+	for (GLuint & program : this->yuvProgram) program = 0;
+	for (GLuint & pboId : this->pboIds) pboId = 0;
+	glGenTextures(3, this->texIds);
+	this->texValid = false;
+	this->pboIndex = 0;
+	gl.load();
+	if ( gl.buffers ) gl.genBuffers(2, this->pboIds);
+	if ( ! gl.shaders ) return;
+	for (int layout = LAYOUT_YUYV; layout < LAYOUT_COUNT; layout++) {
+		const GLchar * sources[4] = {yuvShaderVersion, "", yuvShaderCommon, NULL};
+		switch (layout) {
+		case LAYOUT_YUYV:
+			sources[1] = "#define LUMA0 r\n#define LUMA1 b\n#define CHROMA ga\n";
+			sources[3] = yuvShaderPacked;
+			break;
+		case LAYOUT_UYVY:
+			sources[1] = "#define LUMA0 g\n#define LUMA1 a\n#define CHROMA rb\n";
+			sources[3] = yuvShaderPacked;
+			break;
+		case LAYOUT_NV12:
+			sources[3] = yuvShaderNv12;
+			break;
+		case LAYOUT_I420:
+			sources[3] = yuvShaderI420;
+			break;
+		default:
+			continue;
+		}
+		const GLuint program = createYuvProgram(sources, 4);
+		if (program == 0) continue;
+		gl.useProgram(program);
+		gl.uniform1i(gl.getUniformLocation(program, "tex0"), 0);
+		gl.uniform1i(gl.getUniformLocation(program, "tex1"), 1);
+		gl.uniform1i(gl.getUniformLocation(program, "tex2"), 2);
+		gl.useProgram(0);
+		this->yuvProgram[layout] = program;
+	}
+}
+
+
+/**
+ * Describes the texture planes needed for the last captured image.
+ *
+ * @param[in] frame - captured image
+ * @param[out] planes - receives up to three plane descriptions
+ * @param[in] converted - true if the image is converted to RGB24 on the CPU
+ * @return number of planes
+ */
+size_t VkvmView::getTexPlanes(const Frame & frame, TexPlane * planes, const bool converted) const {
+	const GLsizei w = frame.width;
+	const GLsizei h = frame.height;
+	const GLsizei cw = (w + 1) / 2;
+	const GLsizei ch = (h + 1) / 2;
+	const size_t lumaSize = size_t(w) * size_t(h);
+	const size_t chromaSize = size_t(cw) * size_t(ch);
+	if (frame.layout == LAYOUT_RGB) {
+		planes[0] = TexPlane{GL_RGB, frame.format, frame.type, w, h, 3, GL_LINEAR, 0};
+		return 1;
+	}
+	if ( converted ) {
+		planes[0] = TexPlane{GL_RGB, GL_RGB, GL_UNSIGNED_BYTE, w, h, 3, GL_LINEAR, 0};
+		return 1;
+	}
+	switch (frame.layout) {
+	case LAYOUT_YUYV:
+	case LAYOUT_UYVY:
+		planes[0] = TexPlane{GL_RGBA, GL_RGBA, GL_UNSIGNED_BYTE, w / 2, h, 4, GL_NEAREST, 0};
+		return 1;
+	case LAYOUT_NV12:
+		planes[0] = TexPlane{GL_LUMINANCE, GL_LUMINANCE, GL_UNSIGNED_BYTE, w, h, 1, GL_LINEAR, 0};
+		planes[1] = TexPlane{GL_LUMINANCE_ALPHA, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, cw, ch, 2, GL_LINEAR, lumaSize};
+		return 2;
+	default: /* LAYOUT_I420 */
+		planes[0] = TexPlane{GL_LUMINANCE, GL_LUMINANCE, GL_UNSIGNED_BYTE, w, h, 1, GL_LINEAR, 0};
+		planes[1] = TexPlane{GL_LUMINANCE, GL_LUMINANCE, GL_UNSIGNED_BYTE, cw, ch, 1, GL_LINEAR, lumaSize};
+		planes[2] = TexPlane{GL_LUMINANCE, GL_LUMINANCE, GL_UNSIGNED_BYTE, cw, ch, 1, GL_LINEAR, lumaSize + chromaSize};
+		return 3;
+	}
+}
+
+
+/**
+ * Uploads the given captured image to the persistent textures if it changed since the
+ * last upload. The texture storage is only reallocated if the image format changed.
+ * Pixel data is streamed through alternating pixel buffer objects if available.
+ *
+ * @param[in] frame - captured image in `readFrame`
+ * @return YUV conversion shader program to use or 0 for fixed-function texturing
+ */
+GLuint VkvmView::uploadImage(const Frame & frame) {
+	const GLsizei w = frame.width;
+	const GLsizei h = frame.height;
+	const GLuint program = this->yuvProgram[frame.layout];
+	const bool converted = (frame.layout != LAYOUT_RGB && program == 0);
+	TexPlane planes[3];
+	const size_t planeCount = this->getTexPlanes(frame, planes, converted);
+	/* (re-)allocate texture storage */
+	if (!this->texValid || this->texLayout != frame.layout || this->texWidth != w || this->texHeight != h || this->texFormat != frame.format || this->texType != frame.type) {
+		for (size_t n = 0; n < planeCount; n++) {
+			bindTexture(this->texIds[n], planes[n].filter);
+			glTexImage2D(GL_TEXTURE_2D, 0, planes[n].internalFormat, planes[n].width, planes[n].height, 0, planes[n].format, planes[n].type, NULL);
+		}
+		glBindTexture(GL_TEXTURE_2D, 0);
+		this->texValid = true;
+		this->texLayout = frame.layout;
+		this->texWidth = w;
+		this->texHeight = h;
+		this->texFormat = frame.format;
+		this->texType = frame.type;
+		this->uploadPending = true;
+		this->uploadedSequence = 0;
+	}
+	if ( ! this->uploadPending ) return program;
+	const pcf::image::YuvCoefficients c = pcf::image::getYuvCoefficients(frame.matrix == pcf::video::CYM_BT709, frame.range == pcf::video::CYR_FULL);
+	if (program != 0) {
+		/* column major conversion matrix */
+		const GLfloat matrix[9] = {
+			c.yScale, c.yScale, c.yScale,
+			0.0f, -c.gu, c.bu,
+			c.rv, -c.gv, 0.0f
+		};
+		gl.useProgram(program);
+		gl.uniformMatrix3fv(gl.getUniformLocation(program, "yuvMatrix"), 1, GL_FALSE, matrix);
+		gl.uniform3f(gl.getUniformLocation(program, "yuvOffset"), c.yOffset, 128.0f / 255.0f, 128.0f / 255.0f);
+		gl.uniform2f(gl.getUniformLocation(program, "imageSize"), GLfloat(w), GLfloat(h));
+		gl.useProgram(0);
+	}
+	/* only upload the changed tiles if the textures hold a frame the change set covers */
+	if (!converted && frame.baseSequence != 0 && this->uploadedSequence >= frame.baseSequence && frame.dirty.size() == (tileCount(w) * tileCount(h))) {
+		this->uploadTiles(frame, planes, planeCount);
+		this->uploadPending = false;
+		this->uploadedSequence = frame.sequence;
+		return program;
+	}
+	/* locate the YUV components for the CPU conversion */
+	const unsigned char * data = frame.data;
+	pcf::image::YuvImage yuv;
+	if ( converted ) {
+		const size_t lumaSize = size_t(w) * size_t(h);
+		const size_t cw = size_t((w + 1) / 2);
+		const size_t chromaSize = cw * size_t((h + 1) / 2);
+		switch (frame.layout) {
+		case LAYOUT_YUYV:
+			yuv = pcf::image::YuvImage{data, 2, size_t(w) * 2, data + 1, data + 3, 4, size_t(w) * 2, 0};
+			break;
+		case LAYOUT_UYVY:
+			yuv = pcf::image::YuvImage{data + 1, 2, size_t(w) * 2, data, data + 2, 4, size_t(w) * 2, 0};
+			break;
+		case LAYOUT_NV12:
+			yuv = pcf::image::YuvImage{data, 1, size_t(w), data + lumaSize, data + lumaSize + 1, 2, cw * 2, 1};
+			break;
+		default: /* LAYOUT_I420 */
+			yuv = pcf::image::YuvImage{data, 1, size_t(w), data + lumaSize, data + lumaSize + chromaSize, 1, cw, 1};
+			break;
+		}
+	}
+	const size_t byteSize = converted ? (size_t(w) * size_t(h) * 3) : frame.size;
+	/* copy the pixel data into the next pixel buffer object; the driver transfers it asynchronously */
+	const GLuint pboId = this->pboIds[this->pboIndex];
+	const unsigned char * src = NULL;
+	if (pboId != 0) {
+		gl.bindBuffer(GL_PIXEL_UNPACK_BUFFER, pboId);
+		/* orphan the previous storage to avoid waiting for a pending transfer */
+		gl.bufferData(GL_PIXEL_UNPACK_BUFFER, GLsizeiptr(byteSize), NULL, GL_STREAM_DRAW);
+		unsigned char * dst = static_cast<unsigned char *>(gl.mapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY));
+		if (dst != NULL) {
+			if ( converted ) {
+				pcf::image::convertYuvToRgb24(yuv, size_t(w), size_t(h), c, dst);
+			} else {
+				memcpy(dst, data, byteSize);
+			}
+			if (gl.unmapBuffer(GL_PIXEL_UNPACK_BUFFER) != GL_TRUE) {
+				/* buffer content got lost; upload from client memory */
+				gl.bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+				src = data;
+			}
+		} else {
+			gl.bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			src = data;
+		}
+		this->pboIndex = (this->pboIndex + 1) % 2;
+	} else {
+		src = data;
+	}
+	if (src != NULL && converted) {
+		/* no pixel buffer object available -> convert into client memory */
+		if (this->rgbImageSize != byteSize) {
+			if (this->rgbImage != NULL) free(this->rgbImage);
+			this->rgbImage = static_cast<unsigned char *>(malloc(byteSize));
+			this->rgbImageSize = (this->rgbImage != NULL) ? byteSize : 0;
+		}
+		if (this->rgbImage == NULL) return program;
+		pcf::image::convertYuvToRgb24(yuv, size_t(w), size_t(h), c, this->rgbImage);
+		src = this->rgbImage;
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	for (size_t n = 0; n < planeCount; n++) {
+		glBindTexture(GL_TEXTURE_2D, this->texIds[n]);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, planes[n].width, planes[n].height, planes[n].format, planes[n].type, (src != NULL) ? static_cast<const GLvoid *>(src + planes[n].offset) : bufferOffset(planes[n].offset));
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	if (src == NULL) gl.bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	this->uploadPending = false;
+	this->uploadedSequence = frame.sequence;
+	return program;
+}
+
+
+/**
+ * Uploads the changed tiles of the given frame to the persistent textures. Horizontally
+ * adjacent tiles are combined into a single upload.
+ *
+ * @param[in] frame - captured image with valid `dirty` tiles
+ * @param[in] planes - texture planes of the image
+ * @param[in] planeCount - number of elements in `planes`
+ */
+void VkvmView::uploadTiles(const Frame & frame, const TexPlane * planes, const size_t planeCount) {
+	const size_t tilesX = tileCount(frame.width);
+	const size_t tilesY = tileCount(frame.height);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	for (size_t n = 0; n < planeCount; n++) {
+		const TexPlane & plane = planes[n];
+		const GLsizei tileWidth = tileExtent(plane.width, frame.width);
+		const GLsizei tileHeight = tileExtent(plane.height, frame.height);
+		glBindTexture(GL_TEXTURE_2D, this->texIds[n]);
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, plane.width);
+		for (size_t ty = 0; ty < tilesY; ty++) {
+			const uint8_t * dirty = frame.dirty.data() + (ty * tilesX);
+			const GLsizei y = GLsizei(ty) * tileHeight;
+			if (y >= plane.height) break;
+			const GLsizei height = std::min(tileHeight, plane.height - y);
+			for (size_t tx = 0; tx < tilesX; ) {
+				if (dirty[tx] == 0) {
+					tx++;
+					continue;
+				}
+				size_t end = tx + 1;
+				while (end < tilesX && dirty[end] != 0) end++;
+				const GLsizei x = GLsizei(tx) * tileWidth;
+				if (x < plane.width) {
+					const GLsizei width = std::min(GLsizei(end - tx) * tileWidth, plane.width - x);
+					const unsigned char * src = frame.data + plane.offset + (((size_t(y) * size_t(plane.width)) + size_t(x)) * plane.texelBytes);
+					glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, plane.format, plane.type, src);
+				}
+				tx = end;
+			}
+		}
+	}
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+
+void VkvmView::updateImage(const Layout layout, const GLenum format, const GLenum datType, const Plane * planes, const size_t planeCount, const size_t width, const size_t height, const size_t srcWidth, const size_t srcHeight, const pcf::video::CaptureYuvMatrix matrix, const pcf::video::CaptureYuvRange range, const pcf::video::CaptureOrientation orientation) {
+	if (planes == NULL || planeCount <= 0 || width <= 0 || height <= 0) return;
+	size_t byteSize = 0;
+	for (size_t n = 0; n < planeCount; n++) {
+		if (planes[n].data == NULL) return;
+		byteSize += planes[n].size;
+	}
+	Frame & frame = this->frames[this->writeFrame];
+	if (planeCount > 1 || planes[0].data != frame.data) {
+		/* copy image data to the slot unless the capture device decoded into it */
+		if (this->getCaptureBuffer(byteSize) == NULL) return;
+		unsigned char * dst = frame.data;
+		for (size_t n = 0; n < planeCount; n++) {
+			memcpy(dst, planes[n].data, planes[n].size);
+			dst += planes[n].size;
+		}
+	} else if (byteSize > frame.capacity) {
+		return;
+	}
+	frame.size = byteSize;
+	frame.width = GLsizei(width);
+	frame.height = GLsizei(height);
+	frame.format = format;
+	frame.type = datType;
+	frame.layout = layout;
+	frame.matrix = matrix;
+	frame.range = range;
+	frame.orientation = orientation;
+	/* frame timing; capture devices without timing information report the receive time */
+	const uint64_t now = pcf::video::getCaptureTime();
+	const pcf::video::CaptureTiming timing = this->hasNextTiming ? this->nextTiming : pcf::video::CaptureTiming{0, now, now, now, 0, 0};
+	this->hasNextTiming = false;
+	frame.captureTime = (timing.captured != 0) ? timing.captured : timing.dequeued;
+	frame.receiveTime = now;
+	this->statCaptured++;
+	this->statDropped += static_cast<unsigned long>(timing.dropped);
+	this->statPipelineUs += (now > frame.captureTime) ? (now - frame.captureTime) : 0;
+	if (timing.decoded > timing.decodeStart) {
+		this->statDecoded++;
+		this->statDecodeUs += timing.decoded - timing.decodeStart;
+	}
+	/* the window layout follows the source size which does not change with the decoding scale */
+	const GLsizei oldSrcWidth = this->lastSrcWidth.exchange(GLsizei(srcWidth));
+	const GLsizei oldSrcHeight = this->lastSrcHeight.exchange(GLsizei(srcHeight));
+	const bool resized = oldSrcWidth != GLsizei(srcWidth) || oldSrcHeight != GLsizei(srcHeight);
 	/* call resize callback */
 	if ( resized ) {
 		Fl::awake([](void * viewPtr) {
@@ -211,6 +1048,99 @@ void VkvmView::updateImage(const GLenum format, const GLenum datType, const GLvo
 			view->doCaptureResizeCallback();
 		}, this);
 	}
+	/* neither publish nor redraw unchanged frames */
+	if ( ! this->updateTileChanges(frame, timing.noise) ) return;
+	/* publish the slot and continue with the one released by the event thread or the unseen previous one */
+	const unsigned int released = this->readyFrame.exchange(this->writeFrame | FRAME_FRESH, std::memory_order_acq_rel);
+	if ((released & FRAME_FRESH) != 0) this->statDropped++;
+	this->writeFrame = released & FRAME_INDEX;
+	/* update view in event thread */
+	Fl::awake([](void * viewPtr){
+		if (viewPtr == NULL) return;
+		VkvmView * view = static_cast<VkvmView *>(viewPtr);
+		view->redraw();
+	}, this);
+}
+
+
+/**
+ * Detects the tiles changed by the given frame in `writeFrame` and assigns the frame its
+ * sequence number and change set. The change set covers all tiles changed since the
+ * older one of the two frames which may be held by the event thread. This keeps it valid
+ * even if the event thread skips frames.
+ *
+ * @param[in,out] frame - captured image in `writeFrame`
+ * @param[in] noise - maximum difference per byte which is treated as compression noise
+ * @return true if the frame changed and needs to be published, else false
+ */
+bool VkvmView::updateTileChanges(Frame & frame, const uint8_t noise) {
+	TexPlane planes[3];
+	const size_t planeCount = this->getTexPlanes(frame, planes, false);
+	const size_t tilesX = tileCount(frame.width);
+	const size_t tilesY = tileCount(frame.height);
+	const size_t tiles = tilesX * tilesY;
+	Frame & ref = this->refFrame;
+	if (ref.size != frame.size || ref.width != frame.width || ref.height != frame.height || ref.format != frame.format || ref.type != frame.type || ref.layout != frame.layout || ref.matrix != frame.matrix || ref.range != frame.range || ref.orientation != frame.orientation) {
+		/* changed image format -> start over with the new frame as reference */
+		for (std::vector<uint8_t> & changes : this->slotChanges) changes.assign(tiles, 1);
+		if (ref.capacity < frame.size) {
+			if (ref.data != NULL) free(ref.data);
+			ref.data = static_cast<unsigned char *>(malloc(frame.size));
+			ref.capacity = (ref.data != NULL) ? frame.size : 0;
+		}
+		ref.size = 0;
+		if (ref.data != NULL) {
+			memcpy(ref.data, frame.data, frame.size);
+			ref.size = frame.size;
+			ref.width = frame.width;
+			ref.height = frame.height;
+			ref.format = frame.format;
+			ref.type = frame.type;
+			ref.layout = frame.layout;
+			ref.matrix = frame.matrix;
+			ref.range = frame.range;
+			ref.orientation = frame.orientation;
+		}
+	} else {
+		pcf::image::TilePlane tilePlanes[3];
+		for (size_t n = 0; n < planeCount; n++) {
+			const TexPlane & plane = planes[n];
+			tilePlanes[n] = pcf::image::TilePlane{
+				plane.offset,
+				size_t(plane.width) * plane.texelBytes,
+				size_t(plane.height),
+				size_t(tileExtent(plane.width, frame.width)) * plane.texelBytes,
+				size_t(tileExtent(plane.height, frame.height))
+			};
+		}
+		this->tileChanges.resize(tiles);
+		if (pcf::image::markChangedTiles(frame.data, ref.data, tilePlanes, planeCount, tilesX, tilesY, noise, this->tileChanges.data()) == 0) {
+			return false;
+		}
+		/* accumulate the changes for the frames which may still be held by the event thread */
+		for (unsigned int slot = 0; slot < 3; slot++) {
+			if (slot == this->writeFrame) continue;
+			std::vector<uint8_t> & changes = this->slotChanges[slot];
+			if (changes.size() != tiles) changes.assign(tiles, 1);
+			for (size_t n = 0; n < tiles; n++) changes[n] |= this->tileChanges[n];
+		}
+	}
+	/* the frames in the other slots are not modified by the event thread */
+	unsigned int base = this->writeFrame;
+	for (unsigned int slot = 0; slot < 3; slot++) {
+		if (slot == this->writeFrame || this->frames[slot].sequence == 0) continue;
+		if (base == this->writeFrame || this->frames[slot].sequence < this->frames[base].sequence) base = slot;
+	}
+	if (base != this->writeFrame) {
+		frame.baseSequence = this->frames[base].sequence;
+		frame.dirty = this->slotChanges[base];
+	} else {
+		frame.baseSequence = 0;
+		frame.dirty.clear();
+	}
+	frame.sequence = ++(this->frameSequence);
+	this->slotChanges[this->writeFrame].assign(tiles, 0);
+	return true;
 }
 
 
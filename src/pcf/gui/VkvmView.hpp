@@ -2,12 +2,13 @@
  * @file VkvmView.hpp
  * @author Daniel Starke
  * @date 2019-10-07
- * @version 2026-06-14
+ * @version 2026-10-16
  */
 #ifndef __PCF_GUI_VKVMVIEW_HPP__
 #define __PCF_GUI_VKVMVIEW_HPP__
 
-#include <mutex>
+#include <atomic>
+#include <vector>
 #include <FL/Fl.H>
 #include <FL/Fl_Gl_Window.H>
 #include <FL/fl_draw.H>
@@ -32,25 +33,121 @@ public:
 		ROT_LEFT = 3,
 		ROT_DEFAULT = ROT_UP
 	};
+	/** Frame timing statistics of the last statistics interval (about one second). */
+	struct Statistics {
+		float captureFps; /**< frames received from the capture device per second */
+		float displayFps; /**< frames presented per second */
+		unsigned long dropped; /**< frames dropped by the capture device or replaced before being displayed */
+		float decodeMs; /**< average decoding time in milliseconds */
+		float pipelineMs; /**< average time from capture to onCapture() in milliseconds */
+		float displayMs; /**< average time from onCapture() to presentation in milliseconds */
+		float latencyMs; /**< average time from capture to presentation in milliseconds */
+	};
 private:
 	enum Flag {
 		MIRROR_RIGHT = USERFLAG1,
 		MIRROR_UP = USERFLAG2
 	};
+	/** Memory layout of the captured image. */
+	enum Layout {
+		LAYOUT_RGB, /**< packed RGB described by `lastFormat` and `lastType` */
+		LAYOUT_YUYV, /**< packed YUYV */
+		LAYOUT_UYVY, /**< packed UYVY */
+		LAYOUT_NV12, /**< luma plane followed by the interleaved chroma plane */
+		LAYOUT_I420, /**< luma plane followed by the U and V chroma planes */
+		LAYOUT_COUNT
+	};
+	/** Single image plane passed to updateImage(). */
+	struct Plane {
+		const GLvoid * data; /**< plane data */
+		size_t size; /**< plane size in bytes */
+	};
+	/** Texture storage of a single image plane. */
+	struct TexPlane {
+		GLint internalFormat; /**< texture internal format */
+		GLenum format; /**< pixel data format */
+		GLenum type; /**< pixel data type */
+		GLsizei width; /**< plane width in texels */
+		GLsizei height; /**< plane height in texels */
+		size_t texelBytes; /**< bytes per texel */
+		GLint filter; /**< texture filter */
+		size_t offset; /**< byte offset of the plane within the image data */
+	};
+	/** Captured image slot of the frame exchange between capture and event thread. */
+	struct Frame {
+		unsigned char * data; /**< image data */
+		size_t capacity; /**< allocated size of `data` in bytes */
+		size_t size; /**< image size in bytes or 0 if empty */
+		GLsizei width; /**< image width */
+		GLsizei height; /**< image height */
+		GLenum format; /**< pixel format for LAYOUT_RGB */
+		GLenum type; /**< pixel data type for LAYOUT_RGB */
+		Layout layout; /**< memory layout of the image */
+		pcf::video::CaptureYuvMatrix matrix; /**< YUV to RGB conversion matrix */
+		pcf::video::CaptureYuvRange range; /**< YUV quantization range */
+		pcf::video::CaptureOrientation orientation; /**< vertical row order */
+		uint64_t captureTime; /**< capture time (see pcf::video::getCaptureTime()) */
+		uint64_t receiveTime; /**< time the frame was passed to updateImage() */
+		unsigned long sequence; /**< frame sequence number or 0 if empty */
+		unsigned long baseSequence; /**< sequence number of the frame `dirty` refers to or 0 if unknown */
+		std::vector<uint8_t> dirty; /**< tiles changed since frame `baseSequence` in row-major order */
+	};
+	/** Flag within `readyFrame` which marks a frame not yet taken by the event thread. */
+	static const unsigned int FRAME_FRESH = 4;
+	/** Mask for the slot index within `readyFrame`. */
+	static const unsigned int FRAME_INDEX = 3;
 	pcf::video::CaptureDevice * capDev;
-	GLvoid * lastImage;
-	size_t lastImageSize;
-	GLsizei lastWidth;
-	GLsizei lastHeight;
-	GLenum lastFormat;
-	GLenum lastType;
-	pcf::video::CaptureOrientation lastOrientation; /**< vertical row order of the last captured image */
-	mutable std::mutex captureMutex; /**< locked while drawing or capture update */
+	Frame frames[3]; /**< triple buffer of captured images */
+	unsigned int writeFrame; /**< slot filled by the capture thread */
+	unsigned int readFrame; /**< slot displayed by the event thread */
+	std::atomic<unsigned int> readyFrame; /**< last published slot, ORed with FRAME_FRESH until taken */
+	std::atomic<GLsizei> lastSrcWidth; /**< source width of the last captured image before scaling */
+	std::atomic<GLsizei> lastSrcHeight; /**< source height of the last captured image before scaling */
+	unsigned long frameSequence; /**< sequence number of the last published frame */
+	Frame refFrame; /**< reference image for the tile change detection (capture thread only) */
+	std::vector<uint8_t> tileChanges; /**< tiles changed by the current frame (capture thread only) */
+	std::vector<uint8_t> slotChanges[3]; /**< tiles changed since the frame in each slot (capture thread only) */
 	Fl_Callback * capResizeCb; /**< called if the capture image size changed */
 	void * capResizeCbArg;
 	Fl_Callback * clickCb; /**< called if the user clicked on the widget */
 	void * clickCbArg;
 	Rotation curRotation;
+	std::atomic<int> displayWidth; /**< drawn width in pixels in capture image orientation */
+	std::atomic<int> displayHeight; /**< drawn height in pixels in capture image orientation */
+	bool glReady; /**< OpenGL functions and shader programs are initialized for the current context */
+	GLuint yuvProgram[LAYOUT_COUNT]; /**< YUV to RGB conversion shader program per layout or 0 if unavailable */
+	unsigned char * rgbImage; /**< RGB conversion buffer used if neither conversion shader nor pixel buffer object is available */
+	size_t rgbImageSize; /**< size of `rgbImage` in bytes */
+	bool uploadPending; /**< the image in `readFrame` has not been uploaded to the textures yet */
+	unsigned long uploadedSequence; /**< sequence number of the frame held by the textures or 0 */
+	GLuint texIds[3]; /**< persistent textures for the image planes */
+	bool texValid; /**< texture storage matches `texLayout`, `texWidth`, `texHeight`, `texFormat` and `texType` */
+	Layout texLayout; /**< image layout of the texture storage */
+	GLsizei texWidth; /**< image width of the texture storage */
+	GLsizei texHeight; /**< image height of the texture storage */
+	GLenum texFormat; /**< image pixel format of the texture storage */
+	GLenum texType; /**< image pixel data type of the texture storage */
+	GLuint pboIds[2]; /**< pixel buffer objects used alternately for streaming uploads or 0 if unavailable */
+	size_t pboIndex; /**< index of the pixel buffer object used for the next upload */
+	pcf::video::CaptureTiming nextTiming; /**< timing of the next captured image (capture thread only) */
+	bool hasNextTiming; /**< `nextTiming` is valid */
+	std::atomic<unsigned long> statCaptured; /**< frames received within the current statistics interval */
+	std::atomic<unsigned long> statDropped; /**< frames dropped within the current statistics interval */
+	std::atomic<unsigned long> statDecoded; /**< frames with decoding time within the current statistics interval */
+	std::atomic<uint64_t> statDecodeUs; /**< summed decoding time in microseconds */
+	std::atomic<uint64_t> statPipelineUs; /**< summed time from capture to updateImage() in microseconds */
+	unsigned long statPresented; /**< frames presented within the current statistics interval */
+	uint64_t statDisplayUs; /**< summed time from updateImage() to presentation in microseconds */
+	uint64_t statLatencyUs; /**< summed time from capture to presentation in microseconds */
+	uint64_t statTime; /**< start time of the current statistics interval */
+	uint64_t presentCaptureTime; /**< capture time of the drawn frame awaiting presentation or 0 */
+	uint64_t presentReceiveTime; /**< receive time of the drawn frame awaiting presentation */
+	Statistics stats; /**< statistics of the last interval */
+	bool statsVisible; /**< draw the statistics overlay */
+	Fl_Callback * statsCb; /**< called if the statistics were updated */
+	void * statsCbArg;
+	Fl_Callback * interruptCb; /**< called if the capture device stopped delivering images */
+	void * interruptCbArg;
 public:
 	explicit VkvmView(const int X, const int Y, const int W, const int H);
 
@@ -60,12 +157,10 @@ public:
 	bool captureDevice(pcf::video::CaptureDevice * dev);
 
 	inline size_t captureWidth() const {
-		std::lock_guard<std::mutex> guard(this->captureMutex);
-		return size_t(((int(this->curRotation) & 1) == 0) ? this->lastWidth : this->lastHeight);
+		return size_t(((int(this->curRotation) & 1) == 0) ? this->lastSrcWidth.load() : this->lastSrcHeight.load());
 	}
 	inline size_t captureHeight() const {
-		std::lock_guard<std::mutex> guard(this->captureMutex);
-		return size_t(((int(this->curRotation) & 1) == 0) ? this->lastHeight : this->lastWidth);
+		return size_t(((int(this->curRotation) & 1) == 0) ? this->lastSrcHeight.load() : this->lastSrcWidth.load());
 	}
 
 	inline Rotation rotation() const { return this->curRotation; }
@@ -96,6 +191,39 @@ public:
 		}
 	}
 
+	inline const Statistics & statistics() const { return this->stats; }
+	inline bool showStatistics() const { return this->statsVisible; }
+	inline void showStatistics(const bool val) {
+		if (val != this->statsVisible) {
+			this->statsVisible = val;
+			this->redraw();
+		}
+	}
+
+	inline Fl_Callback * statisticsCallback() const { return this->statsCb; }
+	inline void * statisticsCallbackArg() const { return this->statsCbArg; }
+	inline void statisticsCallback(Fl_Callback * cb, void * arg = NULL) {
+		this->statsCb = cb;
+		this->statsCbArg = arg;
+	}
+	inline void doStatisticsCallback() {
+		if (this->statsCb != NULL) {
+			(*(this->statsCb))(this->as_window(), this->statsCbArg);
+		}
+	}
+
+	inline Fl_Callback * interruptCallback() const { return this->interruptCb; }
+	inline void * interruptCallbackArg() const { return this->interruptCbArg; }
+	inline void interruptCallback(Fl_Callback * cb, void * arg = NULL) {
+		this->interruptCb = cb;
+		this->interruptCbArg = arg;
+	}
+	inline void doInterruptCallback() {
+		if (this->interruptCb != NULL) {
+			(*(this->interruptCb))(this->as_window(), this->interruptCbArg);
+		}
+	}
+
 	inline Fl_Callback * clickCallback() const { return this->clickCb; }
 	inline void * clickCallbackArg() const { return this->clickCbArg; }
 	inline void clickCallback(Fl_Callback * cb, void * arg = NULL) {
@@ -110,6 +238,7 @@ public:
 protected:
 	virtual int handle(int e);
 	virtual void draw();
+	virtual void flush();
 
 	inline void updateStyle(const unsigned int f, const bool on) {
 		unsigned int oldFlags = flags();
@@ -119,8 +248,26 @@ protected:
 
 	virtual void onCapture(const pcf::color::Rgb24 * img, const size_t width, const size_t height, const pcf::video::CaptureOrientation orientation);
 	virtual void onCapture(const pcf::color::Bgr24 * img, const size_t width, const size_t height, const pcf::video::CaptureOrientation orientation);
+	virtual void onCapture(const pcf::color::Yuyv * img, const size_t width, const size_t height, const pcf::video::CaptureYuvMatrix matrix, const pcf::video::CaptureYuvRange range, const pcf::video::CaptureOrientation orientation);
+	virtual void onCapture(const pcf::color::Uyvy * img, const size_t width, const size_t height, const pcf::video::CaptureYuvMatrix matrix, const pcf::video::CaptureYuvRange range, const pcf::video::CaptureOrientation orientation);
+	virtual void onCapture(const uint8_t * y, const uint8_t * uv, const size_t width, const size_t height, const pcf::video::CaptureYuvMatrix matrix, const pcf::video::CaptureYuvRange range, const pcf::video::CaptureOrientation orientation);
+	virtual void onCapture(const uint8_t * y, const uint8_t * u, const uint8_t * v, const size_t width, const size_t height, const pcf::video::CaptureYuvMatrix matrix, const pcf::video::CaptureYuvRange range, const pcf::video::CaptureOrientation orientation);
+	virtual void onCaptureScaled(const pcf::color::Rgb24 * img, const size_t width, const size_t height, const size_t srcWidth, const size_t srcHeight, const pcf::video::CaptureOrientation orientation);
+	virtual void onCaptureTiming(const pcf::video::CaptureTiming & timing);
+	virtual void getDisplaySize(size_t & width, size_t & height) const;
+	virtual void * getCaptureBuffer(const size_t size);
+	virtual void onCaptureInterrupted();
 private:
-	void updateImage(const GLenum format, const GLenum datType, const GLvoid * img, const size_t width, const size_t height, const size_t byteSize, const pcf::video::CaptureOrientation orientation);
+	void initGl();
+	void clearFrames();
+	size_t getTexPlanes(const Frame & frame, TexPlane * planes, const bool converted) const;
+	bool updateTileChanges(Frame & frame, const uint8_t noise);
+	void uploadTiles(const Frame & frame, const TexPlane * planes, const size_t planeCount);
+	void drawStatistics(const int pw, const int ph);
+	void updateStatistics();
+	static void onStatisticsTimer(void * viewPtr);
+	GLuint uploadImage(const Frame & frame);
+	void updateImage(const Layout layout, const GLenum format, const GLenum datType, const Plane * planes, const size_t planeCount, const size_t width, const size_t height, const size_t srcWidth, const size_t srcHeight, const pcf::video::CaptureYuvMatrix matrix, const pcf::video::CaptureYuvRange range, const pcf::video::CaptureOrientation orientation);
 };
 
 
@@ -0,0 +1,698 @@
+/**
+ * @file Convert.cpp
+ * @author Daniel Starke
+ * @date 2026-10-16
+ * @version 2026-10-16
+ */
+#include <algorithm>
+#include <cstring>
+#include <pcf/image/Convert.hpp>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define PCF_IMAGE_CONVERT_AVX2
+#endif
+
+
+namespace pcf {
+namespace image {
+namespace {
+
+
+/**
+ * YUV to RGB conversion factors in fixed point. All kernels use the same 16-bit arithmetic
+ * which yields identical results independent of the selected instruction set:
+ * - luma: `((Y - yOffset) << 7) * yScale >> 16` with `yScale` in 2.14 format
+ * - chroma: `((C - 128) << 8) * factor >> 16` with `factor` in 3.13 format
+ * - color: `(luma + chroma terms + 16) >> 5` saturated to 0..255
+ */
+struct YuvFactors {
+	int16_t yOffset; /**< luma offset */
+	int16_t yScale; /**< luma scale */
+	int16_t rv; /**< V to red factor */
+	int16_t gu; /**< U to green factor (subtracted) */
+	int16_t gv; /**< V to green factor (subtracted) */
+	int16_t bu; /**< U to blue factor */
+};
+
+
+/** Pixel layout of a YUV image which has a dedicated conversion kernel. */
+enum YuvLayout {
+	YL_YUYV, /**< packed Y, U, Y, V */
+	YL_UYVY, /**< packed U, Y, V, Y */
+	YL_NV12, /**< planar Y with interleaved U, V */
+	YL_PLANAR, /**< planar Y, U, V */
+	YL_OTHER /**< converted pixel by pixel */
+};
+
+
+/**
+ * Converts a single row of YUV pixels to RGB24.
+ *
+ * @param[in] y - first luma sample (first U sample for UYVY)
+ * @param[in] u - first U sample (interleaved with V for NV12, unused for packed layouts)
+ * @param[in] v - first V sample (planar only)
+ * @param[in] count - number of pixels
+ * @param[in] f - conversion factors
+ * @param[out] dst - RGB24 output
+ * @return number of converted pixels; a multiple of the kernel block size
+ */
+typedef size_t (* YuvRowFn)(const uint8_t * y, const uint8_t * u, const uint8_t * v, const size_t count, const YuvFactors & f, uint8_t * dst);
+
+
+/** Conversion kernels for each YUV layout (`YL_OTHER` excluded). */
+struct YuvKernels {
+	YuvRowFn row[YL_OTHER]; /**< row conversion function for each layout */
+};
+
+
+/**
+ * Converts packed pixels with 3 or 4 bytes to RGB24.
+ *
+ * @param[in] src - source pixels
+ * @param[in] count - number of pixels
+ * @param[out] dst - RGB24 output
+ * @return number of converted pixels
+ */
+typedef size_t (* PackedRowFn)(const uint8_t * src, const size_t count, uint8_t * dst);
+
+
+/** Shuffle masks which interleave 16 bytes of R, G and B each into 48 bytes of RGB24. */
+alignas(16) const int8_t rgbMasks[3][3][16] = {
+	{ /* R */
+		{0, -128, -128, 1, -128, -128, 2, -128, -128, 3, -128, -128, 4, -128, -128, 5},
+		{-128, -128, 6, -128, -128, 7, -128, -128, 8, -128, -128, 9, -128, -128, 10, -128},
+		{-128, 11, -128, -128, 12, -128, -128, 13, -128, -128, 14, -128, -128, 15, -128, -128}
+	},
+	{ /* G */
+		{-128, 0, -128, -128, 1, -128, -128, 2, -128, -128, 3, -128, -128, 4, -128, -128},
+		{5, -128, -128, 6, -128, -128, 7, -128, -128, 8, -128, -128, 9, -128, -128, 10},
+		{-128, -128, 11, -128, -128, 12, -128, -128, 13, -128, -128, 14, -128, -128, 15, -128}
+	},
+	{ /* B */
+		{-128, -128, 0, -128, -128, 1, -128, -128, 2, -128, -128, 3, -128, -128, 4, -128},
+		{-128, 5, -128, -128, 6, -128, -128, 7, -128, -128, 8, -128, -128, 9, -128, -128},
+		{10, -128, -128, 11, -128, -128, 12, -128, -128, 13, -128, -128, 14, -128, -128, 15}
+	}
+};
+
+
+/** Shuffle mask which converts 4 BGRX pixels into 12 bytes of RGB24. */
+alignas(16) const int8_t bgrxMask[16] = {2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -128, -128, -128, -128};
+
+
+/** Shuffle mask which swaps R and B of 5 RGB24 pixels. The last byte is kept. */
+alignas(16) const int8_t swapMask[16] = {2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 14, 13, 12, 15};
+
+
+/**
+ * Returns the fixed point representation of the given value.
+ *
+ * @param[in] val - value to convert
+ * @param[in] scale - fixed point scale
+ * @return fixed point value
+ */
+inline int16_t toFixed(const float val, const float scale) {
+	return int16_t((val * scale) + 0.5f);
+}
+
+
+/**
+ * Returns the fixed point conversion factors for the given coefficients.
+ *
+ * @param[in] c - conversion coefficients
+ * @return fixed point conversion factors
+ */
+YuvFactors getYuvFactors(const YuvCoefficients & c) {
+	YuvFactors res;
+	res.yOffset = toFixed(c.yOffset, 255.0f);
+	res.yScale = toFixed(c.yScale, 16384.0f);
+	res.rv = toFixed(c.rv, 8192.0f);
+	res.gu = toFixed(c.gu, 8192.0f);
+	res.gv = toFixed(c.gv, 8192.0f);
+	res.bu = toFixed(c.bu, 8192.0f);
+	return res;
+}
+
+
+/**
+ * Returns the upper 16 bits of the product like `_mm_mulhi_epi16()`.
+ *
+ * @param[in] a - first factor
+ * @param[in] b - second factor
+ * @return upper 16 bits of `a * b`
+ */
+inline int32_t mulHigh(const int32_t a, const int32_t b) {
+	return (a * b) >> 16;
+}
+
+
+/**
+ * Returns the color component for the given fixed point value.
+ *
+ * @param[in] val - color component with 5 fractional bits
+ * @return saturated color component
+ */
+inline uint8_t toComponent(const int32_t val) {
+	return static_cast<uint8_t>(std::min(std::max((val + 16) >> 5, int32_t(0)), int32_t(255)));
+}
+
+
+/**
+ * Converts the given pixel range of a YUV image row to RGB24.
+ *
+ * @param[in] src - source image
+ * @param[in] row - row index
+ * @param[in] first - first pixel to convert
+ * @param[in] last - one past the last pixel to convert
+ * @param[in] f - conversion factors
+ * @param[out] dst - RGB24 output of the first pixel
+ */
+void convertRowGeneric(const YuvImage & src, const size_t row, const size_t first, const size_t last, const YuvFactors & f, uint8_t * dst) {
+	const uint8_t * yRow = src.y + (row * src.yRow);
+	const size_t cOffset = (row >> src.cRowShift) * src.cRow;
+	const uint8_t * uRow = src.u + cOffset;
+	const uint8_t * vRow = src.v + cOffset;
+	for (size_t col = first; col < last; col++) {
+		const int32_t l = mulHigh((int32_t(yRow[col * src.yStep]) - f.yOffset) * 128, f.yScale);
+		const int32_t u = (int32_t(uRow[(col >> 1) * src.cStep]) - 128) * 256;
+		const int32_t v = (int32_t(vRow[(col >> 1) * src.cStep]) - 128) * 256;
+		*dst++ = toComponent(l + mulHigh(v, f.rv));
+		*dst++ = toComponent(l - mulHigh(u, f.gu) - mulHigh(v, f.gv));
+		*dst++ = toComponent(l + mulHigh(u, f.bu));
+	}
+}
+
+
+/** @copydoc PackedRowFn */
+size_t convertBgrxRowGeneric(const uint8_t * src, const size_t count, uint8_t * dst) {
+	for (size_t n = 0; n < count; n++, src += 4, dst += 3) {
+		dst[0] = src[2];
+		dst[1] = src[1];
+		dst[2] = src[0];
+	}
+	return count;
+}
+
+
+/** @copydoc PackedRowFn */
+size_t swapRgbRowGeneric(const uint8_t * src, const size_t count, uint8_t * dst) {
+	for (size_t n = 0; n < count; n++, src += 3, dst += 3) {
+		const uint8_t first = src[0];
+		dst[0] = src[2];
+		dst[1] = src[1];
+		dst[2] = first;
+	}
+	return count;
+}
+
+
+/**
+ * Returns the layout of the given YUV image which selects the conversion kernel.
+ *
+ * @param[in] src - source image
+ * @return YUV layout
+ */
+YuvLayout getYuvLayout(const YuvImage & src) {
+	if (src.yStep == 2 && src.cStep == 4 && src.cRowShift == 0 && src.v == (src.u + 2)) {
+		if (src.u == (src.y + 1)) return YL_YUYV;
+		if (src.y == (src.u + 1)) return YL_UYVY;
+	} else if (src.yStep == 1 && src.cStep == 2 && src.v == (src.u + 1)) {
+		return YL_NV12;
+	} else if (src.yStep == 1 && src.cStep == 1) {
+		return YL_PLANAR;
+	}
+	return YL_OTHER;
+}
+
+
+#if defined(__SSE2__)
+/** Conversion factors as SSE2 vectors. */
+struct YuvFactorsSse2 {
+	__m128i yOffset; /**< luma offset */
+	__m128i yScale; /**< luma scale */
+	__m128i rv; /**< V to red factor */
+	__m128i gu; /**< U to green factor */
+	__m128i gv; /**< V to green factor */
+	__m128i bu; /**< U to blue factor */
+
+	/**
+	 * Constructor.
+	 *
+	 * @param[in] f - conversion factors
+	 */
+	explicit YuvFactorsSse2(const YuvFactors & f):
+		yOffset(_mm_set1_epi16(f.yOffset)),
+		yScale(_mm_set1_epi16(f.yScale)),
+		rv(_mm_set1_epi16(f.rv)),
+		gu(_mm_set1_epi16(f.gu)),
+		gv(_mm_set1_epi16(f.gv)),
+		bu(_mm_set1_epi16(f.bu))
+	{}
+};
+
+
+/**
+ * Converts 8 pixels with 16-bit YUV samples to 16-bit RGB components.
+ *
+ * @param[in] y - luma samples
+ * @param[in] c - interleaved U, V samples for 4 pixel pairs
+ * @param[in] k - conversion factors
+ * @param[out] r - red components
+ * @param[out] g - green components
+ * @param[out] b - blue components
+ */
+inline void convertYuv8Sse2(const __m128i y, const __m128i c, const YuvFactorsSse2 & k, __m128i & r, __m128i & g, __m128i & b) {
+	const __m128i bias = _mm_set1_epi16(128);
+	const __m128i round = _mm_set1_epi16(16);
+	const __m128i l = _mm_add_epi16(_mm_mulhi_epi16(_mm_slli_epi16(_mm_sub_epi16(y, k.yOffset), 7), k.yScale), round);
+	const __m128i cs = _mm_slli_epi16(_mm_sub_epi16(c, bias), 8);
+	/* duplicate each chroma sample for both pixels of the pair */
+	const __m128i u = _mm_shufflehi_epi16(_mm_shufflelo_epi16(cs, _MM_SHUFFLE(2, 2, 0, 0)), _MM_SHUFFLE(2, 2, 0, 0));
+	const __m128i v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(cs, _MM_SHUFFLE(3, 3, 1, 1)), _MM_SHUFFLE(3, 3, 1, 1));
+	r = _mm_srai_epi16(_mm_add_epi16(l, _mm_mulhi_epi16(v, k.rv)), 5);
+	g = _mm_srai_epi16(_mm_sub_epi16(_mm_sub_epi16(l, _mm_mulhi_epi16(u, k.gu)), _mm_mulhi_epi16(v, k.gv)), 5);
+	b = _mm_srai_epi16(_mm_add_epi16(l, _mm_mulhi_epi16(u, k.bu)), 5);
+}
+
+
+/**
+ * Loads 16 pixels of the given layout as 16-bit samples.
+ *
+ * @param[in] y - luma pointer as passed to YuvRowFn
+ * @param[in] u - U pointer as passed to YuvRowFn
+ * @param[in] v - V pointer as passed to YuvRowFn
+ * @param[out] y0 - luma samples of the first 8 pixels
+ * @param[out] y1 - luma samples of the last 8 pixels
+ * @param[out] c0 - interleaved U, V samples of the first 8 pixels
+ * @param[out] c1 - interleaved U, V samples of the last 8 pixels
+ * @tparam L - YUV layout
+ */
+template <YuvLayout L>
+inline void loadYuv16Sse2(const uint8_t * y, const uint8_t * u, const uint8_t * v, __m128i & y0, __m128i & y1, __m128i & c0, __m128i & c1) {
+	const __m128i zero = _mm_setzero_si128();
+	if (L == YL_YUYV || L == YL_UYVY) {
+		const __m128i mask = _mm_set1_epi16(0x00FF);
+		const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(y));
+		const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(y + 16));
+		if (L == YL_YUYV) {
+			y0 = _mm_and_si128(a, mask);
+			y1 = _mm_and_si128(b, mask);
+			c0 = _mm_srli_epi16(a, 8);
+			c1 = _mm_srli_epi16(b, 8);
+		} else {
+			y0 = _mm_srli_epi16(a, 8);
+			y1 = _mm_srli_epi16(b, 8);
+			c0 = _mm_and_si128(a, mask);
+			c1 = _mm_and_si128(b, mask);
+		}
+		return;
+	}
+	const __m128i luma = _mm_loadu_si128(reinterpret_cast<const __m128i *>(y));
+	y0 = _mm_unpacklo_epi8(luma, zero);
+	y1 = _mm_unpackhi_epi8(luma, zero);
+	const __m128i chroma = (L == YL_NV12)
+		? _mm_loadu_si128(reinterpret_cast<const __m128i *>(u))
+		: _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(u)), _mm_loadl_epi64(reinterpret_cast<const __m128i *>(v)));
+	c0 = _mm_unpacklo_epi8(chroma, zero);
+	c1 = _mm_unpackhi_epi8(chroma, zero);
+}
+
+
+/**
+ * Stores 16 pixels given as separate R, G and B components as RGB24.
+ *
+ * @param[in] r - red components
+ * @param[in] g - green components
+ * @param[in] b - blue components
+ * @param[out] dst - RGB24 output with 48 bytes
+ */
+inline void storeRgb16(const __m128i r, const __m128i g, const __m128i b, uint8_t * dst) {
+#if defined(__SSSE3__)
+	for (size_t n = 0; n < 3; n++) {
+		const __m128i mr = _mm_load_si128(reinterpret_cast<const __m128i *>(rgbMasks[0][n]));
+		const __m128i mg = _mm_load_si128(reinterpret_cast<const __m128i *>(rgbMasks[1][n]));
+		const __m128i mb = _mm_load_si128(reinterpret_cast<const __m128i *>(rgbMasks[2][n]));
+		const __m128i out = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(r, mr), _mm_shuffle_epi8(g, mg)), _mm_shuffle_epi8(b, mb));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + (n * 16)), out);
+	}
+#else /* ! __SSSE3__ */
+	alignas(16) uint8_t rgb[3][16];
+	_mm_store_si128(reinterpret_cast<__m128i *>(rgb[0]), r);
+	_mm_store_si128(reinterpret_cast<__m128i *>(rgb[1]), g);
+	_mm_store_si128(reinterpret_cast<__m128i *>(rgb[2]), b);
+	for (size_t n = 0; n < 16; n++) {
+		*dst++ = rgb[0][n];
+		*dst++ = rgb[1][n];
+		*dst++ = rgb[2][n];
+	}
+#endif /* __SSSE3__ */
+}
+
+
+/**
+ * @copydoc YuvRowFn
+ * @tparam L - YUV layout
+ */
+template <YuvLayout L>
+size_t convertYuvRowSse2(const uint8_t * y, const uint8_t * u, const uint8_t * v, const size_t count, const YuvFactors & f, uint8_t * dst) {
+	const YuvFactorsSse2 k(f);
+	const size_t blocks = count & ~size_t(15);
+	for (size_t n = 0; n < blocks; n += 16, dst += 48) {
+		__m128i y0, y1, c0, c1, r0, r1, g0, g1, b0, b1;
+		switch (L) {
+		case YL_YUYV:
+		case YL_UYVY:
+			loadYuv16Sse2<L>(y + (n * 2), u, v, y0, y1, c0, c1);
+			break;
+		case YL_NV12:
+			loadYuv16Sse2<L>(y + n, u + n, v, y0, y1, c0, c1);
+			break;
+		default:
+			loadYuv16Sse2<L>(y + n, u + (n / 2), v + (n / 2), y0, y1, c0, c1);
+			break;
+		}
+		convertYuv8Sse2(y0, c0, k, r0, g0, b0);
+		convertYuv8Sse2(y1, c1, k, r1, g1, b1);
+		storeRgb16(_mm_packus_epi16(r0, r1), _mm_packus_epi16(g0, g1), _mm_packus_epi16(b0, b1), dst);
+	}
+	return blocks;
+}
+#endif /* __SSE2__ */
+
+
+#if defined(__SSSE3__)
+/** @copydoc PackedRowFn */
+size_t convertBgrxRowSsse3(const uint8_t * src, const size_t count, uint8_t * dst) {
+	const __m128i mask = _mm_load_si128(reinterpret_cast<const __m128i *>(bgrxMask));
+	size_t n = 0;
+	/* each 16 byte store overlaps the next 4 bytes which are written by the next iteration */
+	for (; (n + 6) <= count; n += 4, src += 16, dst += 12) {
+		const __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst), _mm_shuffle_epi8(px, mask));
+	}
+	return n;
+}
+
+
+/** @copydoc PackedRowFn */
+size_t swapRgbRowSsse3(const uint8_t * src, const size_t count, uint8_t * dst) {
+	const __m128i mask = _mm_load_si128(reinterpret_cast<const __m128i *>(swapMask));
+	size_t n = 0;
+	/* the last byte of each block is stored unchanged and rewritten by the next iteration */
+	for (; (n + 6) <= count; n += 5, src += 15, dst += 15) {
+		const __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst), _mm_shuffle_epi8(px, mask));
+	}
+	return n;
+}
+#endif /* __SSSE3__ */
+
+
+#if defined(PCF_IMAGE_CONVERT_AVX2)
+/**
+ * Converts 16 pixels with 16-bit YUV samples to 16-bit RGB components.
+ *
+ * @param[in] y - luma samples
+ * @param[in] c - interleaved U, V samples for 8 pixel pairs
+ * @param[in] f - conversion factors
+ * @param[out] r - red components
+ * @param[out] g - green components
+ * @param[out] b - blue components
+ */
+__attribute__((target("avx2")))
+inline void convertYuv16Avx2(const __m256i y, const __m256i c, const YuvFactors & f, __m256i & r, __m256i & g, __m256i & b) {
+	const __m256i bias = _mm256_set1_epi16(128);
+	const __m256i round = _mm256_set1_epi16(16);
+	const __m256i l = _mm256_add_epi16(_mm256_mulhi_epi16(_mm256_slli_epi16(_mm256_sub_epi16(y, _mm256_set1_epi16(f.yOffset)), 7), _mm256_set1_epi16(f.yScale)), round);
+	const __m256i cs = _mm256_slli_epi16(_mm256_sub_epi16(c, bias), 8);
+	/* duplicate each chroma sample for both pixels of the pair */
+	const __m256i u = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(cs, _MM_SHUFFLE(2, 2, 0, 0)), _MM_SHUFFLE(2, 2, 0, 0));
+	const __m256i v = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(cs, _MM_SHUFFLE(3, 3, 1, 1)), _MM_SHUFFLE(3, 3, 1, 1));
+	r = _mm256_srai_epi16(_mm256_add_epi16(l, _mm256_mulhi_epi16(v, _mm256_set1_epi16(f.rv))), 5);
+	g = _mm256_srai_epi16(_mm256_sub_epi16(_mm256_sub_epi16(l, _mm256_mulhi_epi16(u, _mm256_set1_epi16(f.gu))), _mm256_mulhi_epi16(v, _mm256_set1_epi16(f.gv))), 5);
+	b = _mm256_srai_epi16(_mm256_add_epi16(l, _mm256_mulhi_epi16(u, _mm256_set1_epi16(f.bu))), 5);
+}
+
+
+/**
+ * Loads 16 pixels of the given layout as 16-bit samples.
+ *
+ * @param[in] y - luma pointer of the first pixel (first U sample for UYVY)
+ * @param[in] u - U pointer of the first pixel
+ * @param[in] v - V pointer of the first pixel
+ * @param[out] luma - luma samples
+ * @param[out] chroma - interleaved U, V samples
+ * @tparam L - YUV layout
+ */
+template <YuvLayout L>
+__attribute__((target("avx2")))
+inline void loadYuv16Avx2(const uint8_t * y, const uint8_t * u, const uint8_t * v, __m256i & luma, __m256i & chroma) {
+	if (L == YL_YUYV || L == YL_UYVY) {
+		const __m256i mask = _mm256_set1_epi16(0x00FF);
+		const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(y));
+		luma = (L == YL_YUYV) ? _mm256_and_si256(a, mask) : _mm256_srli_epi16(a, 8);
+		chroma = (L == YL_YUYV) ? _mm256_srli_epi16(a, 8) : _mm256_and_si256(a, mask);
+		return;
+	}
+	luma = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(y)));
+	if (L == YL_NV12) {
+		chroma = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(u)));
+	} else {
+		chroma = _mm256_cvtepu8_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(u)), _mm_loadl_epi64(reinterpret_cast<const __m128i *>(v))));
+	}
+}
+
+
+/**
+ * @copydoc YuvRowFn
+ * @tparam L - YUV layout
+ */
+template <YuvLayout L>
+__attribute__((target("avx2")))
+size_t convertYuvRowAvx2(const uint8_t * y, const uint8_t * u, const uint8_t * v, const size_t count, const YuvFactors & f, uint8_t * dst) {
+	__m256i masks[3][3];
+	for (size_t c = 0; c < 3; c++) {
+		for (size_t n = 0; n < 3; n++) {
+			masks[c][n] = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i *>(rgbMasks[c][n])));
+		}
+	}
+	const size_t blocks = count & ~size_t(31);
+	for (size_t n = 0; n < blocks; n += 32, dst += 96) {
+		__m256i rgb[3][2];
+		for (size_t half = 0; half < 2; half++) {
+			const size_t i = n + (half * 16);
+			__m256i luma, chroma;
+			switch (L) {
+			case YL_YUYV:
+			case YL_UYVY:
+				loadYuv16Avx2<L>(y + (i * 2), u, v, luma, chroma);
+				break;
+			case YL_NV12:
+				loadYuv16Avx2<L>(y + i, u + i, v, luma, chroma);
+				break;
+			default:
+				loadYuv16Avx2<L>(y + i, u + (i / 2), v + (i / 2), luma, chroma);
+				break;
+			}
+			convertYuv16Avx2(luma, chroma, f, rgb[0][half], rgb[1][half], rgb[2][half]);
+		}
+		/* pack to bytes and restore the pixel order changed by the per lane packing */
+		__m256i comp[3];
+		for (size_t c = 0; c < 3; c++) {
+			comp[c] = _mm256_permute4x64_epi64(_mm256_packus_epi16(rgb[c][0], rgb[c][1]), _MM_SHUFFLE(3, 1, 2, 0));
+		}
+		/* interleave the 16 pixels of each lane to 48 bytes of RGB24 */
+		__m256i out[3];
+		for (size_t k = 0; k < 3; k++) {
+			out[k] = _mm256_or_si256(_mm256_or_si256(_mm256_shuffle_epi8(comp[0], masks[0][k]), _mm256_shuffle_epi8(comp[1], masks[1][k])), _mm256_shuffle_epi8(comp[2], masks[2][k]));
+		}
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), _mm256_permute2x128_si256(out[0], out[1], 0x20));
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 32), _mm256_permute2x128_si256(out[2], out[0], 0x30));
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 64), _mm256_permute2x128_si256(out[1], out[2], 0x31));
+	}
+	return blocks;
+}
+
+
+/** @copydoc PackedRowFn */
+__attribute__((target("avx2")))
+size_t convertBgrxRowAvx2(const uint8_t * src, const size_t count, uint8_t * dst) {
+	const __m256i mask = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i *>(bgrxMask)));
+	const __m256i compact = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+	size_t n = 0;
+	/* each 32 byte store overlaps the next 8 bytes which are written by the next iteration */
+	for (; (n + 11) <= count; n += 8, src += 32, dst += 24) {
+		const __m256i px = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src));
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(px, mask), compact));
+	}
+	return n;
+}
+#endif /* PCF_IMAGE_CONVERT_AVX2 */
+
+
+/**
+ * Selects the fastest YUV conversion kernels supported by the executing CPU.
+ *
+ * @return YUV conversion kernels; NULL entries use the generic conversion
+ */
+YuvKernels selectYuvKernels() {
+	YuvKernels res;
+	memset(&res, 0, sizeof(res));
+#if defined(PCF_IMAGE_CONVERT_AVX2)
+	__builtin_cpu_init();
+	if ( __builtin_cpu_supports("avx2") ) {
+		res.row[YL_YUYV] = convertYuvRowAvx2<YL_YUYV>;
+		res.row[YL_UYVY] = convertYuvRowAvx2<YL_UYVY>;
+		res.row[YL_NV12] = convertYuvRowAvx2<YL_NV12>;
+		res.row[YL_PLANAR] = convertYuvRowAvx2<YL_PLANAR>;
+		return res;
+	}
+#endif
+#if defined(__SSE2__)
+	res.row[YL_YUYV] = convertYuvRowSse2<YL_YUYV>;
+	res.row[YL_UYVY] = convertYuvRowSse2<YL_UYVY>;
+	res.row[YL_NV12] = convertYuvRowSse2<YL_NV12>;
+	res.row[YL_PLANAR] = convertYuvRowSse2<YL_PLANAR>;
+#endif
+	return res;
+}
+
+
+/**
+ * Selects the fastest BGRX conversion supported by the executing CPU.
+ *
+ * @return BGRX conversion function
+ */
+PackedRowFn selectBgrxRow() {
+#if defined(PCF_IMAGE_CONVERT_AVX2)
+	__builtin_cpu_init();
+	if ( __builtin_cpu_supports("avx2") ) return convertBgrxRowAvx2;
+#endif
+#if defined(__SSSE3__)
+	return convertBgrxRowSsse3;
+#else
+	return convertBgrxRowGeneric;
+#endif
+}
+
+
+/**
+ * Converts packed pixels row by row with the given kernel and the generic
+ * conversion for the remaining pixels of each row.
+ *
+ * @param[in] src - source image
+ * @param[in] srcRow - bytes per source row
+ * @param[in] srcBytes - bytes per source pixel
+ * @param[in] width - image width
+ * @param[in] height - image height
+ * @param[out] dst - RGB24 output
+ * @param[in] kernel - accelerated row conversion
+ * @param[in] generic - generic row conversion
+ */
+void convertPacked(const uint8_t * src, const size_t srcRow, const size_t srcBytes, const size_t width, const size_t height, uint8_t * dst, const PackedRowFn kernel, const PackedRowFn generic) {
+	for (size_t row = 0; row < height; row++, src += srcRow, dst += width * 3) {
+		const size_t done = kernel(src, width, dst);
+		generic(src + (done * srcBytes), width - done, dst + (done * 3));
+	}
+}
+
+
+} /* anonymous namespace */
+
+
+/**
+ * Returns the YUV to RGB conversion coefficients for the given parameters.
+ *
+ * @param[in] bt709 - true for ITU-R BT.709, false for ITU-R BT.601
+ * @param[in] fullRange - true for full quantization range, false for limited range
+ * @return conversion coefficients
+ */
+YuvCoefficients getYuvCoefficients(const bool bt709, const bool fullRange) {
+	const float kr = bt709 ? 0.2126f : 0.299f;
+	const float kb = bt709 ? 0.0722f : 0.114f;
+	const float kg = 1.0f - kr - kb;
+	const float cScale = fullRange ? 1.0f : (255.0f / 224.0f);
+	YuvCoefficients res;
+	res.yScale = fullRange ? 1.0f : (255.0f / 219.0f);
+	res.yOffset = fullRange ? 0.0f : (16.0f / 255.0f);
+	res.rv = 2.0f * (1.0f - kr) * cScale;
+	res.gu = 2.0f * kb * (1.0f - kb) / kg * cScale;
+	res.gv = 2.0f * kr * (1.0f - kr) / kg * cScale;
+	res.bu = 2.0f * (1.0f - kb) * cScale;
+	return res;
+}
+
+
+/**
+ * Converts the given YUV image to RGB24 on the CPU. YUYV, UYVY, NV12 and planar layouts
+ * are converted in blocks of 16 or 32 pixels; any other layout pixel by pixel. All
+ * variants produce the same result.
+ *
+ * @param[in] src - source image
+ * @param[in] width - image width
+ * @param[in] height - image height
+ * @param[in] c - conversion coefficients
+ * @param[out] dst - RGB24 output buffer
+ * @remarks The conversion uses AVX2, SSSE3 or SSE2 depending on the executing CPU.
+ */
+void convertYuvToRgb24(const YuvImage & src, const size_t width, const size_t height, const YuvCoefficients & c, uint8_t * dst) {
+	static const YuvKernels kernels = selectYuvKernels();
+	const YuvFactors f = getYuvFactors(c);
+	const YuvLayout layout = getYuvLayout(src);
+	const YuvRowFn kernel = (layout != YL_OTHER) ? kernels.row[layout] : NULL;
+	for (size_t row = 0; row < height; row++, dst += width * 3) {
+		size_t done = 0;
+		if (kernel != NULL) {
+			const uint8_t * yRow = src.y + (row * src.yRow);
+			const size_t cOffset = (row >> src.cRowShift) * src.cRow;
+			done = kernel((layout == YL_UYVY) ? src.u + cOffset : yRow, src.u + cOffset, src.v + cOffset, width, f, dst);
+		}
+		convertRowGeneric(src, row, done, width, f, dst + (done * 3));
+	}
+}
+
+
+/**
+ * Converts the given BGRX image (32 bits per pixel, e.g. `V4L2_PIX_FMT_XBGR32`) to RGB24.
+ *
+ * @param[in] src - source image
+ * @param[in] srcRow - bytes per source row
+ * @param[in] width - image width
+ * @param[in] height - image height
+ * @param[out] dst - RGB24 output buffer
+ * @remarks The conversion uses AVX2 or SSSE3 depending on the executing CPU.
+ */
+void convertBgrxToRgb24(const uint8_t * src, const size_t srcRow, const size_t width, const size_t height, uint8_t * dst) {
+	static const PackedRowFn kernel = selectBgrxRow();
+	convertPacked(src, srcRow, 4, width, height, dst, kernel, convertBgrxRowGeneric);
+}
+
+
+/**
+ * Converts the given BGR24 image to RGB24 or vice versa by swapping the first and third
+ * byte of each pixel. `src` and `dst` may be the same buffer if `srcRow` is `width * 3`.
+ *
+ * @param[in] src - source image
+ * @param[in] srcRow - bytes per source row
+ * @param[in] width - image width
+ * @param[in] height - image height
+ * @param[out] dst - output buffer
+ * @remarks The conversion uses SSSE3 if available at compile time.
+ */
+void convertBgr24ToRgb24(const uint8_t * src, const size_t srcRow, const size_t width, const size_t height, uint8_t * dst) {
+#if defined(__SSSE3__)
+	convertPacked(src, srcRow, 3, width, height, dst, swapRgbRowSsse3, swapRgbRowGeneric);
+#else
+	convertPacked(src, srcRow, 3, width, height, dst, swapRgbRowGeneric, swapRgbRowGeneric);
+#endif
+}
+
+
+} /* namespace image */
+} /* namespace pcf */
@@ -0,0 +1,52 @@
+/**
+ * @file Convert.hpp
+ * @author Daniel Starke
+ * @date 2026-10-16
+ * @version 2026-10-16
+ */
+#ifndef __PCF_IMAGE_CONVERT_HPP__
+#define __PCF_IMAGE_CONVERT_HPP__
+
+#include <cstddef>
+#include <cstdint>
+
+
+namespace pcf {
+namespace image {
+
+
+/** YUV to RGB conversion coefficients for components normalized to 0..1. */
+struct YuvCoefficients {
+	float yScale; /**< luma scale */
+	float yOffset; /**< luma offset */
+	float rv; /**< V to red factor */
+	float gu; /**< U to green factor (subtracted) */
+	float gv; /**< V to green factor (subtracted) */
+	float bu; /**< U to blue factor */
+};
+
+
+/** Location of the YUV components within an image. */
+struct YuvImage {
+	const uint8_t * y; /**< first luma sample */
+	size_t yStep; /**< bytes between horizontally adjacent luma samples */
+	size_t yRow; /**< bytes per luma row */
+	const uint8_t * u; /**< first U sample */
+	const uint8_t * v; /**< first V sample */
+	size_t cStep; /**< bytes between horizontally adjacent chroma samples */
+	size_t cRow; /**< bytes per chroma row */
+	unsigned cRowShift; /**< vertical chroma subsampling as shift value */
+};
+
+
+YuvCoefficients getYuvCoefficients(const bool bt709, const bool fullRange);
+void convertYuvToRgb24(const YuvImage & src, const size_t width, const size_t height, const YuvCoefficients & c, uint8_t * dst);
+void convertBgrxToRgb24(const uint8_t * src, const size_t srcRow, const size_t width, const size_t height, uint8_t * dst);
+void convertBgr24ToRgb24(const uint8_t * src, const size_t srcRow, const size_t width, const size_t height, uint8_t * dst);
+
+
+} /* namespace image */
+} /* namespace pcf */
+
+
+#endif /* __PCF_IMAGE_CONVERT_HPP__ */
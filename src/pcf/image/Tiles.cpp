@@ -0,0 +1,188 @@
+/**
+ * @file Tiles.cpp
+ * @author Daniel Starke
+ * @date 2026-10-16
+ * @version 2026-10-16
+ */
+#include <algorithm>
+#include <cstring>
+#include <pcf/image/Tiles.hpp>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define PCF_IMAGE_TILES_AVX2
+#endif
+
+
+namespace pcf {
+namespace image {
+namespace {
+
+
+/**
+ * Compares a rectangular region of two images.
+ *
+ * @param[in] a - first image region
+ * @param[in] b - second image region
+ * @param[in] stride - bytes per image row
+ * @param[in] width - region width in bytes
+ * @param[in] height - region height in rows
+ * @param[in] threshold - maximum absolute difference per byte which is ignored
+ * @return true if any byte differs by more than `threshold`, else false
+ */
+typedef bool (* RegionDiffersFn)(const uint8_t * a, const uint8_t * b, const size_t stride, const size_t width, const size_t height, const uint8_t threshold);
+
+
+/**
+ * Compares the given row tail byte by byte.
+ *
+ * @param[in] a - first row
+ * @param[in] b - second row
+ * @param[in] first - first byte to compare
+ * @param[in] last - one past the last byte to compare
+ * @param[in] threshold - maximum absolute difference per byte which is ignored
+ * @return true if any byte differs by more than `threshold`, else false
+ */
+inline bool rowDiffers(const uint8_t * a, const uint8_t * b, size_t first, const size_t last, const uint8_t threshold) {
+	for (; first < last; first++) {
+		const int diff = int(a[first]) - int(b[first]);
+		if (diff > int(threshold) || -diff > int(threshold)) return true;
+	}
+	return false;
+}
+
+
+#if defined(__SSE2__)
+/** @copydoc RegionDiffersFn */
+bool regionDiffersSse2(const uint8_t * a, const uint8_t * b, const size_t stride, const size_t width, const size_t height, const uint8_t threshold) {
+	const __m128i limit = _mm_set1_epi8(char(threshold));
+	const __m128i zero = _mm_setzero_si128();
+	const size_t vecWidth = width & ~size_t(15);
+	for (size_t y = 0; y < height; y++, a += stride, b += stride) {
+		__m128i over = zero;
+		for (size_t x = 0; x < vecWidth; x += 16) {
+			const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + x));
+			const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + x));
+			/* |a - b| - threshold with unsigned saturation is non-zero only above the threshold */
+			const __m128i diff = _mm_or_si128(_mm_subs_epu8(va, vb), _mm_subs_epu8(vb, va));
+			over = _mm_or_si128(over, _mm_subs_epu8(diff, limit));
+		}
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(over, zero)) != 0xFFFF) return true;
+		if ( rowDiffers(a, b, vecWidth, width, threshold) ) return true;
+	}
+	return false;
+}
+#else /* ! __SSE2__ */
+/** @copydoc RegionDiffersFn */
+bool regionDiffersGeneric(const uint8_t * a, const uint8_t * b, const size_t stride, const size_t width, const size_t height, const uint8_t threshold) {
+	for (size_t y = 0; y < height; y++, a += stride, b += stride) {
+		if ( rowDiffers(a, b, 0, width, threshold) ) return true;
+	}
+	return false;
+}
+#endif /* __SSE2__ */
+
+
+#if defined(PCF_IMAGE_TILES_AVX2)
+/** @copydoc RegionDiffersFn */
+__attribute__((target("avx2")))
+bool regionDiffersAvx2(const uint8_t * a, const uint8_t * b, const size_t stride, const size_t width, const size_t height, const uint8_t threshold) {
+	const __m256i limit = _mm256_set1_epi8(char(threshold));
+	const __m256i zero = _mm256_setzero_si256();
+	const size_t vecWidth = width & ~size_t(31);
+	for (size_t y = 0; y < height; y++, a += stride, b += stride) {
+		__m256i over = zero;
+		for (size_t x = 0; x < vecWidth; x += 32) {
+			const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + x));
+			const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + x));
+			const __m256i diff = _mm256_or_si256(_mm256_subs_epu8(va, vb), _mm256_subs_epu8(vb, va));
+			over = _mm256_or_si256(over, _mm256_subs_epu8(diff, limit));
+		}
+		if ( ! _mm256_testz_si256(over, over) ) return true;
+		if ( rowDiffers(a, b, vecWidth, width, threshold) ) return true;
+	}
+	return false;
+}
+#endif /* PCF_IMAGE_TILES_AVX2 */
+
+
+/**
+ * Selects the fastest region comparison supported by the executing CPU.
+ *
+ * @return region comparison function
+ */
+RegionDiffersFn selectRegionDiffers() {
+#if defined(PCF_IMAGE_TILES_AVX2)
+	__builtin_cpu_init();
+	if ( __builtin_cpu_supports("avx2") ) return regionDiffersAvx2;
+#endif
+#if defined(__SSE2__)
+	return regionDiffersSse2;
+#else
+	return regionDiffersGeneric;
+#endif
+}
+
+
+} /* anonymous namespace */
+
+
+/**
+ * Compares the given image tile by tile against the reference image and marks each tile
+ * in which any byte differs by more than `threshold`. Changed tiles are copied to the
+ * reference image. Hence, slow gradual changes are still detected once they exceed the
+ * threshold in sum.
+ *
+ * @param[in] image - current image data
+ * @param[in,out] reference - reference image data with the same layout as `image`
+ * @param[in] planes - image plane layouts
+ * @param[in] planeCount - number of elements in `planes`
+ * @param[in] tilesX - number of tiles per row
+ * @param[in] tilesY - number of tile rows
+ * @param[in] threshold - maximum absolute difference per byte which is ignored
+ * @param[out] changed - receives 1 for each changed and 0 for each unchanged tile in row-major order
+ * @return number of changed tiles
+ * @remarks The comparison uses AVX2 or SSE2 depending on the executing CPU.
+ */
+size_t markChangedTiles(const uint8_t * image, uint8_t * reference, const TilePlane * planes, const size_t planeCount, const size_t tilesX, const size_t tilesY, const uint8_t threshold, uint8_t * changed) {
+	static const RegionDiffersFn regionDiffers = selectRegionDiffers();
+	size_t count = 0;
+	memset(changed, 0, tilesX * tilesY);
+	for (size_t ty = 0; ty < tilesY; ty++) {
+		for (size_t tx = 0; tx < tilesX; tx++) {
+			uint8_t & tile = changed[(ty * tilesX) + tx];
+			for (size_t n = 0; n < planeCount && tile == 0; n++) {
+				const TilePlane & plane = planes[n];
+				const size_t x = tx * plane.tileWidth;
+				const size_t y = ty * plane.tileHeight;
+				if (x >= plane.width || y >= plane.height) continue;
+				const size_t offset = plane.offset + (y * plane.width) + x;
+				const size_t width = std::min(plane.tileWidth, plane.width - x);
+				const size_t height = std::min(plane.tileHeight, plane.height - y);
+				if ( regionDiffers(image + offset, reference + offset, plane.width, width, height, threshold) ) tile = 1;
+			}
+			if (tile == 0) continue;
+			count++;
+			/* update the reference with all planes of the changed tile */
+			for (size_t n = 0; n < planeCount; n++) {
+				const TilePlane & plane = planes[n];
+				const size_t x = tx * plane.tileWidth;
+				const size_t y = ty * plane.tileHeight;
+				if (x >= plane.width || y >= plane.height) continue;
+				const size_t width = std::min(plane.tileWidth, plane.width - x);
+				const size_t height = std::min(plane.tileHeight, plane.height - y);
+				for (size_t row = 0; row < height; row++) {
+					const size_t offset = plane.offset + ((y + row) * plane.width) + x;
+					memcpy(reference + offset, image + offset, width);
+				}
+			}
+		}
+	}
+	return count;
+}
+
+
+} /* namespace image */
+} /* namespace pcf */
@@ -0,0 +1,42 @@
+/**
+ * @file Tiles.hpp
+ * @author Daniel Starke
+ * @date 2026-10-16
+ * @version 2026-10-16
+ */
+#ifndef __PCF_IMAGE_TILES_HPP__
+#define __PCF_IMAGE_TILES_HPP__
+
+#include <cstddef>
+#include <cstdint>
+
+
+/** Edge length of a tile in pixels. */
+#define PCF_IMAGE_TILE_SIZE 32
+
+
+namespace pcf {
+namespace image {
+
+
+/**
+ * Layout of a single image plane for markChangedTiles(). All planes of an image share
+ * the same tile grid. Subsampled planes use correspondingly smaller tiles.
+ */
+struct TilePlane {
+	size_t offset; /**< byte offset of the plane within the image data */
+	size_t width; /**< row size in bytes */
+	size_t height; /**< number of rows */
+	size_t tileWidth; /**< tile width in bytes */
+	size_t tileHeight; /**< tile height in rows */
+};
+
+
+size_t markChangedTiles(const uint8_t * image, uint8_t * reference, const TilePlane * planes, const size_t planeCount, const size_t tilesX, const size_t tilesY, const uint8_t threshold, uint8_t * changed);
+
+
+} /* namespace image */
+} /* namespace pcf */
+
+
+#endif /* __PCF_IMAGE_TILES_HPP__ */
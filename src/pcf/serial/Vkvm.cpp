@@ -2,14 +2,16 @@
  * @file Vkvm.cpp
  * @author Daniel Starke
  * @date 2019-10-11
- * @version 2026-06-15
+ * @version 2026-10-16
  */
 #include <algorithm>
 #include <atomic>
 #include <condition_variable>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <mutex>
+#include <new>
 #include <thread>
 #include <vkm-periphery/Framing.hpp>
 #include <vkm-periphery/Protocol.hpp>
@@ -25,7 +27,6 @@
 #undef MB_RIGHT
 #undef S_OK
 #else /* !PCF_IS_WIN */
-#include <cstdio>
 extern "C" {
 #include <dirent.h>
 #include <errno.h>
@@ -34,13 +35,16 @@ extern "C" {
 #include <linux/input.h>
 #include <sys/eventfd.h>
 #include <sys/ioctl.h>
+#include <sys/epoll.h>
 #include <sys/stat.h>
 #include <sys/time.h>
+#include <sys/timerfd.h>
 #include <sys/types.h>
 #include <time.h>
 #include <unistd.h>
 }
 #include <limits>
+#include <vector>
 #include <pcf/UtilityLinux.hpp>
 #ifndef PCF_MAX_SYS_PATH
 #define PCF_MAX_SYS_PATH 1024
@@ -55,18 +59,37 @@ extern "C" {
 
 /** Receive buffer size in bytes. */
 #define RECV_BUFFER_SIZE 1024
-/** Send buffer size in bytes. */
-#define SEND_BUFFER_SIZE 1024
+/** Maximum unquoted request frame payload size in bytes. This exceeds `VKVM_MAX_FRAME_SIZE` to leave the frame size check to the periphery. */
+#define SEND_PAYLOAD_SIZE 512
 /** Maximum number of outstanding requests. */
 #define REQUEST_FIFO_LIMIT 128
+/** Size of a single preallocated request item slot in bytes. Needs to fit the largest request item (`SET_KEYBOARD_WRITE`). */
+#define REQUEST_SLOT_SIZE 336
+/** First periphery protocol version which supports `RequestType::SET_BATCH`. */
+#define BATCH_PROT_VERSION 0x0102
+/** USB keyboard report interval of the periphery in milliseconds. See the keyboard endpoint descriptor in vkm-periphery/Vkm.hpp */
+#define KEYBOARD_REPORT_INTERVAL 4
+/** USB mouse report interval of the periphery in milliseconds. See the mouse endpoint descriptors in vkm-periphery/Vkm.hpp */
+#define MOUSE_REPORT_INTERVAL 1
+/** Number of additional keyboard reports sent by `SET_KEYBOARD_WRITE` for the release of all keys and the lock key toggling. */
+#define KEYBOARD_WRITE_OVERHEAD 10
+/** Serial receive buffer size of the periphery in bytes (Arduino `SERIAL_RX_BUFFER_SIZE`). Limits the number of bytes sent without response. */
+#define PERIPHERY_RX_BUFFER_SIZE 64
+/** Maximum number of events processed per `epoll_wait()` call of the shared reactor. */
+#define REACTOR_MAX_EVENTS 32
+/** Number of records within the binary protocol trace ring. */
+#define TRACE_RING_SIZE 4096
+/** Maximum number of data bytes per binary protocol trace record. Larger chunks use multiple records. */
+#define TRACE_RECORD_DATA 46
 
 
 /**
- * Returns the number of milliseconds passed since the program was started.
+ * Returns the number of microseconds passed since an arbitrary but fixed point in
+ * time. The value is monotonic and does not wrap around within the program run time.
  *
- * @return milliseconds since program start
+ * @return monotonic timestamp in microseconds
  */
-extern "C" inline unsigned long millis(void) {
+static inline uint64_t monotonicMicros(void) {
 #ifdef PCF_IS_WIN
 	static LARGE_INTEGER perfFreq;
 	static int hasPerfFreq = 0;
@@ -76,17 +99,42 @@ extern "C" inline unsigned long millis(void) {
 		hasPerfFreq = 1;
 	}
 	QueryPerformanceCounter(&counter);
-	return static_cast<unsigned long>(int64_t(counter.QuadPart) * INT64_C(1000) / int64_t(perfFreq.QuadPart));
+	/* split into seconds and remainder to avoid an overflow of the intermediate product */
+	const uint64_t count = uint64_t(counter.QuadPart);
+	const uint64_t freq = uint64_t(perfFreq.QuadPart);
+	return ((count / freq) * UINT64_C(1000000)) + ((count % freq) * UINT64_C(1000000) / freq);
 #elif defined(PCF_IS_LINUX)
-	struct timeval tv;
-	if (gettimeofday(&tv, NULL) != 0) return 0;
-	return static_cast<unsigned long>(((int64_t(tv.tv_sec) * INT64_C(1000000)) + int64_t(tv.tv_usec)) / UINT64_C(1000));
+	struct timespec ts;
+	if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) return 0;
+	return (uint64_t(ts.tv_sec) * UINT64_C(1000000)) + (uint64_t(ts.tv_nsec) / UINT64_C(1000));
 #else /* not PCF_IS_WIN and not PCF_IS_LINUX */
 #error Unsupported target OS.
 #endif
 }
 
 
+/**
+ * Returns the number of milliseconds passed since an arbitrary but fixed point in time.
+ * The value wraps around at the range of `unsigned long`.
+ *
+ * @return monotonic timestamp in milliseconds
+ */
+extern "C" inline unsigned long millis(void) {
+	return static_cast<unsigned long>(monotonicMicros() / UINT64_C(1000));
+}
+
+
+/**
+ * Returns the number of microseconds passed since an arbitrary but fixed point in time.
+ * The value wraps around at the range of `unsigned long`.
+ *
+ * @return monotonic timestamp in microseconds
+ */
+extern "C" inline unsigned long micros(void) {
+	return static_cast<unsigned long>(monotonicMicros());
+}
+
+
 #ifdef VKVM_TRACE
 #include <stdarg.h>
 #include <stdio.h>
@@ -140,25 +188,19 @@ namespace {
 
 /* forward declaration */
 struct SerialCommon;
+static bool serialSendFrame(SerialCommon & args, const uint8_t seq);
+#ifdef PCF_IS_LINUX
+class VkvmReactor;
+#endif /* PCF_IS_LINUX */
 
 
 /**
- * Reference counting byte buffer.
- *
- * @remarks This class is not thread-safe.
+ * Byte buffer which stores up to 255 bytes inline to avoid heap allocations.
  */
 class ByteBuffer {
 private:
-	/**
-	 * Internal structure which holds the actual data.
-	 * The actual size depends on the byte buffer size.
-	 */
-	struct Rc {
-		std::atomic_size_t refCount; /**< Current reference count. The object is deleted if this reaches zero. */
-		uint8_t size; /**< Byte buffer size. */
-		uint8_t buffer[1]; /**< Pointer to the first byte of the byte buffer. */
-	};
-	Rc * ptr; /**< Pointer to the byte buffer object. */
+	uint8_t size; /**< Byte buffer size. */
+	uint8_t buffer[UINT8_MAX]; /**< Byte buffer data. Only the first `size` bytes are valid. */
 public:
 	/**
 	 * Constructor.
@@ -166,69 +208,34 @@ public:
 	 * @param[in] buf - initial buffer data to use
 	 * @param[in] len - buffer size
 	 */
-	explicit inline ByteBuffer(const uint8_t * buf, const uint8_t len) {
-		this->ptr = static_cast<Rc *>(malloc(offsetof(Rc, buffer) + size_t(len)));
-		if (this->ptr == NULL) throw std::bad_alloc();
-		this->ptr->refCount.store(1, std::memory_order_relaxed);
-		this->ptr->size = len;
-		memcpy(this->ptr->buffer, buf, size_t(len));
+	explicit inline ByteBuffer(const uint8_t * buf, const uint8_t len):
+		size(len)
+	{
+		if (len > 0) memcpy(this->buffer, buf, size_t(len));
 	}
 
 	/**
 	 * Copy constructor.
 	 *
 	 * @param[in] o - object to copy
-	 * @remarks This only increases the reference counter.
+	 * @remarks Only the valid bytes are copied.
 	 */
 	inline ByteBuffer(const ByteBuffer & o):
-		ptr(o.ptr)
-	{
-		this->aquire();
-	}
-
-	/**
-	 * Move constructor.
-	 *
-	 * @param[in,out] o - object to move
-	 * @remarks The object moved is no longer available from its original identifier after this.
-	 */
-	inline ByteBuffer(ByteBuffer && o):
-		ptr(o.ptr)
+		size(o.size)
 	{
-		o.ptr = NULL;
-	}
-
-	/**
-	 * Destructor.
-	 */
-	inline ~ByteBuffer() {
-		this->release();
+		if (o.size > 0) memcpy(this->buffer, o.buffer, size_t(o.size));
 	}
 
 	/**
 	 * Assignment operator.
 	 *
 	 * @param[in] o - object o assign
-	 * @remarks This only modifies the reference counter.
+	 * @remarks Only the valid bytes are copied.
 	 */
 	inline ByteBuffer & operator= (const ByteBuffer & o) {
 		if (&o == this) return *this;
-		this->release();
-		this->ptr = o.ptr;
-		this->aquire();
-		return *this;
-	}
-
-	/**
-	 * Move assignment operator.
-	 *
-	 * @param[in,out] o - object to move
-	 * @remarks The object moved is no longer available from its original identifier after this.
-	 */
-	inline ByteBuffer & operator= (ByteBuffer && o) {
-		this->release();
-		this->ptr = o.ptr;
-		o.ptr = NULL;
+		this->size = o.size;
+		if (o.size > 0) memcpy(this->buffer, o.buffer, size_t(o.size));
 		return *this;
 	}
 
@@ -238,7 +245,7 @@ public:
 	 * @return byte buffer pointer
 	 */
 	inline uint8_t * getPointer() {
-		return (this->ptr != NULL) ? this->ptr->buffer : NULL;
+		return this->buffer;
 	}
 
 	/**
@@ -247,7 +254,7 @@ public:
 	 * @return byte buffer pointer
 	 */
 	inline const uint8_t * getPointer() const {
-		return (this->ptr != NULL) ? this->ptr->buffer : NULL;
+		return this->buffer;
 	}
 
 	/**
@@ -256,28 +263,55 @@ public:
 	 * @return byte buffer size
 	 */
 	inline uint8_t getSize() const {
-		return (this->ptr != NULL) ? this->ptr->size : 0;
+		return this->size;
 	}
-private:
+};
+
+
+/**
+ * Unquoted payload of the request frame being sent. Values are written big-endian
+ * and the whole frame is encoded at once via `Framing::encode()`.
+ */
+struct PayloadBuffer {
+	uint8_t data[SEND_PAYLOAD_SIZE]; /**< Payload data. Only the first `size` bytes are valid. */
+	size_t size; /**< Payload size in bytes. */
+
 	/**
-	 * Increases the reference counter.
+	 * Discards the current payload.
 	 */
-	inline void aquire() {
-		if (this->ptr == NULL) return;
-		this->ptr->refCount.fetch_add(1, std::memory_order_relaxed);
+	inline void clear() {
+		this->size = 0;
 	}
 
 	/**
-	 * Decreases the reference counter and deletes the pointed
-	 * object when it reaches zero.
+	 * Appends the given value big-endian encoded.
+	 *
+	 * @param[in] val - value to append
+	 * @return true on success, false if the buffer is full
+	 * @tparam T - value type
 	 */
-	inline void release() {
-		if (this->ptr == NULL) return;
-		if (this->ptr->refCount.fetch_sub(1, std::memory_order_release) == 1) {
-			std::atomic_thread_fence(std::memory_order_acquire);
-			free(this->ptr);
-			this->ptr = NULL;
+	template <typename T>
+	inline typename enable_if<is_integral<T>::value, bool>::type write(const T val) {
+		if ((this->size + sizeof(T)) > sizeof(this->data)) return false;
+		const uint64_t value = uint64_t(val); /* two's complement for signed values */
+		for (size_t i = sizeof(T); i > 0; i--) {
+			this->data[this->size++] = uint8_t((value >> (8 * (i - 1))) & 0xFF);
 		}
+		return true;
+	}
+
+	/**
+	 * Appends the given data.
+	 *
+	 * @param[in] buf - data to append
+	 * @param[in] len - data size
+	 * @return true on success, false if the buffer is full
+	 */
+	inline bool write(const uint8_t * buf, const size_t len) {
+		if ((this->size + len) > sizeof(this->data)) return false;
+		if (len > 0) memcpy(this->data + this->size, buf, len);
+		this->size += len;
+		return true;
 	}
 };
 
@@ -369,19 +403,26 @@ inline double mapRequestParam(const AbsCoord & from) { return from.getNorm(); }
 struct RequestQueueItem {
 	RequestQueueItem * next; /**< Pointer to the next request item in the queue. */
 
-	const uint8_t seq; /**< Associated frame sequence number. */
+	uint8_t seq; /**< Associated frame sequence number. Assigned when added to the request queue. */
 	const RequestType::Type type; /**< Associated request type. See vkm-periphery/Protocol.hpp */
+	unsigned long sentAt; /**< Timestamp (derived from millis()) at which this request has been sent. */
+	unsigned long sentAtUs; /**< Timestamp (derived from micros()) at which this request has been sent. Used for statistics. */
+	uint8_t batchSize; /**< Number of requests sent within the frame started by this request. Zero if sent within the frame of a previous request. */
+	uint16_t frameSize; /**< Number of bytes sent for the frame started by this request. Zero if sent within the frame of a previous request. */
 
 	/**
 	 * Constructor.
 	 *
-	 * @param[in] s - frame sequence number to use
 	 * @param[in] t - request type to use (see vkm-periphery/Protocol.hpp)
 	 */
-	explicit inline RequestQueueItem(const uint8_t s, const RequestType::Type t):
+	explicit inline RequestQueueItem(const RequestType::Type t):
 		next(NULL),
-		seq(s),
-		type(t)
+		seq(0),
+		type(t),
+		sentAt(0),
+		sentAtUs(0),
+		batchSize(1),
+		frameSize(0)
 	{}
 
 	/** Destructor. */
@@ -399,6 +440,19 @@ struct RequestQueueItem {
 	 * @return true on success, else false
 	 */
 	virtual bool send(SerialCommon &) const = 0;
+	/**
+	 * Writes the request type and fields within the current frame.
+	 *
+	 * @param[in,out] args - shared `VkvmDevice` arguments reference
+	 * @return true on success, else false
+	 */
+	virtual bool sendPayload(SerialCommon &) const = 0;
+	/**
+	 * Returns the number of bytes written by `sendPayload()`.
+	 *
+	 * @return payload size in bytes
+	 */
+	virtual size_t getPayloadSize() const = 0;
 	/**
 	 * Called to set the result value from the given data.
 	 *
@@ -417,6 +471,353 @@ struct RequestQueueItem {
 };
 
 
+/**
+ * Fixed capacity pool of request item slots. Allocation and deallocation are lock-free
+ * and never access the heap.
+ */
+class RequestQueueItemPool {
+private:
+	enum {
+		NO_SLOT = 0xFFFFFFFF /**< Slot index which marks the end of the free list. */
+	};
+	/** Storage of a single request item. */
+	union Slot {
+		std::max_align_t align; /**< Ensures proper alignment for any request item. */
+		uint8_t data[REQUEST_SLOT_SIZE]; /**< Request item storage. */
+	};
+	Slot slots[REQUEST_FIFO_LIMIT]; /**< Request item storage of all slots. */
+	std::atomic<uint32_t> nextFree[REQUEST_FIFO_LIMIT]; /**< Index of the next free slot for each free slot. */
+	std::atomic<uint64_t> freeList; /**< Index of the first free slot (lower 32 bits) and modification counter to avoid ABA issues (upper 32 bits). */
+public:
+	/** Constructor. */
+	explicit inline RequestQueueItemPool():
+		freeList(0)
+	{
+		for (uint32_t i = 0; i < REQUEST_FIFO_LIMIT; i++) {
+			this->nextFree[i].store((i + 1) < REQUEST_FIFO_LIMIT ? (i + 1) : uint32_t(NO_SLOT), std::memory_order_relaxed);
+		}
+	}
+
+	RequestQueueItemPool(const RequestQueueItemPool &) = delete;
+	RequestQueueItemPool & operator= (const RequestQueueItemPool &) = delete;
+
+	/**
+	 * Constructs a new request item within a free slot.
+	 *
+	 * @param[in] args - constructor arguments
+	 * @return new request item or NULL if all slots are in use
+	 * @tparam T - request item type
+	 * @tparam Args - constructor argument types
+	 */
+	template <typename T, typename ...Args>
+	inline T * create(Args... args) {
+		static_assert(sizeof(T) <= sizeof(Slot), "REQUEST_SLOT_SIZE is too small for this request item");
+		void * mem = this->allocate();
+		if (mem == NULL) return NULL;
+		return new (mem) T(args...);
+	}
+
+	/**
+	 * Destructs the given request item and returns its slot to the pool.
+	 *
+	 * @param[in] item - request item to destroy
+	 */
+	inline void destroy(RequestQueueItem * item) {
+		if (item == NULL) return;
+		item->~RequestQueueItem();
+		this->deallocate(reinterpret_cast<Slot *>(item));
+	}
+private:
+	/**
+	 * Removes the first slot from the free list.
+	 *
+	 * @return slot memory or NULL if all slots are in use
+	 */
+	inline void * allocate() {
+		uint64_t head = this->freeList.load(std::memory_order_acquire);
+		for ( ;; ) {
+			const uint32_t index = uint32_t(head & 0xFFFFFFFF);
+			if (index == uint32_t(NO_SLOT)) return NULL;
+			const uint64_t tag = (head >> 32) + 1;
+			const uint64_t newHead = (tag << 32) | uint64_t(this->nextFree[index].load(std::memory_order_relaxed));
+			if ( this->freeList.compare_exchange_weak(head, newHead, std::memory_order_acquire, std::memory_order_acquire) ) {
+				return this->slots[index].data;
+			}
+		}
+	}
+
+	/**
+	 * Adds the given slot to the front of the free list.
+	 *
+	 * @param[in] slot - slot to add
+	 */
+	inline void deallocate(Slot * slot) {
+		const uint32_t index = uint32_t(slot - this->slots);
+		uint64_t head = this->freeList.load(std::memory_order_relaxed);
+		for ( ;; ) {
+			this->nextFree[index].store(uint32_t(head & 0xFFFFFFFF), std::memory_order_relaxed);
+			const uint64_t tag = (head >> 32) + 1;
+			const uint64_t newHead = (tag << 32) | uint64_t(index);
+			if ( this->freeList.compare_exchange_weak(head, newHead, std::memory_order_release, std::memory_order_relaxed) ) return;
+		}
+	}
+};
+
+
+/**
+ * Lock-free recorder for the `VkvmStatistics` counters. All values are updated
+ * with relaxed atomic operations. Hence, recording is possible from any thread
+ * without locking and a snapshot is only consistent per counter.
+ */
+struct SerialStatistics {
+	/** Round-trip time statistics of a single request type. */
+	struct Rtt {
+		std::atomic<uint64_t> count; /**< Number of measured round-trips. */
+		std::atomic<uint64_t> sumUs; /**< Sum of all round-trip times in microseconds. */
+		std::atomic<uint32_t> maxUs; /**< Maximum round-trip time in microseconds. */
+		std::atomic<uint64_t> histogram[VkvmStatistics::RTT_BUCKETS]; /**< Round-trip time histogram. */
+	};
+	Rtt rtt[RequestType::COUNT]; /**< Round-trip times per `RequestType`. */
+	std::atomic<uint64_t> results[size_t(VkvmCallback::PeripheryResult::COUNT)]; /**< Number of request results per periphery result code. */
+	std::atomic<uint64_t> depthHistogram[VkvmStatistics::DEPTH_BUCKETS]; /**< Request queue depth sampled whenever a new request is queued. */
+	std::atomic<uint32_t> maxQueueDepth; /**< Maximum number of queued requests. */
+	std::atomic<uint64_t> requests; /**< Number of queued requests. */
+	std::atomic<uint64_t> merged; /**< Number of requests merged into an already queued request. */
+	std::atomic<uint64_t> rejected; /**< Number of requests rejected due to a full request queue. */
+	std::atomic<uint64_t> framesSent; /**< Number of request frames sent. */
+	std::atomic<uint64_t> batchesSent; /**< Number of `RequestType::SET_BATCH` frames sent. */
+	std::atomic<uint64_t> framesReceived; /**< Number of valid frames received. */
+	std::atomic<uint64_t> interrupts; /**< Number of unsolicited interrupt frames received. */
+	std::atomic<uint64_t> brokenFrames; /**< Number of broken frames received from the periphery. */
+	std::atomic<uint64_t> timeouts; /**< Number of request timeouts. */
+	std::atomic<uint64_t> bytesSent; /**< Number of bytes written to the serial device. */
+	std::atomic<uint64_t> bytesReceived; /**< Number of bytes read from the serial device. */
+
+	/** Constructor. */
+	explicit SerialStatistics() {
+		this->reset();
+	}
+
+	/**
+	 * Increments the given counter.
+	 *
+	 * @param[in,out] counter - counter to increment
+	 * @param[in] val - value to add
+	 */
+	static inline void add(std::atomic<uint64_t> & counter, const uint64_t val = 1) {
+		counter.fetch_add(val, std::memory_order_relaxed);
+	}
+
+	/**
+	 * Raises the given maximum value to the passed value if larger.
+	 *
+	 * @param[in,out] maximum - maximum value to update
+	 * @param[in] val - new sample
+	 */
+	static inline void max(std::atomic<uint32_t> & maximum, const uint32_t val) {
+		uint32_t old = maximum.load(std::memory_order_relaxed);
+		while (val > old && ( ! maximum.compare_exchange_weak(old, val, std::memory_order_relaxed) ));
+	}
+
+	/**
+	 * Returns the histogram bucket for the given value. Bucket 0 holds values below
+	 * `base` and bucket `i` values below `base << i`. The last bucket holds all
+	 * remaining values.
+	 *
+	 * @param[in] val - value to classify
+	 * @param[in] base - upper limit of the first bucket
+	 * @param[in] buckets - number of buckets
+	 * @return bucket index
+	 */
+	static inline size_t bucket(uint64_t val, const uint64_t base, const size_t buckets) {
+		size_t i = 0;
+		for (val /= base; val > 0 && i < (buckets - 1); val >>= 1) i++;
+		return i;
+	}
+
+	/**
+	 * Records the round-trip time of a single request or frame.
+	 *
+	 * @param[in] type - request type
+	 * @param[in] us - round-trip time in microseconds
+	 */
+	inline void addRtt(const RequestType::Type type, const unsigned long us) {
+		if (size_t(type) >= size_t(RequestType::COUNT)) return;
+		Rtt & r = this->rtt[type];
+		add(r.count);
+		add(r.sumUs, us);
+		max(r.maxUs, uint32_t(PCF_MIN(us, static_cast<unsigned long>(UINT32_MAX))));
+		add(r.histogram[bucket(us, VkvmStatistics::RTT_BASE, VkvmStatistics::RTT_BUCKETS)]);
+	}
+
+	/**
+	 * Records the current request queue depth.
+	 *
+	 * @param[in] depth - number of queued requests
+	 */
+	inline void addQueueDepth(const size_t depth) {
+		add(this->depthHistogram[bucket(depth, 1, VkvmStatistics::DEPTH_BUCKETS)]);
+		max(this->maxQueueDepth, uint32_t(depth));
+	}
+
+	/**
+	 * Copies all counters to the given snapshot.
+	 *
+	 * @param[out] out - receives the counter values
+	 */
+	void copyTo(VkvmStatistics & out) const {
+		for (size_t t = 0; t < size_t(RequestType::COUNT); t++) {
+			out.rtt[t].count = this->rtt[t].count.load(std::memory_order_relaxed);
+			out.rtt[t].sumUs = this->rtt[t].sumUs.load(std::memory_order_relaxed);
+			out.rtt[t].maxUs = this->rtt[t].maxUs.load(std::memory_order_relaxed);
+			for (size_t i = 0; i < VkvmStatistics::RTT_BUCKETS; i++) {
+				out.rtt[t].histogram[i] = this->rtt[t].histogram[i].load(std::memory_order_relaxed);
+			}
+		}
+		for (size_t i = 0; i < size_t(VkvmCallback::PeripheryResult::COUNT); i++) {
+			out.results[i] = this->results[i].load(std::memory_order_relaxed);
+		}
+		for (size_t i = 0; i < VkvmStatistics::DEPTH_BUCKETS; i++) {
+			out.depthHistogram[i] = this->depthHistogram[i].load(std::memory_order_relaxed);
+		}
+		out.maxQueueDepth = this->maxQueueDepth.load(std::memory_order_relaxed);
+		out.requests = this->requests.load(std::memory_order_relaxed);
+		out.merged = this->merged.load(std::memory_order_relaxed);
+		out.rejected = this->rejected.load(std::memory_order_relaxed);
+		out.framesSent = this->framesSent.load(std::memory_order_relaxed);
+		out.batchesSent = this->batchesSent.load(std::memory_order_relaxed);
+		out.framesReceived = this->framesReceived.load(std::memory_order_relaxed);
+		out.interrupts = this->interrupts.load(std::memory_order_relaxed);
+		out.brokenFrames = this->brokenFrames.load(std::memory_order_relaxed);
+		out.timeouts = this->timeouts.load(std::memory_order_relaxed);
+		out.bytesSent = this->bytesSent.load(std::memory_order_relaxed);
+		out.bytesReceived = this->bytesReceived.load(std::memory_order_relaxed);
+	}
+
+	/** Resets all counters to zero. */
+	void reset() {
+		for (size_t t = 0; t < size_t(RequestType::COUNT); t++) {
+			this->rtt[t].count.store(0, std::memory_order_relaxed);
+			this->rtt[t].sumUs.store(0, std::memory_order_relaxed);
+			this->rtt[t].maxUs.store(0, std::memory_order_relaxed);
+			for (size_t i = 0; i < VkvmStatistics::RTT_BUCKETS; i++) {
+				this->rtt[t].histogram[i].store(0, std::memory_order_relaxed);
+			}
+		}
+		for (size_t i = 0; i < size_t(VkvmCallback::PeripheryResult::COUNT); i++) {
+			this->results[i].store(0, std::memory_order_relaxed);
+		}
+		for (size_t i = 0; i < VkvmStatistics::DEPTH_BUCKETS; i++) {
+			this->depthHistogram[i].store(0, std::memory_order_relaxed);
+		}
+		this->maxQueueDepth.store(0, std::memory_order_relaxed);
+		this->requests.store(0, std::memory_order_relaxed);
+		this->merged.store(0, std::memory_order_relaxed);
+		this->rejected.store(0, std::memory_order_relaxed);
+		this->framesSent.store(0, std::memory_order_relaxed);
+		this->batchesSent.store(0, std::memory_order_relaxed);
+		this->framesReceived.store(0, std::memory_order_relaxed);
+		this->interrupts.store(0, std::memory_order_relaxed);
+		this->brokenFrames.store(0, std::memory_order_relaxed);
+		this->timeouts.store(0, std::memory_order_relaxed);
+		this->bytesSent.store(0, std::memory_order_relaxed);
+		this->bytesReceived.store(0, std::memory_order_relaxed);
+	}
+};
+
+
+/**
+ * Lock-free ring buffer which records the raw serial data in both directions
+ * together with a timestamp. The oldest records are overwritten if full.
+ * Each record is guarded by its record number. This allows concurrent
+ * recording and dumping without locks. Records being overwritten while
+ * dumping are skipped.
+ */
+class TraceRing {
+public:
+	/** Possible data directions. */
+	enum Direction {
+		DIR_IN, /**< Received from the VKVM periphery. */
+		DIR_OUT /**< Sent to the VKVM periphery. */
+	};
+private:
+	/** Single trace record. */
+	struct Record {
+		std::atomic<uint64_t> stamp; /**< Record number plus one or zero while being written. */
+		uint64_t time; /**< Timestamp in microseconds (derived from monotonicMicros()). Does not wrap around unlike micros(). */
+		uint8_t dir; /**< Data direction. See `Direction`. */
+		uint8_t size; /**< Number of valid bytes in `data`. */
+		uint8_t data[TRACE_RECORD_DATA]; /**< Raw serial data. */
+	};
+	std::atomic<uint64_t> next; /**< Number of the next record to write. */
+	Record records[TRACE_RING_SIZE]; /**< Record storage. */
+public:
+	/** Constructor. */
+	explicit TraceRing():
+		next(0)
+	{
+		for (size_t i = 0; i < TRACE_RING_SIZE; i++) this->records[i].stamp.store(0, std::memory_order_relaxed);
+	}
+
+	TraceRing(const TraceRing &) = delete;
+	TraceRing & operator= (const TraceRing &) = delete;
+
+	/**
+	 * Records the given serial data.
+	 *
+	 * @param[in] dir - data direction
+	 * @param[in] buf - raw serial data
+	 * @param[in] len - number of bytes in `buf`
+	 */
+	void add(const Direction dir, const uint8_t * buf, size_t len) {
+		const uint64_t time = monotonicMicros();
+		while (len > 0) {
+			const uint64_t n = this->next.fetch_add(1, std::memory_order_relaxed);
+			const size_t size = PCF_MIN(len, size_t(TRACE_RECORD_DATA));
+			Record & rec = this->records[n % TRACE_RING_SIZE];
+			rec.stamp.store(0, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			rec.time = time;
+			rec.dir = uint8_t(dir);
+			rec.size = uint8_t(size);
+			memcpy(rec.data, buf, size);
+			rec.stamp.store(n + 1, std::memory_order_release);
+			buf += size;
+			len -= size;
+		}
+	}
+
+	/**
+	 * Writes all records in chronological order to the given file.
+	 * The output starts with the 8 byte magic `VKVMTRC1`. Each record consists
+	 * of the 64-bit little-endian timestamp in microseconds, the direction
+	 * (0 = in, 1 = out), the data length and the raw data.
+	 *
+	 * @param[in,out] fp - output file
+	 * @return true on success, else false
+	 */
+	bool dump(FILE * fp) const {
+		static const char magic[8] = {'V', 'K', 'V', 'M', 'T', 'R', 'C', '1'};
+		if (fwrite(magic, sizeof(magic), 1, fp) != 1) return false;
+		const uint64_t end = this->next.load(std::memory_order_acquire);
+		const uint64_t begin = (end > TRACE_RING_SIZE) ? end - TRACE_RING_SIZE : 0;
+		uint8_t out[8 + 2 + TRACE_RECORD_DATA];
+		for (uint64_t n = begin; n < end; n++) {
+			const Record & rec = this->records[n % TRACE_RING_SIZE];
+			if (rec.stamp.load(std::memory_order_acquire) != (n + 1)) continue; /* overwritten or being written */
+			for (size_t i = 0; i < 8; i++) out[i] = uint8_t(rec.time >> (8 * i));
+			out[8] = rec.dir;
+			out[9] = PCF_MIN(rec.size, uint8_t(TRACE_RECORD_DATA));
+			memcpy(out + 10, rec.data, out[9]);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (rec.stamp.load(std::memory_order_relaxed) != (n + 1)) continue; /* overwritten while copying */
+			if (fwrite(out, size_t(10 + out[9]), 1, fp) != 1) return false;
+		}
+		return true;
+	}
+};
+
+
 /**
  * Object with the shared `VkvmDevice` arguments.
  */
@@ -424,28 +825,37 @@ struct SerialCommon {
 	std::mutex disconnectMutex; /**< Guard to avoid parallel disconnect operations. */
 	std::mutex openCloseMutex; /**< Guard to avoid serial device open/close operations. */
 	std::mutex queueMutex; /**< Guard to sequentialize request queuing. */
-	std::mutex readMutex; /**< Locked until serial read thread termination. */
+	std::mutex readMutex; /**< Locked until serial read thread termination or while attached to the shared reactor. */
 	std::mutex writeMutex; /**< Locked until serial write thread termination. */
 	std::thread disconnectThread; /**< Thread for asynchronous serial device disconnect operations. */
-	std::condition_variable writable; /**< To wake up the serial write thread. */
+	std::condition_variable writable; /**< To wake up the serial write thread. Use `serialWakeWriter()`. */
 	VkvmDevice * volatile device; /**< Reference to the owning `VkvmDevice` instance. */
 	Framing<VKVM_MAX_FRAME_SIZE> * volatile framing; /**< Serial device framing handler. This is used for input and output operations. */
-	uint8_t buffer[SEND_BUFFER_SIZE]; /**< Serial send buffer. */
-	size_t bufferSize; /**< Current data size within the serial send buffer. */
+	PayloadBuffer payload; /**< Unquoted payload of the request frame being sent. */
+	uint8_t buffer[Framing<VKVM_MAX_FRAME_SIZE>::maxEncodedSize(SEND_PAYLOAD_SIZE)]; /**< Serial send buffer for a single encoded frame. */
 	RequestQueueItem * reqFifoFirst; /**< Pointer to the first element of the request queue. */
 	RequestQueueItem * reqFifoLast; /**< Pointer to the last element of the request queue. */
+	RequestQueueItem * reqFifoNext; /**< Pointer to the first element of the request queue which has not been sent yet. */
 	size_t reqFifoSize; /**< Number of pending requests in the queue. */
+	RequestQueueItemPool reqPool; /**< Preallocated storage for the request queue items. */
+	size_t reqInFlight; /**< Number of frames sent for which the result has not yet been received. These are the first ones in the queue. */
+	size_t reqWindow; /**< Maximum number of frames sent without waiting for their results (sliding window size). */
+	size_t bytesInFlight; /**< Number of bytes sent for the frames whose result has not yet been received. */
+	size_t lastFrameSize; /**< Number of bytes written for the most recently sent frame. */
+	volatile bool batchSupport; /**< Set if the VKVM periphery supports `RequestType::SET_BATCH`. */
 	uint8_t reqNumber; /**< Next request frame sequence number. Note that zero is reserved for interrupts messages. */
-	volatile bool reqPending; /**< True if there is an outstanding request for which the result has not yet been received. */
 	size_t tickDuration; /**< Interval in milliseconds at which the read thread checks related events (e.g. disconnect request). */
 	size_t timeout; /**< Serial device open/write/request response timeout in milliseconds. */
 	volatile unsigned long lastSent; /**< Timestampt (derived from millis()) at which the last request has been set. */
+	volatile unsigned long lastReceived; /**< Timestamp (derived from millis()) at which the last request result has been received. */
 	VkvmCallback * volatile callback; /**< Reference to a callback handler used for device changes, unsolicited responses and request responses. */
 	tSerial * volatile serial; /**< Low level serial device handler. */
 	volatile bool connected; /**< Set if there is an open serial connection to the VKVM periphery. */
 	volatile bool terminate; /**< Set if the serial connection to the VKVM periphery has been terminated. Checked by the read/write threads. */
 	uint8_t lastUsbState; /**< Most recently received USB periphery state. */
 	uint8_t lastLEDs; /**< Most recently received keyboard status LED bits. */
+	SerialStatistics stats; /**< Connection statistics. */
+	TraceRing trace; /**< Binary protocol trace of the serial data. */
 	/**< Possible hook procedure states. */
 	enum HookProcState {
 		HPS_START, /**< The keyboard/mouse hook has been installed. */
@@ -474,6 +884,17 @@ struct SerialCommon {
 	HHOOK mouseHook; /**< Handle of the mouse hook. */
 #elif defined(PCF_IS_LINUX)
 	int hookTermFd; /**< File descriptor to transmit termination request events. */
+	/**< Possible shared reactor attachment states. */
+	enum ReactorState {
+		RS_DETACHED, /**< Not served by the shared reactor. */
+		RS_PENDING, /**< Waiting to be attached by the shared reactor thread. */
+		RS_ATTACHED /**< Served by the shared reactor thread. */
+	};
+	VkvmReactor * reactor; /**< Shared reactor serving this connection or NULL if served by the read/write threads. */
+	ReactorState reactorState; /**< Current shared reactor attachment state. Guarded by the reactor. */
+	size_t outPos; /**< Number of bytes of the encoded frame in `buffer` already written by the shared reactor. */
+	size_t outSize; /**< Size of the encoded frame in `buffer` to be written by the shared reactor. Zero if none is pending. */
+	bool outWait; /**< Set while the shared reactor waits for the serial device to become writable. */
 #endif /* PCF_IS_LINUX */
 };
 
@@ -522,19 +943,18 @@ struct RequestQueueItemT : public RequestQueueItem {
 	typedef tuple<Args...> Params;
 
 	const Callback callback; /**< Handle to the associated callback function. */
-	const Params params; /**< Request parameters. */
+	Params params; /**< Request parameters. These may change by merging until the request has been sent. */
 	Result result; /**< Result value (if any). */
 
 	/**
 	 * Constructor.
 	 *
-	 * @param[in] s - frame sequence number to use
 	 * @param[in] t - request type
 	 * @param[in] cb - function to call on completion (success and error)
 	 * @param[in] p - request parameters
 	 */
-	explicit inline RequestQueueItemT(const uint8_t s, const RequestType::Type t, const Callback cb, Args... p):
-		RequestQueueItem(s, t),
+	explicit inline RequestQueueItemT(const RequestType::Type t, const Callback cb, Args... p):
+		RequestQueueItem(t),
 		callback(cb),
 		params(forward<Args>(p)...)
 	{}
@@ -552,13 +972,47 @@ struct RequestQueueItemT : public RequestQueueItem {
 	 */
 	virtual bool send(SerialCommon & args) const override {
 		if (args.framing == NULL || args.terminate) return false;
-		/* first set sent time and then pending state to ensure timeout checks work properly */
 		args.lastSent = millis();
-		args.reqPending = true;
-		if ( ! args.framing->beginTransmission(this->seq) ) return false;
-		if ( ! args.framing->write(uint8_t(this->type)) ) return false;
-		if ( ! this->sendParams(args, typename make_index_sequence<sizeof...(Args)>::type()) ) return false;
-		if ( ! args.framing->endTransmission() ) return false;
+		args.payload.clear();
+		if ( ! this->sendPayload(args) ) return false;
+		return serialSendFrame(args, this->seq);
+	}
+
+	/**
+	 * Serialize the request type and its parameters within the current frame.
+	 *
+	 * @param[in,out] args - shared `VkvmDevice` arguments
+	 * @return true on success, else false
+	 */
+	virtual bool sendPayload(SerialCommon & args) const override {
+		if ( ! args.payload.write(uint8_t(this->type)) ) return false;
+		return this->sendParams(args, typename make_index_sequence<sizeof...(Args)>::type());
+	}
+
+	/**
+	 * Returns the serialized size of the request type and its parameters.
+	 *
+	 * @return payload size in bytes
+	 */
+	virtual size_t getPayloadSize() const override {
+		return 1 + this->paramsSize(typename make_index_sequence<sizeof...(Args)>::type());
+	}
+
+	/**
+	 * Merges the parameters of a subsequent request of the same type into
+	 * this request. Absolute coordinates are replaced by the newer ones.
+	 * Relative values are summed up as long as the result stays within +/- 127.
+	 * Nothing is changed if any of the parameters cannot be merged.
+	 *
+	 * @param[in] cb - callback function of the subsequent request
+	 * @param[in] p - parameters of the subsequent request
+	 * @return true on success, else false
+	 */
+	inline bool merge(const Callback cb, const Args & ...p) {
+		if (cb != this->callback) return false;
+		Params merged(this->params);
+		if ( ! this->mergeParamsAt<0>(merged, p...) ) return false;
+		this->params = merged;
 		return true;
 	}
 
@@ -736,7 +1190,7 @@ private:
 	 */
 	template <typename T>
 	inline bool sendParam(SerialCommon & args, const T param) const {
-		return args.framing->write(param);
+		return args.payload.write(param);
 	}
 
 	/**
@@ -749,7 +1203,7 @@ private:
 	 * @return true on success, else false
 	 */
 	inline bool sendParam(SerialCommon & args, const ByteBuffer & param) const {
-		return args.framing->write(static_cast<const uint8_t *>(param.getPointer()), size_t(param.getSize()));
+		return args.payload.write(static_cast<const uint8_t *>(param.getPointer()), size_t(param.getSize()));
 	}
 
 	/**
@@ -762,7 +1216,7 @@ private:
 	 * @return true on success, else false
 	 */
 	inline bool sendParam(SerialCommon & args, const AbsCoord & param) const {
-		return args.framing->write(param.getRaw());
+		return args.payload.write(param.getRaw());
 	}
 
 	/**
@@ -807,56 +1261,241 @@ private:
 	inline bool sendParams(SerialCommon & args, const index_sequence<i...>) const {
 		return this->sendParamsUnpacked(args, get<i>(this->params)...);
 	}
-};
 
+	/**
+	 * Returns the serialized size of a single request parameter.
+	 *
+	 * @param[in] param - request parameter
+	 * @return size in bytes
+	 * @tparam T - request parameter type
+	 */
+	template <typename T>
+	static inline size_t paramSize(const T &) {
+		return sizeof(T);
+	}
 
-/**
- * Queues a request which shall be sent to the connected VKVM periphery.
- * The request consists of the request type, a callback method called upon reception of
- * the result from the periphery and the arguments according to the request type.
- *
- * @param[in] args - object with the shared `VkvmDevice` arguments
- * @param[in] type - VKVM protocol specific request type
- * @param[in] callback - `VkvmCallback` method which receives the request result
- * @param[in] params - request specific parameters
- * @return true on success, else false
- * @see vkm-periphery/Protocol.hpp
- */
-template <typename R, typename ...Args>
-bool serialQueueCommand(SerialCommon & args, const RequestType::Type type, typename RequestQueueItemT<R, Args...>::Callback callback, Args... params) {
-	if (args.device == NULL || args.terminate) return false;
-	std::unique_lock<std::mutex> guard(args.queueMutex);
-	if (args.reqFifoSize >= REQUEST_FIFO_LIMIT) return false;
-	if (args.reqNumber == 0) args.reqNumber++; /* zero is reserved for interrupts messages */
-	const uint8_t seq = args.reqNumber++;
-	RequestQueueItem * item = new RequestQueueItemT<R, Args...>(seq, type, callback, params...);
-	if (args.reqFifoFirst == NULL) {
-		args.reqFifoFirst = item;
-	} else {
-		args.reqFifoLast->next = item;
+	/**
+	 * Returns the serialized size of a single request parameter.
+	 * This is the specialization for the `ByteBuffer` type.
+	 *
+	 * @param[in] param - request parameter
+	 * @return size in bytes
+	 */
+	static inline size_t paramSize(const ByteBuffer & param) {
+		return size_t(param.getSize());
 	}
-	args.reqFifoLast = item;
-	args.reqFifoSize++;
-	guard.unlock();
-	args.writable.notify_one();
-	return true;
-}
 
+	/**
+	 * Returns the serialized size of a single request parameter.
+	 * This is the specialization for the `AbsCoord` type.
+	 *
+	 * @param[in] param - request parameter
+	 * @return size in bytes
+	 */
+	static inline size_t paramSize(const AbsCoord & param) {
+		return sizeof(param.getRaw());
+	}
 
-/**
- * Performs an asynchronous disconnect of the serial connected VKVM periphery.
- *
- * @param[in] args - object with the shared `VkvmDevice` arguments
- * @param[in] reason - disconnect reason forwarded to the registered callback
- */
-static void serialDisconnect(SerialCommon & args, VkvmCallback::DisconnectReason reason) {
-	vkvmTrace(3, "disconnect\t%i\n", int(reason));
-	if ( ! args.disconnectMutex.try_lock() ) return; /* only one instance shall call disconnect */
-	vkvmTrace(3, "disconnect forwarded\t%i\n", int(reason));
-	if ( args.disconnectThread.joinable() ) args.disconnectThread.join();
-	args.disconnectThread = std::thread([&, reason] () mutable {
-		try {
-			VkvmCallback * cb = NULL;
+	/**
+	 * Returns the serialized size of all request parameters.
+	 * Final case.
+	 *
+	 * @return size in bytes
+	 */
+	static inline size_t paramsSizeUnpacked() {
+		return 0;
+	}
+
+	/**
+	 * Returns the serialized size of all request parameters.
+	 *
+	 * @param[in] p0 - current parameter
+	 * @param[in] rest - remaining parameters
+	 * @return size in bytes
+	 * @tparam T0 - current parameter type
+	 * @tparam Rest - remaining parameter types
+	 */
+	template <typename T0, typename ...Rest>
+	static inline size_t paramsSizeUnpacked(const T0 & p0, const Rest & ...rest) {
+		return paramSize(p0) + paramsSizeUnpacked(rest...);
+	}
+
+	/**
+	 * Returns the serialized size of all request parameters.
+	 *
+	 * @param[in] seq - type only index sequence of the tuple parameter values
+	 * @return size in bytes
+	 * @tparam i - tuple indices
+	 */
+	template <size_t ...i>
+	inline size_t paramsSize(const index_sequence<i...>) const {
+		return paramsSizeUnpacked(get<i>(this->params)...);
+	}
+
+	/**
+	 * Merges a single request parameter. Parameters of unknown type cannot
+	 * be merged.
+	 *
+	 * @param[in,out] a - stored parameter
+	 * @param[in] b - parameter to merge
+	 * @return true on success, else false
+	 * @tparam T - request parameter type
+	 */
+	template <typename T>
+	static inline bool mergeParam(T & a, const T & b) {
+		return false;
+	}
+
+	/**
+	 * Merges a single request parameter.
+	 * This is the specialization for relative values which are summed up.
+	 *
+	 * @param[in,out] a - stored parameter
+	 * @param[in] b - parameter to merge
+	 * @return true on success, else false
+	 */
+	static inline bool mergeParam(int8_t & a, const int8_t & b) {
+		const int sum = int(a) + int(b);
+		if (sum < -127 || sum > 127) return false;
+		a = int8_t(sum);
+		return true;
+	}
+
+	/**
+	 * Merges a single request parameter.
+	 * This is the specialization for the `AbsCoord` type which is replaced.
+	 *
+	 * @param[in,out] a - stored parameter
+	 * @param[in] b - parameter to merge
+	 * @return true on success, else false
+	 */
+	static inline bool mergeParam(AbsCoord & a, const AbsCoord & b) {
+		a = b;
+		return true;
+	}
+
+	/**
+	 * Merges all given request parameters into the passed tuple.
+	 * Final case.
+	 *
+	 * @param[in,out] out - request parameters to merge into
+	 * @return true on success, else false
+	 * @tparam i - tuple index of the next parameter
+	 */
+	template <size_t i>
+	static inline bool mergeParamsAt(Params & out) {
+		return true;
+	}
+
+	/**
+	 * Merges all given request parameters into the passed tuple.
+	 *
+	 * @param[in,out] out - request parameters to merge into
+	 * @param[in] p0 - current parameter to merge
+	 * @param[in] rest - remaining parameters to merge
+	 * @return true on success, else false
+	 * @tparam i - tuple index of the current parameter
+	 * @tparam T0 - current parameter type
+	 * @tparam Rest - remaining parameter types
+	 */
+	template <size_t i, typename T0, typename ...Rest>
+	static inline bool mergeParamsAt(Params & out, const T0 & p0, const Rest & ...rest) {
+		if ( ! mergeParam(get<i>(out), p0) ) return false;
+		return mergeParamsAt<i + 1>(out, rest...);
+	}
+};
+
+
+static void serialWakeWriter(SerialCommon & args);
+
+
+/**
+ * Checks whether consecutive requests of the given type may be merged into one.
+ *
+ * @param[in] type - request type to check
+ * @return true if mergeable, else false
+ */
+static inline bool serialIsMergeable(const RequestType::Type type) {
+	switch (type) {
+	case RequestType::SET_MOUSE_MOVE_ABS:
+	case RequestType::SET_MOUSE_MOVE_REL:
+	case RequestType::SET_MOUSE_SCROLL:
+		return true;
+	default:
+		return false;
+	}
+}
+
+
+/**
+ * Queues a request which shall be sent to the connected VKVM periphery.
+ * The request consists of the request type, a callback method called upon reception of
+ * the result from the periphery and the arguments according to the request type.
+ * Mouse movement and scroll requests are merged into the last queued request if that
+ * one has the same type and was not sent yet. Only a single callback is reported for
+ * merged requests. New requests are constructed within a preallocated slot outside of
+ * the critical section.
+ *
+ * @param[in] args - object with the shared `VkvmDevice` arguments
+ * @param[in] type - VKVM protocol specific request type
+ * @param[in] callback - `VkvmCallback` method which receives the request result
+ * @param[in] params - request specific parameters
+ * @return true on success, else false
+ * @see vkm-periphery/Protocol.hpp
+ */
+template <typename R, typename ...Args>
+bool serialQueueCommand(SerialCommon & args, const RequestType::Type type, typename RequestQueueItemT<R, Args...>::Callback callback, Args... params) {
+	if (args.device == NULL || args.terminate) return false;
+	if ( serialIsMergeable(type) ) {
+		std::lock_guard<std::mutex> guard(args.queueMutex);
+		if (args.reqFifoNext != NULL && args.reqFifoLast->type == type) {
+			/* the last request has not been sent yet; each request type uses always the same parameter types */
+			if ( static_cast<RequestQueueItemT<R, Args...> *>(args.reqFifoLast)->merge(callback, params...) ) {
+				SerialStatistics::add(args.stats.merged);
+				return true;
+			}
+		}
+	}
+	/* the pool capacity limits the number of queued requests to REQUEST_FIFO_LIMIT */
+	RequestQueueItem * item = args.reqPool.create< RequestQueueItemT<R, Args...> >(type, callback, params...);
+	if (item == NULL) {
+		SerialStatistics::add(args.stats.rejected);
+		return false;
+	}
+	std::unique_lock<std::mutex> guard(args.queueMutex);
+	if (args.reqNumber == 0) args.reqNumber++; /* zero is reserved for interrupts messages */
+	item->seq = args.reqNumber++;
+	if (args.reqFifoFirst == NULL) {
+		args.reqFifoFirst = item;
+	} else {
+		args.reqFifoLast->next = item;
+	}
+	args.reqFifoLast = item;
+	if (args.reqFifoNext == NULL) args.reqFifoNext = item;
+	args.reqFifoSize++;
+	const size_t depth = args.reqFifoSize;
+	guard.unlock();
+	SerialStatistics::add(args.stats.requests);
+	args.stats.addQueueDepth(depth);
+	serialWakeWriter(args);
+	return true;
+}
+
+
+/**
+ * Performs an asynchronous disconnect of the serial connected VKVM periphery.
+ *
+ * @param[in] args - object with the shared `VkvmDevice` arguments
+ * @param[in] reason - disconnect reason forwarded to the registered callback
+ */
+static void serialDisconnect(SerialCommon & args, VkvmCallback::DisconnectReason reason) {
+	vkvmTrace(3, "disconnect\t%i\n", int(reason));
+	if ( ! args.disconnectMutex.try_lock() ) return; /* only one instance shall call disconnect */
+	vkvmTrace(3, "disconnect forwarded\t%i\n", int(reason));
+	if ( args.disconnectThread.joinable() ) args.disconnectThread.join();
+	args.disconnectThread = std::thread([&, reason] () mutable {
+		try {
+			VkvmCallback * cb = NULL;
 			std::lock_guard<std::mutex> dcGuard(args.disconnectMutex, std::adopt_lock);
 			if ( ! args.openCloseMutex.try_lock() ) {
 				{
@@ -868,7 +1507,7 @@ static void serialDisconnect(SerialCommon & args, VkvmCallback::DisconnectReason
 						 * which would deadlock against the acquire. Signal the started read/write
 						 * thread to terminate and let it or the next close() perform the teardown. */
 						args.terminate = true;
-						args.writable.notify_one();
+						serialWakeWriter(args);
 						return;
 					}
 					if (args.connected && args.callback != NULL) {
@@ -886,7 +1525,7 @@ static void serialDisconnect(SerialCommon & args, VkvmCallback::DisconnectReason
 				std::lock_guard<std::mutex> queueGuard(args.queueMutex);
 				args.terminate = true; /* signal remaining read/write threads to terminate */
 			}
-			args.writable.notify_one();
+			serialWakeWriter(args);
 			std::lock_guard<std::mutex> readGuard(args.readMutex); /* wait for read thread to terminate */
 			std::lock_guard<std::mutex> writeGuard(args.writeMutex); /* wait for write thread to terminate */
 			cb = args.callback;
@@ -898,7 +1537,8 @@ static void serialDisconnect(SerialCommon & args, VkvmCallback::DisconnectReason
 			args.serial = NULL;
 			args.connected = false;
 			args.terminate = false;
-			args.reqPending = false;
+			args.reqFifoNext = args.reqFifoFirst;
+			args.reqInFlight = 0;
 			vkvmTrace(3, "closed2\t0x%p\n", static_cast<const void *>(args.serial));
 			if (cb != NULL) cb->onVkvmDisconnected(reason);
 		} catch (...) {}
@@ -907,118 +1547,213 @@ static void serialDisconnect(SerialCommon & args, VkvmCallback::DisconnectReason
 
 
 /**
- * Writes data to the serial connected VKVM periphery. This function is being
- * used as callback for the `Framing` class. Data is first written to an internal
- * buffer and actually send to the periphery at each complete frame or when
- * reaching the end of the internal buffer size.
+ * Encodes the current request payload as a single frame and writes it to the
+ * serial connected VKVM periphery.
  *
- * @param[in] argsPtr - object with the shared `VkvmDevice` arguments
- * @param[in] val - single byte value to write
- * @param[in] eof - true to force data transmission (end of frame), else false
+ * @param[in,out] args - object with the shared `VkvmDevice` arguments
+ * @param[in] seq - frame sequence number
  * @return true on success, else false
  */
-static bool serialWrite(void * argsPtr, const uint8_t val, const bool eof) {
-	if (argsPtr == NULL) return false;
-	SerialCommon * args = static_cast<SerialCommon *>(argsPtr);
-	if (args->serial == NULL || args->terminate) return false;
-	args->buffer[args->bufferSize++] = val;
-	if (!eof && args->bufferSize < SEND_BUFFER_SIZE) return true;
+static bool serialSendFrame(SerialCommon & args, const uint8_t seq) {
+	if (args.serial == NULL || args.terminate) return false;
+	const size_t size = args.framing->encode(args.buffer, sizeof(args.buffer), seq, args.payload.data, args.payload.size);
+	if (size == 0) return false;
 #ifdef VKVM_TRACE
 	vkvmTrace(1, "out\t");
-	for (size_t i = 0; i < args->bufferSize; i++) {
+	for (size_t i = 0; i < size; i++) {
 		if (i != 0) vkvmTrace(0, " ");
-		vkvmTrace(0, "%02X", unsigned(args->buffer[i] & 0xFF));
+		vkvmTrace(0, "%02X", unsigned(args.buffer[i] & 0xFF));
 	}
 	vkvmTrace(2, "\n");
 #endif /* VKVM_TRACE */
-	const ssize_t res = ser_write(args->serial, args->buffer, args->bufferSize, args->timeout);
-	const bool success = (res == ssize_t(args->bufferSize));
-	args->bufferSize = 0;
-	return success;
+#ifdef PCF_IS_LINUX
+	if (args.reactor != NULL) {
+		/* written without blocking by the shared reactor (see `VkvmReactor::flush()`) */
+		args.outPos = 0;
+		args.outSize = size;
+		args.lastFrameSize = size;
+		return true;
+	}
+#endif /* PCF_IS_LINUX */
+	const ssize_t res = ser_write(args.serial, args.buffer, size, args.timeout);
+	args.lastFrameSize = (res > 0) ? size_t(res) : 0;
+	if (res > 0) {
+		SerialStatistics::add(args.stats.bytesSent, uint64_t(res));
+		args.trace.add(TraceRing::DIR_OUT, args.buffer, size_t(res));
+	}
+	return res == ssize_t(size);
 }
 
 
 /**
- * Read handler for data from the serial connected VKVM periphery. This function
- * is being used as callback for the `Framing` class. It handles outstanding request
- * responses and unsolicited responses.
+ * Checks whether the given request type may be sent as sub-command of a
+ * `RequestType::SET_BATCH` request.
  *
- * @param[in] args - object with the shared `VkvmDevice` arguments
- * @param[in] seq - frame sequence number
- * @param[in] buf - payload data buffer
- * @param[in] len - payload data length
- * @param[in] err - true if an error occurred parsing the frame, else false
+ * @param[in] type - request type to check
+ * @return true if batchable, else false
  */
-static void serialReadHandler(SerialCommon & args, const uint8_t seq, uint8_t * buf, const size_t len, const bool err) {
-	if (args.device == NULL || args.framing == NULL || args.callback == NULL || args.serial == NULL || args.terminate || buf == NULL) {
-		return;
+static inline bool serialIsBatchable(const RequestType::Type type) {
+	return type >= RequestType::SET_KEYBOARD_DOWN && type < RequestType::SET_BATCH;
+}
+
+
+/**
+ * Estimates the time needed by the VKVM periphery to process the given request.
+ * The periphery sends one USB report at a time and waits for the host to poll it
+ * before sending the next one. Hence, the time is derived from the number of
+ * reports and the poll interval of the affected endpoint.
+ *
+ * @param[in] item - request to estimate
+ * @return estimated processing time in milliseconds
+ */
+static size_t serialEstimateRunTime(const RequestQueueItem & item) {
+	/* the payload starts with the request type byte */
+	const size_t fields = item.getPayloadSize() - 1;
+	switch (item.type) {
+	case RequestType::SET_KEYBOARD_DOWN:
+	case RequestType::SET_KEYBOARD_UP:
+		return PCF_MAX(fields, size_t(1)) * KEYBOARD_REPORT_INTERVAL;
+	case RequestType::SET_KEYBOARD_ALL_UP:
+		return KEYBOARD_REPORT_INTERVAL;
+	case RequestType::SET_KEYBOARD_PUSH:
+		return 2 * fields * KEYBOARD_REPORT_INTERVAL;
+	case RequestType::SET_KEYBOARD_WRITE:
+		/* the first field holds the modifiers */
+		return (2 * (fields - 1) + KEYBOARD_WRITE_OVERHEAD) * KEYBOARD_REPORT_INTERVAL;
+	case RequestType::SET_MOUSE_BUTTON_DOWN:
+	case RequestType::SET_MOUSE_BUTTON_UP:
+		return PCF_MAX(fields, size_t(1)) * MOUSE_REPORT_INTERVAL;
+	case RequestType::SET_MOUSE_BUTTON_PUSH:
+		return 2 * fields * MOUSE_REPORT_INTERVAL;
+	case RequestType::SET_MOUSE_BUTTON_ALL_UP:
+	case RequestType::SET_MOUSE_MOVE_ABS:
+	case RequestType::SET_MOUSE_MOVE_REL:
+	case RequestType::SET_MOUSE_SCROLL:
+		return MOUSE_REPORT_INTERVAL;
+	default:
+		return 0;
 	}
-	if (len < 1 || err) {
-		args.callback->onVkvmBrokenFrame();
-		return;
+}
+
+
+/**
+ * Sends the given request and the following `batchSize - 1` requests within
+ * a single `RequestType::SET_BATCH` frame.
+ *
+ * @param[in,out] args - object with the shared `VkvmDevice` arguments
+ * @param[in] first - first request of the batch
+ * @return true on success, else false
+ */
+static bool serialSendBatch(SerialCommon & args, const RequestQueueItem * first) {
+	if (args.framing == NULL || args.terminate) return false;
+	args.lastSent = millis();
+	args.payload.clear();
+	if ( ! args.payload.write(uint8_t(RequestType::SET_BATCH)) ) return false;
+	const RequestQueueItem * item = first;
+	for (uint8_t n = 0; n < first->batchSize && item != NULL; n++, item = item->next) {
+		if ( ! args.payload.write(uint8_t(item->getPayloadSize())) ) return false;
+		if ( ! item->sendPayload(args) ) return false;
 	}
+	return serialSendFrame(args, first->seq);
+}
+
+
+/**
+ * Returns the time elapsed since the VKVM periphery started processing the
+ * oldest outstanding frame. The periphery processes the frames one after
+ * another. Hence, this is measured from the later one of its send time and the
+ * time the previous result has been received. The caller needs to hold
+ * `queueMutex` and ensure that a request is outstanding.
+ *
+ * @param[in] args - object with the shared `VkvmDevice` arguments
+ * @param[in] now - current timestamp (derived from millis())
+ * @return elapsed time in milliseconds
+ */
+static inline size_t serialRequestElapsed(const SerialCommon & args, const unsigned long now) {
+	return PCF_MIN(size_t(now - args.reqFifoFirst->sentAt), size_t(now - args.lastReceived));
+}
+
+
+/**
+ * Checks whether the oldest outstanding request has not been answered within
+ * the configured timeout.
+ *
+ * @param[in] args - object with the shared `VkvmDevice` arguments
+ * @param[in] now - current timestamp (derived from millis())
+ * @return true on timeout, else false
+ */
+static bool serialRequestTimedOut(SerialCommon & args, const unsigned long now) {
+	std::lock_guard<std::mutex> guard(args.queueMutex);
+	if (args.reqInFlight == 0 || args.reqFifoFirst == NULL) return false;
+	return serialRequestElapsed(args, now) >= args.timeout;
+}
+
+
+/**
+ * Checks whether the next queued request may be sent to the VKVM periphery.
+ * Only a single request is outstanding until the protocol version has been
+ * verified. The periphery reads the next frame only after the previous one has
+ * been processed. Hence, the outstanding frames need to fit into its serial
+ * receive buffer. The caller needs to hold `queueMutex`.
+ *
+ * @param[in] args - object with the shared `VkvmDevice` arguments
+ * @return true if the sliding window allows to send the next request, else false
+ */
+static inline bool serialCanSend(const SerialCommon & args) {
+	if (args.reqFifoNext == NULL) return false;
+	if (args.reqInFlight == 0) return true;
+	if (args.reqInFlight >= (args.connected ? args.reqWindow : 1)) return false;
+	const size_t nextSize = Framing<VKVM_MAX_FRAME_SIZE>::maxEncodedSize(args.reqFifoNext->getPayloadSize());
+	return (args.bytesInFlight + nextSize) <= PERIPHERY_RX_BUFFER_SIZE;
+}
+
+
+/**
+ * Removes the first request from the queue. This needs to be an outstanding
+ * request. The outstanding frame count is only reduced for the first request
+ * of a frame.
+ *
+ * @param[in] args - object with the shared `VkvmDevice` arguments
+ */
+static void serialPopRequest(SerialCommon & args) {
+	std::unique_lock<std::mutex> guard(args.queueMutex);
 	RequestQueueItem * item = args.reqFifoFirst;
-	if (item != NULL && size_t(millis() - args.lastSent) >= args.timeout) {
-		vkvmTrace(3, "timeout1\t%lu\n", args.lastSent);
-		serialDisconnect(args, VkvmCallback::DisconnectReason::D_TIMEOUT);
-		return;
-	}
-	VkvmCallback::PeripheryResult res = VkvmCallback::PeripheryResult::COUNT;
-	switch (buf[0]) {
-	case ResponseType::S_OK:
-		res = VkvmCallback::PeripheryResult::PR_OK;
-		break;
-	case ResponseType::E_BROKEN_FRAME:
-		res = VkvmCallback::PeripheryResult::PR_BROKEN_FRAME;
-		break;
-	case ResponseType::E_UNSUPPORTED_REQ_TYPE:
-		res = VkvmCallback::PeripheryResult::PR_UNSUPPORTED_REQ_TYPE;
-		break;
-	case ResponseType::E_INVALID_REQ_TYPE:
-		res = VkvmCallback::PeripheryResult::PR_INVALID_REQ_TYPE;
-		break;
-	case ResponseType::E_INVALID_FIELD_VALUE:
-		res = VkvmCallback::PeripheryResult::PR_INVALID_FIELD_VALUE;
-		break;
-	case ResponseType::E_HOST_WRITE_ERROR:
-		res = VkvmCallback::PeripheryResult::PR_HOST_WRITE_ERROR;
-		break;
-	case ResponseType::I_USB_STATE_UPDATE:
-		if (len == 2) {
-			args.lastUsbState = buf[1];
-			args.callback->onVkvmUsbState(VkvmCallback::PeripheryResult::PR_OK, buf[1]);
-			return;
-		}
-		args.callback->onVkvmBrokenFrame();
-		return;
-	case ResponseType::I_LED_UPDATE:
-		if (len == 2) {
-			args.lastLEDs = buf[1];
-			args.callback->onVkvmKeyboardLeds(VkvmCallback::PeripheryResult::PR_OK, buf[1]);
-			return;
-		}
-		args.callback->onVkvmBrokenFrame();
-		return;
-	case ResponseType::D_MESSAGE:
-		return;
-	default:
-		args.callback->onVkvmBrokenFrame();
-		return;
-	}
-	if (item == NULL || item->seq != seq) {
-		/* A response was received without any pending request. */
-		vkvmTrace(3, "invalid\t%u\n", unsigned(seq));
-		return;
+	if (item == NULL) return;
+	args.reqFifoFirst = item->next;
+	if (args.reqFifoFirst == NULL) args.reqFifoLast = NULL;
+	if (args.reqFifoNext == item) args.reqFifoNext = item->next;
+	args.reqFifoSize--;
+	if (item->batchSize > 0 && args.reqInFlight > 0) {
+		args.reqInFlight--;
+		args.bytesInFlight -= PCF_MIN(args.bytesInFlight, size_t(item->frameSize));
 	}
+	guard.unlock();
+	serialWakeWriter(args);
+	args.reqPool.destroy(item);
+}
+
+
+/**
+ * Processes the result of the given request and reports it to the registered
+ * callback.
+ *
+ * @param[in] args - object with the shared `VkvmDevice` arguments
+ * @param[in] item - request to complete
+ * @param[in] res - request result code
+ * @param[in] buf - response fields (without the response type)
+ * @param[in] len - length of the response fields
+ */
+static void serialCompleteRequest(SerialCommon & args, RequestQueueItem * item, const VkvmCallback::PeripheryResult res, const uint8_t * buf, const size_t len) {
+	if (res < VkvmCallback::PeripheryResult::COUNT) SerialStatistics::add(args.stats.results[size_t(res)]);
 	switch (item->type) {
 	case RequestType::GET_USB_STATE:
-		if (res == VkvmCallback::PeripheryResult::PR_OK && len >= 2) {
-			args.lastUsbState = buf[1];
+		if (res == VkvmCallback::PeripheryResult::PR_OK && len >= 1) {
+			args.lastUsbState = buf[0];
 		}
 		break;
 	case RequestType::GET_KEYBOARD_LEDS:
-		if (res == VkvmCallback::PeripheryResult::PR_OK && len >= 2) {
-			args.lastLEDs = buf[1];
+		if (res == VkvmCallback::PeripheryResult::PR_OK && len >= 1) {
+			args.lastLEDs = buf[0];
 		}
 		break;
 	default:
@@ -1026,13 +1761,14 @@ static void serialReadHandler(SerialCommon & args, const uint8_t seq, uint8_t *
 	}
 	switch (item->type) {
 	case RequestType::GET_PROTOCOL_VERSION:
-		if (res != VkvmCallback::PeripheryResult::PR_OK || len < 3) {
+		if (res != VkvmCallback::PeripheryResult::PR_OK || len < 2) {
 			serialDisconnect(args, VkvmCallback::DisconnectReason::D_INVALID_PROTOCOL);
 		} else {
-			const uint16_t major = uint16_t(uint16_t(buf[2]) | (uint16_t(buf[1]) << 8));
-			if (((major ^ VKVM_PROT_VERSION) & VKVM_PROT_MAJOR_MASK) != 0) {
+			const uint16_t version = uint16_t(uint16_t(buf[1]) | (uint16_t(buf[0]) << 8));
+			if (((version ^ VKVM_PROT_VERSION) & VKVM_PROT_MAJOR_MASK) != 0) {
 				serialDisconnect(args, VkvmCallback::DisconnectReason::D_INVALID_PROTOCOL);
 			} else {
+				args.batchSupport = (version >= BATCH_PROT_VERSION);
 				args.connected = true;
 				args.callback->onVkvmConnected();
 				/* cannot fail because the queue is still empty */
@@ -1058,29 +1794,267 @@ static void serialReadHandler(SerialCommon & args, const uint8_t seq, uint8_t *
 	case RequestType::SET_MOUSE_MOVE_ABS:
 	case RequestType::SET_MOUSE_MOVE_REL:
 	case RequestType::SET_MOUSE_SCROLL:
-		if ( item->setResult(buf + 1, (len >= 1) ? size_t(len - 1) : 0) ) {
+		if ( item->setResult(buf, len) ) {
 			item->report(args, res);
 		} else {
 			args.callback->onVkvmBrokenFrame();
 		}
-		break;
-	default:
+		break;
+	default:
+		args.callback->onVkvmBrokenFrame();
+		break;
+	}
+}
+
+
+/**
+ * Maps the given periphery response type to the corresponding request result.
+ *
+ * @param[in] type - periphery response type
+ * @return request result or `VkvmCallback::PeripheryResult::COUNT` if `type` is no request result
+ */
+static VkvmCallback::PeripheryResult serialPeripheryResult(const uint8_t type) {
+	switch (type) {
+	case ResponseType::S_OK: return VkvmCallback::PeripheryResult::PR_OK;
+	case ResponseType::E_BROKEN_FRAME: return VkvmCallback::PeripheryResult::PR_BROKEN_FRAME;
+	case ResponseType::E_UNSUPPORTED_REQ_TYPE: return VkvmCallback::PeripheryResult::PR_UNSUPPORTED_REQ_TYPE;
+	case ResponseType::E_INVALID_REQ_TYPE: return VkvmCallback::PeripheryResult::PR_INVALID_REQ_TYPE;
+	case ResponseType::E_INVALID_FIELD_VALUE: return VkvmCallback::PeripheryResult::PR_INVALID_FIELD_VALUE;
+	case ResponseType::E_HOST_WRITE_ERROR: return VkvmCallback::PeripheryResult::PR_HOST_WRITE_ERROR;
+	default: return VkvmCallback::PeripheryResult::COUNT;
+	}
+}
+
+
+/**
+ * Read handler for data from the serial connected VKVM periphery. This function
+ * is being used as callback for the `Framing` class. It handles outstanding request
+ * responses and unsolicited responses.
+ * The periphery processes the requests in order. Hence, outstanding requests sent
+ * before the one matching the received sequence number were lost and are reported
+ * as broken frame first. This keeps the callbacks in request order.
+ * The result of a batch frame is reported for each of its requests according to
+ * the returned bit map and the response types of the failed sub-commands.
+ *
+ * @param[in] args - object with the shared `VkvmDevice` arguments
+ * @param[in] seq - frame sequence number
+ * @param[in] buf - payload data buffer
+ * @param[in] len - payload data length
+ * @param[in] err - true if an error occurred parsing the frame, else false
+ */
+static void serialReadHandler(SerialCommon & args, const uint8_t seq, uint8_t * buf, const size_t len, const bool err) {
+	/* result fields passed for lost requests */
+	static const uint8_t noResult[sizeof(uint64_t)] = {0};
+	if (args.device == NULL || args.framing == NULL || args.callback == NULL || args.serial == NULL || args.terminate || buf == NULL) {
+		return;
+	}
+	const unsigned long receivedAtUs = micros();
+	if (len < 1 || err) {
+		SerialStatistics::add(args.stats.brokenFrames);
+		args.callback->onVkvmBrokenFrame();
+		return;
+	}
+	SerialStatistics::add(args.stats.framesReceived);
+	if ( serialRequestTimedOut(args, millis()) ) {
+		SerialStatistics::add(args.stats.timeouts);
+		vkvmTrace(3, "timeout1\t%lu\n", args.lastSent);
+		serialDisconnect(args, VkvmCallback::DisconnectReason::D_TIMEOUT);
+		return;
+	}
+	VkvmCallback::PeripheryResult res = serialPeripheryResult(buf[0]);
+	switch (buf[0]) {
+	case ResponseType::I_USB_STATE_UPDATE:
+		SerialStatistics::add(args.stats.interrupts);
+		if (len == 2) {
+			args.lastUsbState = buf[1];
+			args.callback->onVkvmUsbState(VkvmCallback::PeripheryResult::PR_OK, buf[1]);
+			return;
+		}
+		args.callback->onVkvmBrokenFrame();
+		return;
+	case ResponseType::I_LED_UPDATE:
+		SerialStatistics::add(args.stats.interrupts);
+		if (len == 2) {
+			args.lastLEDs = buf[1];
+			args.callback->onVkvmKeyboardLeds(VkvmCallback::PeripheryResult::PR_OK, buf[1]);
+			return;
+		}
+		args.callback->onVkvmBrokenFrame();
+		return;
+	case ResponseType::D_MESSAGE:
+		return;
+	default:
+		if (res == VkvmCallback::PeripheryResult::COUNT) {
+			args.callback->onVkvmBrokenFrame();
+			return;
+		}
+		break;
+	}
+	/* find the outstanding request with the received sequence number */
+	RequestQueueItem * item = NULL;
+	{
+		std::lock_guard<std::mutex> guard(args.queueMutex);
+		for (RequestQueueItem * it = args.reqFifoFirst; it != NULL && it != args.reqFifoNext; it = it->next) {
+			if (it->seq == seq && it->batchSize > 0) {
+				item = it;
+				break;
+			}
+		}
+	}
+	if (item == NULL) {
+		/* A response was received without any pending request. */
+		vkvmTrace(3, "invalid\t%u\n", unsigned(seq));
+		return;
+	}
+	args.lastReceived = millis();
+	/* only this thread removes requests from the queue */
+	while (args.reqFifoFirst != item) {
+		vkvmTrace(3, "lost\t%u\n", unsigned(args.reqFifoFirst->seq));
+		serialCompleteRequest(args, args.reqFifoFirst, VkvmCallback::PeripheryResult::PR_BROKEN_FRAME, noResult, sizeof(noResult));
+		serialPopRequest(args);
+	}
+	args.stats.addRtt((item->batchSize > 1) ? RequestType::SET_BATCH : item->type, receivedAtUs - item->sentAtUs);
+	if (item->batchSize <= 1) {
+		serialCompleteRequest(args, item, res, buf + 1, size_t(len - 1));
+		serialPopRequest(args);
+		return;
+	}
+	/* the bit map is followed by the response type of each failed sub-command */
+	const uint8_t count = item->batchSize;
+	const uint8_t * subErr = buf + 1 + sizeof(uint32_t);
+	uint32_t resMap = 0;
+	if (res == VkvmCallback::PeripheryResult::PR_OK) {
+		uint8_t failed = 0;
+		if ( readBigEndian(buf + 1, size_t(len - 1), resMap) ) {
+			for (uint8_t n = 0; n < count; n++) {
+				if (((resMap >> n) & 1) == 0) failed++;
+			}
+		}
+		if (len != (1 + sizeof(uint32_t) + size_t(failed))) res = VkvmCallback::PeripheryResult::PR_BROKEN_FRAME;
+	}
+	for (uint8_t n = 0; n < count; n++) {
+		VkvmCallback::PeripheryResult subRes = res;
+		if (res == VkvmCallback::PeripheryResult::PR_OK && ((resMap >> n) & 1) == 0) {
+			subRes = serialPeripheryResult(*subErr++);
+			/* unknown or successful response types are not valid here */
+			if (subRes == VkvmCallback::PeripheryResult::COUNT || subRes == VkvmCallback::PeripheryResult::PR_OK) {
+				subRes = VkvmCallback::PeripheryResult::PR_BROKEN_FRAME;
+			}
+		}
+		args.stats.addRtt(args.reqFifoFirst->type, receivedAtUs - args.reqFifoFirst->sentAtUs);
+		serialCompleteRequest(args, args.reqFifoFirst, subRes, noResult, 0);
+		serialPopRequest(args);
+	}
+}
+
+
+/**
+ * Parses the given data received from the serial connected VKVM periphery
+ * and forwards the contained frames to `serialReadHandler()`.
+ *
+ * @param[in] args - object with the shared `VkvmDevice` arguments
+ * @param[in] buf - received data
+ * @param[in] len - number of bytes in `buf`
+ * @return false if the read handler terminated the connection, else true
+ */
+static bool serialProcessInput(SerialCommon & args, const uint8_t * buf, const ssize_t len) {
+	if (len > 0) {
+		SerialStatistics::add(args.stats.bytesReceived, uint64_t(len));
+		args.trace.add(TraceRing::DIR_IN, buf, size_t(len));
+	}
+#ifdef VKVM_TRACE
+	if (len > 0) {
+		/* trace output */
+		vkvmTrace(1, "in\t");
+		for (ssize_t i = 0; i < len; i++) {
+			if (i != 0) vkvmTrace(0, " ");
+			vkvmTrace(0, "%02X", unsigned(buf[i] & 0xFF));
+		}
+		vkvmTrace(2, "\n");
+	}
+#endif /* VKVM_TRACE */
+	if (len <= 0) return args.serial != NULL;
+	return args.framing->read(buf, size_t(len), [&](const uint8_t seq, uint8_t * frame, const size_t frameLen, const bool err) -> bool {
+		serialReadHandler(args, seq, frame, frameLen, err);
+		return args.serial != NULL; /* stop if the read handler terminated the connection */
+	}, [&]() {
+		SerialStatistics::add(args.stats.brokenFrames);
 		args.callback->onVkvmBrokenFrame();
-		break;
+	});
+}
+
+
+/**
+ * Sends a keep alive request if no request was sent for `timeout` milliseconds
+ * and checks the outstanding requests for timeouts.
+ *
+ * @param[in] args - object with the shared `VkvmDevice` arguments
+ * @return false if an outstanding request timed out, else true
+ */
+static bool serialCheckTimeouts(SerialCommon & args) {
+	/* ping device if no request was sent for timeout milliseconds */
+	const unsigned long now = millis();
+	if (size_t(now - args.lastSent) >= args.timeout) {
+		serialQueueCommand<void>(args, RequestType::GET_ALIVE, NULL);
 	}
-	/* remove item from queue */
-	std::unique_lock<std::mutex> guard(args.queueMutex);
-	if (item->next == NULL) {
-		args.reqFifoFirst = NULL;
-		args.reqFifoLast = NULL;
-	} else {
-		args.reqFifoFirst = item->next;
+	/* check timeouts of outstanding requests */
+	if ( serialRequestTimedOut(args, now) ) {
+		SerialStatistics::add(args.stats.timeouts);
+		vkvmTrace(3, "timeout2\t%lu\n", args.lastSent);
+		return false;
 	}
-	args.reqFifoSize--;
-	args.reqPending = false;
-	guard.unlock();
-	args.writable.notify_one();
-	delete item;
+	return true;
+}
+
+
+/**
+ * Sends the next queued request frame to the VKVM periphery. Consecutive queued
+ * requests are combined into a single `RequestType::SET_BATCH` frame if supported
+ * by the periphery. The caller needs to hold `queueMutex` and ensure that
+ * `serialCanSend()` returned true.
+ *
+ * @param[in,out] args - object with the shared `VkvmDevice` arguments
+ * @return true on success, else false
+ */
+static bool serialSendNext(SerialCommon & args) {
+	RequestQueueItem * item = args.reqFifoNext;
+	/* first set sent time and then outstanding state to ensure timeout checks work properly */
+	item->sentAt = millis();
+	item->sentAtUs = micros();
+	item->batchSize = 1;
+	RequestQueueItem * last = item;
+	/* outstanding frames are kept within the receive buffer of the periphery */
+	size_t sizeLimit = Framing<VKVM_MAX_FRAME_SIZE>::maxEncodedSize(VKVM_MAX_FRAME_SIZE);
+	if (args.reqInFlight > 0) sizeLimit = PERIPHERY_RX_BUFFER_SIZE - PCF_MIN(args.bytesInFlight, size_t(PERIPHERY_RX_BUFFER_SIZE));
+	if (args.batchSupport && serialIsBatchable(item->type)) {
+		/* add following requests as long as they fit into a single batch frame and the
+		 * periphery finishes them well within the request timeout */
+		const size_t runTimeLimit = args.timeout / 2;
+		size_t frameSize = 2 + item->getPayloadSize();
+		size_t runTime = serialEstimateRunTime(*item);
+		while (last->next != NULL && item->batchSize < VKVM_MAX_BATCH_SIZE && serialIsBatchable(last->next->type)) {
+			const size_t nextSize = frameSize + 1 + last->next->getPayloadSize();
+			if (nextSize > VKVM_MAX_FRAME_SIZE) break;
+			if (Framing<VKVM_MAX_FRAME_SIZE>::maxEncodedSize(nextSize) > sizeLimit) break;
+			const size_t nextRunTime = runTime + serialEstimateRunTime(*(last->next));
+			if (nextRunTime > runTimeLimit) break;
+			last = last->next;
+			last->sentAt = item->sentAt;
+			last->sentAtUs = item->sentAtUs;
+			last->batchSize = 0;
+			item->batchSize++;
+			frameSize = nextSize;
+			runTime = nextRunTime;
+		}
+	}
+	args.reqFifoNext = last->next;
+	args.reqInFlight++;
+	SerialStatistics::add(args.stats.framesSent);
+	if (item->batchSize > 1) SerialStatistics::add(args.stats.batchesSent);
+	if ( ! ((item->batchSize > 1) ? serialSendBatch(args, item) : item->send(args)) ) return false;
+	item->frameSize = uint16_t(args.lastFrameSize);
+	args.bytesInFlight += args.lastFrameSize;
+	return true;
 }
 
 
@@ -1119,45 +2093,11 @@ static void serialReadThread(SerialCommon & args) {
 				serialDisconnect(args, VkvmCallback::DisconnectReason::D_RECV_ERROR);
 				return;
 			}
-#ifdef VKVM_TRACE
-			if (res > 0) {
-				/* trace output */
-				vkvmTrace(1, "in\t");
-				for (ssize_t i = 0; i < res; i++) {
-					if (i != 0) vkvmTrace(0, " ");
-					vkvmTrace(0, "%02X", unsigned(recvBuffer[i] & 0xFF));
-				}
-				vkvmTrace(2, "\n");
-			}
-#endif /* VKVM_TRACE */
-			for (ssize_t i = 0; i < res; i++) {
-				auto readHandlerMapping = [&](const uint8_t seq, uint8_t * buf, const size_t len, const bool err) -> bool {
-					serialReadHandler(args, seq, buf, len, err);
-					return true;
-				};
-				if ( ! args.framing->read(recvBuffer[i], readHandlerMapping) ) {
-					args.callback->onVkvmBrokenFrame();
-				}
-				if (args.serial == NULL) {
-					return; /* read handler terminated the connection */
-				}
-			}
-			/* ping device if no request was sent for timeout milliseconds */
-			const unsigned long now = millis();
-			if (size_t(now - args.lastSent) >= args.timeout) {
-				serialQueueCommand<void>(args, RequestType::GET_ALIVE, NULL);
-			}
-			/* send outstanding request first before checking timeouts */
-			if ( ! args.reqPending ) continue;
-			/* check timeouts of pending requests */
-			args.queueMutex.lock();
-			if (size_t(now - args.lastSent) >= args.timeout) {
-				args.queueMutex.unlock();
-				vkvmTrace(3, "timeout2\t%lu\n", args.lastSent);
+			if ( ! serialProcessInput(args, recvBuffer, res) ) return;
+			if ( ! serialCheckTimeouts(args) ) {
 				serialDisconnect(args, VkvmCallback::DisconnectReason::D_TIMEOUT);
 				return;
 			}
-			args.queueMutex.unlock();
 		}
 		if ( args.terminate ) {
 			serialDisconnect(args, VkvmCallback::DisconnectReason::D_USER);
@@ -1168,8 +2108,9 @@ static void serialReadThread(SerialCommon & args) {
 
 /**
  * Background thread which writes outstanding requests to the serial connected
- * VKVM periphery. This performs one request at a time. The actual serialization
- * of the queued requests is done in `RequestQueueItemT::send()`.
+ * VKVM periphery. This sends up to `reqWindow` frames without waiting for
+ * their results. The actual serialization of the queued requests is done in
+ * `serialSendNext()`.
  *
  * @param[in] args - object with the shared `VkvmDevice` arguments
  */
@@ -1185,24 +2126,461 @@ static void serialWriteThread(SerialCommon & args) {
 			return;
 		}
 		while ( ! args.terminate ) {
-			/* send next request if none is pending */
+			/* send next request if the sliding window is not exhausted */
 			std::unique_lock<std::mutex> guard(args.queueMutex);
 			args.writable.wait(guard, [&args] {
-				return args.terminate || args.serial == NULL || (args.reqPending == false && args.reqFifoFirst != NULL);
+				return args.terminate || args.serial == NULL || serialCanSend(args);
 			});
 			if (args.terminate || args.serial == NULL) return;
-			if (args.reqPending == false && args.reqFifoFirst != NULL) {
-				if ( ! args.reqFifoFirst->send(args) ) {
-					args.queueMutex.unlock();
-					serialDisconnect(args, VkvmCallback::DisconnectReason::D_SEND_ERROR);
-					return;
-				}
+			if ( ! serialSendNext(args) ) {
+				guard.unlock();
+				serialDisconnect(args, VkvmCallback::DisconnectReason::D_SEND_ERROR);
+				return;
 			}
 		}
 	} catch (...) {}
 }
 
 
+#ifdef PCF_IS_LINUX
+/** Set if newly opened connections shall be served by the shared reactor. */
+std::atomic<bool> useSharedReactor(false);
+
+
+/**
+ * Returns the time until `serialCheckTimeouts()` needs to be called next for the
+ * given connection.
+ *
+ * @param[in] args - object with the shared `VkvmDevice` arguments
+ * @param[in] now - current timestamp (derived from millis())
+ * @return remaining time in milliseconds
+ */
+static size_t serialTimeUntilCheck(SerialCommon & args, const unsigned long now) {
+	std::lock_guard<std::mutex> guard(args.queueMutex);
+	/* the oldest outstanding request was not sent after the last one */
+	const size_t elapsed = (args.reqInFlight > 0 && args.reqFifoFirst != NULL) ? serialRequestElapsed(args, now) : size_t(now - args.lastSent);
+	return (elapsed >= args.timeout) ? 0 : args.timeout - elapsed;
+}
+
+
+/**
+ * Shared I/O reactor which serves the serial connections of all `VkvmDevice`
+ * instances opened while `VkvmDevice::setSharedReactor()` is enabled. A single
+ * thread waits via epoll for incoming data, queued requests and termination
+ * requests of all attached connections. This replaces the read and write thread
+ * of each connection. Keep alive and request timeouts are handled by a single
+ * timerfd which is armed to the earliest deadline of all attached connections.
+ * Frames are written without blocking. The remainder of a partially written
+ * frame is flushed once the serial device becomes writable again. Further
+ * requests of that connection are held back meanwhile. Hence, a stalled
+ * device does not delay the others and is detected by its request timeout.
+ */
+class VkvmReactor {
+private:
+	std::mutex mutex; /**< Guards `pending` and `SerialCommon::reactorState`. */
+	std::condition_variable detached; /**< Signaled whenever a connection has been detached. */
+	std::vector<SerialCommon *> pending; /**< Connections to be attached by the reactor thread. */
+	std::vector<SerialCommon *> devices; /**< Attached connections. Only accessed by the reactor thread. */
+	std::thread thread; /**< Reactor thread handle. */
+	volatile bool stopping; /**< Set to terminate the reactor thread. */
+	int epollFd; /**< epoll instance which watches all file descriptors below. */
+	int wakeFd; /**< eventfd to wake up the reactor thread. */
+	int timerFd; /**< timerfd armed to the next keep alive or request timeout deadline. */
+	uint8_t recvBuffer[RECV_BUFFER_SIZE]; /**< Receive buffer shared by all attached connections. */
+public:
+	/** Constructor. */
+	explicit VkvmReactor():
+		stopping(false),
+		epollFd(epoll_create1(EPOLL_CLOEXEC)),
+		wakeFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+		timerFd(timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC))
+	{
+		if (this->epollFd < 0 || this->wakeFd < 0 || this->timerFd < 0 || ( ! this->watch(this->wakeFd, NULL) ) || ( ! this->watch(this->timerFd, &(this->timerFd)) )) {
+			this->closeFds();
+			return;
+		}
+		try {
+			this->thread = std::thread(&VkvmReactor::run, this);
+		} catch (...) {
+			this->closeFds();
+		}
+	}
+
+	/** Destructor. */
+	~VkvmReactor() {
+		if ( this->thread.joinable() ) {
+			this->stopping = true;
+			this->wake();
+			this->thread.join();
+		}
+		this->closeFds();
+	}
+
+	VkvmReactor(const VkvmReactor &) = delete;
+	VkvmReactor & operator= (const VkvmReactor &) = delete;
+
+	/**
+	 * Hands the given connection over to the reactor thread. The connection needs
+	 * to be opened and initialized like for the read/write threads.
+	 *
+	 * @param[in,out] args - object with the shared `VkvmDevice` arguments
+	 * @return true on success, false if the reactor is not available
+	 */
+	bool attach(SerialCommon & args) {
+		if (this->epollFd < 0) return false;
+		{
+			std::lock_guard<std::mutex> guard(this->mutex);
+			args.reactorState = SerialCommon::RS_PENDING;
+			this->pending.push_back(&args);
+		}
+		this->wake();
+		return true;
+	}
+
+	/**
+	 * Waits until the reactor thread detached the given connection. The reactor
+	 * only detaches the connection on error or if `SerialCommon::terminate` is set.
+	 *
+	 * @param[in,out] args - object with the shared `VkvmDevice` arguments
+	 */
+	void detach(SerialCommon & args) {
+		std::unique_lock<std::mutex> guard(this->mutex);
+		if (args.reactorState == SerialCommon::RS_PENDING) {
+			this->pending.erase(std::find(this->pending.begin(), this->pending.end(), &args));
+			args.reactorState = SerialCommon::RS_DETACHED;
+			return;
+		}
+		if (args.reactorState == SerialCommon::RS_DETACHED) return;
+		if (std::this_thread::get_id() == this->thread.get_id()) {
+			/* called from within a callback */
+			guard.unlock();
+			this->drop(args, VkvmCallback::DisconnectReason::D_USER);
+			return;
+		}
+		this->wake();
+		this->detached.wait(guard, [&args] { return args.reactorState == SerialCommon::RS_DETACHED; });
+	}
+
+	/**
+	 * Wakes up the reactor thread to process queued requests and termination
+	 * requests of all attached connections.
+	 */
+	void wake() {
+		const uint64_t val = 1;
+		if (xEINTR(write, this->wakeFd, &val, sizeof(val)) != ssize_t(sizeof(val))) {
+			vkvmTrace(3, "error\treactor wake\t%s\n", strerror(errno));
+		}
+	}
+private:
+	/**
+	 * Adds the given file descriptor to the watched input file descriptors.
+	 *
+	 * @param[in] fd - file descriptor to watch
+	 * @param[in] ptr - user pointer returned by `epoll_wait()`
+	 * @return true on success, else false
+	 */
+	bool watch(const int fd, void * ptr) {
+		struct epoll_event ev;
+		memset(&ev, 0, sizeof(ev));
+		ev.events = EPOLLIN;
+		ev.data.ptr = ptr;
+		return epoll_ctl(this->epollFd, EPOLL_CTL_ADD, fd, &ev) == 0;
+	}
+
+	/**
+	 * Enables or disables the output readiness notification for the given
+	 * connection.
+	 *
+	 * @param[in,out] args - connection to change
+	 * @param[in] enable - true to wait until the serial device becomes writable
+	 * @return true on success, else false
+	 */
+	bool watchOutput(SerialCommon & args, const bool enable) {
+		if (args.outWait == enable) return true;
+		struct epoll_event ev;
+		memset(&ev, 0, sizeof(ev));
+		ev.events = enable ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+		ev.data.ptr = &args;
+		if (epoll_ctl(this->epollFd, EPOLL_CTL_MOD, ser_getFd(args.serial), &ev) != 0) return false;
+		args.outWait = enable;
+		return true;
+	}
+
+	/** Closes all reactor file descriptors. */
+	void closeFds() {
+		if (this->timerFd >= 0) ::close(this->timerFd);
+		if (this->wakeFd >= 0) ::close(this->wakeFd);
+		if (this->epollFd >= 0) ::close(this->epollFd);
+		this->timerFd = -1;
+		this->wakeFd = -1;
+		this->epollFd = -1;
+	}
+
+	/**
+	 * Checks whether the given connection is still attached. The connection may
+	 * have been detached from within a callback.
+	 *
+	 * @param[in] args - connection to check
+	 * @return true if attached, else false
+	 */
+	bool isAttached(const SerialCommon * args) const {
+		return std::find(this->devices.begin(), this->devices.end(), args) != this->devices.end();
+	}
+
+	/**
+	 * Attaches all pending connections. This performs the same initial steps as
+	 * the read thread.
+	 *
+	 * @return true if connections were attached, else false
+	 */
+	bool attachPending() {
+		std::vector<SerialCommon *> list;
+		{
+			std::lock_guard<std::mutex> guard(this->mutex);
+			if ( this->pending.empty() ) return false;
+			list.swap(this->pending);
+			for (size_t i = 0; i < list.size(); i++) list[i]->reactorState = SerialCommon::RS_ATTACHED;
+		}
+		for (size_t i = 0; i < list.size(); i++) {
+			SerialCommon & args = *(list[i]);
+			args.readMutex.lock();
+			args.outPos = 0;
+			args.outSize = 0;
+			args.outWait = false;
+			this->devices.push_back(&args);
+			if (args.device == NULL || args.framing == NULL || args.callback == NULL || args.serial == NULL || args.terminate) {
+				this->drop(args, args.terminate ? VkvmCallback::DisconnectReason::D_USER : VkvmCallback::DisconnectReason::D_SEND_ERROR);
+				continue;
+			}
+			if ( ! this->watch(ser_getFd(args.serial), &args) ) {
+				this->drop(args, VkvmCallback::DisconnectReason::D_RECV_ERROR);
+				continue;
+			}
+			/* initially send the protocol version request to check the version */
+			if ( ! serialQueueCommand<void>(args, RequestType::GET_PROTOCOL_VERSION, NULL) ) {
+				this->drop(args, VkvmCallback::DisconnectReason::D_SEND_ERROR);
+				continue;
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * Reports the disconnect of the given connection via `serialDisconnect()` and
+	 * detaches it from the reactor.
+	 *
+	 * @param[in,out] args - connection to detach
+	 * @param[in] reason - disconnect reason
+	 */
+	void drop(SerialCommon & args, const VkvmCallback::DisconnectReason reason) {
+		serialDisconnect(args, reason);
+		if (args.serial != NULL) epoll_ctl(this->epollFd, EPOLL_CTL_DEL, ser_getFd(args.serial), NULL);
+		this->devices.erase(std::find(this->devices.begin(), this->devices.end(), &args));
+		args.readMutex.unlock(); /* allows the disconnect thread to proceed */
+		{
+			std::lock_guard<std::mutex> guard(this->mutex);
+			args.reactorState = SerialCommon::RS_DETACHED;
+		}
+		this->detached.notify_all();
+	}
+
+	/**
+	 * Reads and processes the available data of the given connection.
+	 *
+	 * @param[in,out] args - connection with available input data
+	 */
+	void receive(SerialCommon & args) {
+		const ssize_t res = ser_read(args.serial, this->recvBuffer, RECV_BUFFER_SIZE, 0);
+		if (res == -1) {
+			/* read error */
+			this->drop(args, VkvmCallback::DisconnectReason::D_RECV_ERROR);
+			return;
+		}
+		serialProcessInput(args, this->recvBuffer, res);
+	}
+
+	/**
+	 * Writes the pending output of the given connection without blocking.
+	 * The caller needs to hold `queueMutex`.
+	 *
+	 * @param[in,out] args - connection to flush
+	 * @return true on success or if the serial device is not writable, false on error
+	 */
+	bool flush(SerialCommon & args) {
+		const int fd = ser_getFd(args.serial);
+		while (args.outPos < args.outSize) {
+			const ssize_t res = xEINTR(write, fd, args.buffer + args.outPos, args.outSize - args.outPos);
+			if (res < 0) {
+				if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+				vkvmTrace(3, "error\treactor write\t%s\n", strerror(errno));
+				return false;
+			}
+			SerialStatistics::add(args.stats.bytesSent, uint64_t(res));
+			args.trace.add(TraceRing::DIR_OUT, args.buffer + args.outPos, size_t(res));
+			args.outPos += size_t(res);
+		}
+		if (args.outPos >= args.outSize) {
+			args.outPos = 0;
+			args.outSize = 0;
+		}
+		return this->watchOutput(args, args.outSize > 0);
+	}
+
+	/**
+	 * Handles termination requests, timeouts and queued requests of the given
+	 * connection.
+	 *
+	 * @param[in,out] args - connection to serve
+	 */
+	void serve(SerialCommon & args) {
+		if ( args.terminate ) {
+			this->drop(args, VkvmCallback::DisconnectReason::D_USER);
+			return;
+		}
+		if ( ! serialCheckTimeouts(args) ) {
+			this->drop(args, VkvmCallback::DisconnectReason::D_TIMEOUT);
+			return;
+		}
+		/* send queued requests while the sliding window is not exhausted and the previous frame was written */
+		std::unique_lock<std::mutex> guard(args.queueMutex);
+		bool ok = this->flush(args);
+		while (ok && args.outSize == 0 && serialCanSend(args)) {
+			ok = serialSendNext(args) && this->flush(args);
+		}
+		if ( ! ok ) {
+			guard.unlock();
+			this->drop(args, VkvmCallback::DisconnectReason::D_SEND_ERROR);
+		}
+	}
+
+	/** Arms the timer to the earliest deadline of all attached connections. */
+	void armTimer() {
+		struct itimerspec spec;
+		memset(&spec, 0, sizeof(spec));
+		if ( ! this->devices.empty() ) {
+			const unsigned long now = millis();
+			size_t next = std::numeric_limits<size_t>::max();
+			for (size_t i = 0; i < this->devices.size(); i++) {
+				next = std::min(next, serialTimeUntilCheck(*(this->devices[i]), now));
+			}
+			next = std::max(next, size_t(1)); /* zero would disarm the timer */
+			spec.it_value.tv_sec = time_t(next / 1000);
+			spec.it_value.tv_nsec = long((next % 1000) * 1000000);
+		}
+		timerfd_settime(this->timerFd, 0, &spec, NULL);
+	}
+
+	/** Reactor thread. */
+	void run() {
+		try {
+			struct epoll_event events[REACTOR_MAX_EVENTS];
+			while ( ! this->stopping ) {
+				const int count = xEINTR(epoll_wait, this->epollFd, events, REACTOR_MAX_EVENTS, -1);
+				bool serveAll = false;
+				for (int i = 0; i < count; i++) {
+					void * ptr = events[i].data.ptr;
+					if (ptr == NULL || ptr == &(this->timerFd)) {
+						/* wake up request or timer expiration */
+						uint64_t val;
+						xEINTR(read, (ptr == NULL) ? this->wakeFd : this->timerFd, &val, sizeof(val));
+						serveAll = true;
+					} else {
+						SerialCommon * args = static_cast<SerialCommon *>(ptr);
+						if ((events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) != 0 && this->isAttached(args)) {
+							this->receive(*args);
+						}
+						if ((events[i].events & EPOLLOUT) != 0 && this->isAttached(args)) {
+							/* continue with the pending output and the following requests */
+							this->serve(*args);
+						}
+					}
+				}
+				if ( this->attachPending() ) serveAll = true;
+				if ( serveAll ) {
+					/* backwards to remain valid if the current connection gets detached */
+					for (size_t i = this->devices.size(); i-- > 0; ) {
+						if (i >= this->devices.size()) continue;
+						this->serve(*(this->devices[i]));
+					}
+				}
+				this->armTimer();
+			}
+			this->attachPending();
+			while ( ! this->devices.empty() ) {
+				this->drop(*(this->devices.back()), VkvmCallback::DisconnectReason::D_USER);
+			}
+		} catch (...) {}
+	}
+};
+
+
+/**
+ * Returns the process wide shared reactor. It is created on first use and
+ * intentionally never destroyed to allow `VkvmDevice` instances to be closed
+ * during static object destruction.
+ *
+ * @return shared reactor instance
+ */
+static VkvmReactor & sharedReactor() {
+	static VkvmReactor * reactor = new VkvmReactor();
+	return *reactor;
+}
+#endif /* PCF_IS_LINUX */
+
+
+/**
+ * Wakes up the serial write thread or the shared reactor serving the given
+ * connection to process queued requests or termination requests.
+ *
+ * @param[in,out] args - object with the shared `VkvmDevice` arguments
+ */
+static void serialWakeWriter(SerialCommon & args) {
+#ifdef PCF_IS_LINUX
+	if (args.reactor != NULL) {
+		args.reactor->wake();
+		return;
+	}
+#endif /* PCF_IS_LINUX */
+	args.writable.notify_one();
+}
+
+
+/**
+ * Serves the given connection by the shared reactor if enabled.
+ *
+ * @param[in,out] args - object with the shared `VkvmDevice` arguments
+ * @return true if attached to the shared reactor, false if read/write threads are needed
+ */
+static bool serialAttachReactor(SerialCommon & args) {
+#ifdef PCF_IS_LINUX
+	args.reactor = NULL;
+	if ( ! useSharedReactor ) return false;
+	VkvmReactor & reactor = sharedReactor();
+	args.reactor = &reactor; /* needs to be set before the reactor thread uses the connection */
+	if ( reactor.attach(args) ) return true;
+	args.reactor = NULL;
+#else /* !PCF_IS_LINUX */
+	PCF_UNUSED(args);
+#endif /* PCF_IS_LINUX */
+	return false;
+}
+
+
+/**
+ * Waits until the shared reactor stopped serving the given connection.
+ * This is the counterpart to joining the read/write threads.
+ *
+ * @param[in,out] args - object with the shared `VkvmDevice` arguments
+ */
+static void serialDetachReactor(SerialCommon & args) {
+#ifdef PCF_IS_LINUX
+	if (args.reactor != NULL) args.reactor->detach(args);
+#else /* !PCF_IS_LINUX */
+	PCF_UNUSED(args);
+#endif /* PCF_IS_LINUX */
+}
+
+
 #ifdef PCF_IS_LINUX
 /** Holds a single input device handle. */
 struct InputDevice {
@@ -1262,13 +2640,19 @@ VkvmDevice::VkvmDevice():
 	self(new VkvmDevice::Pimple)
 {
 	self->common.device = this;
-	self->common.framing = new Framing<VKVM_MAX_FRAME_SIZE>(serialWrite, &(self->common));
-	self->common.bufferSize = 0;
+	/* frames are sent via `Framing::encode()` only */
+	self->common.framing = new Framing<VKVM_MAX_FRAME_SIZE>(NULL);
+	self->common.payload.clear();
 	self->common.reqFifoFirst = NULL;
 	self->common.reqFifoLast = NULL;
+	self->common.reqFifoNext = NULL;
 	self->common.reqFifoSize = 0;
+	self->common.reqInFlight = 0;
+	self->common.reqWindow = 1;
+	self->common.bytesInFlight = 0;
+	self->common.lastFrameSize = 0;
+	self->common.batchSupport = false;
 	self->common.reqNumber = 0;
-	self->common.reqPending = false;
 	self->common.tickDuration = 100;
 	self->common.timeout = 1000;
 	self->common.callback = NULL;
@@ -1286,6 +2670,11 @@ VkvmDevice::VkvmDevice():
 	self->common.mouseHook = NULL;
 #elif defined(PCF_IS_LINUX)
 	self->common.hookTermFd = -1;
+	self->common.reactor = NULL;
+	self->common.reactorState = SerialCommon::RS_DETACHED;
+	self->common.outPos = 0;
+	self->common.outSize = 0;
+	self->common.outWait = false;
 #endif /* PCF_IS_LINUX */
 	self->grabbingInput = false;
 }
@@ -1303,6 +2692,25 @@ VkvmDevice::~VkvmDevice() {
 }
 
 
+/**
+ * Selects whether subsequently opened VKVM periphery devices are served by a
+ * single process wide I/O reactor thread instead of a dedicated read and write
+ * thread per device. This avoids periodic wake ups and scales to many devices
+ * within the same process. Already opened devices are not affected.
+ *
+ * @param[in] enable - true to use the shared reactor, false to use dedicated threads
+ * @return true on success, false if not supported on the current platform
+ */
+bool VkvmDevice::setSharedReactor(const bool enable) {
+#ifdef PCF_IS_LINUX
+	useSharedReactor = enable;
+	return true;
+#else /* !PCF_IS_LINUX */
+	return ! enable;
+#endif /* PCF_IS_LINUX */
+}
+
+
 /**
  * Opens the given VKVM periphery device from the passed serial device path.
  *
@@ -1311,13 +2719,18 @@ VkvmDevice::~VkvmDevice() {
  * @param[in] path - serial device path of the VKVM periphery device
  * @param[in] timeout - timeout in milliseconds
  * @param[in] tickDuration - internal serial read timeout in milliseconds used
- *  to check the VKVM periphery device via keep-alive
+ *  to check the VKVM periphery device via keep-alive (not used by the shared reactor)
+ * @param[in] window - maximum number of request frames sent to the VKVM periphery
+ *  without waiting for their results (limited to the request queue size)
  * @return true on success, else false
+ * @remarks The periphery needs to be able to buffer `window` frames while
+ *  the current one is being processed.
  */
-bool VkvmDevice::open(VkvmCallback & cb, const char * path, const size_t timeout, const size_t tickDuration) {
+bool VkvmDevice::open(VkvmCallback & cb, const char * path, const size_t timeout, const size_t tickDuration, const size_t window) {
 	vkvmTrace(3, "open\t%s\n", path);
 	std::lock_guard<std::mutex> guard(self->common.openCloseMutex);
 	if (self->common.serial != NULL || self->common.terminate) return false;
+	serialDetachReactor(self->common);
 	if ( self->common.disconnectThread.joinable() ) self->common.disconnectThread.join();
 	if ( self->readThread.joinable() ) self->readThread.join();
 	if ( self->writeThread.joinable() ) self->writeThread.join();
@@ -1341,25 +2754,33 @@ bool VkvmDevice::open(VkvmCallback & cb, const char * path, const size_t timeout
 	}
 	ser_clear(self->common.serial);
 	self->common.framing->setFirstOut();
-	self->common.bufferSize = 0;
+	self->common.payload.clear();
 	while (self->common.reqFifoFirst != NULL) {
 		RequestQueueItem * next = self->common.reqFifoFirst->next;
-		delete self->common.reqFifoFirst;
+		self->common.reqPool.destroy(self->common.reqFifoFirst);
 		self->common.reqFifoFirst = next;
 	}
 	self->common.reqFifoFirst = NULL;
 	self->common.reqFifoLast = NULL;
+	self->common.reqFifoNext = NULL;
 	self->common.reqFifoSize = 0;
+	self->common.reqInFlight = 0;
+	self->common.reqWindow = PCF_MIN(PCF_MAX(window, size_t(1)), size_t(REQUEST_FIFO_LIMIT));
+	self->common.bytesInFlight = 0;
+	self->common.lastFrameSize = 0;
+	self->common.lastReceived = millis();
+	self->common.batchSupport = false;
 	self->common.reqNumber = 0;
-	self->common.reqPending = false;
 	self->common.lastUsbState = USBSTATE_OFF;
 	self->common.lastLEDs = 0;
 	self->common.tickDuration = tickDuration;
 	self->common.timeout = timeout;
 	self->common.callback = &cb;
 	self->common.connected = false;
-	self->readThread = std::thread(serialReadThread, std::ref(self->common));
-	self->writeThread = std::thread(serialWriteThread, std::ref(self->common));
+	if ( ! serialAttachReactor(self->common) ) {
+		self->readThread = std::thread(serialReadThread, std::ref(self->common));
+		self->writeThread = std::thread(serialWriteThread, std::ref(self->common));
+	}
 	vkvmTrace(3, "opened\t0x%p\t%s\n", static_cast<const void *>(self->common.serial), path);
 	return true;
 }
@@ -1439,6 +2860,7 @@ bool VkvmDevice::close() {
 	vkvmTrace(3, "close1\t0x%p\n", static_cast<const void *>(self->common.serial));
 	std::lock_guard<std::mutex> guard(self->common.openCloseMutex);
 	if (self->common.serial == NULL || self->common.terminate) {
+		serialDetachReactor(self->common);
 		if ( self->common.disconnectThread.joinable() ) self->common.disconnectThread.join();
 		if ( self->readThread.joinable() ) self->readThread.join();
 		if ( self->writeThread.joinable() ) self->writeThread.join();
@@ -1448,11 +2870,13 @@ bool VkvmDevice::close() {
 		std::lock_guard<std::mutex> queueGuard(self->common.queueMutex);
 		self->common.terminate = true;
 	}
-	self->common.writable.notify_one();
+	serialWakeWriter(self->common);
 	if ( self->grabbingInput ) this->grabGlobalInput(false);
-	if ( self->common.disconnectThread.joinable() ) self->common.disconnectThread.join();
+	serialDetachReactor(self->common);
 	if ( self->readThread.joinable() ) self->readThread.join();
 	if ( self->writeThread.joinable() ) self->writeThread.join();
+	/* the terminating read/write threads start the disconnect thread which reports `D_USER` */
+	if ( self->common.disconnectThread.joinable() ) self->common.disconnectThread.join();
 	self->common.callback = NULL;
 	const void * oldHandle = self->common.serial;
 	PCF_UNUSED(oldHandle);
@@ -1464,6 +2888,47 @@ bool VkvmDevice::close() {
 }
 
 
+/**
+ * Returns a snapshot of the connection statistics. Recording is lock-free and
+ * always enabled. The snapshot is consistent per counter only.
+ *
+ * @return connection statistics
+ */
+VkvmStatistics VkvmDevice::getStatistics() const {
+	VkvmStatistics res;
+	self->common.stats.copyTo(res);
+	std::lock_guard<std::mutex> guard(self->common.queueMutex);
+	res.queueDepth = uint32_t(self->common.reqFifoSize);
+	res.inFlight = uint32_t(self->common.reqInFlight);
+	return res;
+}
+
+
+/**
+ * Resets all accumulated connection statistics.
+ */
+void VkvmDevice::resetStatistics() {
+	self->common.stats.reset();
+}
+
+
+/**
+ * Writes the binary protocol trace of the most recent serial data to the given
+ * file. Recording is lock-free and always enabled. Use `script/trace-dec.awk`
+ * to convert the output for `script/prot-dec.awk`.
+ *
+ * @param[in] path - output file path
+ * @return true on success, else false
+ */
+bool VkvmDevice::dumpTrace(const char * path) const {
+	if (path == NULL) return false;
+	FILE * fp = fopen(path, "wb");
+	if (fp == NULL) return false;
+	const bool res = self->common.trace.dump(fp);
+	return (fclose(fp) == 0) && res;
+}
+
+
 /**
  * Returns the most recent USB periphery state field from
  * the connected remote device.
@@ -1941,14 +3406,12 @@ LRESULT CALLBACK lowLevelKeyboardProc(int nCode, WPARAM wParam, LPARAM lParam) {
 
 
 /**
- * Sends the accumulated mouse movement to the periphery device. Movement is held back and merged
- * while other requests are still pending.
+ * Sends the accumulated mouse movement to the periphery device. Movement which was not sent yet
+ * is merged within the request queue. Movement is kept if the request queue is full.
  *
  * @param[in,out] ctx - object with the shared `VkvmDevice` arguments
- * @param[in] force - set true to always send
  */
-static void flushPendingMouse(SerialCommon & ctx, const bool force) {
-	if ( ! (force || ctx.reqFifoSize == 0) ) return;
+static void flushPendingMouse(SerialCommon & ctx) {
 	if ( ctx.hasPendingAbs ) {
 		if ( ! ctx.device->mouseMoveAbs(ctx.pendingAbsX, ctx.pendingAbsY) ) return;
 		ctx.hasPendingAbs = false;
@@ -2023,13 +3486,13 @@ LRESULT CALLBACK rawInputProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
 					vkvmHookCtx->pendingRelX += long(mouse.lLastX);
 					vkvmHookCtx->pendingRelY += long(mouse.lLastY);
 				}
-				flushPendingMouse(*vkvmHookCtx, false);
+				flushPendingMouse(*vkvmHookCtx);
 			}
 		}
 		break; /* `DefWindowProc()` is mandatory for raw input cleanup */
 	case WM_TIMER:
-		/* send leftover movement if the user stopped moving while the request queue was busy */
-		if (vkvmHookCtx != NULL) flushPendingMouse(*vkvmHookCtx, false);
+		/* send leftover movement if the user stopped moving while the request queue was full */
+		if (vkvmHookCtx != NULL) flushPendingMouse(*vkvmHookCtx);
 		return 0;
 	default:
 		break;
@@ -2052,7 +3515,7 @@ LRESULT CALLBACK lowLevelMouseProc(int nCode, WPARAM wParam, LPARAM lParam) {
 	PMSLLHOOKSTRUCT p = reinterpret_cast<PMSLLHOOKSTRUCT>(lParam);
 	if (wParam != WM_MOUSEMOVE) {
 		/* commit pending movement first so that buttons and scrolling act on the current position */
-		flushPendingMouse(*vkvmHookCtx, true);
+		flushPendingMouse(*vkvmHookCtx);
 	}
 	switch (wParam) {
 	case WM_LBUTTONDOWN: vkvmHookCtx->device->mouseButtonDown(USBBUTTON_LEFT);   break;
@@ -2687,9 +4150,8 @@ bool VkvmDevice::grabGlobalInput(const bool enable) {
 				double absX = 0.0, absY = 0.0;
 				bool hasAbsXY = false;
 				InputDevice::ValueType relX = 0, relY = 0, relWheel = 0;
-				/* flushes accumulated mouse motion to avoid queue lag; set `force` true to bypass queue check */
-				const auto flushPendingMouse = [this, &absX, &absY, &hasAbsXY, &relX, &relY, &relWheel] (const bool force) {
-					if ( ! (force || self->common.reqFifoSize == 0) ) return;
+				/* flushes accumulated mouse motion; unsent motion is merged within the request queue */
+				const auto flushPendingMouse = [this, &absX, &absY, &hasAbsXY, &relX, &relY, &relWheel] () {
 					if ( hasAbsXY ) {
 						if ( ! self->common.device->mouseMoveAbs(absX, absY) ) return;
 						hasAbsXY = false;
@@ -2720,7 +4182,7 @@ bool VkvmDevice::grabGlobalInput(const bool enable) {
 					FD_SET(self->common.hookTermFd, &readFds);
 					FD_SET(libinput_get_fd(li), &readFds);
 					const int maxFd = std::max(self->common.hookTermFd, libinput_get_fd(li));
-					/* wait for next key event; recheck quickly if mouse movement is still pending */
+					/* wait for next key event; recheck quickly if mouse movement is still pending due to a full request queue */
 					const bool hasPendingMouse = hasAbsXY || relX != 0 || relY != 0 || relWheel != 0;
 					tout.tv_sec = 0;
 					tout.tv_usec = hasPendingMouse ? 10000 : (succeeded ? 500000 : 250000);
@@ -2751,7 +4213,7 @@ bool VkvmDevice::grabGlobalInput(const bool enable) {
 						case LIBINPUT_EVENT_POINTER_BUTTON: {
 							struct libinput_event_pointer * pointerEvent = libinput_event_get_pointer_event(event);
 							/* commit pending motion first so that buttons hit on the current position */
-							flushPendingMouse(true);
+							flushPendingMouse();
 							switch (libinput_event_pointer_get_button_state(pointerEvent)) {
 							case LIBINPUT_BUTTON_STATE_PRESSED:
 								switch (libinput_event_pointer_get_button(pointerEvent)) {
@@ -2810,7 +4272,7 @@ bool VkvmDevice::grabGlobalInput(const bool enable) {
 						libinput_dispatch(li);
 					}
 					/* update mouse/wheel movements from accumulated values */
-					flushPendingMouse(false);
+					flushPendingMouse();
 				}
 			} catch (...) {}
 		});
@@ -2,13 +2,14 @@
  * @file Vkvm.hpp
  * @author Daniel Starke
  * @date 2019-10-11
- * @version 2026-06-13
+ * @version 2026-10-16
  */
 #ifndef __PCF_SERIAL_VKVM_HPP__
 #define __PCF_SERIAL_VKVM_HPP__
 
 #include <cstddef>
 #include <cstdint>
+#include <vkm-periphery/Protocol.hpp>
 #include <vkm-periphery/UsbKeys.hpp>
 
 
@@ -219,6 +220,58 @@ public:
 };
 
 
+/**
+ * Snapshot of the VKVM periphery connection statistics.
+ * All counters accumulate over reconnects until `VkvmDevice::resetStatistics()`.
+ *
+ * @see VkvmDevice::getStatistics()
+ */
+struct VkvmStatistics {
+	/** Upper round-trip time limit of the first histogram bucket in microseconds. */
+	static constexpr uint32_t RTT_BASE = 128;
+	/**
+	 * Number of round-trip time histogram buckets. Bucket `i` counts round-trip
+	 * times below `RTT_BASE << i` microseconds which do not fit into a previous
+	 * bucket. The last bucket counts all remaining.
+	 */
+	static constexpr size_t RTT_BUCKETS = 16;
+	/**
+	 * Number of queue depth histogram buckets. Bucket 0 counts an empty queue and
+	 * bucket `i` a depth within [2^(i-1), 2^i).
+	 */
+	static constexpr size_t DEPTH_BUCKETS = 9;
+	/** Round-trip time statistics of a single request type. */
+	struct Rtt {
+		uint64_t count; /**< Number of measured round-trips. */
+		uint64_t sumUs; /**< Sum of all round-trip times in microseconds. */
+		uint32_t maxUs; /**< Maximum round-trip time in microseconds. */
+		uint64_t histogram[RTT_BUCKETS]; /**< Round-trip time histogram. */
+	};
+	/**
+	 * Round-trip times per `RequestType` from frame transmission to result reception.
+	 * Requests sent within a `RequestType::SET_BATCH` frame are accounted for their own
+	 * type and the batch frame itself for `RequestType::SET_BATCH`.
+	 */
+	Rtt rtt[RequestType::COUNT];
+	uint64_t results[size_t(VkvmCallback::PeripheryResult::COUNT)]; /**< Number of request results per periphery result code. */
+	uint64_t depthHistogram[DEPTH_BUCKETS]; /**< Request queue depth sampled whenever a new request is queued. */
+	uint32_t queueDepth; /**< Current number of queued requests. */
+	uint32_t maxQueueDepth; /**< Maximum number of queued requests. */
+	uint32_t inFlight; /**< Current number of frames sent without received result. */
+	uint64_t requests; /**< Number of queued requests. */
+	uint64_t merged; /**< Number of requests merged into an already queued request. */
+	uint64_t rejected; /**< Number of requests rejected due to a full request queue. */
+	uint64_t framesSent; /**< Number of request frames sent. */
+	uint64_t batchesSent; /**< Number of `RequestType::SET_BATCH` frames sent. */
+	uint64_t framesReceived; /**< Number of valid frames received. */
+	uint64_t interrupts; /**< Number of unsolicited interrupt frames received. */
+	uint64_t brokenFrames; /**< Number of broken frames received from the periphery. */
+	uint64_t timeouts; /**< Number of request timeouts. */
+	uint64_t bytesSent; /**< Number of bytes written to the serial device. */
+	uint64_t bytesReceived; /**< Number of bytes read from the serial device. */
+};
+
+
 /**
  * Class to handle a VKVM periphery device connection.
  *
@@ -238,7 +291,9 @@ public:
 	VkvmDevice(const VkvmDevice &) = delete;
 	VkvmDevice & operator= (const VkvmDevice &) = delete;
 
-	bool open(VkvmCallback & cb, const char * path, const size_t timeout = 1000, const size_t tickDuration = 100);
+	static bool setSharedReactor(const bool enable);
+
+	bool open(VkvmCallback & cb, const char * path, const size_t timeout = 1000, const size_t tickDuration = 100, const size_t window = 1);
 	bool isOpen() const;
 	bool isConnected() const;
 	bool isFullyConnected() const;
@@ -247,6 +302,10 @@ public:
 	bool isBootAbsMouse() const;
 	bool close();
 
+	VkvmStatistics getStatistics() const;
+	void resetStatistics();
+	bool dumpTrace(const char * path) const;
+
 	uint8_t usbState() const;
 	uint8_t keyboardLeds() const;
 	bool keyboardDown(const uint8_t key, const int osKey = -1);
@@ -2,11 +2,12 @@
  * @file Capture.hpp
  * @author Daniel Starke
  * @date 2019-10-01
- * @version 2026-06-14
+ * @version 2026-10-16
  */
 #ifndef __PCF_VIDEO_CAPTURE_HPP__
 #define __PCF_VIDEO_CAPTURE_HPP__
 
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <vector>
@@ -15,6 +16,10 @@
 #include <pcf/Cloneable.hpp>
 
 
+/** Maximum difference per byte between two frames decoded from JPEG which is treated as compression noise. */
+#define PCF_CAPTURE_JPEG_NOISE 8
+
+
 namespace pcf {
 namespace video {
 
@@ -32,6 +37,49 @@ enum CaptureOrientation {
 };
 
 
+/**
+ * Enumeration of possible YUV to RGB conversion matrices.
+ */
+enum CaptureYuvMatrix {
+	CYM_BT601, /**< ITU-R BT.601 (standard definition) */
+	CYM_BT709 /**< ITU-R BT.709 (high definition) */
+};
+
+
+/**
+ * Enumeration of possible YUV quantization ranges.
+ */
+enum CaptureYuvRange {
+	CYR_LIMITED, /**< luma in 16..235 and chroma in 16..240 */
+	CYR_FULL /**< all components in 0..255 */
+};
+
+
+/**
+ * Timing of a single captured frame. All time points are given in microseconds of the
+ * clock returned by getCaptureTime(). The noise level tells the callback how far lossy
+ * decoded frames may differ from an unchanged source.
+ */
+struct CaptureTiming {
+	uint64_t captured; /**< time the frame was captured by the driver or 0 if unknown */
+	uint64_t dequeued; /**< time the frame was received from the driver */
+	uint64_t decodeStart; /**< time the decoding started */
+	uint64_t decoded; /**< time the decoding finished */
+	size_t dropped; /**< number of frames dropped by the capture device since the previous frame */
+	uint8_t noise; /**< maximum difference per byte treated as compression noise (0 for lossless sources) */
+};
+
+
+/**
+ * Returns the current time of the monotonic clock used for CaptureTiming.
+ *
+ * @return time in microseconds
+ */
+inline uint64_t getCaptureTime() {
+	return uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+
 /**
  * Callback interface to be implemented to receive captured images.
  */
@@ -61,6 +109,137 @@ public:
 	 * @remarks This may be called from a different thread.
 	 */
 	virtual void onCapture(const pcf::color::Bgr24 * image, const size_t width, const size_t height, const CaptureOrientation orientation) = 0;
+
+	/**
+	 * Called with the captured image as packed YUYV array in the given dimensions.
+	 * Each array element holds two pixels.
+	 *
+	 * @param[in] image - image data
+	 * @param[in] width - image width (even)
+	 * @param[in] height - image height
+	 * @param[in] matrix - YUV to RGB conversion matrix
+	 * @param[in] range - YUV quantization range
+	 * @param[in] orientation - vertical row order of the image data
+	 * @remarks This may be called from a different thread.
+	 */
+	virtual void onCapture(const pcf::color::Yuyv * image, const size_t width, const size_t height, const CaptureYuvMatrix matrix, const CaptureYuvRange range, const CaptureOrientation orientation) = 0;
+
+	/**
+	 * Called with the captured image as packed UYVY array in the given dimensions.
+	 * Each array element holds two pixels.
+	 *
+	 * @param[in] image - image data
+	 * @param[in] width - image width (even)
+	 * @param[in] height - image height
+	 * @param[in] matrix - YUV to RGB conversion matrix
+	 * @param[in] range - YUV quantization range
+	 * @param[in] orientation - vertical row order of the image data
+	 * @remarks This may be called from a different thread.
+	 */
+	virtual void onCapture(const pcf::color::Uyvy * image, const size_t width, const size_t height, const CaptureYuvMatrix matrix, const CaptureYuvRange range, const CaptureOrientation orientation) = 0;
+
+	/**
+	 * Called with the captured image in planar NV12 format in the given dimensions.
+	 * The chroma plane holds interleaved U/V pairs with half the width and height
+	 * (rounded up) of the luma plane.
+	 *
+	 * @param[in] y - luma plane
+	 * @param[in] uv - interleaved chroma plane
+	 * @param[in] width - image width
+	 * @param[in] height - image height
+	 * @param[in] matrix - YUV to RGB conversion matrix
+	 * @param[in] range - YUV quantization range
+	 * @param[in] orientation - vertical row order of the image data
+	 * @remarks This may be called from a different thread.
+	 */
+	virtual void onCapture(const uint8_t * y, const uint8_t * uv, const size_t width, const size_t height, const CaptureYuvMatrix matrix, const CaptureYuvRange range, const CaptureOrientation orientation) = 0;
+
+	/**
+	 * Called with the captured image in planar I420 format in the given dimensions.
+	 * The chroma planes have half the width and height (rounded up) of the luma plane.
+	 *
+	 * @param[in] y - luma plane
+	 * @param[in] u - U chroma plane
+	 * @param[in] v - V chroma plane
+	 * @param[in] width - image width
+	 * @param[in] height - image height
+	 * @param[in] matrix - YUV to RGB conversion matrix
+	 * @param[in] range - YUV quantization range
+	 * @param[in] orientation - vertical row order of the image data
+	 * @remarks This may be called from a different thread.
+	 */
+	virtual void onCapture(const uint8_t * y, const uint8_t * u, const uint8_t * v, const size_t width, const size_t height, const CaptureYuvMatrix matrix, const CaptureYuvRange range, const CaptureOrientation orientation) = 0;
+
+	/**
+	 * Called with the captured image as RGB24 array which was scaled down from the given
+	 * source dimensions while decoding. The default implementation passes the image
+	 * on to onCapture().
+	 *
+	 * @param[in] image - image data
+	 * @param[in] width - image width
+	 * @param[in] height - image height
+	 * @param[in] srcWidth - source image width
+	 * @param[in] srcHeight - source image height
+	 * @param[in] orientation - vertical row order of the image data
+	 * @remarks This may be called from a different thread.
+	 */
+	virtual void onCaptureScaled(const pcf::color::Rgb24 * image, const size_t width, const size_t height, const size_t srcWidth, const size_t srcHeight, const CaptureOrientation orientation) {
+		(void)srcWidth;
+		(void)srcHeight;
+		this->onCapture(image, width, height, orientation);
+	}
+
+	/**
+	 * Returns the size in pixels at which the captured images are displayed. Capture
+	 * devices may use this to decode at a reduced resolution which is still at least as
+	 * large as the given size. The default implementation returns 0 for unknown.
+	 *
+	 * @param[out] width - display width
+	 * @param[out] height - display height
+	 * @remarks This may be called from a different thread.
+	 */
+	virtual void getDisplaySize(size_t & width, size_t & height) const {
+		width = 0;
+		height = 0;
+	}
+
+	/**
+	 * Called with the timing of the next captured image right before it is passed to
+	 * onCapture() or onCaptureScaled() from the same thread. Capture devices without
+	 * timing information do not call this. The default implementation does nothing.
+	 *
+	 * @param[in] timing - frame timing
+	 * @remarks This may be called from a different thread.
+	 */
+	virtual void onCaptureTiming(const CaptureTiming & timing) {
+		(void)timing;
+	}
+
+	/**
+	 * Returns a buffer into which the capture device may decode the next image before
+	 * passing it to onCapture() or onCaptureScaled(). This saves the callback from copying
+	 * the image. The buffer is only valid until the next onCapture() or onCaptureScaled()
+	 * call. The default implementation returns NULL to let the capture device use its
+	 * own buffer.
+	 *
+	 * @param[in] size - needed buffer size in bytes
+	 * @return buffer with at least `size` bytes or NULL
+	 * @remarks This may be called from a different thread.
+	 */
+	virtual void * getCaptureBuffer(const size_t size) {
+		(void)size;
+		return NULL;
+	}
+
+	/**
+	 * Called if the capture device stopped delivering images although it is still present,
+	 * e.g. because streaming could not be restarted after a source change. The capture
+	 * device needs to be stopped and started again to resume capturing. The default
+	 * implementation does nothing.
+	 *
+	 * @remarks This may be called from a different thread.
+	 */
+	virtual void onCaptureInterrupted() {}
 };
 
 
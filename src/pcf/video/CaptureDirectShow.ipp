@@ -2,7 +2,7 @@
  * @file CaptureDirectShow.ipp
  * @author Daniel Starke
  * @date 2019-10-03
- * @version 2026-06-14
+ * @version 2026-10-16
  * @todo rework with new MF API:
  *  - https://www.dreamincode.net/forums/topic/347938-a-new-webcam-api-tutorial-in-c-for-windows/
  *  - https://www.codeproject.com/Articles/776058/Capturing-Live-video-from-Web-camera-on-Windows-an
@@ -12,6 +12,7 @@
 #include <libpcf/cvutf8.h>
 #include <libpcf/tchar.h>
 #include <pcf/video/Capture.hpp>
+#include <pcf/video/CaptureTest.hpp>
 #include <pcf/ScopeExit.hpp>
 #include <pcf/UtilityWindows.hpp>
 #include <windows.h>
@@ -1674,6 +1675,9 @@ CaptureDeviceList NativeVideoCaptureProvider::getDeviceList() {
 	ComPtr<IMoniker> moniker;
 	CaptureDeviceList result;
 
+	/* add test capture devices enabled via environment variables */
+	addTestCaptureDevices(result);
+
 	/* instantiate enumerator for video input devices */
 	res = CoCreateInstance(CLSID_SystemDeviceEnum, NULL, CLSCTX_INPROC_SERVER, IID_ICreateDevEnum, &devEnum);
 	if ( FAILED(res) ) return result;
@@ -0,0 +1,985 @@
+/**
+ * @file CaptureTest.cpp
+ * @author Daniel Starke
+ * @date 2026-10-16
+ * @version 2026-10-16
+ */
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <libpcf/target.h>
+#include <pcf/video/CaptureTest.hpp>
+#ifdef PCF_IS_LINUX
+extern "C" {
+#include <turbojpeg.h>
+}
+#endif /* PCF_IS_LINUX */
+
+
+/** Minimum test capture frame width and height in pixels. */
+#define PCF_TEST_MIN_SIZE 16
+
+
+/** Maximum test capture frame width and height in pixels. */
+#define PCF_TEST_MAX_SIZE 8192
+
+
+/** Maximum test capture frame rate. */
+#define PCF_TEST_MAX_FPS 1000
+
+
+/** Horizontal and vertical movement of the moving box and scrolling image in pixels per frame. */
+#define PCF_TEST_PATTERN_STEP 8
+
+
+/** Number of frame counter bits drawn by the moving pattern. */
+#define PCF_TEST_PATTERN_COUNTER_BITS 16
+
+
+namespace pcf {
+namespace video {
+namespace {
+
+
+/** Configuration value names of TestCaptureFormat. */
+const char * const formatNames[] = {"rgb24", "bgr24", "yuyv", "uyvy", "nv12", "i420", "mjpeg"};
+
+
+/** Configuration value names of PatternCaptureDevice::Pattern. */
+const char * const patternNames[] = {"static", "moving", "full"};
+
+
+/**
+ * Single image plane of a frame format.
+ */
+struct FramePlane {
+	size_t offset; /**< byte offset of the plane within the frame */
+	size_t stride; /**< bytes per row */
+	size_t bytesNum; /**< numerator of the bytes per pixel */
+	size_t bytesDen; /**< denominator of the bytes per pixel */
+	size_t rowDen; /**< vertical subsampling factor */
+};
+
+
+/**
+ * Describes the planes of the given frame format.
+ *
+ * @param[in] fmt - frame format (not TCF_MJPEG)
+ * @param[in] w - frame width in pixels (even)
+ * @param[in] h - frame height in pixels (even)
+ * @param[out] planes - receives the plane descriptions
+ * @return number of planes
+ */
+size_t getFramePlanes(const TestCaptureFormat fmt, const size_t w, const size_t h, FramePlane (& planes)[3]) {
+	switch (fmt) {
+	case TCF_RGB24:
+	case TCF_BGR24:
+		planes[0] = FramePlane{0, w * 3, 3, 1, 1};
+		return 1;
+	case TCF_YUYV:
+	case TCF_UYVY:
+		planes[0] = FramePlane{0, w * 2, 2, 1, 1};
+		return 1;
+	case TCF_NV12:
+		planes[0] = FramePlane{0, w, 1, 1, 1};
+		planes[1] = FramePlane{w * h, w, 1, 1, 2};
+		return 2;
+	case TCF_I420:
+		planes[0] = FramePlane{0, w, 1, 1, 1};
+		planes[1] = FramePlane{w * h, w / 2, 1, 2, 2};
+		planes[2] = FramePlane{(w * h) + ((w / 2) * (h / 2)), w / 2, 1, 2, 2};
+		return 3;
+	default:
+		return 0;
+	}
+}
+
+
+/**
+ * Returns whether the given value equals the given null-terminated string.
+ *
+ * @param[in] value - value to compare
+ * @param[in] valueLen - length of `value`
+ * @param[in] str - string to compare with
+ * @return true on match, else false
+ */
+inline bool matches(const char * value, const size_t valueLen, const char * str) {
+	return strlen(str) == valueLen && strncmp(value, str, valueLen) == 0;
+}
+
+
+/**
+ * Parses an unsigned decimal configuration value.
+ *
+ * @param[in] value - configuration value
+ * @param[in] valueLen - length of `value`
+ * @param[in] minVal - minimum allowed value
+ * @param[in] maxVal - maximum allowed value
+ * @param[out] out - receives the parsed value
+ * @return parsing result
+ */
+CaptureDevice::ReturnCode parseUnsigned(const char * value, const size_t valueLen, const unsigned long minVal, const unsigned long maxVal, unsigned long & out) {
+	char * numEnd = NULL;
+	if (valueLen == 0 || value[0] < '0' || value[0] > '9') return CaptureDevice::RC_ERROR_INV_SYNTAX;
+	const unsigned long num = strtoul(value, &numEnd, 10);
+	if (numEnd != (value + valueLen)) return CaptureDevice::RC_ERROR_INV_SYNTAX;
+	if (num < minVal || num > maxVal) return CaptureDevice::RC_ERROR_INV_ARG;
+	out = num;
+	return CaptureDevice::RC_SUCCESS;
+}
+
+
+/**
+ * Parses the given semicolon separated list of `key=value` pairs and calls the
+ * passed function for each pair. The function returns whether the key is known
+ * and sets the result.
+ *
+ * @param[in] val - configuration to parse
+ * @param[out] errPos - optionally sets the parsing position on error
+ * @param[in] fn - function called for each pair
+ * @return success state
+ * @tparam Fn - function type `bool (const char *, size_t, const char *, size_t, ReturnCode &)`
+ */
+template <typename Fn>
+CaptureDevice::ReturnCode parseConfiguration(const char * val, const char ** errPos, Fn fn) {
+	const char * ptr = val;
+	while (*ptr != 0) {
+		const char * key = ptr;
+		const char * sep = key + strcspn(key, "=;");
+		if (*sep != '=' || sep == key) {
+			if (errPos != NULL) *errPos = key;
+			return CaptureDevice::RC_ERROR_INV_SYNTAX;
+		}
+		const char * value = sep + 1;
+		const char * end = value + strcspn(value, ";");
+		CaptureDevice::ReturnCode res = CaptureDevice::RC_SUCCESS;
+		if ( ! fn(key, size_t(sep - key), value, size_t(end - value), res) ) {
+			if (errPos != NULL) *errPos = key;
+			return CaptureDevice::RC_ERROR_INV_ARG;
+		}
+		if (res != CaptureDevice::RC_SUCCESS) {
+			if (errPos != NULL) *errPos = value;
+			return res;
+		}
+		ptr = (*end == ';') ? end + 1 : end;
+	}
+	return CaptureDevice::RC_SUCCESS;
+}
+
+
+/**
+ * Returns a heap allocated copy of the given configuration string.
+ *
+ * @param[in] buf - configuration string
+ * @param[in] len - return value of snprintf() which created `buf`
+ * @param[in] size - size of `buf` in bytes
+ * @return copy of `buf` or NULL on error
+ */
+char * copyConfiguration(const char * buf, const int len, const size_t size) {
+	if (len <= 0 || size_t(len) >= size) return NULL;
+	char * res = static_cast<char *>(malloc(size_t(len + 1) * sizeof(char)));
+	if (res != NULL) memcpy(res, buf, size_t(len + 1) * sizeof(char));
+	return res;
+}
+
+
+/**
+ * Returns a heap allocated copy of the given string.
+ *
+ * @param[in] str - string to copy
+ * @return copy of `str` or NULL if `str` is NULL or on allocation failure
+ */
+char * copyString(const char * str) {
+	if (str == NULL) return NULL;
+	const size_t len = strlen(str) + 1;
+	char * res = static_cast<char *>(malloc(len * sizeof(char)));
+	if (res != NULL) memcpy(res, str, len * sizeof(char));
+	return res;
+}
+
+
+/**
+ * Returns the position of a triangle wave which bounces between 0 and `range`.
+ *
+ * @param[in] t - linear position
+ * @param[in] range - upper limit
+ * @return position within 0 and `range`
+ */
+inline size_t bounce(const uint64_t t, const size_t range) {
+	if (range == 0) return 0;
+	const size_t pos = size_t(t % (2 * uint64_t(range)));
+	return (pos > range) ? (2 * range) - pos : pos;
+}
+
+
+} /* anonymous namespace */
+
+
+TestCaptureDevice::TestCaptureDevice(const char * p, const char * n):
+	CaptureDevice(),
+	devicePath(copyString(p)),
+	deviceName(copyString(n)),
+	settings(Settings{1920, 1080, 60, TCF_YUYV}),
+	active(Settings{1920, 1080, 60, TCF_YUYV}),
+	stopping(false)
+{}
+
+
+TestCaptureDevice::TestCaptureDevice(const TestCaptureDevice & o):
+	CaptureDevice(),
+	devicePath(copyString(o.devicePath)),
+	deviceName(copyString(o.deviceName)),
+	settings(o.settings),
+	active(o.settings),
+	stopping(false)
+{}
+
+
+TestCaptureDevice::~TestCaptureDevice() {
+	this->stop();
+	if (this->devicePath != NULL) free(this->devicePath);
+	if (this->deviceName != NULL) free(this->deviceName);
+}
+
+
+/**
+ * Starts the video capture procedure with this device.
+ *
+ * @param[in,out] wnd - use this parent window
+ * @param[in] cb - send capture images to this callback
+ * @return true on success, else false
+ */
+bool TestCaptureDevice::start(Window /* wnd */, CaptureCallback & cb) {
+	if ( ! this->mutex.try_lock() ) return false;
+	std::lock_guard<std::mutex> guard(this->mutex, std::adopt_lock);
+	this->stopInternal();
+	this->callback = &cb;
+	this->active = this->settings;
+	if ( ! this->prepare() ) {
+		this->release();
+		return false;
+	}
+	this->stopping = false;
+	this->thread = std::thread(&TestCaptureDevice::threadProc, this);
+	this->running = true;
+	return true;
+}
+
+
+/**
+ * Stops the video capture procedure.
+ *
+ * @return true on success, else false
+ */
+bool TestCaptureDevice::stop() {
+	std::lock_guard<std::mutex> guard(this->mutex);
+	return this->stopInternal();
+}
+
+
+size_t TestCaptureDevice::getFrameSize(const TestCaptureFormat fmt, const size_t w, const size_t h) {
+	switch (fmt) {
+	case TCF_RGB24:
+	case TCF_BGR24:
+		return w * h * 3;
+	case TCF_YUYV:
+	case TCF_UYVY:
+		return w * h * 2;
+	case TCF_NV12:
+	case TCF_I420:
+		return (w * h) + (2 * ((w + 1) / 2) * ((h + 1) / 2));
+	default:
+		return 0;
+	}
+}
+
+
+void TestCaptureDevice::forward(const uint8_t * data, const CaptureTiming & timing) {
+	const size_t w = this->active.width;
+	const size_t h = this->active.height;
+	CaptureCallback * cb = this->callback;
+	cb->onCaptureTiming(timing);
+	switch (this->active.format) {
+	case TCF_RGB24:
+		cb->onCapture(reinterpret_cast<const pcf::color::Rgb24 *>(data), w, h, CO_TOP_DOWN);
+		break;
+	case TCF_BGR24:
+		cb->onCapture(reinterpret_cast<const pcf::color::Bgr24 *>(data), w, h, CO_TOP_DOWN);
+		break;
+	case TCF_YUYV:
+		cb->onCapture(reinterpret_cast<const pcf::color::Yuyv *>(data), w, h, CYM_BT601, CYR_LIMITED, CO_TOP_DOWN);
+		break;
+	case TCF_UYVY:
+		cb->onCapture(reinterpret_cast<const pcf::color::Uyvy *>(data), w, h, CYM_BT601, CYR_LIMITED, CO_TOP_DOWN);
+		break;
+	case TCF_NV12:
+		cb->onCapture(data, data + (w * h), w, h, CYM_BT601, CYR_LIMITED, CO_TOP_DOWN);
+		break;
+	case TCF_I420:
+		cb->onCapture(data, data + (w * h), data + (w * h) + ((w / 2) * (h / 2)), w, h, CYM_BT601, CYR_LIMITED, CO_TOP_DOWN);
+		break;
+	default:
+		break;
+	}
+}
+
+
+bool TestCaptureDevice::setCommonValue(Settings & s, const char * key, const size_t keyLen, const char * value, const size_t valueLen, const TestCaptureFormat maxFormat, ReturnCode & res) {
+	unsigned long num = 0;
+	if ( matches(key, keyLen, "width") ) {
+		res = parseUnsigned(value, valueLen, PCF_TEST_MIN_SIZE, PCF_TEST_MAX_SIZE, num);
+		if (res == RC_SUCCESS && (num & 1) != 0) res = RC_ERROR_INV_ARG;
+		if (res == RC_SUCCESS) s.width = size_t(num);
+	} else if ( matches(key, keyLen, "height") ) {
+		res = parseUnsigned(value, valueLen, PCF_TEST_MIN_SIZE, PCF_TEST_MAX_SIZE, num);
+		if (res == RC_SUCCESS && (num & 1) != 0) res = RC_ERROR_INV_ARG;
+		if (res == RC_SUCCESS) s.height = size_t(num);
+	} else if ( matches(key, keyLen, "fps") ) {
+		res = parseUnsigned(value, valueLen, 0, PCF_TEST_MAX_FPS, num);
+		if (res == RC_SUCCESS) s.fps = unsigned(num);
+	} else if ( matches(key, keyLen, "format") ) {
+		res = RC_ERROR_INV_ARG;
+		for (int n = 0; n <= int(maxFormat); n++) {
+			if ( matches(value, valueLen, formatNames[n]) ) {
+				s.format = TestCaptureFormat(n);
+				res = RC_SUCCESS;
+				break;
+			}
+		}
+	} else {
+		return false;
+	}
+	return true;
+}
+
+
+int TestCaptureDevice::getCommonConfiguration(char * buf, const size_t size) const {
+	return snprintf(buf, size, "width=%u;height=%u;fps=%u;format=%s", unsigned(this->settings.width), unsigned(this->settings.height), this->settings.fps, formatNames[this->settings.format]);
+}
+
+
+/**
+ * Background thread which produces the frames at the configured frame rate. The schedule
+ * is re-synchronized if frame production falls behind by more than one frame. The frames
+ * missed by this are reported as dropped.
+ */
+void TestCaptureDevice::threadProc() {
+	typedef std::chrono::steady_clock Clock;
+	const Clock::duration period = (this->active.fps > 0) ? std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds(1000000000 / this->active.fps)) : Clock::duration::zero();
+	Clock::time_point next = Clock::now();
+	size_t dropped = 0;
+	for (uint64_t index = 0; ; index++) {
+		{
+			std::unique_lock<std::mutex> lock(this->stopMutex);
+			if ( this->stopSignal.wait_until(lock, next, [this]() { return this->stopping; }) ) break;
+		}
+		CaptureTiming timing;
+		timing.captured = getCaptureTime();
+		timing.dequeued = timing.captured;
+		timing.decodeStart = timing.captured;
+		timing.decoded = timing.captured;
+		timing.dropped = dropped;
+		timing.noise = 0;
+		if ( ! this->produce(index, timing) ) break;
+		if (period == Clock::duration::zero()) continue;
+		next += period;
+		const Clock::time_point now = Clock::now();
+		if (now > (next + period)) {
+			dropped = size_t((now - next) / period);
+			next = now;
+		} else {
+			dropped = 0;
+		}
+	}
+}
+
+
+/**
+ * Internal helper method to stop capturing.
+ * The caller needs to hold a lock to the mutex.
+ *
+ * @return true on success, else false
+ */
+bool TestCaptureDevice::stopInternal() {
+	if ( this->thread.joinable() ) {
+		{
+			std::lock_guard<std::mutex> lock(this->stopMutex);
+			this->stopping = true;
+		}
+		this->stopSignal.notify_all();
+		this->thread.join();
+		this->release();
+	}
+	this->running = false;
+	return true;
+}
+
+
+PatternCaptureDevice::PatternCaptureDevice():
+	Base("test:pattern", "Test Pattern"),
+	pattern(P_MOVING),
+	activePattern(P_MOVING),
+	boxX(0),
+	boxY(0),
+	boxDrawn(false)
+{}
+
+
+PatternCaptureDevice::PatternCaptureDevice(const PatternCaptureDevice & o):
+	Base(o),
+	pattern(o.pattern),
+	activePattern(o.pattern),
+	boxX(0),
+	boxY(0),
+	boxDrawn(false)
+{}
+
+
+PatternCaptureDevice::~PatternCaptureDevice() {
+	/* stop here as the background thread calls our produce() */
+	this->stop();
+}
+
+
+char * PatternCaptureDevice::getConfiguration() {
+	std::lock_guard<std::mutex> guard(this->mutex);
+	char buf[128];
+	const int len = this->getCommonConfiguration(buf, sizeof(buf));
+	if (len <= 0 || size_t(len) >= sizeof(buf)) return NULL;
+	const int len2 = snprintf(buf + len, sizeof(buf) - size_t(len), ";pattern=%s", patternNames[this->pattern]);
+	return copyConfiguration(buf, len + len2, sizeof(buf));
+}
+
+
+PatternCaptureDevice::ReturnCode PatternCaptureDevice::setConfiguration(const char * val, const char ** errPos) {
+	if (val == NULL) return RC_ERROR_INV_ARG;
+	std::lock_guard<std::mutex> guard(this->mutex);
+	Settings newSettings = this->settings;
+	Pattern newPattern = this->pattern;
+	const ReturnCode res = parseConfiguration(val, errPos, [&](const char * key, const size_t keyLen, const char * value, const size_t valueLen, ReturnCode & result) -> bool {
+		if ( setCommonValue(newSettings, key, keyLen, value, valueLen, TCF_I420, result) ) return true;
+		if ( ! matches(key, keyLen, "pattern") ) return false;
+		result = RC_ERROR_INV_ARG;
+		for (int n = 0; n <= int(P_FULL); n++) {
+			if ( matches(value, valueLen, patternNames[n]) ) {
+				newPattern = Pattern(n);
+				result = RC_SUCCESS;
+				break;
+			}
+		}
+		return true;
+	});
+	if (res != RC_SUCCESS) return res;
+	this->settings = newSettings;
+	this->pattern = newPattern;
+	return RC_SUCCESS;
+}
+
+
+/**
+ * Draws the background image with color bars above a gray ramp.
+ *
+ * @return true on success, else false
+ */
+bool PatternCaptureDevice::prepare() {
+	static const uint8_t bars[8][3] = {
+		{255, 255, 255}, {255, 255, 0}, {0, 255, 255}, {0, 255, 0},
+		{255, 0, 255}, {255, 0, 0}, {0, 0, 255}, {0, 0, 0}
+	};
+	const size_t w = this->active.width;
+	const size_t h = this->active.height;
+	this->activePattern = this->pattern;
+	try {
+		this->background.assign(getFrameSize(this->active.format, w, h), 0);
+	} catch (...) {
+		fprintf(stderr, "Error: failed to allocate the test pattern background image\n");
+		return false;
+	}
+	const size_t barHeight = ((h * 3) / 4) & ~size_t(1);
+	for (size_t n = 0; n < 8; n++) {
+		const size_t x0 = ((w * n) / 8) & ~size_t(1);
+		const size_t x1 = ((w * (n + 1)) / 8) & ~size_t(1);
+		this->fillRect(this->background, x0, 0, x1 - x0, barHeight, bars[n][0], bars[n][1], bars[n][2]);
+	}
+	for (size_t n = 0; n < 16; n++) {
+		const size_t x0 = ((w * n) / 16) & ~size_t(1);
+		const size_t x1 = ((w * (n + 1)) / 16) & ~size_t(1);
+		const uint8_t gray = uint8_t(n * 17);
+		this->fillRect(this->background, x0, barHeight, x1 - x0, h - barHeight, gray, gray, gray);
+	}
+	this->frame = this->background;
+	this->boxDrawn = false;
+	return true;
+}
+
+
+bool PatternCaptureDevice::produce(const uint64_t index, CaptureTiming & timing) {
+	const size_t w = this->active.width;
+	const size_t h = this->active.height;
+	if (this->activePattern == P_STATIC) {
+		this->forward(this->background.data(), timing);
+		return true;
+	}
+	if (this->activePattern == P_MOVING) {
+		const size_t boxW = std::max(size_t(2), (w / 8) & ~size_t(1));
+		const size_t boxH = std::max(size_t(2), (h / 8) & ~size_t(1));
+		if ( this->boxDrawn ) this->copyRect(this->boxX, this->boxY, boxW, boxH);
+		this->boxX = bounce(index * PCF_TEST_PATTERN_STEP, w - boxW) & ~size_t(1);
+		this->boxY = bounce(index * PCF_TEST_PATTERN_STEP, h - boxH) & ~size_t(1);
+		this->fillRect(this->frame, this->boxX, this->boxY, boxW, boxH, 255, 128, 0);
+		this->boxDrawn = true;
+	} else {
+		/* P_FULL */
+		this->scroll(size_t((index * PCF_TEST_PATTERN_STEP) % w) & ~size_t(1));
+	}
+	/* frame counter as binary blocks at the bottom left to detect lost or repeated frames */
+	const size_t bit = std::max(size_t(2), (std::min(w, h) / 64) & ~size_t(1));
+	for (size_t n = 0; n < PCF_TEST_PATTERN_COUNTER_BITS && ((n + 1) * bit) <= w; n++) {
+		const uint8_t value = ((index >> (PCF_TEST_PATTERN_COUNTER_BITS - 1 - n)) & 1) ? 255 : 0;
+		this->fillRect(this->frame, n * bit, h - bit, bit, bit, value, value, value);
+	}
+	timing.decoded = getCaptureTime();
+	this->forward(this->frame.data(), timing);
+	return true;
+}
+
+
+void PatternCaptureDevice::release() {
+	std::vector<uint8_t>().swap(this->background);
+	std::vector<uint8_t>().swap(this->frame);
+}
+
+
+/**
+ * Fills the given rectangle with a solid color. The rectangle is extended to even
+ * coordinates to cover whole chroma samples.
+ *
+ * @param[in,out] image - image to draw into
+ * @param[in] x - left edge in pixels
+ * @param[in] y - top edge in pixels
+ * @param[in] w - width in pixels
+ * @param[in] h - height in pixels
+ * @param[in] r - red component
+ * @param[in] g - green component
+ * @param[in] b - blue component
+ */
+void PatternCaptureDevice::fillRect(std::vector<uint8_t> & image, size_t x, size_t y, size_t w, size_t h, const uint8_t r, const uint8_t g, const uint8_t b) const {
+	const size_t width = this->active.width;
+	const size_t height = this->active.height;
+	if (x >= width || y >= height) return;
+	w = (std::min(w, width - x) + (x & 1) + 1) & ~size_t(1);
+	h = (std::min(h, height - y) + (y & 1) + 1) & ~size_t(1);
+	x &= ~size_t(1);
+	y &= ~size_t(1);
+	w = std::min(w, width - x);
+	h = std::min(h, height - y);
+	/* ITU-R BT.601 with limited quantization range */
+	const uint8_t yc = uint8_t(((66 * int(r)) + (129 * int(g)) + (25 * int(b)) + 4224) >> 8);
+	const uint8_t uc = uint8_t(((-38 * int(r)) - (74 * int(g)) + (112 * int(b)) + 32896) >> 8);
+	const uint8_t vc = uint8_t(((112 * int(r)) - (94 * int(g)) - (18 * int(b)) + 32896) >> 8);
+	uint8_t * data = image.data();
+	switch (this->active.format) {
+	case TCF_RGB24:
+	case TCF_BGR24:
+		{
+			const uint8_t c0 = (this->active.format == TCF_RGB24) ? r : b;
+			const uint8_t c2 = (this->active.format == TCF_RGB24) ? b : r;
+			for (size_t row = y; row < (y + h); row++) {
+				uint8_t * ptr = data + (row * width * 3) + (x * 3);
+				for (size_t col = 0; col < w; col++, ptr += 3) {
+					ptr[0] = c0;
+					ptr[1] = g;
+					ptr[2] = c2;
+				}
+			}
+		}
+		break;
+	case TCF_YUYV:
+	case TCF_UYVY:
+		{
+			const uint8_t pair[4] = {
+				(this->active.format == TCF_YUYV) ? yc : uc,
+				(this->active.format == TCF_YUYV) ? uc : yc,
+				(this->active.format == TCF_YUYV) ? yc : vc,
+				(this->active.format == TCF_YUYV) ? vc : yc
+			};
+			for (size_t row = y; row < (y + h); row++) {
+				uint8_t * ptr = data + (row * width * 2) + (x * 2);
+				for (size_t col = 0; col < w; col += 2, ptr += 4) memcpy(ptr, pair, 4);
+			}
+		}
+		break;
+	case TCF_NV12:
+		for (size_t row = y; row < (y + h); row++) memset(data + (row * width) + x, yc, w);
+		for (size_t row = (y / 2); row < ((y + h) / 2); row++) {
+			uint8_t * ptr = data + (width * height) + (row * width) + x;
+			for (size_t col = 0; col < w; col += 2, ptr += 2) {
+				ptr[0] = uc;
+				ptr[1] = vc;
+			}
+		}
+		break;
+	case TCF_I420:
+		for (size_t row = y; row < (y + h); row++) memset(data + (row * width) + x, yc, w);
+		for (size_t row = (y / 2); row < ((y + h) / 2); row++) {
+			memset(data + (width * height) + (row * (width / 2)) + (x / 2), uc, w / 2);
+			memset(data + (width * height) + ((width / 2) * (height / 2)) + (row * (width / 2)) + (x / 2), vc, w / 2);
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+
+/**
+ * Restores the given rectangle of the current frame from the background image.
+ *
+ * @param[in] x - left edge in pixels (even)
+ * @param[in] y - top edge in pixels (even)
+ * @param[in] w - width in pixels (even)
+ * @param[in] h - height in pixels (even)
+ */
+void PatternCaptureDevice::copyRect(size_t x, size_t y, size_t w, size_t h) {
+	FramePlane planes[3];
+	const size_t count = getFramePlanes(this->active.format, this->active.width, this->active.height, planes);
+	w = std::min(w, this->active.width - x);
+	h = std::min(h, this->active.height - y);
+	for (size_t n = 0; n < count; n++) {
+		const FramePlane & plane = planes[n];
+		const size_t first = (x * plane.bytesNum) / plane.bytesDen;
+		const size_t bytes = (w * plane.bytesNum) / plane.bytesDen;
+		for (size_t row = (y / plane.rowDen); row < ((y + h) / plane.rowDen); row++) {
+			const size_t offset = plane.offset + (row * plane.stride) + first;
+			memcpy(this->frame.data() + offset, this->background.data() + offset, bytes);
+		}
+	}
+}
+
+
+/**
+ * Sets the current frame to the background image rotated to the left.
+ *
+ * @param[in] shift - rotation in pixels (even)
+ */
+void PatternCaptureDevice::scroll(const size_t shift) {
+	FramePlane planes[3];
+	const size_t count = getFramePlanes(this->active.format, this->active.width, this->active.height, planes);
+	for (size_t n = 0; n < count; n++) {
+		const FramePlane & plane = planes[n];
+		const size_t bytes = (shift * plane.bytesNum) / plane.bytesDen;
+		const size_t rows = this->active.height / plane.rowDen;
+		for (size_t row = 0; row < rows; row++) {
+			const uint8_t * src = this->background.data() + plane.offset + (row * plane.stride);
+			uint8_t * dst = this->frame.data() + plane.offset + (row * plane.stride);
+			memcpy(dst, src + bytes, plane.stride - bytes);
+			memcpy(dst + plane.stride - bytes, src, bytes);
+		}
+	}
+}
+
+
+ReplayCaptureDevice::ReplayCaptureDevice():
+	Base("test:replay", "Test Replay"),
+	filePath(NULL),
+	loop(true),
+	activeLoop(true),
+	fp(NULL),
+	position(0),
+	jpeg(NULL),
+	decodeFailureReported(false)
+{
+	this->settings.fps = 30;
+}
+
+
+ReplayCaptureDevice::ReplayCaptureDevice(const ReplayCaptureDevice & o):
+	Base(o),
+	filePath(copyString(o.filePath)),
+	loop(o.loop),
+	activeLoop(o.loop),
+	fp(NULL),
+	position(0),
+	jpeg(NULL),
+	decodeFailureReported(false)
+{}
+
+
+ReplayCaptureDevice::~ReplayCaptureDevice() {
+	/* stop here as the background thread calls our produce() */
+	this->stop();
+	if (this->filePath != NULL) free(this->filePath);
+}
+
+
+char * ReplayCaptureDevice::getConfiguration() {
+	std::lock_guard<std::mutex> guard(this->mutex);
+	const size_t size = 128 + ((this->filePath != NULL) ? strlen(this->filePath) : 0);
+	char * buf = static_cast<char *>(malloc(size * sizeof(char)));
+	if (buf == NULL) return NULL;
+	const int len = this->getCommonConfiguration(buf, size);
+	if (len <= 0 || size_t(len) >= size) {
+		free(buf);
+		return NULL;
+	}
+	const int len2 = snprintf(buf + len, size - size_t(len), ";loop=%s;file=%s", this->loop ? "yes" : "no", (this->filePath != NULL) ? this->filePath : "");
+	if (len2 <= 0 || size_t(len + len2) >= size) {
+		free(buf);
+		return NULL;
+	}
+	return buf;
+}
+
+
+ReplayCaptureDevice::ReturnCode ReplayCaptureDevice::setConfiguration(const char * val, const char ** errPos) {
+	if (val == NULL) return RC_ERROR_INV_ARG;
+	std::lock_guard<std::mutex> guard(this->mutex);
+	Settings newSettings = this->settings;
+	bool newLoop = this->loop;
+	const char * newFile = NULL;
+	size_t newFileLen = 0;
+	const ReturnCode res = parseConfiguration(val, errPos, [&](const char * key, const size_t keyLen, const char * value, const size_t valueLen, ReturnCode & result) -> bool {
+		if ( setCommonValue(newSettings, key, keyLen, value, valueLen, TCF_MJPEG, result) ) return true;
+		if ( matches(key, keyLen, "loop") ) {
+			if ( matches(value, valueLen, "yes") ) {
+				newLoop = true;
+			} else if ( matches(value, valueLen, "no") ) {
+				newLoop = false;
+			} else {
+				result = RC_ERROR_INV_ARG;
+			}
+			return true;
+		}
+		if ( matches(key, keyLen, "file") ) {
+			if (valueLen == 0) result = RC_ERROR_INV_ARG;
+			newFile = value;
+			newFileLen = valueLen;
+			return true;
+		}
+		return false;
+	});
+	if (res != RC_SUCCESS) return res;
+	if (newFile != NULL) {
+		char * path = static_cast<char *>(malloc((newFileLen + 1) * sizeof(char)));
+		if (path == NULL) return RC_ERROR_INV_ARG;
+		memcpy(path, newFile, newFileLen * sizeof(char));
+		path[newFileLen] = 0;
+		if (this->filePath != NULL) free(this->filePath);
+		this->filePath = path;
+	}
+	this->settings = newSettings;
+	this->loop = newLoop;
+	return RC_SUCCESS;
+}
+
+
+/**
+ * Opens the configured file. MJPEG files are loaded completely and split into their
+ * JPEG images.
+ *
+ * @return true on success, else false
+ */
+bool ReplayCaptureDevice::prepare() {
+	if (this->filePath == NULL) {
+		fprintf(stderr, "Error: no file configured for the replay capture device\n");
+		return false;
+	}
+	this->activeLoop = this->loop;
+	this->decodeFailureReported = false;
+	this->position = 0;
+	this->fp = fopen(this->filePath, "rb");
+	if (this->fp == NULL) {
+		fprintf(stderr, "Error: failed to open \"%s\" for replay (%s)\n", this->filePath, strerror(errno));
+		return false;
+	}
+	if (this->active.format != TCF_MJPEG) {
+		try {
+			this->data.resize(getFrameSize(this->active.format, this->active.width, this->active.height));
+		} catch (...) {
+			fprintf(stderr, "Error: failed to allocate the replay frame buffer\n");
+			return false;
+		}
+		return true;
+	}
+#ifdef PCF_IS_LINUX
+	/* load the whole file and find the JPEG images by their SOI and EOI markers */
+	uint8_t chunk[65536];
+	size_t bytesRead;
+	while ((bytesRead = fread(chunk, 1, sizeof(chunk), this->fp)) > 0) {
+		this->data.insert(this->data.end(), chunk, chunk + bytesRead);
+	}
+	fclose(this->fp);
+	this->fp = NULL;
+	const uint8_t * ptr = this->data.data();
+	const size_t size = this->data.size();
+	for (size_t n = 0; (n + 1) < size; n++) {
+		if (ptr[n] != 0xFF || ptr[n + 1] != 0xD8) continue;
+		size_t end = n + 2;
+		while ((end + 1) < size && (ptr[end] != 0xFF || ptr[end + 1] != 0xD9)) end++;
+		if ((end + 1) >= size) break; /* truncated image */
+		this->offsets.push_back(n);
+		this->offsets.push_back(end + 2);
+		n = end + 1;
+	}
+	if ( this->offsets.empty() ) {
+		fprintf(stderr, "Error: \"%s\" contains no JPEG images\n", this->filePath);
+		return false;
+	}
+	this->jpeg = tjInitDecompress();
+	if (this->jpeg == NULL) {
+		fprintf(stderr, "Error: tjInitDecompress failed (%s)\n", tjGetErrorStr2(NULL));
+		return false;
+	}
+	return true;
+#else /* ! PCF_IS_LINUX */
+	fprintf(stderr, "Error: MJPEG replay is not supported on this platform\n");
+	return false;
+#endif /* PCF_IS_LINUX */
+}
+
+
+bool ReplayCaptureDevice::produce(const uint64_t /* index */, CaptureTiming & timing) {
+	if (this->active.format == TCF_MJPEG) {
+		if ((this->position * 2) >= this->offsets.size()) {
+			if ( ! this->activeLoop ) return false;
+			this->position = 0;
+		}
+		const size_t first = this->offsets[this->position * 2];
+		const size_t last = this->offsets[(this->position * 2) + 1];
+		this->position++;
+		return this->decodeJpeg(this->data.data() + first, last - first, timing);
+	}
+	const size_t size = this->data.size();
+	if (fread(this->data.data(), 1, size, this->fp) != size) {
+		if ( ! this->activeLoop ) return false;
+		rewind(this->fp);
+		if (fread(this->data.data(), 1, size, this->fp) != size) {
+			fprintf(stderr, "Error: \"%s\" contains no complete frame\n", this->filePath);
+			return false;
+		}
+	}
+	timing.decoded = getCaptureTime();
+	this->forward(this->data.data(), timing);
+	return true;
+}
+
+
+void ReplayCaptureDevice::release() {
+	if (this->fp != NULL) {
+		fclose(this->fp);
+		this->fp = NULL;
+	}
+#ifdef PCF_IS_LINUX
+	if (this->jpeg != NULL) {
+		tjDestroy(static_cast<tjhandle>(this->jpeg));
+		this->jpeg = NULL;
+	}
+#endif /* PCF_IS_LINUX */
+	std::vector<uint8_t>().swap(this->data);
+	std::vector<size_t>().swap(this->offsets);
+	std::vector<uint8_t>().swap(this->decoded);
+}
+
+
+/**
+ * Decodes the given JPEG image to RGB24 and passes it to the callback. The image is
+ * decoded at 1/2 or 1/4 scale if the result still covers the display size reported by
+ * the callback, like the native capture device does.
+ *
+ * @param[in] src - JPEG image data
+ * @param[in] srcSize - number of bytes in `src`
+ * @param[in,out] timing - frame timing
+ * @return true to continue, false to end the stream
+ */
+bool ReplayCaptureDevice::decodeJpeg(const uint8_t * src, const size_t srcSize, CaptureTiming & timing) {
+#ifdef PCF_IS_LINUX
+	tjhandle handle = static_cast<tjhandle>(this->jpeg);
+	CaptureCallback * cb = this->callback;
+	int jpegWidth, jpegHeight, jpegSubsamp, jpegColorspace;
+	const char * error = NULL;
+	if (tjDecompressHeader3(handle, src, static_cast<unsigned long>(srcSize), &jpegWidth, &jpegHeight, &jpegSubsamp, &jpegColorspace) != 0) {
+		error = tjGetErrorStr2(handle);
+	}
+	size_t dispWidth, dispHeight;
+	cb->getDisplaySize(dispWidth, dispHeight);
+	int outWidth = jpegWidth;
+	int outHeight = jpegHeight;
+	if (error == NULL && dispWidth > 0 && dispHeight > 0) {
+		for (int denom = 4; denom > 1; denom /= 2) {
+			const tjscalingfactor factor = {1, denom};
+			const int scaledWidth = TJSCALED(jpegWidth, factor);
+			const int scaledHeight = TJSCALED(jpegHeight, factor);
+			if (size_t(scaledWidth) >= dispWidth && size_t(scaledHeight) >= dispHeight) {
+				outWidth = scaledWidth;
+				outHeight = scaledHeight;
+				break;
+			}
+		}
+	}
+	uint8_t * dest = NULL;
+	if (error == NULL) {
+		const size_t bytes = size_t(outWidth) * size_t(outHeight) * 3;
+		dest = static_cast<uint8_t *>(cb->getCaptureBuffer(bytes));
+		if (dest == NULL) {
+			if (this->decoded.size() < bytes) this->decoded.resize(bytes);
+			dest = this->decoded.data();
+		}
+		if (tjDecompress2(handle, src, static_cast<unsigned long>(srcSize), dest, outWidth, 0, outHeight, TJPF_RGB, TJFLAG_FASTDCT) != 0) {
+			/* corrupt data warnings still yield an image */
+			if (tjGetErrorCode(handle) != TJERR_WARNING) error = tjGetErrorStr2(handle);
+		}
+	}
+	timing.decoded = getCaptureTime();
+	if (error != NULL) {
+		if ( ! this->decodeFailureReported ) {
+			fprintf(stderr, "Warning: failed to decode MJPEG frame (%s)\n", error);
+			this->decodeFailureReported = true;
+		}
+		return true;
+	}
+	timing.noise = PCF_CAPTURE_JPEG_NOISE;
+	cb->onCaptureTiming(timing);
+	if (outWidth != jpegWidth || outHeight != jpegHeight) {
+		cb->onCaptureScaled(reinterpret_cast<const pcf::color::Rgb24 *>(dest), size_t(outWidth), size_t(outHeight), size_t(jpegWidth), size_t(jpegHeight), CO_TOP_DOWN);
+	} else {
+		cb->onCapture(reinterpret_cast<const pcf::color::Rgb24 *>(dest), size_t(outWidth), size_t(outHeight), CO_TOP_DOWN);
+	}
+	return true;
+#else /* ! PCF_IS_LINUX */
+	(void)src;
+	(void)srcSize;
+	(void)timing;
+	return false;
+#endif /* PCF_IS_LINUX */
+}
+
+
+void addTestCaptureDevices(CaptureDeviceList & list) {
+	/* the device list is polled regularly; report invalid configurations only once */
+	static std::atomic<bool> patternReported(false);
+	static std::atomic<bool> replayReported(false);
+	const char * errPos = NULL;
+	const char * patternConfig = getenv(PCF_TEST_PATTERN_ENV);
+	if (patternConfig != NULL) {
+		PatternCaptureDevice * dev = new PatternCaptureDevice();
+		if (dev->setConfiguration(patternConfig, &errPos) != CaptureDevice::RC_SUCCESS && ( ! patternReported.exchange(true) )) {
+			fprintf(stderr, "Warning: invalid %s value at \"%s\"\n", PCF_TEST_PATTERN_ENV, (errPos != NULL) ? errPos : patternConfig);
+		}
+		list.push_back(dev);
+	}
+	const char * replayConfig = getenv(PCF_TEST_REPLAY_ENV);
+	if (replayConfig != NULL) {
+		ReplayCaptureDevice * dev = new ReplayCaptureDevice();
+		if (dev->setConfiguration(replayConfig, &errPos) != CaptureDevice::RC_SUCCESS && ( ! replayReported.exchange(true) )) {
+			fprintf(stderr, "Warning: invalid %s value at \"%s\"\n", PCF_TEST_REPLAY_ENV, (errPos != NULL) ? errPos : replayConfig);
+		}
+		list.push_back(dev);
+	}
+}
+
+
+} /* namespace video */
+} /* namespace pcf */
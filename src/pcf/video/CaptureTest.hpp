@@ -0,0 +1,332 @@
+/**
+ * @file CaptureTest.hpp
+ * @author Daniel Starke
+ * @date 2026-10-16
+ * @version 2026-10-16
+ */
+#ifndef __PCF_VIDEO_CAPTURETEST_HPP__
+#define __PCF_VIDEO_CAPTURETEST_HPP__
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <pcf/video/Capture.hpp>
+
+
+/** Environment variable which enables the test pattern capture device with the given configuration. */
+#define PCF_TEST_PATTERN_ENV "VKVM_TEST_PATTERN"
+
+
+/** Environment variable which enables the replay capture device with the given configuration. */
+#define PCF_TEST_REPLAY_ENV "VKVM_TEST_REPLAY"
+
+
+namespace pcf {
+namespace video {
+
+
+/**
+ * Enumeration of the frame formats supported by the test capture devices.
+ */
+enum TestCaptureFormat {
+	TCF_RGB24, /**< packed RGB24 */
+	TCF_BGR24, /**< packed BGR24 */
+	TCF_YUYV, /**< packed YUYV 4:2:2 */
+	TCF_UYVY, /**< packed UYVY 4:2:2 */
+	TCF_NV12, /**< planar Y with interleaved UV 4:2:0 */
+	TCF_I420, /**< planar Y, U, V 4:2:0 */
+	TCF_MJPEG /**< concatenated JPEG images (replay only) */
+};
+
+
+/**
+ * Common base of the test capture devices. Frames are produced by a background thread
+ * at the configured frame rate without any capture hardware. YUV frames use ITU-R BT.601
+ * with limited quantization range.
+ */
+class TestCaptureDevice : public CaptureDevice {
+protected:
+	/** Settings shared by all test capture devices. */
+	struct Settings {
+		size_t width; /**< frame width in pixels */
+		size_t height; /**< frame height in pixels */
+		unsigned fps; /**< frames per second or 0 for as fast as possible */
+		TestCaptureFormat format; /**< frame format */
+	};
+	char * devicePath; /**< capture device path */
+	char * deviceName; /**< capture device name */
+	Settings settings; /**< configured settings */
+	Settings active; /**< settings of the running capture */
+	bool stopping; /**< signals the background thread to terminate */
+	std::thread thread; /**< frame producing background thread */
+	std::mutex mutex; /**< guards against multiple capture starts and configuration changes */
+	std::mutex stopMutex; /**< guards `stopping` */
+	std::condition_variable stopSignal; /**< wakes up the background thread on stop */
+public:
+	/**
+	 * Constructor.
+	 *
+	 * @param[in] p - unique path of the capture device
+	 * @param[in] n - human readable capture device name
+	 */
+	explicit TestCaptureDevice(const char * p, const char * n);
+
+	/**
+	 * Copy constructor.
+	 *
+	 * @param[in] o - object to copy
+	 */
+	TestCaptureDevice(const TestCaptureDevice & o);
+
+	/** Destructor. */
+	virtual ~TestCaptureDevice();
+
+	/**
+	 * Returns the unique path of the capture device. The returned pointer shell not be freed.
+	 *
+	 * @return capture device path
+	 */
+	virtual const char * getPath() {
+		return this->devicePath;
+	}
+
+	/**
+	 * Returns the human readable name of the capture device. The returned pointer shell not be freed.
+	 *
+	 * @return capture device name
+	 */
+	virtual const char * getName() {
+		return this->deviceName;
+	}
+
+	/**
+	 * Does nothing as test capture devices are only configured via setConfiguration().
+	 *
+	 * @param[in,out] wnd - use this parent window
+	 */
+	virtual void configure(Window /* wnd */) {}
+
+	virtual bool start(Window wnd, CaptureCallback & cb);
+	virtual bool stop();
+
+	/**
+	 * Returns the number of bytes of a single frame in the given format.
+	 *
+	 * @param[in] fmt - frame format (not TCF_MJPEG)
+	 * @param[in] w - frame width in pixels
+	 * @param[in] h - frame height in pixels
+	 * @return frame size in bytes
+	 */
+	static size_t getFrameSize(const TestCaptureFormat fmt, const size_t w, const size_t h);
+protected:
+	/**
+	 * Prepares the frame production with the `active` settings. Called with the mutex
+	 * locked right before the background thread is started.
+	 *
+	 * @return true on success, else false
+	 */
+	virtual bool prepare() = 0;
+
+	/**
+	 * Produces the next frame and passes it to the callback. Called from the background thread.
+	 *
+	 * @param[in] index - zero based frame index
+	 * @param[in,out] timing - frame timing with `captured` and `dequeued` set
+	 * @return true to continue, false to end the stream
+	 */
+	virtual bool produce(const uint64_t index, CaptureTiming & timing) = 0;
+
+	/** Releases the resources allocated by prepare(). */
+	virtual void release() {}
+
+	/**
+	 * Passes the given frame on to the callback.
+	 *
+	 * @param[in] data - frame data in the active format
+	 * @param[in] timing - frame timing
+	 */
+	void forward(const uint8_t * data, const CaptureTiming & timing);
+
+	/**
+	 * Handles the configuration keys shared by all test capture devices.
+	 *
+	 * @param[in,out] s - settings to modify
+	 * @param[in] key - configuration key
+	 * @param[in] keyLen - length of `key`
+	 * @param[in] value - configuration value
+	 * @param[in] valueLen - length of `value`
+	 * @param[in] maxFormat - last supported format
+	 * @param[out] res - receives the result
+	 * @return true if the key was handled, else false
+	 */
+	static bool setCommonValue(Settings & s, const char * key, const size_t keyLen, const char * value, const size_t valueLen, const TestCaptureFormat maxFormat, ReturnCode & res);
+
+	/**
+	 * Formats the configuration keys shared by all test capture devices.
+	 * The caller needs to hold a lock to the mutex.
+	 *
+	 * @param[out] buf - output buffer
+	 * @param[in] size - size of `buf` in bytes
+	 * @return number of characters written as by snprintf()
+	 */
+	int getCommonConfiguration(char * buf, const size_t size) const;
+private:
+	void threadProc();
+	bool stopInternal();
+};
+
+
+/**
+ * Capture device which generates synthetic test patterns. These consist of color bars and
+ * a gray ramp with an optional moving region.
+ */
+class PatternCaptureDevice : public Cloneable<PatternCaptureDevice, TestCaptureDevice> {
+public:
+	typedef Cloneable<PatternCaptureDevice, TestCaptureDevice> Base;
+	/** Possible test patterns. */
+	enum Pattern {
+		P_STATIC, /**< never changing image */
+		P_MOVING, /**< bouncing box and frame counter on a static background */
+		P_FULL /**< horizontally scrolling image which changes every pixel */
+	};
+private:
+	Pattern pattern; /**< configured pattern */
+	Pattern activePattern; /**< pattern of the running capture */
+	std::vector<uint8_t> background; /**< static background image */
+	std::vector<uint8_t> frame; /**< currently generated frame */
+	size_t boxX; /**< horizontal position of the moving box */
+	size_t boxY; /**< vertical position of the moving box */
+	bool boxDrawn; /**< true if the moving box was drawn to `frame` */
+public:
+	/** Constructor. */
+	explicit PatternCaptureDevice();
+
+	/**
+	 * Copy constructor.
+	 *
+	 * @param[in] o - object to copy
+	 */
+	PatternCaptureDevice(const PatternCaptureDevice & o);
+
+	/** Destructor. */
+	virtual ~PatternCaptureDevice();
+
+	/**
+	 * Returns the current configuration of the capture device. The returned pointer needs to be freed.
+	 * The configuration is a semicolon separated list of `key=value` pairs. Possible keys are:
+	 * - `width`: frame width in pixels (even, 16 to 8192)
+	 * - `height`: frame height in pixels (even, 16 to 8192)
+	 * - `fps`: frames per second (0 for as fast as possible, up to 1000)
+	 * - `format`: `rgb24`, `bgr24`, `yuyv`, `uyvy`, `nv12` or `i420`
+	 * - `pattern`: `static`, `moving` or `full`
+	 *
+	 * @return capture device configuration
+	 */
+	virtual char * getConfiguration();
+
+	/**
+	 * Changes the current configuration of the capture device to the provided one.
+	 * Keys not given keep their current value. Changes take effect with the next start().
+	 *
+	 * @param[in] val - new configuration to use
+	 * @param[out] errPos - optionally sets the parsing position on error
+	 * @return success state
+	 * @see getConfiguration()
+	 */
+	virtual ReturnCode setConfiguration(const char * val, const char ** errPos);
+protected:
+	virtual bool prepare();
+	virtual bool produce(const uint64_t index, CaptureTiming & timing);
+	virtual void release();
+private:
+	void fillRect(std::vector<uint8_t> & image, size_t x, size_t y, size_t w, size_t h, const uint8_t r, const uint8_t g, const uint8_t b) const;
+	void copyRect(size_t x, size_t y, size_t w, size_t h);
+	void scroll(const size_t shift);
+};
+
+
+/**
+ * Capture device which replays recorded frames from a file. Raw frames are expected
+ * back-to-back as written by `v4l2-ctl --stream-to`. MJPEG files are concatenated JPEG
+ * images and are only supported on Linux.
+ */
+class ReplayCaptureDevice : public Cloneable<ReplayCaptureDevice, TestCaptureDevice> {
+public:
+	typedef Cloneable<ReplayCaptureDevice, TestCaptureDevice> Base;
+private:
+	char * filePath; /**< path of the replayed file */
+	bool loop; /**< restart at the beginning of the file once the end was reached */
+	bool activeLoop; /**< `loop` of the running capture */
+	FILE * fp; /**< opened file for raw frames */
+	std::vector<uint8_t> data; /**< raw frame buffer or complete MJPEG file */
+	std::vector<size_t> offsets; /**< start and end offset of each JPEG image in `data` */
+	size_t position; /**< index of the next JPEG image */
+	std::vector<uint8_t> decoded; /**< decoded RGB24 frame if the callback provides no buffer */
+	void * jpeg; /**< TurboJPEG decompressor handle */
+	bool decodeFailureReported; /**< limits the decoding failure warning to once per stream */
+public:
+	/** Constructor. */
+	explicit ReplayCaptureDevice();
+
+	/**
+	 * Copy constructor.
+	 *
+	 * @param[in] o - object to copy
+	 */
+	ReplayCaptureDevice(const ReplayCaptureDevice & o);
+
+	/** Destructor. */
+	virtual ~ReplayCaptureDevice();
+
+	/**
+	 * Returns the current configuration of the capture device. The returned pointer needs to be freed.
+	 * The configuration is a semicolon separated list of `key=value` pairs. Possible keys are:
+	 * - `file`: path of the recorded file
+	 * - `width`: frame width in pixels (even, 16 to 8192; ignored for MJPEG)
+	 * - `height`: frame height in pixels (even, 16 to 8192; ignored for MJPEG)
+	 * - `fps`: recorded frames per second or 0 to replay as fast as possible (up to 1000)
+	 * - `format`: `rgb24`, `bgr24`, `yuyv`, `uyvy`, `nv12`, `i420` or `mjpeg`
+	 * - `loop`: `yes` to restart at the end of the file, else `no`
+	 *
+	 * @return capture device configuration
+	 */
+	virtual char * getConfiguration();
+
+	/**
+	 * Changes the current configuration of the capture device to the provided one.
+	 * Keys not given keep their current value. Changes take effect with the next start().
+	 *
+	 * @param[in] val - new configuration to use
+	 * @param[out] errPos - optionally sets the parsing position on error
+	 * @return success state
+	 * @see getConfiguration()
+	 */
+	virtual ReturnCode setConfiguration(const char * val, const char ** errPos);
+protected:
+	virtual bool prepare();
+	virtual bool produce(const uint64_t index, CaptureTiming & timing);
+	virtual void release();
+private:
+	bool decodeJpeg(const uint8_t * src, const size_t srcSize, CaptureTiming & timing);
+};
+
+
+/**
+ * Adds the test capture devices enabled via the environment variables PCF_TEST_PATTERN_ENV
+ * and PCF_TEST_REPLAY_ENV to the given list. The variable values are passed to
+ * setConfiguration() of the corresponding device.
+ *
+ * @param[in,out] list - capture device list to extend
+ */
+void addTestCaptureDevices(CaptureDeviceList & list);
+
+
+} /* namespace video */
+} /* namespace pcf */
+
+
+#endif /* __PCF_VIDEO_CAPTURETEST_HPP__ */
@@ -2,9 +2,12 @@
  * @file CaptureVideo4Linux2.ipp
  * @author Daniel Starke
  * @date 2020-01-12
- * @version 2026-06-14
+ * @version 2026-10-16
  */
 #include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
@@ -13,6 +16,7 @@
 #include <new>
 #include <stdexcept>
 #include <thread>
+#include <vector>
 #include <FL/Fl.H>
 #include <FL/Fl_Button.H>
 #include <FL/Fl_Check_Button.H>
@@ -25,7 +29,10 @@
 #include <pcf/gui/SvgData.hpp>
 #include <pcf/gui/SvgView.hpp>
 #include <pcf/gui/Utility.hpp>
+#include <pcf/image/Convert.hpp>
 #include <pcf/video/Capture.hpp>
+#include <pcf/video/CaptureTest.hpp>
+#include <pcf/video/MjpegBandDecoder.hpp>
 #include <pcf/ScopeExit.hpp>
 #include <pcf/UtilityLinux.hpp>
 extern "C" {
@@ -42,6 +49,7 @@ extern "C" {
 #include <sys/stat.h>
 #include <sys/time.h>
 #include <sys/types.h>
+#include <turbojpeg.h>
 #include <unistd.h>
 }
 
@@ -51,6 +59,22 @@ extern "C" {
 #endif
 
 
+/** Minimum number of V4L2 capture buffers. */
+#define PCF_V4L2_MIN_BUFFERS 2
+
+
+/** Maximum number of V4L2 capture buffers. */
+#define PCF_V4L2_MAX_BUFFERS 16
+
+
+/** Default number of V4L2 capture buffers. */
+#define PCF_V4L2_DEF_BUFFERS 4
+
+
+/** Environment variable with the configuration passed to setConfiguration() of each V4L2 capture device. */
+#define PCF_V4L2_CONFIG_ENV "VKVM_V4L2_CONFIG"
+
+
 namespace pcf {
 namespace video {
 namespace {
@@ -251,11 +275,209 @@ private:
 CaptureDeviceChangeNotifier CaptureDeviceChangeNotifier::singleton;
 
 
+/** Capture source format as negotiated with or requested from the capture device. */
+struct CaptureSourceFormat {
+	__u32 pixelFormat; /**< V4L2 pixel format or 0 if none was set */
+	__u32 width; /**< frame width in pixels */
+	__u32 height; /**< frame height in pixels */
+	struct v4l2_fract interval; /**< time per frame in seconds or 0/0 to use the shortest one supported */
+};
+
+
+/** Capture device state which is restored if the device arrives again after it vanished. */
+struct CaptureState {
+	__u8 card[32]; /**< device name as reported by `VIDIOC_QUERYCAP` */
+	__u8 busInfo[32]; /**< device location as reported by `VIDIOC_QUERYCAP` */
+	CaptureSourceFormat source; /**< last negotiated capture source format (pixel format 0 if none) */
+	__u32 field; /**< last negotiated interleaving field order */
+	__u32 bufferCount; /**< number of capture buffers used last */
+	std::vector<struct v4l2_control> controls; /**< last known control values */
+	bool interrupted; /**< capturing ended because the device vanished or streaming could not be restarted */
+};
+
+
+/**
+ * Reads the values of all controls which can be changed by the user. Read-only, volatile,
+ * inactive and non-scalar controls are skipped.
+ *
+ * @param[in] fd - file descriptor of the capture device
+ * @param[out] controls - receives the control values in control ID order
+ */
+void getUserControls(const int fd, std::vector<struct v4l2_control> & controls) {
+	struct v4l2_queryctrl query;
+	struct v4l2_control control;
+	const __u32 skipFlags = V4L2_CTRL_FLAG_DISABLED | V4L2_CTRL_FLAG_READ_ONLY | V4L2_CTRL_FLAG_INACTIVE | V4L2_CTRL_FLAG_VOLATILE | V4L2_CTRL_FLAG_WRITE_ONLY;
+	controls.clear();
+	memset(&query, 0, sizeof(query));
+	query.id = V4L2_CTRL_FLAG_NEXT_CTRL;
+	while (xEINTR(ioctl, fd, VIDIOC_QUERYCTRL, &query) >= 0) {
+		const __u32 id = query.id;
+		query.id = id | V4L2_CTRL_FLAG_NEXT_CTRL;
+		if ((query.flags & skipFlags) != 0) continue;
+		switch (query.type) {
+		case V4L2_CTRL_TYPE_INTEGER:
+		case V4L2_CTRL_TYPE_BOOLEAN:
+		case V4L2_CTRL_TYPE_MENU:
+		case V4L2_CTRL_TYPE_INTEGER_MENU:
+			break;
+		default:
+			continue;
+		}
+		memset(&control, 0, sizeof(control));
+		control.id = id;
+		if (xEINTR(ioctl, fd, VIDIOC_G_CTRL, &control) < 0) continue;
+		controls.push_back(control);
+	}
+}
+
+
+/**
+ * Sets the given control values. Automatic mode controls precede the controls they
+ * govern in control ID order. Hence, the values are applied in the given order.
+ * Controls which cannot be set are ignored.
+ *
+ * @param[in] fd - file descriptor of the capture device
+ * @param[in] controls - control values to set
+ */
+void setUserControls(const int fd, const std::vector<struct v4l2_control> & controls) {
+	for (struct v4l2_control control : controls) {
+		if (xEINTR(ioctl, fd, VIDIOC_S_CTRL, &control) < 0) {
+			fprintf(stderr, "Warning: ioctl failed for VIDIOC_S_CTRL with control 0x%08lX (%s)\n", static_cast<unsigned long>(control.id), strerror(errno));
+		}
+	}
+}
+
+
+/**
+ * Process wide cache of the last state of each capture device. Devices are identified by
+ * name and bus location as the device path may change if the device arrives again.
+ */
+class CaptureStateCache {
+private:
+	std::vector<CaptureState> states; /**< cached capture device states */
+	std::mutex mutex; /**< guards `states` */
+	static CaptureStateCache singleton; /**< global object instance */
+public:
+	/**
+	 * Returns a single global `CaptureStateCache` instance.
+	 *
+	 * @return `CaptureStateCache` instance
+	 */
+	static inline CaptureStateCache & getInstance() {
+		return CaptureStateCache::singleton;
+	}
+
+	/**
+	 * Sets the identity fields of the given state from the capture device.
+	 *
+	 * @param[in] fd - file descriptor of the capture device
+	 * @param[out] state - state to update
+	 * @return true on success, else false
+	 */
+	static bool getIdentity(const int fd, CaptureState & state) {
+		struct v4l2_capability caps;
+		memset(&caps, 0, sizeof(caps));
+		if (xEINTR(ioctl, fd, VIDIOC_QUERYCAP, &caps) < 0) return false;
+		memcpy(state.card, caps.card, sizeof(state.card));
+		memcpy(state.busInfo, caps.bus_info, sizeof(state.busInfo));
+		return true;
+	}
+
+	/**
+	 * Returns the cached state of a capture device if capturing with it was interrupted
+	 * because it vanished. A device with the same name at a different bus location (e.g.
+	 * other USB port) is accepted if no exact match exists. The entry stays marked as
+	 * interrupted until update() is called once streaming has been restarted.
+	 *
+	 * @param[in] identity - state with the identity of the capture device
+	 * @param[out] state - cached state
+	 * @return true if an interrupted state was found, else false
+	 */
+	bool resume(const CaptureState & identity, CaptureState & state) {
+		std::lock_guard<std::mutex> guard(this->mutex);
+		CaptureState * match = NULL;
+		for (CaptureState & entry : this->states) {
+			if ( ! entry.interrupted || entry.source.pixelFormat == 0 ) continue;
+			if (memcmp(entry.card, identity.card, sizeof(entry.card)) != 0) continue;
+			if (memcmp(entry.busInfo, identity.busInfo, sizeof(entry.busInfo)) == 0) {
+				match = &entry;
+				break;
+			}
+			if (match == NULL) match = &entry;
+		}
+		if (match == NULL) return false;
+		state = *match;
+		return true;
+	}
+
+	/**
+	 * Stores the given state of a capture device. Any previous state of it is replaced.
+	 *
+	 * @param[in] state - capture device state
+	 */
+	void update(const CaptureState & state) {
+		std::lock_guard<std::mutex> guard(this->mutex);
+		CaptureState & entry = this->find(state);
+		entry = state;
+		entry.interrupted = false;
+	}
+
+	/**
+	 * Stores the current control values of the given capture device.
+	 *
+	 * @param[in] fd - file descriptor of the capture device
+	 */
+	void updateControls(const int fd) {
+		CaptureState identity;
+		if ( ! getIdentity(fd, identity) ) return;
+		std::vector<struct v4l2_control> controls;
+		getUserControls(fd, controls);
+		std::lock_guard<std::mutex> guard(this->mutex);
+		this->find(identity).controls = std::move(controls);
+	}
+
+	/**
+	 * Marks the state of the given capture device as interrupted.
+	 *
+	 * @param[in] identity - state with the identity of the capture device
+	 */
+	void interrupt(const CaptureState & identity) {
+		std::lock_guard<std::mutex> guard(this->mutex);
+		this->find(identity).interrupted = true;
+	}
+private:
+	/**
+	 * Returns the cache entry with the identity of the given state. A new entry without
+	 * source format is added if none exists. The caller needs to hold a lock to the mutex.
+	 *
+	 * @param[in] identity - state with the identity of the capture device
+	 * @return cache entry
+	 */
+	CaptureState & find(const CaptureState & identity) {
+		for (CaptureState & entry : this->states) {
+			if (memcmp(entry.card, identity.card, sizeof(entry.card)) == 0 && memcmp(entry.busInfo, identity.busInfo, sizeof(entry.busInfo)) == 0) {
+				return entry;
+			}
+		}
+		this->states.push_back(CaptureState()); /* value-initialized, i.e. without source format */
+		CaptureState & entry = this->states.back();
+		memcpy(entry.card, identity.card, sizeof(entry.card));
+		memcpy(entry.busInfo, identity.busInfo, sizeof(entry.busInfo));
+		return entry;
+	}
+};
+
+
+/** Global `CaptureStateCache` object. */
+CaptureStateCache CaptureStateCache::singleton;
+
+
 /**
  * Capture source configuration window.
  */
 class CaptureSourceConfigWindow : public Fl_Double_Window {
 private:
+	pcf::gui::HoverChoice * modeList;
 	pcf::gui::HoverChoice * formatList;
 	__u32 * formatTypes;
 	size_t formatTypeSize;
@@ -276,7 +498,7 @@ public:
 	 * @param[in] L - window label (optional)
 	 */
 	explicit CaptureSourceConfigWindow(const char * L = NULL):
-		Fl_Double_Window(pcf::gui::adjDpiH(240), pcf::gui::adjDpiV(160), L),
+		Fl_Double_Window(pcf::gui::adjDpiH(240), pcf::gui::adjDpiV(196), L),
 		formatTypes(NULL),
 		formatTypeSize(0)
 	{
@@ -290,6 +512,19 @@ public:
 		const int valH = W - labelH - (2 * spaceH);
 		int y1 = spaceV;
 
+		pcf::gui::SvgView * modeLabel = new pcf::gui::SvgView(spaceH, y1, widgetV, widgetV, pcf::gui::autoSvg);
+		modeLabel->tooltip("selection mode");
+		modeList = new pcf::gui::HoverChoice(spaceH + labelH, y1, valH, widgetV);
+		modeList->tooltip("selection mode");
+		modeList->align(FL_ALIGN_LEFT);
+		/* same order as `NativeCaptureDevice::SourceMode` */
+		modeList->add("Ask on each start", 0, NULL);
+		modeList->add("Automatic", 0, NULL);
+		modeList->add("Fixed", 0, NULL);
+		modeList->value(0);
+		modeList->callback(PCF_GUI_CALLBACK(onModeChange), this);
+		y1 += widgetV + spaceV;
+
 		pcf::gui::SvgView * formatLabel = new pcf::gui::SvgView(spaceH, y1, widgetV, widgetV, pcf::gui::formatSvg);
 		formatLabel->tooltip("format");
 		formatList = new pcf::gui::HoverChoice(spaceH + labelH, y1, valH, widgetV);
@@ -359,6 +594,16 @@ public:
 		if (this->formatTypes != NULL) free(this->formatTypes);
 	}
 
+	/**
+	 * Returns the currently selected source mode. This is 0 to ask again on the next start,
+	 * 1 to select the format automatically from now on and 2 to keep the selected format.
+	 *
+	 * @return source mode as index into `NativeCaptureDevice::SourceMode`
+	 */
+	inline int getSourceMode() const {
+		return this->modeList->value();
+	}
+
 	/**
 	 * Returns the currently selected capture format.
 	 *
@@ -449,6 +694,8 @@ public:
 		formatList->value((formatIndex >= 0) ? formatIndex : 0);
 		resolutionList->redraw();
 		onFormatChange(formatList); /* this fills the list with possible resolutions */
+		modeList->value(0);
+		onModeChange(modeList);
 		ok->take_focus();
 		/* the window is created from here on */
 		Fl_Double_Window::show();
@@ -477,10 +724,31 @@ protected:
 		return 1;
 	}
 private:
+	PCF_GUI_BIND(CaptureSourceConfigWindow, onModeChange, pcf::gui::HoverChoice);
 	PCF_GUI_BIND(CaptureSourceConfigWindow, onFormatChange, pcf::gui::HoverChoice);
 	PCF_GUI_BIND(CaptureSourceConfigWindow, onOk, pcf::gui::SvgButton);
 	PCF_GUI_BIND(CaptureSourceConfigWindow, onCancel, pcf::gui::SvgButton);
 
+	/**
+	 * Called on mode list click. The format settings are not used in
+	 * automatic mode and get deactivated accordingly.
+	 */
+	void onModeChange(pcf::gui::HoverChoice * /* list */) {
+		if (this->modeList->value() == 1) {
+			this->formatList->deactivate();
+			this->resolutionList->deactivate();
+			this->resolutionWidth->deactivate();
+			this->resolutionHeight->deactivate();
+			this->interleavingList->deactivate();
+		} else {
+			this->formatList->activate();
+			this->resolutionList->activate();
+			this->resolutionWidth->activate();
+			this->resolutionHeight->activate();
+			this->interleavingList->activate();
+		}
+	}
+
 	/**
 	 * Called on format list click to display a popup window with
 	 * possible capture formats.
@@ -1120,6 +1388,8 @@ private:
 	 * @param[in,out] button - associated button
 	 */
 	inline void onOk(pcf::gui::SvgButton * /* button */) {
+		/* remember the confirmed values to restore them if the device arrives again */
+		CaptureStateCache::getInstance().updateControls(this->videoFd);
 		this->hide();
 	}
 
@@ -1173,9 +1443,225 @@ private:
 };
 
 
+/**
+ * Returns the estimated time needed to turn a single frame of the given source format into
+ * something the capture callback can display. The values per pixel are rough figures taken
+ * from `captureBench` and only need to be right relative to each other.
+ *
+ * @param[in] pixelFormat - V4L2 pixel format
+ * @param[in] width - frame width
+ * @param[in] height - frame height
+ * @param[in] dispWidth - display width or 0 if unknown
+ * @param[in] dispHeight - display height or 0 if unknown
+ * @return estimated decoding time in nanoseconds
+ */
+double getDecodeCost(const __u32 pixelFormat, const size_t width, const size_t height, const size_t dispWidth, const size_t dispHeight) {
+	const double pixels = double(width) * double(height);
+	switch (pixelFormat) {
+	case V4L2_PIX_FMT_YUYV:
+	case V4L2_PIX_FMT_UYVY:
+	case V4L2_PIX_FMT_NV12:
+	case V4L2_PIX_FMT_YUV420:
+	case V4L2_PIX_FMT_YVU420:
+		/* forwarded as is and converted by the callback (or natively if padded) */
+		return pixels * 0.3;
+	case V4L2_PIX_FMT_RGB24:
+		return pixels * 0.4;
+	case V4L2_PIX_FMT_BGR24:
+	case V4L2_PIX_FMT_BGR32:
+	case V4L2_PIX_FMT_XBGR32:
+	case V4L2_PIX_FMT_ABGR32:
+		return pixels * 0.6;
+	case V4L2_PIX_FMT_MJPEG:
+	case V4L2_PIX_FMT_JPEG:
+		{
+			/* entropy decoding scales with the source, IDCT and color conversion with the output (see decodeJpeg()) */
+			double outPixels = pixels;
+			if (dispWidth > 0 && dispHeight > 0) {
+				for (size_t denom = 4; denom > 1; denom /= 2) {
+					const size_t scaledWidth = (width + denom - 1) / denom;
+					const size_t scaledHeight = (height + denom - 1) / denom;
+					if (scaledWidth >= dispWidth && scaledHeight >= dispHeight) {
+						outPixels = double(scaledWidth) * double(scaledHeight);
+						break;
+					}
+				}
+			}
+			return (pixels * 1.5) + (outPixels * 3.5);
+		}
+	default:
+		/* libv4lconvert */
+		return pixels * 8.0;
+	}
+}
+
+
+/** Candidate of the automatic capture source format selection. */
+struct CaptureSourceCandidate {
+	CaptureSourceFormat format; /**< capture source format */
+	double coverage; /**< fraction of the display size covered by the frame size (0..1) */
+	double fps; /**< expected frames per second after decoding */
+	double latency; /**< expected capture to screen latency in nanoseconds */
+	double pixels; /**< number of pixels per frame */
+};
+
+
+/**
+ * Checks whether the capture source candidate `a` is better suited than `b`. Candidates are
+ * ranked by display size coverage, then by frame rate and finally by latency. Small differences
+ * are ignored to prefer the cheaper candidate in case of doubt.
+ *
+ * @param[in] a - first candidate
+ * @param[in] b - second candidate
+ * @return true if `a` is better than `b`, else false
+ */
+bool isBetterSource(const CaptureSourceCandidate & a, const CaptureSourceCandidate & b) {
+	if (std::abs(a.coverage - b.coverage) > 0.02) return a.coverage > b.coverage;
+	if (std::abs(a.fps - b.fps) > (std::max(a.fps, b.fps) * 0.05)) return a.fps > b.fps;
+	if (std::abs(a.latency - b.latency) > 500000.0) return a.latency < b.latency;
+	return a.pixels < b.pixels;
+}
+
+
+/**
+ * Selects the capture source format with the highest frame rate and the lowest capture
+ * to screen latency for the given display size. All formats, frame sizes and frame
+ * intervals reported by the capture device are considered. Compressed formats other
+ * than MJPEG are skipped as they cannot be decoded.
+ *
+ * @param[in] fd - file descriptor of the capture device
+ * @param[in] dispWidth - display width or 0 if unknown
+ * @param[in] dispHeight - display height or 0 if unknown
+ * @param[out] out - selected capture source format
+ * @return true on success, else false if no usable format was found
+ */
+bool selectSourceFormat(const int fd, size_t dispWidth, size_t dispHeight, CaptureSourceFormat & out) {
+	struct v4l2_fmtdesc fmtItem;
+	struct v4l2_frmsizeenum resItem;
+	std::vector<CaptureSourceFormat> formats;
+	/* collect all format and frame size combinations */
+	memset(&fmtItem, 0, sizeof(fmtItem));
+	fmtItem.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+	for (fmtItem.index = 0; xEINTR(ioctl, fd, VIDIOC_ENUM_FMT, &fmtItem) >= 0; fmtItem.index++) {
+		const __u32 pixelFormat = fmtItem.pixelformat;
+		if ((fmtItem.flags & V4L2_FMT_FLAG_COMPRESSED) != 0 && pixelFormat != V4L2_PIX_FMT_MJPEG && pixelFormat != V4L2_PIX_FMT_JPEG) continue;
+		memset(&resItem, 0, sizeof(resItem));
+		resItem.pixel_format = pixelFormat;
+		for (resItem.index = 0; xEINTR(ioctl, fd, VIDIOC_ENUM_FRAMESIZES, &resItem) >= 0; resItem.index++) {
+			if (resItem.type == V4L2_FRMSIZE_TYPE_DISCRETE) {
+				formats.push_back(CaptureSourceFormat{pixelFormat, resItem.discrete.width, resItem.discrete.height, {0, 0}});
+				continue;
+			}
+			/* continuous or stepwise: the largest size and the smallest one covering the display */
+			const struct v4l2_frmsize_stepwise & sw = resItem.stepwise;
+			formats.push_back(CaptureSourceFormat{pixelFormat, sw.max_width, sw.max_height, {0, 0}});
+			if (dispWidth > 0 && dispHeight > 0) {
+				const __u32 stepWidth = std::max(sw.step_width, __u32(1));
+				const __u32 stepHeight = std::max(sw.step_height, __u32(1));
+				const __u32 width = std::max(sw.min_width, std::min(sw.max_width, __u32(dispWidth)));
+				const __u32 height = std::max(sw.min_height, std::min(sw.max_height, __u32(dispHeight)));
+				formats.push_back(CaptureSourceFormat{
+					pixelFormat,
+					std::min(sw.max_width, sw.min_width + (((width - sw.min_width + stepWidth - 1) / stepWidth) * stepWidth)),
+					std::min(sw.max_height, sw.min_height + (((height - sw.min_height + stepHeight - 1) / stepHeight) * stepHeight)),
+					{0, 0}
+				});
+			}
+			break;
+		}
+	}
+	if ( formats.empty() ) return false;
+	/* without a known display size the largest frame size is the target */
+	if (dispWidth == 0 || dispHeight == 0) {
+		for (const CaptureSourceFormat & format : formats) {
+			if ((double(format.width) * double(format.height)) > (double(dispWidth) * double(dispHeight))) {
+				dispWidth = size_t(format.width);
+				dispHeight = size_t(format.height);
+			}
+		}
+	}
+	/* rate each frame interval of each combination */
+	bool found = false;
+	CaptureSourceCandidate best;
+	auto rate = [&](const CaptureSourceFormat & format, const struct v4l2_fract & interval) {
+		CaptureSourceCandidate candidate;
+		/* assume 30 fps if the device does not report any frame interval */
+		const double frameTime = (interval.numerator > 0 && interval.denominator > 0) ? (1e9 * double(interval.numerator) / double(interval.denominator)) : (1e9 / 30.0);
+		const double decodeTime = getDecodeCost(format.pixelFormat, size_t(format.width), size_t(format.height), dispWidth, dispHeight);
+		candidate.format = format;
+		candidate.format.interval = interval;
+		candidate.coverage = std::min(1.0, double(format.width) / double(dispWidth)) * std::min(1.0, double(format.height) / double(dispHeight));
+		candidate.fps = 1e9 / std::max(frameTime, decodeTime);
+		candidate.latency = frameTime + decodeTime;
+		candidate.pixels = double(format.width) * double(format.height);
+		if ( ! found || isBetterSource(candidate, best) ) {
+			best = candidate;
+			found = true;
+		}
+	};
+	struct v4l2_frmivalenum ivalItem;
+	for (const CaptureSourceFormat & format : formats) {
+		memset(&ivalItem, 0, sizeof(ivalItem));
+		ivalItem.pixel_format = format.pixelFormat;
+		ivalItem.width = format.width;
+		ivalItem.height = format.height;
+		bool hasInterval = false;
+		for (ivalItem.index = 0; xEINTR(ioctl, fd, VIDIOC_ENUM_FRAMEINTERVALS, &ivalItem) >= 0; ivalItem.index++) {
+			hasInterval = true;
+			if (ivalItem.type == V4L2_FRMIVAL_TYPE_DISCRETE) {
+				rate(format, ivalItem.discrete);
+			} else {
+				/* continuous or stepwise: the shortest interval is always the best one */
+				rate(format, ivalItem.stepwise.min);
+				break;
+			}
+		}
+		if ( ! hasInterval ) rate(format, format.interval);
+	}
+	if ( ! found ) return false;
+	out = best.format;
+	return true;
+}
+
+
+/**
+ * Returns the shortest frame interval supported by the capture device for the given format.
+ *
+ * @param[in] fd - file descriptor of the capture device
+ * @param[in] format - capture source format
+ * @param[out] interval - shortest time per frame in seconds
+ * @return true on success, else false if the device does not report frame intervals
+ */
+bool getShortestInterval(const int fd, const CaptureSourceFormat & format, struct v4l2_fract & interval) {
+	struct v4l2_frmivalenum ivalItem;
+	bool found = false;
+	memset(&ivalItem, 0, sizeof(ivalItem));
+	ivalItem.pixel_format = format.pixelFormat;
+	ivalItem.width = format.width;
+	ivalItem.height = format.height;
+	for (ivalItem.index = 0; xEINTR(ioctl, fd, VIDIOC_ENUM_FRAMEINTERVALS, &ivalItem) >= 0; ivalItem.index++) {
+		const struct v4l2_fract & value = (ivalItem.type == V4L2_FRMIVAL_TYPE_DISCRETE) ? ivalItem.discrete : ivalItem.stepwise.min;
+		if (value.numerator == 0 || value.denominator == 0) continue;
+		/* a/b < c/d <=> a*d < c*b */
+		if ( ! found || (uint64_t(value.numerator) * uint64_t(interval.denominator)) < (uint64_t(interval.numerator) * uint64_t(value.denominator)) ) {
+			interval = value;
+			found = true;
+		}
+		if (ivalItem.type != V4L2_FRMIVAL_TYPE_DISCRETE) break;
+	}
+	return found;
+}
+
+
 class NativeCaptureDevice : public Cloneable<NativeCaptureDevice, CaptureDevice> {
 public:
 	typedef Cloneable<NativeCaptureDevice, CaptureDevice> Base;
+	/** Capture source format selection on start(). */
+	enum SourceMode {
+		SM_ASK, /**< let the user select the format in the capture source configuration window */
+		SM_AUTO, /**< select the format with the highest frame rate and lowest latency for the display size */
+		SM_FIXED /**< use the format given via setConfiguration() or last selected by the user */
+	};
 private:
 	/** Single capture buffer description. */
 	struct CaptureBuffer {
@@ -1187,13 +1673,28 @@ private:
 	CaptureConfigurationWindow * config; /**< capture device configuration window object */
 	int fd; /**< capture device file descriptor */
 	int ed; /**< event file descriptor to signal termination */
-	struct CaptureBuffer bufferDesc[2]; /**< memory mapped regions for video capturing */
+	int de; /**< event file descriptor to signal a pending frame to the decode thread */
+	struct CaptureBuffer bufferDesc[PCF_V4L2_MAX_BUFFERS]; /**< memory mapped regions for video capturing */
 	__u32 bufferCount; /**< number of video buffers */
+	__u32 bufferRequest; /**< number of video buffers requested from the driver on start */
+	bool lowLatency; /**< drain all pending buffers on wakeup and hand only the newest one to the decoder */
+	SourceMode sourceMode; /**< capture source format selection mode */
+	CaptureSourceFormat sourceFormat; /**< last negotiated or configured capture source format */
+	std::atomic<uint64_t> pendingFrame; /**< latest dequeued frame for the decode thread (see packFrame()) or 0 */
+	CaptureTiming bufferTiming[PCF_V4L2_MAX_BUFFERS]; /**< timing of the frame in each dequeued capture buffer */
+	std::atomic<size_t> droppedFrames; /**< number of frames dropped since the last frame was decoded */
 	struct v4lconvert_data * converter; /**< libv4lconvert handle used to decode the source format to RGB24 */
+	tjhandle jpeg; /**< TurboJPEG decompressor used instead of `converter` for MJPEG sources */
+	MjpegBandDecoder bandDecoder; /**< multi-threaded decoder for large MJPEG frames with restart markers */
 	struct v4l2_format srcFormat; /**< actual capture source format set on the device (e.g. MJPEG) */
+	CaptureState state; /**< identity and negotiated state of the opened device (see CaptureStateCache) */
+	bool sourceEvents; /**< true if subscribed to `V4L2_EVENT_SOURCE_CHANGE` */
+	bool formatChanged; /**< tells the decode thread to update its source dependent values (guarded by `decodeMutex`) */
 	unsigned char * rgbBuffer; /**< destination buffer receiving the converted RGB24 frames */
 	size_t rgbBufferLength; /**< size of `rgbBuffer` in bytes */
 	std::thread thread; /**< video capture background thread */
+	std::thread decodeThread; /**< video decode background thread */
+	std::mutex decodeMutex; /**< held by the decode thread while it accesses the capture buffers */
 	std::mutex mutex; /**< guards against multiple capture starts */
 public:
 	/**
@@ -1209,14 +1710,25 @@ public:
 		config(NULL),
 		fd(-1),
 		ed(-1),
+		de(-1),
 		bufferCount(0),
+		bufferRequest(PCF_V4L2_DEF_BUFFERS),
+		lowLatency(false),
+		sourceMode(SM_ASK),
+		sourceFormat(CaptureSourceFormat{0, 0, 0, {0, 0}}),
+		pendingFrame(0),
+		droppedFrames(0),
 		converter(NULL),
+		jpeg(NULL),
+		bandDecoder(),
+		state(),
+		sourceEvents(false),
+		formatChanged(false),
 		rgbBuffer(NULL),
 		rgbBufferLength(0)
 	{
 		this->initFrom(p, n);
-		this->bufferDesc[0].start = MAP_FAILED;
-		this->bufferDesc[1].start = MAP_FAILED;
+		for (struct CaptureBuffer & desc : this->bufferDesc) desc.start = MAP_FAILED;
 	}
 
 	/**
@@ -1231,14 +1743,25 @@ public:
 		config(NULL),
 		fd(-1),
 		ed(-1),
+		de(-1),
 		bufferCount(0),
+		bufferRequest(o.bufferRequest),
+		lowLatency(o.lowLatency),
+		sourceMode(o.sourceMode),
+		sourceFormat(o.sourceFormat),
+		pendingFrame(0),
+		droppedFrames(0),
 		converter(NULL),
+		jpeg(NULL),
+		bandDecoder(),
+		state(),
+		sourceEvents(false),
+		formatChanged(false),
 		rgbBuffer(NULL),
 		rgbBufferLength(0)
 	{
 		this->initFrom(o.devicePath, o.deviceName);
-		this->bufferDesc[0].start = MAP_FAILED;
-		this->bufferDesc[1].start = MAP_FAILED;
+		for (struct CaptureBuffer & desc : this->bufferDesc) desc.start = MAP_FAILED;
 	}
 
 	/**
@@ -1263,6 +1786,10 @@ public:
 		if (this != &o) {
 			this->stop();
 			this->initFrom(o.devicePath, o.deviceName);
+			this->bufferRequest = o.bufferRequest;
+			this->lowLatency = o.lowLatency;
+			this->sourceMode = o.sourceMode;
+			this->sourceFormat = o.sourceFormat;
 			if (this->config != NULL) {
 				delete this->config;
 				this->config = NULL;
@@ -1329,78 +1856,256 @@ public:
 
 	/**
 	 * Returns the current configuration of the capture device. The returned pointer needs to be freed.
+	 * The configuration is a semicolon separated list of `key=value` pairs. Possible keys are:
+	 * - `buffers`: number of capture buffers (2 to 16)
+	 * - `latency`: `normal` to hand every dequeued frame to the decoder or `low` to drain all pending
+	 *   frames first and hand over only the newest one
+	 * - `mode`: `ask` to select the source format in a window on start, `auto` to select the one with
+	 *   the highest frame rate and lowest latency for the current display size or `fixed` to use the
+	 *   one given by `format`, `size` and `interval`
+	 * - `format`: V4L2 pixel format as four character code (e.g. `MJPG`)
+	 * - `size`: frame size as `<width>x<height>`
+	 * - `interval`: time per frame in seconds as `<numerator>/<denominator>` (e.g. `1/60`)
+	 *
+	 * The last three are only included once a source format was negotiated or set. They report the
+	 * format chosen on the last start in `ask` and `auto` mode.
 	 *
 	 * @return capture device configuration
 	 */
 	virtual char * getConfiguration() {
-		// @todo
-		return NULL;
+		static const char * modeNames[] = {"ask", "auto", "fixed"};
+		std::lock_guard<std::mutex> guard(this->mutex);
+		const CaptureSourceFormat & source = this->sourceFormat;
+		char buf[160];
+		int len = snprintf(buf, sizeof(buf), "buffers=%u;latency=%s;mode=%s", unsigned(this->bufferRequest), this->lowLatency ? "low" : "normal", modeNames[this->sourceMode]);
+		if (len > 0 && size_t(len) < sizeof(buf) && source.pixelFormat != 0) {
+			const int addLen = snprintf(
+				buf + len,
+				sizeof(buf) - size_t(len),
+				";format=%.4s;size=%lux%lu;interval=%lu/%lu",
+				reinterpret_cast<const char *>(&(source.pixelFormat)),
+				static_cast<unsigned long>(source.width),
+				static_cast<unsigned long>(source.height),
+				static_cast<unsigned long>(source.interval.numerator),
+				static_cast<unsigned long>(source.interval.denominator)
+			);
+			len = (addLen > 0) ? len + addLen : addLen;
+		}
+		if (len <= 0 || size_t(len) >= sizeof(buf)) return NULL;
+		char * res = static_cast<char *>(malloc(size_t(len + 1) * sizeof(char)));
+		if (res != NULL) memcpy(res, buf, size_t(len + 1) * sizeof(char));
+		return res;
 	}
 
 	/**
 	 * Changes the current configuration of the capture device to the provided one.
+	 * Keys not given keep their current value. Changes take effect with the next start().
 	 *
 	 * @param[in] val - new configuration to use
 	 * @param[out] errPos - optionally sets the parsing position on error
 	 * @return success state
+	 * @see getConfiguration()
 	 */
-	virtual ReturnCode setConfiguration(const char * /* val */, const char ** /* errPos */) {
-		// @todo
-		return RC_ERROR_INV_ARG;
+	virtual ReturnCode setConfiguration(const char * val, const char ** errPos) {
+		if (val == NULL) return RC_ERROR_INV_ARG;
+		std::lock_guard<std::mutex> guard(this->mutex);
+		__u32 newBufferRequest = this->bufferRequest;
+		bool newLowLatency = this->lowLatency;
+		SourceMode newSourceMode = this->sourceMode;
+		CaptureSourceFormat newSourceFormat = this->sourceFormat;
+		const char * ptr = val;
+		while (*ptr != 0) {
+			const char * key = ptr;
+			const char * sep = key + strcspn(key, "=;");
+			if (*sep != '=' || sep == key) {
+				if (errPos != NULL) *errPos = key;
+				return RC_ERROR_INV_SYNTAX;
+			}
+			const char * value = sep + 1;
+			const char * end = value + strcspn(value, ";");
+			const size_t keyLen = size_t(sep - key);
+			const size_t valueLen = size_t(end - value);
+			if (keyLen == 7 && strncmp(key, "buffers", 7) == 0) {
+				char * numEnd = NULL;
+				const unsigned long num = strtoul(value, &numEnd, 10);
+				if (numEnd == value || numEnd != end) {
+					if (errPos != NULL) *errPos = value;
+					return RC_ERROR_INV_SYNTAX;
+				}
+				if (num < PCF_V4L2_MIN_BUFFERS || num > PCF_V4L2_MAX_BUFFERS) {
+					if (errPos != NULL) *errPos = value;
+					return RC_ERROR_INV_ARG;
+				}
+				newBufferRequest = __u32(num);
+			} else if (keyLen == 7 && strncmp(key, "latency", 7) == 0) {
+				if (valueLen == 3 && strncmp(value, "low", 3) == 0) {
+					newLowLatency = true;
+				} else if (valueLen == 6 && strncmp(value, "normal", 6) == 0) {
+					newLowLatency = false;
+				} else {
+					if (errPos != NULL) *errPos = value;
+					return RC_ERROR_INV_ARG;
+				}
+			} else if (keyLen == 4 && strncmp(key, "mode", 4) == 0) {
+				if (valueLen == 3 && strncmp(value, "ask", 3) == 0) {
+					newSourceMode = SM_ASK;
+				} else if (valueLen == 4 && strncmp(value, "auto", 4) == 0) {
+					newSourceMode = SM_AUTO;
+				} else if (valueLen == 5 && strncmp(value, "fixed", 5) == 0) {
+					newSourceMode = SM_FIXED;
+				} else {
+					if (errPos != NULL) *errPos = value;
+					return RC_ERROR_INV_ARG;
+				}
+			} else if (keyLen == 6 && strncmp(key, "format", 6) == 0) {
+				if (valueLen != 4) {
+					if (errPos != NULL) *errPos = value;
+					return RC_ERROR_INV_SYNTAX;
+				}
+				newSourceFormat.pixelFormat = v4l2_fourcc(value[0], value[1], value[2], value[3]);
+			} else if (keyLen == 4 && strncmp(key, "size", 4) == 0) {
+				char * numEnd = NULL;
+				const unsigned long width = strtoul(value, &numEnd, 10);
+				if (numEnd == value || *numEnd != 'x') {
+					if (errPos != NULL) *errPos = value;
+					return RC_ERROR_INV_SYNTAX;
+				}
+				const char * heightStr = numEnd + 1;
+				const unsigned long height = strtoul(heightStr, &numEnd, 10);
+				if (numEnd == heightStr || numEnd != end) {
+					if (errPos != NULL) *errPos = heightStr;
+					return RC_ERROR_INV_SYNTAX;
+				}
+				if (width == 0 || height == 0 || width > 0xFFFFFFFFUL || height > 0xFFFFFFFFUL) {
+					if (errPos != NULL) *errPos = value;
+					return RC_ERROR_INV_ARG;
+				}
+				newSourceFormat.width = __u32(width);
+				newSourceFormat.height = __u32(height);
+			} else if (keyLen == 8 && strncmp(key, "interval", 8) == 0) {
+				char * numEnd = NULL;
+				const unsigned long num = strtoul(value, &numEnd, 10);
+				if (numEnd == value || *numEnd != '/') {
+					if (errPos != NULL) *errPos = value;
+					return RC_ERROR_INV_SYNTAX;
+				}
+				const char * denStr = numEnd + 1;
+				const unsigned long den = strtoul(denStr, &numEnd, 10);
+				if (numEnd == denStr || numEnd != end) {
+					if (errPos != NULL) *errPos = denStr;
+					return RC_ERROR_INV_SYNTAX;
+				}
+				if ((num == 0) != (den == 0) || num > 0xFFFFFFFFUL || den > 0xFFFFFFFFUL) {
+					if (errPos != NULL) *errPos = value;
+					return RC_ERROR_INV_ARG;
+				}
+				newSourceFormat.interval.numerator = __u32(num);
+				newSourceFormat.interval.denominator = __u32(den);
+			} else {
+				if (errPos != NULL) *errPos = key;
+				return RC_ERROR_INV_ARG;
+			}
+			ptr = (*end == ';') ? end + 1 : end;
+		}
+		if (newSourceMode == SM_FIXED && (newSourceFormat.pixelFormat == 0 || newSourceFormat.width == 0 || newSourceFormat.height == 0)) {
+			/* fixed mode requires a complete source format */
+			if (errPos != NULL) *errPos = val;
+			return RC_ERROR_INV_ARG;
+		}
+		this->bufferRequest = newBufferRequest;
+		this->lowLatency = newLowLatency;
+		this->sourceMode = newSourceMode;
+		this->sourceFormat = newSourceFormat;
+		return RC_SUCCESS;
 	}
 
 	/**
 	 * Starts the video capture procedure with this device.
-	 * A modal window is opened with capture source settings if none have
-	 * been set previously via setConfiguration().
+	 * A modal window is opened with capture source settings unless the `auto` or
+	 * `fixed` mode has been set previously via setConfiguration() or chosen in that
+	 * window for the following starts. The frame interval
+	 * is set to the configured or else the shortest one supported by the device.
+	 * If capturing with this device was interrupted because it vanished or streaming
+	 * could not be restarted, the previously negotiated format, number of buffers and
+	 * control values are restored instead without asking.
 	 *
 	 * @param[in,out] wnd - use this parent window
 	 * @param[in] cb - send capture images to this callback
 	 * @return true on success, else false
-	 * @remarks `VIDIOC_SUBSCRIBE_EVENT` is not registered as buffer layout or format changes are
-	 * guaranteed to happen only while streaming if turned off.
+	 * @remarks `V4L2_EVENT_SOURCE_CHANGE` is handled by restarting the stream with the
+	 * same pixel format at the new source resolution (see restream()). If this fails,
+	 * capturing ends with a call to `CaptureCallback::onCaptureInterrupted()`.
 	 */
 	virtual bool start(Window /* wnd */, CaptureCallback & cb) {
 		struct v4l2_format captureFormat;
-		struct v4l2_buffer buf;
 		/* fresh start */
 		if ( ! this->mutex.try_lock() ) return false;
 		std::unique_lock<std::mutex> guard(this->mutex, std::adopt_lock);
 		this->stopInternal();
 		this->Base::callback = &cb;
 		this->ed = eventfd(0, EFD_NONBLOCK);
-		if (this->devicePath == NULL || this->ed < 0) return false;
+		this->de = eventfd(0, EFD_NONBLOCK);
+		if (this->devicePath == NULL || this->ed < 0 || this->de < 0) {
+			this->stopInternal();
+			return false;
+		}
 		/* open capture device directly (no libv4l2 wrapper) so we control the source format ourselves */
 		this->fd = open(this->devicePath, O_RDWR | O_NONBLOCK, 0);
 		if (this->fd < 0) return false;
+		/* identify the device to restore its state if it vanished while capturing */
+		CaptureState cached;
+		const bool hasIdentity = CaptureStateCache::getIdentity(this->fd, this->state);
+		const bool resume = hasIdentity && CaptureStateCache::getInstance().resume(this->state, cached);
+		if ( ! hasIdentity ) memset(this->state.card, 0, sizeof(this->state.card));
 		/* set capture format */
 		{
-			CaptureSourceConfigWindow configWin("Capture Source Configuration");
-			if ( ! configWin.show(this->fd, 0, 0) ) {
-				this->stopInternal();
-				return false;
-			}
-			/* force the user selected source format directly in the V4L2 kernel driver */
+			CaptureSourceFormat source = this->sourceFormat;
+			SourceMode mode = this->sourceMode;
 			memset(&captureFormat, 0, sizeof(captureFormat));
 			captureFormat.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-			captureFormat.fmt.pix.width = configWin.getCaptureWidth();
-			captureFormat.fmt.pix.height = configWin.getCaptureHeight();
-			captureFormat.fmt.pix.pixelformat = configWin.getCaptureFormat();
-			captureFormat.fmt.pix.field = configWin.getCaptureFieldOrder();
-			if (xEINTR(ioctl, this->fd, VIDIOC_S_FMT, &captureFormat) < 0) {
-				/* failed to set capture format */
-				fprintf(stderr, "Error: ioctl failed for VIDIOC_S_FMT with %lux%lu using %.4s (%s)\n", static_cast<unsigned long>(captureFormat.fmt.pix.width), static_cast<unsigned long>(captureFormat.fmt.pix.height), reinterpret_cast<const char *>(&(captureFormat.fmt.pix.pixelformat)), strerror(errno));
-				this->stopInternal();
-				return false;
+			captureFormat.fmt.pix.field = V4L2_FIELD_NONE;
+			if ( resume ) {
+				/* silently continue with the state negotiated before the device vanished */
+				source = cached.source;
+				captureFormat.fmt.pix.field = cached.field;
+				setUserControls(this->fd, cached.controls);
+			} else {
+				if (mode == SM_ASK) {
+					CaptureSourceConfigWindow configWin("Capture Source Configuration");
+					if ( ! configWin.show(this->fd, 0, 0) ) {
+						this->stopInternal();
+						return false;
+					}
+					mode = SourceMode(configWin.getSourceMode());
+					if (mode != SM_AUTO) {
+						source.pixelFormat = configWin.getCaptureFormat();
+						source.width = configWin.getCaptureWidth();
+						source.height = configWin.getCaptureHeight();
+						source.interval.numerator = 0;
+						source.interval.denominator = 0;
+						captureFormat.fmt.pix.field = configWin.getCaptureFieldOrder();
+					}
+				}
+				if (mode == SM_AUTO) {
+					size_t dispWidth, dispHeight;
+					cb.getDisplaySize(dispWidth, dispHeight);
+					if ( ! selectSourceFormat(this->fd, dispWidth, dispHeight, source) ) {
+						fprintf(stderr, "Error: no supported capture format found\n");
+						this->stopInternal();
+						return false;
+					}
+				}
 			}
-			/* read back the format the driver actually accepted (this is our conversion source) */
-			memset(&(this->srcFormat), 0, sizeof(this->srcFormat));
-			this->srcFormat.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-			if (xEINTR(ioctl, this->fd, VIDIOC_G_FMT, &(this->srcFormat)) < 0) {
-				fprintf(stderr, "Error: ioctl failed for VIDIOC_G_FMT (%s)\n", strerror(errno));
+			/* force the selected source format directly in the V4L2 kernel driver */
+			captureFormat.fmt.pix.width = source.width;
+			captureFormat.fmt.pix.height = source.height;
+			captureFormat.fmt.pix.pixelformat = source.pixelFormat;
+			if ( ! this->setSourceFormat(captureFormat, source) ) {
 				this->stopInternal();
 				return false;
 			}
+			this->sourceFormat = source;
+			this->sourceMode = mode;
 			/* create the libv4lconvert decoder which converts the source format to RGB24 */
 			this->converter = v4lconvert_create(this->fd);
 			if (this->converter == NULL) {
@@ -1408,35 +2113,187 @@ public:
 				this->stopInternal();
 				return false;
 			}
-			/* allocate the RGB24 destination buffer (width * height * 3) */
-			if ( ! getFrameBytes(size_t(this->srcFormat.fmt.pix.width), size_t(this->srcFormat.fmt.pix.height), this->rgbBufferLength) ) {
-				fprintf(stderr, "Error: invalid capture resolution %lux%lu\n", static_cast<unsigned long>(this->srcFormat.fmt.pix.width), static_cast<unsigned long>(this->srcFormat.fmt.pix.height));
-				this->stopInternal();
-				return false;
+			/* MJPEG is decoded by TurboJPEG directly as libv4lconvert is considerably slower */
+			if (this->srcFormat.fmt.pix.pixelformat == V4L2_PIX_FMT_MJPEG || this->srcFormat.fmt.pix.pixelformat == V4L2_PIX_FMT_JPEG) {
+				this->jpeg = tjInitDecompress();
+				if (this->jpeg == NULL) {
+					fprintf(stderr, "Warning: tjInitDecompress failed (%s)\n", tjGetErrorStr2(NULL));
+				} else {
+					this->bandDecoder.start();
+				}
 			}
-			this->rgbBuffer = static_cast<unsigned char *>(malloc(this->rgbBufferLength));
-			if (this->rgbBuffer == NULL) {
-				fprintf(stderr, "Error: failed to allocate %lu bytes for the RGB24 conversion buffer\n", static_cast<unsigned long>(this->rgbBufferLength));
-				this->rgbBufferLength = 0;
+			/* allocate the RGB24 destination buffer (width * height * 3) */
+			if ( ! this->allocRgbBuffer() ) {
 				this->stopInternal();
 				return false;
 			}
 		}
 		/* initialize capture buffers */
+		if ( ! this->mapBuffers((resume && cached.bufferCount > 0) ? cached.bufferCount : this->bufferRequest) ) {
+			this->stopInternal();
+			return false;
+		}
+		/* remember the negotiated state; cached by the capture thread once streaming started */
+		this->state.source = this->sourceFormat;
+		this->state.field = this->srcFormat.fmt.pix.field;
+		this->state.bufferCount = this->bufferCount;
+		if ( hasIdentity ) getUserControls(this->fd, this->state.controls);
+		/* get notified about source resolution changes (e.g. at HDMI receivers) if supported */
+		struct v4l2_event_subscription sub;
+		memset(&sub, 0, sizeof(sub));
+		sub.type = V4L2_EVENT_SOURCE_CHANGE;
+		this->sourceEvents = xEINTR(ioctl, this->fd, VIDIOC_SUBSCRIBE_EVENT, &sub) >= 0;
+		/* start decode and capture thread */
+		this->pendingFrame.store(0, std::memory_order_relaxed);
+		this->droppedFrames.store(0, std::memory_order_relaxed);
+		this->formatChanged = true;
+		this->decodeThread = std::thread(&NativeCaptureDevice::decodeProc, this);
+		this->thread = std::thread(&NativeCaptureDevice::threadProc, this, this->lowLatency);
+		return true;
+	}
+
+	/**
+	 * Stops the video capture procedure.
+	 *
+	 * @return true on success, else false
+	 */
+	virtual bool stop() {
+		if ( ! this->mutex.try_lock() ) return false;
+		const bool res = this->stopInternal();
+		this->mutex.unlock();
+		return res;
+	}
+private:
+	/**
+	 * Initializes the object from the given parameters.
+	 *
+	 * @param[in] p - unique path of the video capture device
+	 * @param[in] n - human readable video capture device name
+	 */
+	inline void initFrom(const char * p, const char * n) {
+		if (p != NULL) {
+			const size_t len = strlen(p) + 1;
+			this->devicePath = static_cast<char *>(malloc(len * sizeof(char)));
+			if (this->devicePath != NULL) memcpy(this->devicePath, p, len * sizeof(char));
+			this->setName(n);
+		}
+	}
+
+	/**
+	 * Sets the frame interval of the negotiated source format at the capture device. The shortest
+	 * interval supported for this format is used if none was given. The interval accepted by the
+	 * driver is written back. It becomes 0/0 if the device does not support frame intervals.
+	 *
+	 * @param[in,out] source - negotiated capture source format
+	 */
+	void setFrameInterval(CaptureSourceFormat & source) {
+		struct v4l2_streamparm parm;
+		memset(&parm, 0, sizeof(parm));
+		parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+		if (xEINTR(ioctl, this->fd, VIDIOC_G_PARM, &parm) < 0 || (parm.parm.capture.capability & V4L2_CAP_TIMEPERFRAME) == 0) {
+			source.interval.numerator = 0;
+			source.interval.denominator = 0;
+			return;
+		}
+		if (source.interval.numerator == 0 || source.interval.denominator == 0) {
+			if ( ! getShortestInterval(this->fd, source, source.interval) ) {
+				source.interval = parm.parm.capture.timeperframe;
+				return;
+			}
+		}
+		parm.parm.capture.timeperframe = source.interval;
+		if (xEINTR(ioctl, this->fd, VIDIOC_S_PARM, &parm) < 0) {
+			fprintf(stderr, "Warning: ioctl failed for VIDIOC_S_PARM with %lu/%lu (%s)\n", static_cast<unsigned long>(source.interval.numerator), static_cast<unsigned long>(source.interval.denominator), strerror(errno));
+			memset(&parm, 0, sizeof(parm));
+			parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+			if (xEINTR(ioctl, this->fd, VIDIOC_G_PARM, &parm) < 0) {
+				source.interval.numerator = 0;
+				source.interval.denominator = 0;
+				return;
+			}
+		}
+		source.interval = parm.parm.capture.timeperframe;
+	}
+
+	/**
+	 * Sets the given source format at the capture device and reads back the format
+	 * the driver actually accepted to `srcFormat` and `source`. The frame interval
+	 * is set afterwards (see setFrameInterval()).
+	 *
+	 * @param[in,out] captureFormat - requested format (modified by the driver)
+	 * @param[in,out] source - requested source format, receives the negotiated one
+	 * @return true on success, else false
+	 */
+	bool setSourceFormat(struct v4l2_format & captureFormat, CaptureSourceFormat & source) {
+		if (xEINTR(ioctl, this->fd, VIDIOC_S_FMT, &captureFormat) < 0) {
+			/* failed to set capture format */
+			fprintf(stderr, "Error: ioctl failed for VIDIOC_S_FMT with %lux%lu using %.4s (%s)\n", static_cast<unsigned long>(captureFormat.fmt.pix.width), static_cast<unsigned long>(captureFormat.fmt.pix.height), reinterpret_cast<const char *>(&(captureFormat.fmt.pix.pixelformat)), strerror(errno));
+			return false;
+		}
+		/* read back the format the driver actually accepted (this is our conversion source) */
+		memset(&(this->srcFormat), 0, sizeof(this->srcFormat));
+		this->srcFormat.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+		if (xEINTR(ioctl, this->fd, VIDIOC_G_FMT, &(this->srcFormat)) < 0) {
+			fprintf(stderr, "Error: ioctl failed for VIDIOC_G_FMT (%s)\n", strerror(errno));
+			return false;
+		}
+		source.pixelFormat = this->srcFormat.fmt.pix.pixelformat;
+		source.width = this->srcFormat.fmt.pix.width;
+		source.height = this->srcFormat.fmt.pix.height;
+		this->setFrameInterval(source);
+		return true;
+	}
+
+	/**
+	 * Makes sure that `rgbBuffer` can hold a RGB24 frame of the size given by `srcFormat`.
+	 * The current buffer is kept if it is large enough.
+	 *
+	 * @return true on success, else false
+	 */
+	bool allocRgbBuffer() {
+		size_t length;
+		if ( ! getFrameBytes(size_t(this->srcFormat.fmt.pix.width), size_t(this->srcFormat.fmt.pix.height), length) ) {
+			fprintf(stderr, "Error: invalid capture resolution %lux%lu\n", static_cast<unsigned long>(this->srcFormat.fmt.pix.width), static_cast<unsigned long>(this->srcFormat.fmt.pix.height));
+			return false;
+		}
+		if (this->rgbBuffer != NULL && this->rgbBufferLength >= length) return true;
+		if (this->rgbBuffer != NULL) free(this->rgbBuffer);
+		this->rgbBuffer = static_cast<unsigned char *>(malloc(length));
+		if (this->rgbBuffer == NULL) {
+			fprintf(stderr, "Error: failed to allocate %lu bytes for the RGB24 conversion buffer\n", static_cast<unsigned long>(length));
+			this->rgbBufferLength = 0;
+			return false;
+		}
+		this->rgbBufferLength = length;
+		return true;
+	}
+
+	/**
+	 * Requests the given number of capture buffers from the driver, maps them
+	 * into memory and queues them for capturing.
+	 *
+	 * @param[in] count - number of buffers to request
+	 * @return true on success, else false
+	 * @remarks Buffers mapped before an error occurred are released by unmapBuffers().
+	 */
+	bool mapBuffers(const __u32 count) {
 		struct v4l2_requestbuffers req;
+		struct v4l2_buffer buf;
 		memset(&req, 0, sizeof(req));
-		req.count = 2; /* double buffering */
+		req.count = count;
 		req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
 		req.memory = V4L2_MEMORY_MMAP;
 		if (xEINTR(ioctl, this->fd, VIDIOC_REQBUFS, &req) < 0) {
 			/* memory mapping is not supported */
 			fprintf(stderr, "Error: ioctl failed for VIDIOC_REQBUFS with V4L2_MEMORY_MMAP (%s)\n", strerror(errno));
-			this->stopInternal();
 			return false;
 		}
-		this->bufferDesc[0].start = MAP_FAILED;
-		this->bufferDesc[1].start = MAP_FAILED;
-		this->bufferCount = req.count;
+		if (req.count < PCF_V4L2_MIN_BUFFERS) {
+			fprintf(stderr, "Error: VIDIOC_REQBUFS returned only %u of %u buffers\n", unsigned(req.count), unsigned(count));
+			return false;
+		}
+		/* the driver may allocate more buffers than requested; unmapped ones are never queued */
+		this->bufferCount = std::min(req.count, __u32(PCF_V4L2_MAX_BUFFERS));
 		for (__u32 n = 0; n < this->bufferCount; n++) {
 			memset(&buf, 0, sizeof(buf));
 			buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
@@ -1445,7 +2302,6 @@ public:
 			if (xEINTR(ioctl, this->fd, VIDIOC_QUERYBUF, &buf) < 0) {
 				/* failed to get buffer state */
 				fprintf(stderr, "Error: ioctl failed for VIDIOC_QUERYBUF (%s)\n", strerror(errno));
-				this->stopInternal();
 				return false;
 			}
 			this->bufferDesc[n].length = buf.length;
@@ -1453,7 +2309,6 @@ public:
 			if (this->bufferDesc[n].start == MAP_FAILED) {
 				/* failed to obtain memory mapped user space region of the buffers */
 				fprintf(stderr, "Error: mmap failed (%s)\n", strerror(errno));
-				this->stopInternal();
 				return false;
 			}
 		}
@@ -1464,61 +2319,144 @@ public:
 			buf.memory = V4L2_MEMORY_MMAP;
 			buf.index = n;
 			if (xEINTR(ioctl, this->fd, VIDIOC_QBUF, &buf) < 0) {
-				fprintf(stderr, "Error: ioctl failed for VIDIOC_QBUF with V4L2_MEMORY_MMAP (%s)\n", strerror(errno));
 				/* failed to queue buffer */
-				this->stopInternal();
+				fprintf(stderr, "Error: ioctl failed for VIDIOC_QBUF with V4L2_MEMORY_MMAP (%s)\n", strerror(errno));
 				return false;
 			}
 		}
-		/* start capture thread */
-		this->thread = std::thread(&NativeCaptureDevice::threadProc, this);
 		return true;
 	}
 
 	/**
-	 * Stops the video capture procedure.
+	 * Unmaps all capture buffers. The buffers remain allocated by the driver
+	 * until they are released via `VIDIOC_REQBUFS` or the device is closed.
+	 */
+	void unmapBuffers() {
+		for (__u32 n = 0; n < this->bufferCount; n++) {
+			if (this->bufferDesc[n].start != MAP_FAILED) {
+				munmap(this->bufferDesc[n].start, this->bufferDesc[n].length);
+				this->bufferDesc[n].start = MAP_FAILED;
+			}
+		}
+		this->bufferCount = 0;
+	}
+
+	/**
+	 * Restarts streaming after the capture source changed. The pixel format, frame interval
+	 * and number of buffers are kept while the frame size is taken from the new source.
+	 * Digital video receivers are set to the newly detected timings first. The decode
+	 * thread is held off while the capture buffers are replaced.
+	 * Called from the capture thread while streaming.
 	 *
 	 * @return true on success, else false
 	 */
-	virtual bool stop() {
-		if ( ! this->mutex.try_lock() ) return false;
-		const bool res = this->stopInternal();
-		this->mutex.unlock();
-		return res;
+	bool restream() {
+		std::lock_guard<std::mutex> decodeGuard(this->decodeMutex);
+		enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+		if (xEINTR(ioctl, this->fd, VIDIOC_STREAMOFF, &type) < 0) {
+			fprintf(stderr, "Error: ioctl failed for VIDIOC_STREAMOFF (%s)\n", strerror(errno));
+			return false;
+		}
+		/* all buffers are dequeued by now; a frame pending for the decode thread is void */
+		this->pendingFrame.store(0, std::memory_order_relaxed);
+		const __u32 count = this->bufferCount;
+		this->unmapBuffers();
+		struct v4l2_requestbuffers req;
+		memset(&req, 0, sizeof(req));
+		req.count = 0;
+		req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+		req.memory = V4L2_MEMORY_MMAP;
+		if (xEINTR(ioctl, this->fd, VIDIOC_REQBUFS, &req) < 0) {
+			fprintf(stderr, "Error: ioctl failed for VIDIOC_REQBUFS to release the buffers (%s)\n", strerror(errno));
+			return false;
+		}
+		struct v4l2_dv_timings timings;
+		memset(&timings, 0, sizeof(timings));
+		if (xEINTR(ioctl, this->fd, VIDIOC_QUERY_DV_TIMINGS, &timings) >= 0 && xEINTR(ioctl, this->fd, VIDIOC_S_DV_TIMINGS, &timings) < 0) {
+			fprintf(stderr, "Warning: ioctl failed for VIDIOC_S_DV_TIMINGS (%s)\n", strerror(errno));
+		}
+		/* the driver reports the new source frame size as current format */
+		struct v4l2_format captureFormat;
+		memset(&captureFormat, 0, sizeof(captureFormat));
+		captureFormat.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+		if (xEINTR(ioctl, this->fd, VIDIOC_G_FMT, &captureFormat) < 0) {
+			fprintf(stderr, "Error: ioctl failed for VIDIOC_G_FMT (%s)\n", strerror(errno));
+			return false;
+		}
+		/* `sourceFormat` is guarded by `mutex` and keeps reporting the format of the last start */
+		CaptureSourceFormat source = this->state.source;
+		captureFormat.fmt.pix.pixelformat = source.pixelFormat;
+		captureFormat.fmt.pix.field = this->state.field;
+		if ( ! this->setSourceFormat(captureFormat, source) ) return false;
+		if ( ! this->allocRgbBuffer() ) return false;
+		if ( ! this->mapBuffers(count) ) return false;
+		if (xEINTR(ioctl, this->fd, VIDIOC_STREAMON, &type) < 0) {
+			fprintf(stderr, "Error: ioctl failed for VIDIOC_STREAMON (%s)\n", strerror(errno));
+			return false;
+		}
+		this->formatChanged = true;
+		if (this->state.card[0] != 0) {
+			this->state.source = source;
+			this->state.field = this->srcFormat.fmt.pix.field;
+			this->state.bufferCount = this->bufferCount;
+			CaptureStateCache::getInstance().update(this->state);
+		}
+		return true;
 	}
-private:
+
 	/**
-	 * Initializes the object from the given parameters.
+	 * Packs the given capture buffer reference into a single value for `pendingFrame`.
 	 *
-	 * @param[in] p - unique path of the video capture device
-	 * @param[in] n - human readable video capture device name
+	 * @param[in] buf - dequeued capture buffer
+	 * @return packed buffer index and number of bytes used (never 0)
 	 */
-	inline void initFrom(const char * p, const char * n) {
-		if (p != NULL) {
-			const size_t len = strlen(p) + 1;
-			this->devicePath = static_cast<char *>(malloc(len * sizeof(char)));
-			if (this->devicePath != NULL) memcpy(this->devicePath, p, len * sizeof(char));
-			this->setName(n);
+	static inline uint64_t packFrame(const struct v4l2_buffer & buf) {
+		return (uint64_t(buf.bytesused) << 32) | uint64_t(buf.index + 1);
+	}
+
+	/**
+	 * Returns the given capture buffer to the driver.
+	 *
+	 * @param[in] index - capture buffer index
+	 */
+	inline void requeue(const __u32 index) {
+		struct v4l2_buffer buf;
+		memset(&buf, 0, sizeof(buf));
+		buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+		buf.memory = V4L2_MEMORY_MMAP;
+		buf.index = index;
+		if (xEINTR(ioctl, this->fd, VIDIOC_QBUF, &buf) < 0) {
+			fprintf(stderr, "Error: ioctl failed for VIDIOC_QBUF (%s)\n", strerror(errno));
 		}
 	}
 
 	/**
 	 * Background thread which retrieves the frames from the
-	 * capture device and forwards those to the registered
-	 * callback handlers.
+	 * capture device and hands those over to the decode thread.
+	 * Only the latest frame is kept for the decode thread. Frames
+	 * which were superseded before being decoded are re-queued
+	 * right away. Hence, capturing continues at the device rate
+	 * independent of the decoding speed.
 	 *
+	 * @param[in] drain - dequeue all pending buffers on wakeup and hand over only the newest one
 	 * @remarks The thread will terminate on error or termination event.
 	 */
-	void threadProc() {
+	void threadProc(const bool drain) {
 		struct v4l2_buffer buf;
-		struct v4l2_format destFmt;
+		struct v4l2_buffer next;
 		enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+		struct v4l2_event event;
 		struct timeval tout;
 		fd_set fds;
+		fd_set efds;
+		__u32 lastSequence = 0;
+		bool hasSequence = false;
 		if (xEINTR(ioctl, this->fd, VIDIOC_STREAMON, &type) < 0) {
 			fprintf(stderr, "Error: ioctl failed for VIDIOC_STREAMON (%s)\n", strerror(errno));
 			return;
 		}
+		/* remember the negotiated state to restore it if the device arrives again */
+		if (this->state.card[0] != 0) CaptureStateCache::getInstance().update(this->state);
 		/* no buffer layout or format changes can be done from here on */
 		const auto streamOffOnReturn = makeScopeExit([=]() mutable {
 			type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
@@ -1527,70 +2465,411 @@ private:
 			}
 			/* buffer layout and format changes are possible again */
 		});
-		/* RGB24 destination format the source frames are converted to by libv4lconvert */
-		memset(&destFmt, 0, sizeof(destFmt));
-		destFmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-		destFmt.fmt.pix.width = this->srcFormat.fmt.pix.width;
-		destFmt.fmt.pix.height = this->srcFormat.fmt.pix.height;
-		destFmt.fmt.pix.pixelformat = V4L2_PIX_FMT_RGB24;
-		destFmt.fmt.pix.field = this->srcFormat.fmt.pix.field;
-		v4lconvert_fixup_fmt(&destFmt);
-		bool conversionFailureReported = false; /* limit the conversion failure warning to once per stream */
 		for ( ;; ) {
 			FD_ZERO(&fds);
 			FD_SET(this->ed, &fds);
 			FD_SET(this->fd, &fds);
+			FD_ZERO(&efds);
+			if ( this->sourceEvents ) FD_SET(this->fd, &efds);
 			tout.tv_sec = 2;
 			tout.tv_usec = 0;
 			errno = 0;
-			const int sRes = select(std::max(this->ed, this->fd) + 1, &fds, NULL, NULL, &tout);
+			const int sRes = select(std::max(this->ed, this->fd) + 1, &fds, NULL, &efds, &tout);
 			if (sRes < 0) {
 				if (errno == EAGAIN || errno == EINTR) continue;
 				break;
 			}
 			if (sRes > 0 && FD_ISSET(this->ed, &fds) != 0) break;
+			if (sRes > 0 && FD_ISSET(this->fd, &efds) != 0) {
+				/* pending events; restart streaming at the new resolution on source changes */
+				bool sourceChanged = false;
+				memset(&event, 0, sizeof(event));
+				while (xEINTR(ioctl, this->fd, VIDIOC_DQEVENT, &event) >= 0) {
+					if (event.type == V4L2_EVENT_SOURCE_CHANGE && (event.u.src_change.changes & V4L2_EVENT_SRC_CH_RESOLUTION) != 0) {
+						sourceChanged = true;
+					}
+					if (event.pending == 0) break;
+				}
+				if (sourceChanged) {
+					if ( ! this->restream() ) {
+						/* keep the last state for the restart requested via the callback */
+						if (this->state.card[0] != 0) CaptureStateCache::getInstance().interrupt(this->state);
+						this->callback->onCaptureInterrupted();
+						return;
+					}
+					hasSequence = false;
+					continue;
+				}
+			}
 			if (sRes == 0 || FD_ISSET(this->fd, &fds) == 0) continue; /* timeout */
 			/* get a buffer with the received capture data */
 			memset(&buf, 0, sizeof(buf));
 			buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
 			buf.memory = V4L2_MEMORY_MMAP;
 			if (xEINTR(ioctl, this->fd, VIDIOC_DQBUF, &buf) < 0) {
-				fprintf(stderr, "Warning: ioctl failed for VIDIOC_DQBUF with V4L2_MEMORY_MMAP (%s)\n", strerror(errno));
+				const int error = errno;
+				fprintf(stderr, "Warning: ioctl failed for VIDIOC_DQBUF with V4L2_MEMORY_MMAP (%s)\n", strerror(error));
+				if (error == ENODEV) return; /* device vanished; stopInternal() marks its state for restart */
 				continue;
 			}
+			if ( drain ) {
+				/* skip to the newest frame; stale buffers are re-queued without decoding them */
+				for ( ;; ) {
+					memset(&next, 0, sizeof(next));
+					next.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+					next.memory = V4L2_MEMORY_MMAP;
+					if (xEINTR(ioctl, this->fd, VIDIOC_DQBUF, &next) < 0) {
+						if (errno != EAGAIN) {
+							fprintf(stderr, "Warning: ioctl failed for VIDIOC_DQBUF with V4L2_MEMORY_MMAP (%s)\n", strerror(errno));
+						}
+						break;
+					}
+					this->requeue(buf.index);
+					buf = next;
+				}
+			}
 			const bool validFrame = buf.index < this->bufferCount && buf.bytesused > 0 && size_t(buf.bytesused) <= this->bufferDesc[buf.index].length;
 			if ( ! validFrame ) {
 				fprintf(stderr, "Warning: dropping invalid capture frame (index %u, %u bytes used)\n", buf.index, buf.bytesused);
+				this->requeue(buf.index);
+				this->droppedFrames.fetch_add(1, std::memory_order_relaxed);
+				continue;
+			}
+			/* frames skipped by the driver or drained above show up as gaps in the sequence numbers */
+			if (hasSequence && buf.sequence > (lastSequence + 1)) {
+				this->droppedFrames.fetch_add(size_t(buf.sequence - lastSequence - 1), std::memory_order_relaxed);
+			}
+			lastSequence = buf.sequence;
+			hasSequence = true;
+			CaptureTiming & timing = this->bufferTiming[buf.index];
+			timing.dequeued = getCaptureTime();
+			if ((buf.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK) == V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC) {
+				/* same clock as getCaptureTime() */
+				timing.captured = (uint64_t(buf.timestamp.tv_sec) * 1000000) + uint64_t(buf.timestamp.tv_usec);
 			} else {
-				/* decode the source frame to RGB24 using libv4lconvert */
-				const int converted = v4lconvert_convert(
-					this->converter,
-					&(this->srcFormat),
-					&destFmt,
-					static_cast<unsigned char *>(this->bufferDesc[buf.index].start),
-					int(buf.bytesused),
-					this->rgbBuffer,
-					int(this->rgbBufferLength)
-				);
-				if (converted < 0) {
+				timing.captured = 0;
+			}
+			/* hand over to the decode thread; a frame it did not pick up yet is superseded */
+			const uint64_t stale = this->pendingFrame.exchange(packFrame(buf), std::memory_order_acq_rel);
+			if (stale != 0) {
+				this->requeue(__u32(stale & 0xFFFFFFFF) - 1);
+				this->droppedFrames.fetch_add(1, std::memory_order_relaxed);
+			}
+			const uint64_t signal = 1;
+			if (write(this->de, &signal, sizeof(signal)) < 0) {
+				fprintf(stderr, "Warning: failed to signal the decode thread (%s)\n", strerror(errno));
+			}
+		}
+	}
+
+	/**
+	 * Background thread which decodes the latest frame handed
+	 * over by the capture thread and forwards it to the
+	 * registered callback handlers. The decoded capture buffer
+	 * is returned to the driver afterwards.
+	 *
+	 * @remarks The thread will terminate on error or termination event.
+	 */
+	void decodeProc() {
+		struct v4l2_format destFmt;
+		struct timeval tout;
+		fd_set fds;
+		uint64_t signal;
+		CaptureYuvMatrix yuvMatrix = CYM_BT601;
+		CaptureYuvRange yuvRange = CYR_LIMITED;
+		pcf::image::YuvCoefficients yuvCoefficients = pcf::image::getYuvCoefficients(false, false);
+		uint8_t noise = 0;
+		bool conversionFailureReported = false; /* limit the conversion failure warning to once per stream */
+		memset(&destFmt, 0, sizeof(destFmt));
+		for ( ;; ) {
+			FD_ZERO(&fds);
+			FD_SET(this->ed, &fds);
+			FD_SET(this->de, &fds);
+			tout.tv_sec = 2;
+			tout.tv_usec = 0;
+			errno = 0;
+			const int sRes = select(std::max(this->ed, this->de) + 1, &fds, NULL, NULL, &tout);
+			if (sRes < 0) {
+				if (errno == EAGAIN || errno == EINTR) continue;
+				break;
+			}
+			if (sRes > 0 && FD_ISSET(this->ed, &fds) != 0) break;
+			if (sRes == 0 || FD_ISSET(this->de, &fds) == 0) continue; /* timeout */
+			if (read(this->de, &signal, sizeof(signal)) != ssize_t(sizeof(signal))) continue;
+			/* the capture buffers and source format remain unchanged until the frame was handled */
+			std::lock_guard<std::mutex> decodeGuard(this->decodeMutex);
+			if ( this->formatChanged ) {
+				/* RGB24 destination format the source frames are converted to by libv4lconvert */
+				memset(&destFmt, 0, sizeof(destFmt));
+				destFmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+				destFmt.fmt.pix.width = this->srcFormat.fmt.pix.width;
+				destFmt.fmt.pix.height = this->srcFormat.fmt.pix.height;
+				destFmt.fmt.pix.pixelformat = V4L2_PIX_FMT_RGB24;
+				destFmt.fmt.pix.field = this->srcFormat.fmt.pix.field;
+				v4lconvert_fixup_fmt(&destFmt);
+				/* YUV parameters for formats which are passed on without conversion */
+				const struct v4l2_pix_format & pix = this->srcFormat.fmt.pix;
+				const bool hasExtFields = pix.priv == V4L2_PIX_FMT_PRIV_MAGIC;
+				const __u32 colorspace = pix.colorspace;
+				const __u32 encoding = (hasExtFields && pix.ycbcr_enc != V4L2_YCBCR_ENC_DEFAULT) ? pix.ycbcr_enc : __u32(V4L2_MAP_YCBCR_ENC_DEFAULT(colorspace));
+				const __u32 quantization = (hasExtFields && pix.quantization != V4L2_QUANTIZATION_DEFAULT) ? pix.quantization : __u32(V4L2_MAP_QUANTIZATION_DEFAULT(false, colorspace, encoding));
+				yuvMatrix = (encoding == V4L2_YCBCR_ENC_709 || encoding == V4L2_YCBCR_ENC_XV709) ? CYM_BT709 : CYM_BT601;
+				yuvRange = (quantization == V4L2_QUANTIZATION_FULL_RANGE) ? CYR_FULL : CYR_LIMITED;
+				yuvCoefficients = pcf::image::getYuvCoefficients(yuvMatrix == CYM_BT709, yuvRange == CYR_FULL);
+				/* only lossy compressed sources differ without an actual content change */
+				noise = (pix.pixelformat == V4L2_PIX_FMT_MJPEG || pix.pixelformat == V4L2_PIX_FMT_JPEG) ? PCF_CAPTURE_JPEG_NOISE : 0;
+				conversionFailureReported = false;
+				this->formatChanged = false;
+			}
+			const uint64_t frame = this->pendingFrame.exchange(0, std::memory_order_acq_rel);
+			if (frame == 0) continue; /* already taken with a previous signal */
+			const __u32 index = __u32(frame & 0xFFFFFFFF) - 1;
+			const __u32 bytesUsed = __u32(frame >> 32);
+			CaptureTiming timing = this->bufferTiming[index];
+			timing.decodeStart = getCaptureTime();
+			timing.dropped = this->droppedFrames.exchange(0, std::memory_order_relaxed);
+			timing.noise = noise;
+			if (this->jpeg != NULL) {
+				/* decode the MJPEG frame to RGB24 using TurboJPEG */
+				size_t width, height, srcWidth, srcHeight;
+				unsigned char * dest = this->getDestBuffer();
+				const char * error = this->decodeJpeg(static_cast<const unsigned char *>(this->bufferDesc[index].start), size_t(bytesUsed), dest, width, height, srcWidth, srcHeight);
+				timing.decoded = getCaptureTime();
+				/* re-queue receive buffer */
+				this->requeue(index);
+				if (error != NULL) {
 					if ( ! conversionFailureReported ) {
-						fprintf(stderr, "Warning: v4lconvert_convert failed (%s)\n", v4lconvert_get_error_message(this->converter));
+						fprintf(stderr, "Warning: failed to decode MJPEG frame (%s)\n", error);
 						conversionFailureReported = true;
 					}
+					continue;
+				}
+				this->callback->onCaptureTiming(timing);
+				if (width != srcWidth || height != srcHeight) {
+					this->callback->onCaptureScaled(reinterpret_cast<const pcf::color::Rgb24 *>(dest), width, height, srcWidth, srcHeight, CO_TOP_DOWN);
 				} else {
-					this->callback->onCapture(
-						reinterpret_cast<const pcf::color::Rgb24 *>(this->rgbBuffer),
-						size_t(destFmt.fmt.pix.width),
-						size_t(destFmt.fmt.pix.height),
-						CO_TOP_DOWN
-					);
+					this->callback->onCapture(reinterpret_cast<const pcf::color::Rgb24 *>(dest), width, height, CO_TOP_DOWN);
 				}
+				continue;
 			}
+			/* pass YUV frames on as they are; the callback converts those */
+			timing.decoded = timing.decodeStart;
+			if ( this->forwardYuv(static_cast<const uint8_t *>(this->bufferDesc[index].start), size_t(bytesUsed), yuvMatrix, yuvRange, timing) ) {
+				/* re-queue receive buffer */
+				this->requeue(index);
+				continue;
+			}
+			/* decode the source frame to RGB24 natively if supported, else using libv4lconvert */
+			unsigned char * dest = this->getDestBuffer();
+			const bool native = this->convertNative(static_cast<const uint8_t *>(this->bufferDesc[index].start), size_t(bytesUsed), yuvCoefficients, dest);
+			const int converted = native ? 0 : v4lconvert_convert(
+				this->converter,
+				&(this->srcFormat),
+				&destFmt,
+				static_cast<unsigned char *>(this->bufferDesc[index].start),
+				int(bytesUsed),
+				dest,
+				int(this->rgbBufferLength)
+			);
+			timing.decoded = getCaptureTime();
 			/* re-queue receive buffer */
-			if (xEINTR(ioctl, this->fd, VIDIOC_QBUF, &buf) < 0) {
-				fprintf(stderr, "Error: ioctl failed for VIDIOC_QBUF (%s)\n", strerror(errno));
+			this->requeue(index);
+			if (converted < 0) {
+				if ( ! conversionFailureReported ) {
+					fprintf(stderr, "Warning: v4lconvert_convert failed (%s)\n", v4lconvert_get_error_message(this->converter));
+					conversionFailureReported = true;
+				}
+			} else {
+				this->callback->onCaptureTiming(timing);
+				this->callback->onCapture(
+					reinterpret_cast<const pcf::color::Rgb24 *>(dest),
+					size_t(destFmt.fmt.pix.width),
+					size_t(destFmt.fmt.pix.height),
+					CO_TOP_DOWN
+				);
+			}
+		}
+	}
+
+	/**
+	 * Returns the buffer to decode the next RGB24 frame into. This is the buffer provided
+	 * by the callback if available to avoid an additional copy, else `rgbBuffer`.
+	 *
+	 * @return destination buffer with `rgbBufferLength` bytes
+	 */
+	inline unsigned char * getDestBuffer() {
+		unsigned char * dest = static_cast<unsigned char *>(this->callback->getCaptureBuffer(this->rgbBufferLength));
+		return (dest != NULL) ? dest : this->rgbBuffer;
+	}
+
+	/**
+	 * Passes the given frame on to the callback without conversion if the
+	 * source format is a tightly packed YUV format supported by CaptureCallback.
+	 *
+	 * @param[in] src - frame data
+	 * @param[in] srcSize - number of bytes in `src`
+	 * @param[in] matrix - YUV to RGB conversion matrix
+	 * @param[in] range - YUV quantization range
+	 * @param[in] timing - frame timing
+	 * @return true if the frame was passed on, else false
+	 */
+	bool forwardYuv(const uint8_t * src, const size_t srcSize, const CaptureYuvMatrix matrix, const CaptureYuvRange range, const CaptureTiming & timing) {
+		const struct v4l2_pix_format & pix = this->srcFormat.fmt.pix;
+		const size_t width = size_t(pix.width);
+		const size_t height = size_t(pix.height);
+		const size_t lumaSize = width * height;
+		const size_t chromaSize = ((width + 1) / 2) * ((height + 1) / 2);
+		switch (pix.pixelformat) {
+		case V4L2_PIX_FMT_YUYV:
+		case V4L2_PIX_FMT_UYVY:
+			if (size_t(pix.bytesperline) != (width * 2) || srcSize < (lumaSize * 2)) return false;
+			break;
+		case V4L2_PIX_FMT_NV12:
+		case V4L2_PIX_FMT_YUV420:
+		case V4L2_PIX_FMT_YVU420:
+			if (size_t(pix.bytesperline) != width || srcSize < (lumaSize + (chromaSize * 2))) return false;
+			break;
+		default:
+			return false;
+		}
+		this->callback->onCaptureTiming(timing);
+		switch (pix.pixelformat) {
+		case V4L2_PIX_FMT_YUYV:
+			this->callback->onCapture(reinterpret_cast<const pcf::color::Yuyv *>(src), width, height, matrix, range, CO_TOP_DOWN);
+			break;
+		case V4L2_PIX_FMT_UYVY:
+			this->callback->onCapture(reinterpret_cast<const pcf::color::Uyvy *>(src), width, height, matrix, range, CO_TOP_DOWN);
+			break;
+		case V4L2_PIX_FMT_NV12:
+			this->callback->onCapture(src, src + lumaSize, width, height, matrix, range, CO_TOP_DOWN);
+			break;
+		case V4L2_PIX_FMT_YUV420:
+			this->callback->onCapture(src, src + lumaSize, src + lumaSize + chromaSize, width, height, matrix, range, CO_TOP_DOWN);
+			break;
+		default: /* V4L2_PIX_FMT_YVU420 */
+			this->callback->onCapture(src, src + lumaSize + chromaSize, src + lumaSize, width, height, matrix, range, CO_TOP_DOWN);
+			break;
+		}
+		return true;
+	}
+
+	/**
+	 * Converts the given frame to RGB24 with the SIMD converters of pcf::image if the
+	 * source format is supported by those. This covers YUV frames with padded rows
+	 * which cannot be passed on as they are as well as BGR24, BGRX and RGB24 frames.
+	 *
+	 * @param[in] src - frame data
+	 * @param[in] srcSize - number of bytes in `src`
+	 * @param[in] c - YUV to RGB conversion coefficients
+	 * @param[out] dest - RGB24 output with `rgbBufferLength` bytes
+	 * @return true if the frame was converted, else false
+	 */
+	bool convertNative(const uint8_t * src, const size_t srcSize, const pcf::image::YuvCoefficients & c, unsigned char * dest) const {
+		const struct v4l2_pix_format & pix = this->srcFormat.fmt.pix;
+		const size_t width = size_t(pix.width);
+		const size_t height = size_t(pix.height);
+		const size_t stride = size_t(pix.bytesperline);
+		const size_t lumaSize = stride * height;
+		if ((width * height * 3) > this->rgbBufferLength) return false;
+		switch (pix.pixelformat) {
+		case V4L2_PIX_FMT_YUYV:
+			if (stride < (width * 2) || srcSize < lumaSize) return false;
+			pcf::image::convertYuvToRgb24(pcf::image::YuvImage{src, 2, stride, src + 1, src + 3, 4, stride, 0}, width, height, c, dest);
+			break;
+		case V4L2_PIX_FMT_UYVY:
+			if (stride < (width * 2) || srcSize < lumaSize) return false;
+			pcf::image::convertYuvToRgb24(pcf::image::YuvImage{src + 1, 2, stride, src, src + 2, 4, stride, 0}, width, height, c, dest);
+			break;
+		case V4L2_PIX_FMT_NV12:
+			if (stride < width || srcSize < (lumaSize + (stride * ((height + 1) / 2)))) return false;
+			pcf::image::convertYuvToRgb24(pcf::image::YuvImage{src, 1, stride, src + lumaSize, src + lumaSize + 1, 2, stride, 1}, width, height, c, dest);
+			break;
+		case V4L2_PIX_FMT_YUV420:
+		case V4L2_PIX_FMT_YVU420:
+			{
+				const size_t chromaStride = stride / 2;
+				const size_t chromaSize = chromaStride * ((height + 1) / 2);
+				if (stride < width || chromaStride < ((width + 1) / 2) || srcSize < (lumaSize + (chromaSize * 2))) return false;
+				const uint8_t * first = src + lumaSize;
+				const uint8_t * second = first + chromaSize;
+				const bool yvu = pix.pixelformat == V4L2_PIX_FMT_YVU420;
+				pcf::image::convertYuvToRgb24(pcf::image::YuvImage{src, 1, stride, yvu ? second : first, yvu ? first : second, 1, chromaStride, 1}, width, height, c, dest);
 			}
+			break;
+		case V4L2_PIX_FMT_BGR24:
+			if (stride < (width * 3) || srcSize < lumaSize) return false;
+			pcf::image::convertBgr24ToRgb24(src, stride, width, height, dest);
+			break;
+		case V4L2_PIX_FMT_BGR32:
+		case V4L2_PIX_FMT_XBGR32:
+		case V4L2_PIX_FMT_ABGR32:
+			if (stride < (width * 4) || srcSize < lumaSize) return false;
+			pcf::image::convertBgrxToRgb24(src, stride, width, height, dest);
+			break;
+		case V4L2_PIX_FMT_RGB24:
+			if (stride < (width * 3) || srcSize < lumaSize) return false;
+			for (size_t row = 0; row < height; row++) memcpy(dest + (row * width * 3), src + (row * stride), width * 3);
+			break;
+		default:
+			return false;
 		}
+		return true;
+	}
+
+	/**
+	 * Decodes the given MJPEG frame to RGB24 using TurboJPEG.
+	 * The frame is decoded at 1/2 or 1/4 scale via scaled IDCT if the result
+	 * still covers the display size reported by the callback. Large frames with
+	 * restart markers are decoded in horizontal bands on multiple threads.
+	 *
+	 * @param[in] src - JPEG frame data
+	 * @param[in] srcSize - number of bytes in `src`
+	 * @param[out] dest - destination buffer with `rgbBufferLength` bytes
+	 * @param[out] width - decoded image width
+	 * @param[out] height - decoded image height
+	 * @param[out] srcWidth - source image width
+	 * @param[out] srcHeight - source image height
+	 * @return NULL on success, else the error message
+	 */
+	const char * decodeJpeg(const unsigned char * src, const size_t srcSize, unsigned char * dest, size_t & width, size_t & height, size_t & srcWidth, size_t & srcHeight) {
+		int jpegWidth, jpegHeight, jpegSubsamp, jpegColorspace;
+		if (tjDecompressHeader3(this->jpeg, src, static_cast<unsigned long>(srcSize), &jpegWidth, &jpegHeight, &jpegSubsamp, &jpegColorspace) != 0) {
+			return tjGetErrorStr2(this->jpeg);
+		}
+		size_t dispWidth, dispHeight;
+		this->callback->getDisplaySize(dispWidth, dispHeight);
+		int outWidth = jpegWidth;
+		int outHeight = jpegHeight;
+		int outDenom = 1;
+		if (dispWidth > 0 && dispHeight > 0) {
+			for (int denom = 4; denom > 1; denom /= 2) {
+				const tjscalingfactor factor = {1, denom};
+				const int scaledWidth = TJSCALED(jpegWidth, factor);
+				const int scaledHeight = TJSCALED(jpegHeight, factor);
+				if (size_t(scaledWidth) >= dispWidth && size_t(scaledHeight) >= dispHeight) {
+					outWidth = scaledWidth;
+					outHeight = scaledHeight;
+					outDenom = denom;
+					break;
+				}
+			}
+		}
+		size_t bytes;
+		if ( ! getFrameBytes(size_t(outWidth), size_t(outHeight), bytes) || bytes > this->rgbBufferLength ) {
+			return "frame exceeds the negotiated capture resolution";
+		}
+		const char * bandError = NULL;
+		if ( this->bandDecoder.decode(src, srcSize, size_t(jpegWidth), size_t(jpegHeight), size_t(outDenom), dest, bandError) ) {
+			if (bandError != NULL) return bandError;
+		} else if (tjDecompress2(this->jpeg, src, static_cast<unsigned long>(srcSize), dest, outWidth, 0, outHeight, TJPF_RGB, TJFLAG_FASTDCT) != 0) {
+			/* corrupt data warnings are common with MJPEG streams and still yield an image */
+			if (tjGetErrorCode(this->jpeg) != TJERR_WARNING) return tjGetErrorStr2(this->jpeg);
+		}
+		width = size_t(outWidth);
+		height = size_t(outHeight);
+		srcWidth = size_t(jpegWidth);
+		srcHeight = size_t(jpegHeight);
+		return NULL;
 	}
 
 	/**
@@ -1600,34 +2879,43 @@ private:
 	 * @return true on success, else false
 	 */
 	bool stopInternal() {
-		if ( this->thread.joinable() ) {
+		if (this->thread.joinable() || this->decodeThread.joinable()) {
 			if (this->ed >= 0) {
 				uint64_t term = 1;
 				while (write(this->ed, &term, sizeof(term)) != ssize_t(sizeof(term))) {
 					usleep(10000);
 				}
 			}
-			this->thread.join();
+			if ( this->thread.joinable() ) this->thread.join();
+			if ( this->decodeThread.joinable() ) this->decodeThread.join();
 		}
 		if (this->ed >= 0) {
 			close(this->ed);
 			this->ed = -1;
 		}
+		if (this->de >= 0) {
+			close(this->de);
+			this->de = -1;
+		}
 		if (this->converter != NULL) {
 			v4lconvert_destroy(this->converter);
 			this->converter = NULL;
 		}
+		this->bandDecoder.stop();
+		if (this->jpeg != NULL) {
+			tjDestroy(this->jpeg);
+			this->jpeg = NULL;
+		}
 		if (this->fd >= 0) {
+			/* keep the cached state for a silent restart if the device vanished while capturing */
+			struct v4l2_capability caps;
+			if (this->state.card[0] != 0 && xEINTR(ioctl, this->fd, VIDIOC_QUERYCAP, &caps) < 0 && errno == ENODEV) {
+				CaptureStateCache::getInstance().interrupt(this->state);
+			}
 			close(this->fd);
 			this->fd = -1;
 		}
-		for (__u32 n = 0; n < this->bufferCount; n++) {
-			if (this->bufferDesc[n].start != MAP_FAILED) {
-				munmap(this->bufferDesc[n].start, this->bufferDesc[n].length);
-				this->bufferDesc[n].start = MAP_FAILED;
-			}
-		}
-		this->bufferCount = 0;
+		this->unmapBuffers();
 		if (this->rgbBuffer != NULL) {
 			free(this->rgbBuffer);
 			this->rgbBuffer = NULL;
@@ -1810,6 +3098,21 @@ CaptureDeviceList NativeVideoCaptureProvider::getDeviceList() {
 	char path[PCF_MAX_SYS_PATH] = "/sys/class/video4linux";
 	NativeVideoCaptureProvider::Pimple::getAvailableDevices(result, path, true);
 
+	/* apply the capture configuration given via environment variable; report invalid ones only once */
+	static std::atomic<bool> configReported(false);
+	const char * config = getenv(PCF_V4L2_CONFIG_ENV);
+	if (config != NULL) {
+		for (CaptureDevice * dev : result) {
+			const char * errPos = NULL;
+			if (dev->setConfiguration(config, &errPos) != CaptureDevice::RC_SUCCESS && ( ! configReported.exchange(true) )) {
+				fprintf(stderr, "Warning: invalid %s value at \"%s\"\n", PCF_V4L2_CONFIG_ENV, (errPos != NULL) ? errPos : config);
+			}
+		}
+	}
+
+	/* add test capture devices enabled via environment variables */
+	addTestCaptureDevices(result);
+
 	/* return device list */
 	return result;
 }
@@ -0,0 +1,415 @@
+/**
+ * @file MjpegBandDecoder.hpp
+ * @author Daniel Starke
+ * @date 2026-10-16
+ * @version 2026-10-16
+ */
+#ifndef __PCF_VIDEO_MJPEGBANDDECODER_HPP__
+#define __PCF_VIDEO_MJPEGBANDDECODER_HPP__
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+extern "C" {
+#include <turbojpeg.h>
+}
+
+
+/** Maximum number of threads decoding a single MJPEG frame. */
+#define PCF_V4L2_MJPEG_MAX_THREADS 8
+
+
+/** Minimum number of pixels of an MJPEG frame to decode it on multiple threads. */
+#define PCF_V4L2_MJPEG_MIN_PIXELS (1280 * 720)
+
+
+namespace pcf {
+namespace video {
+
+
+/**
+ * Decodes MJPEG frames with restart markers on multiple threads. The entropy coded data
+ * is split at the restart markers which coincide with MCU row boundaries into horizontal
+ * bands. Each band is decoded as independent JPEG image into its rows of the output frame.
+ * The calling thread and a small pool of worker threads take the next pending band once
+ * idle. Hence, the frame latency is bound by the slowest band.
+ * Vertically subsampled chroma is upsampled with the neighboring chroma rows. A band
+ * therefore also decodes the MCU rows up to the next restart segment boundary above and
+ * below and discards them to yield the same output as a single decoder call.
+ */
+class MjpegBandDecoder {
+private:
+	/** Horizontal band of a frame. */
+	struct Band {
+		size_t firstSegment; /**< first restart segment to decode */
+		size_t lastSegment; /**< one past the last restart segment to decode */
+		size_t decodeRow; /**< first decoded image row */
+		size_t decodeHeight; /**< number of decoded image rows */
+		size_t row; /**< first image row of the output frame */
+		size_t height; /**< number of image rows of the output frame */
+	};
+	/** Restart segment boundary which coincides with an MCU row boundary. */
+	struct Cut {
+		size_t segment; /**< index of the first restart segment after the boundary */
+		size_t row; /**< image row of the boundary */
+	};
+	/** Decoding state of a single thread. */
+	struct Worker {
+		tjhandle handle; /**< TurboJPEG decompressor */
+		std::vector<uint8_t> image; /**< JPEG image of the current band */
+		std::vector<unsigned char> rgb; /**< decoded rows of the current band including the discarded ones */
+
+		/** Constructor. */
+		Worker():
+			handle(NULL)
+		{}
+	};
+	std::vector<Worker> workers; /**< decoding state of each thread; index 0 belongs to the calling thread */
+	std::vector<std::thread> threads; /**< worker threads */
+	std::mutex mutex; /**< guards the job below, `generation`, `active`, `terminate` and `error` */
+	std::condition_variable wake; /**< signals a new job or termination to the worker threads */
+	std::condition_variable done; /**< signals the completion of a job or worker thread to the calling thread */
+	uint64_t generation; /**< number of started jobs */
+	size_t active; /**< number of worker threads processing the current job */
+	bool terminate; /**< signals the worker threads to terminate */
+	const uint8_t * src; /**< JPEG frame of the current job */
+	std::vector<uint8_t> header; /**< JPEG header up to the entropy coded data */
+	size_t heightOffset; /**< offset of the image height within `header` */
+	std::vector<size_t> segments; /**< start and end offset of each restart segment within `src` */
+	std::vector<Cut> cuts; /**< restart segment boundaries of the current job */
+	std::vector<Band> bands; /**< bands of the current job */
+	unsigned char * dest; /**< RGB24 output frame of the current job */
+	size_t destWidth; /**< output frame width */
+	size_t scale; /**< scaling denominator of the output frame */
+	std::atomic<size_t> nextBand; /**< next band to decode */
+	std::atomic<size_t> remaining; /**< number of bands not decoded yet */
+	char error[256]; /**< first decoding error of the current job or an empty string */
+public:
+	/** Constructor. */
+	explicit inline MjpegBandDecoder():
+		generation(0),
+		active(0),
+		terminate(false),
+		src(NULL),
+		heightOffset(0),
+		dest(NULL),
+		destWidth(0),
+		scale(1),
+		nextBand(0),
+		remaining(0)
+	{
+		this->error[0] = 0;
+	}
+
+	/** Destructor. */
+	inline ~MjpegBandDecoder() {
+		this->stop();
+	}
+
+	/**
+	 * Starts the worker threads. The number of threads including the calling one is
+	 * limited by the number of CPU cores and PCF_V4L2_MJPEG_MAX_THREADS unless given.
+	 *
+	 * @param[in] threadCount - number of threads including the calling one or 0 for the default
+	 * @return true on success, false if multi-threaded decoding is not available
+	 */
+	bool start(const size_t threadCount = 0) {
+		this->stop();
+		const size_t count = (threadCount > 0) ? threadCount : std::min(size_t(std::thread::hardware_concurrency()), size_t(PCF_V4L2_MJPEG_MAX_THREADS));
+		if (count < 2) return false;
+		this->workers.resize(count);
+		for (Worker & worker : this->workers) {
+			worker.handle = tjInitDecompress();
+			if (worker.handle == NULL) {
+				this->stop();
+				return false;
+			}
+		}
+		this->terminate = false;
+		try {
+			for (size_t n = 1; n < count; n++) this->threads.emplace_back(&MjpegBandDecoder::workerProc, this, n);
+		} catch (...) {
+			this->stop();
+			return false;
+		}
+		return true;
+	}
+
+	/**
+	 * Stops the worker threads. This may not be called while decode() is running.
+	 */
+	void stop() {
+		{
+			std::lock_guard<std::mutex> guard(this->mutex);
+			this->terminate = true;
+		}
+		this->wake.notify_all();
+		for (std::thread & thread : this->threads) {
+			if ( thread.joinable() ) thread.join();
+		}
+		this->threads.clear();
+		for (Worker & worker : this->workers) {
+			if (worker.handle != NULL) tjDestroy(worker.handle);
+		}
+		this->workers.clear();
+	}
+
+	/**
+	 * Decodes the given MJPEG frame if it contains suitable restart markers.
+	 *
+	 * @param[in] data - JPEG frame data
+	 * @param[in] size - number of bytes in `data`
+	 * @param[in] width - JPEG image width
+	 * @param[in] height - JPEG image height
+	 * @param[in] denom - scaling denominator (1, 2 or 4)
+	 * @param[out] out - RGB24 output frame with the scaled size
+	 * @param[out] err - receives the error message or NULL on success
+	 * @return true if the frame was decoded, false if not applicable
+	 */
+	bool decode(const uint8_t * data, const size_t size, const size_t width, const size_t height, const size_t denom, unsigned char * out, const char * & err) {
+		if (this->workers.empty() || (width * height) < PCF_V4L2_MJPEG_MIN_PIXELS) return false;
+		{
+			std::unique_lock<std::mutex> lock(this->mutex);
+			/* worker threads may still return from the previous job */
+			this->done.wait(lock, [this]() { return this->active == 0; });
+			if ( ! this->split(data, size, width, height) ) return false;
+			const tjscalingfactor factor = {1, int(denom)};
+			this->src = data;
+			this->dest = out;
+			this->destWidth = size_t(TJSCALED(int(width), factor));
+			this->scale = denom;
+			this->error[0] = 0;
+			this->nextBand.store(0, std::memory_order_relaxed);
+			this->remaining.store(this->bands.size(), std::memory_order_relaxed);
+			this->generation++;
+		}
+		this->wake.notify_all();
+		this->decodeBands(0);
+		std::unique_lock<std::mutex> lock(this->mutex);
+		this->done.wait(lock, [this]() { return this->remaining.load(std::memory_order_acquire) == 0; });
+		err = (this->error[0] != 0) ? this->error : NULL;
+		return true;
+	}
+private:
+	/**
+	 * Worker thread which decodes bands of each started job.
+	 *
+	 * @param[in] index - index within `workers`
+	 */
+	void workerProc(const size_t index) {
+		uint64_t seen;
+		{
+			std::lock_guard<std::mutex> guard(this->mutex);
+			seen = this->generation;
+		}
+		for ( ;; ) {
+			{
+				std::unique_lock<std::mutex> lock(this->mutex);
+				this->wake.wait(lock, [this, seen]() { return this->terminate || this->generation != seen; });
+				if ( this->terminate ) return;
+				seen = this->generation;
+				this->active++;
+			}
+			this->decodeBands(index);
+			{
+				std::lock_guard<std::mutex> guard(this->mutex);
+				this->active--;
+			}
+			this->done.notify_all();
+		}
+	}
+
+	/**
+	 * Decodes pending bands of the current job until none is left.
+	 *
+	 * @param[in] index - index within `workers`
+	 */
+	void decodeBands(const size_t index) {
+		Worker & worker = this->workers[index];
+		for ( ;; ) {
+			const size_t n = this->nextBand.fetch_add(1, std::memory_order_relaxed);
+			if (n >= this->bands.size()) break;
+			this->decodeBand(worker, this->bands[n]);
+			if (this->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+				std::lock_guard<std::mutex> guard(this->mutex);
+				this->done.notify_all();
+			}
+		}
+	}
+
+	/**
+	 * Decodes the given band into the output frame.
+	 *
+	 * @param[in,out] worker - decoding state of the calling thread
+	 * @param[in] band - band to decode
+	 */
+	void decodeBand(Worker & worker, const Band & band) {
+		/* build an independent JPEG image with the band height and renumbered restart markers */
+		std::vector<uint8_t> & image = worker.image;
+		image.assign(this->header.begin(), this->header.end());
+		image[this->heightOffset] = uint8_t(band.decodeHeight >> 8);
+		image[this->heightOffset + 1] = uint8_t(band.decodeHeight);
+		for (size_t n = band.firstSegment; n < band.lastSegment; n++) {
+			if (n > band.firstSegment) {
+				image.push_back(0xFF);
+				image.push_back(uint8_t(0xD0 + ((n - band.firstSegment - 1) & 7)));
+			}
+			image.insert(image.end(), this->src + this->segments[n * 2], this->src + this->segments[(n * 2) + 1]);
+		}
+		image.push_back(0xFF);
+		image.push_back(0xD9);
+		const tjscalingfactor factor = {1, int(this->scale)};
+		const size_t pitch = this->destWidth * 3;
+		const size_t outRow = band.row / this->scale;
+		const size_t decodeRows = size_t(TJSCALED(int(band.decodeHeight), factor));
+		const bool overlap = band.decodeRow != band.row || band.decodeHeight != band.height;
+		unsigned char * out = this->dest + (outRow * pitch);
+		if ( overlap ) {
+			worker.rgb.resize(decodeRows * pitch);
+			out = worker.rgb.data();
+		}
+		if (tjDecompress2(worker.handle, image.data(), static_cast<unsigned long>(image.size()), out, int(this->destWidth), int(pitch), int(decodeRows), TJPF_RGB, TJFLAG_FASTDCT) != 0) {
+			/* corrupt data warnings are common with MJPEG streams and still yield an image */
+			if (tjGetErrorCode(worker.handle) != TJERR_WARNING) {
+				std::lock_guard<std::mutex> guard(this->mutex);
+				if (this->error[0] == 0) snprintf(this->error, sizeof(this->error), "%s", tjGetErrorStr2(worker.handle));
+				return;
+			}
+		}
+		if ( overlap ) {
+			/* keep only the rows of the band itself */
+			const size_t rows = size_t(TJSCALED(int(band.row + band.height), factor)) - outRow;
+			memcpy(this->dest + (outRow * pitch), worker.rgb.data() + (((band.row - band.decodeRow) / this->scale) * pitch), rows * pitch);
+		}
+	}
+
+	/**
+	 * Parses the given JPEG frame and splits it into bands at restart markers which
+	 * coincide with MCU row boundaries. Only baseline and extended sequential
+	 * Huffman coded images with a single interleaved scan are supported.
+	 *
+	 * @param[in] data - JPEG frame data
+	 * @param[in] size - number of bytes in `data`
+	 * @param[in] width - expected image width
+	 * @param[in] height - expected image height
+	 * @return true if the frame was split into at least two bands, else false
+	 */
+	bool split(const uint8_t * data, const size_t size, const size_t width, const size_t height) {
+		if (size < 4 || data[0] != 0xFF || data[1] != 0xD8) return false;
+		size_t interval = 0;
+		size_t components = 0;
+		size_t mcuWidth = 0;
+		size_t mcuHeight = 0;
+		bool overlap = false;
+		size_t pos = 2;
+		for ( ;; ) {
+			if ((pos + 4) > size || data[pos] != 0xFF) return false;
+			const uint8_t marker = data[pos + 1];
+			if (marker == 0xFF) {
+				pos++; /* fill byte */
+				continue;
+			}
+			const size_t length = (size_t(data[pos + 2]) << 8) | size_t(data[pos + 3]);
+			if (length < 2 || (pos + 2 + length) > size) return false;
+			const uint8_t * payload = data + pos + 4;
+			if (marker == 0xC0 || marker == 0xC1) {
+				/* start of frame: precision, height, width, components, per component: id, sampling factors, table */
+				if (length < 8) return false;
+				components = size_t(payload[5]);
+				if (components == 0 || length < (8 + (components * 3))) return false;
+				if (((size_t(payload[1]) << 8) | size_t(payload[2])) != height || ((size_t(payload[3]) << 8) | size_t(payload[4])) != width) return false;
+				size_t maxH = 1, maxV = 1;
+				for (size_t n = 0; n < components && components > 1; n++) {
+					maxH = std::max(maxH, size_t(payload[7 + (n * 3)] >> 4));
+					maxV = std::max(maxV, size_t(payload[7 + (n * 3)] & 0x0F));
+				}
+				/* vertically subsampled chroma needs the neighboring MCU rows for upsampling */
+				for (size_t n = 0; n < components && components > 1; n++) {
+					overlap = overlap || size_t(payload[7 + (n * 3)] & 0x0F) < maxV;
+				}
+				mcuWidth = maxH * 8;
+				mcuHeight = maxV * 8;
+				this->heightOffset = pos + 5;
+			} else if (marker >= 0xC2 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+				return false; /* progressive, lossless or arithmetic coding */
+			} else if (marker == 0xDD) {
+				/* define restart interval */
+				if (length < 4) return false;
+				interval = (size_t(payload[0]) << 8) | size_t(payload[1]);
+			} else if (marker == 0xDA) {
+				/* start of scan: all components need to be interleaved in this scan */
+				if (mcuHeight == 0 || interval == 0 || size_t(payload[0]) != components) return false;
+				pos += 2 + length;
+				break;
+			}
+			pos += 2 + length;
+		}
+		this->header.assign(data, data + pos);
+		/* find the restart markers within the entropy coded data */
+		this->segments.clear();
+		this->segments.push_back(pos);
+		while (pos < size) {
+			const uint8_t * ff = static_cast<const uint8_t *>(memchr(data + pos, 0xFF, size - pos));
+			if (ff == NULL) {
+				pos = size;
+				break;
+			}
+			pos = size_t(ff - data);
+			if ((pos + 1) >= size) break;
+			const uint8_t marker = data[pos + 1];
+			if (marker == 0x00) {
+				pos += 2; /* stuffed zero byte */
+			} else if (marker == 0xFF) {
+				pos++; /* fill byte */
+			} else if (marker >= 0xD0 && marker <= 0xD7) {
+				this->segments.push_back(pos);
+				this->segments.push_back(pos + 2);
+				pos += 2;
+			} else {
+				break; /* end of image */
+			}
+		}
+		this->segments.push_back(pos);
+		/* the frame is only usable if all restart segments are present */
+		const size_t mcusPerRow = (width + mcuWidth - 1) / mcuWidth;
+		const size_t mcuRows = (height + mcuHeight - 1) / mcuHeight;
+		const size_t segmentCount = this->segments.size() / 2;
+		if (segmentCount != (((mcusPerRow * mcuRows) + interval - 1) / interval)) return false;
+		/* collect the restart segment boundaries at MCU row boundaries */
+		this->cuts.clear();
+		this->cuts.push_back(Cut{0, 0});
+		for (size_t n = 1; n < segmentCount; n++) {
+			const size_t mcu = n * interval;
+			if ((mcu % mcusPerRow) == 0) this->cuts.push_back(Cut{n, (mcu / mcusPerRow) * mcuHeight});
+		}
+		this->cuts.push_back(Cut{segmentCount, height});
+		/* split into twice as many bands as threads for an even load */
+		const size_t bandCount = this->workers.size() * 2;
+		const size_t lastCut = this->cuts.size() - 1;
+		size_t first = 0;
+		this->bands.clear();
+		for (size_t n = 1; n <= lastCut; n++) {
+			if (n < lastCut && (this->cuts[n].row * bandCount) < ((this->bands.size() + 1) * height)) continue;
+			const Cut & from = this->cuts[(overlap && first > 0) ? (first - 1) : first];
+			const Cut & to = this->cuts[(overlap && n < lastCut) ? (n + 1) : n];
+			const size_t row = this->cuts[first].row;
+			this->bands.push_back(Band{from.segment, to.segment, from.row, to.row - from.row, row, this->cuts[n].row - row});
+			first = n;
+		}
+		return this->bands.size() > 1;
+	}
+};
+
+
+} /* namespace video */
+} /* namespace pcf */
+
+
+#endif /* __PCF_VIDEO_MJPEGBANDDECODER_HPP__ */
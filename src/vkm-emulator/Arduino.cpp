@@ -0,0 +1,450 @@
+/**
+ * @file Arduino.cpp
+ * @author Daniel Starke
+ * @copyright Copyright 2026 Daniel Starke
+ * @date 2026-10-16
+ * @version 2026-10-16
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "Arduino.h"
+#include "PluggableUSB.h"
+
+
+HardwareSerial Serial1;
+USBDeviceClass USBDevice;
+
+
+namespace {
+
+
+/** Maximum time in microseconds to wait for serial input within `HardwareSerial::available()`. */
+#define SERIAL_IDLE_WAIT 1000
+
+
+/**
+ * Returns the smaller of the given values.
+ *
+ * @param[in] x - first value
+ * @param[in] y - second value
+ * @return smallest value
+ */
+#define VKM_EMULATOR_MIN(x, y) (((x) < (y)) ? (x) : (y))
+
+
+/**
+ * Returns the larger of the given values.
+ *
+ * @param[in] x - first value
+ * @param[in] y - second value
+ * @return largest value
+ */
+#define VKM_EMULATOR_MAX(x, y) (((x) > (y)) ? (x) : (y))
+
+
+/** Current pin states. */
+uint32_t pinState[EMULATOR_PIN_COUNT] = {0};
+
+
+/**
+ * Sleeps for the given number of microseconds.
+ *
+ * @param[in] us - duration in microseconds
+ */
+void sleepMicroseconds(const unsigned long us) {
+	struct timespec ts;
+	ts.tv_sec = time_t(us / 1000000);
+	ts.tv_nsec = long((us % 1000000) * 1000);
+	while (nanosleep(&ts, &ts) != 0 && errno == EINTR);
+}
+
+
+} /* anonymous namespace */
+
+
+/**
+ * Returns the number of microseconds since the first call. Other than `micros()` this
+ * does not wrap around and is used for the emulation timing.
+ *
+ * @return microseconds
+ */
+unsigned long emulatorMicros(void) {
+	static struct timespec start = {0, 0};
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	if (start.tv_sec == 0 && start.tv_nsec == 0) start = now;
+	return (static_cast<unsigned long>(now.tv_sec - start.tv_sec) * 1000000UL) + static_cast<unsigned long>(now.tv_nsec / 1000) - static_cast<unsigned long>(start.tv_nsec / 1000);
+}
+
+
+/**
+ * Returns the number of milliseconds since start.
+ * The emulated USB host polls the device endpoints here. This allows the firmware to
+ * observe host side changes within busy waiting loops like it would via the USB
+ * interrupt.
+ *
+ * @return milliseconds
+ */
+uint32_t millis(void) {
+	PluggableUSB().poll();
+	return uint32_t(emulatorMicros() / 1000);
+}
+
+
+/**
+ * Returns the number of microseconds since start.
+ *
+ * @return microseconds
+ */
+uint32_t micros(void) {
+	return uint32_t(emulatorMicros());
+}
+
+
+/**
+ * Waits the given number of milliseconds.
+ *
+ * @param[in] ms - duration in milliseconds
+ */
+void delay(uint32_t ms) {
+	const uint32_t start = millis();
+	while (uint32_t(millis() - start) < ms) {
+		sleepMicroseconds(100);
+	}
+}
+
+
+/**
+ * Waits the given number of microseconds.
+ *
+ * @param[in] us - duration in microseconds
+ */
+void delayMicroseconds(uint32_t us) {
+	sleepMicroseconds(us);
+}
+
+
+/**
+ * Configures the given pin. This has no effect.
+ *
+ * @param[in] pin - pin number
+ * @param[in] mode - pin mode
+ */
+void pinMode(uint32_t pin, uint32_t mode) {
+	(void)pin;
+	(void)mode;
+}
+
+
+/**
+ * Sets the output state of the given pin.
+ *
+ * @param[in] pin - pin number
+ * @param[in] val - `LOW` or `HIGH`
+ */
+void digitalWrite(uint32_t pin, uint32_t val) {
+	if (pin < EMULATOR_PIN_COUNT) pinState[pin] = val;
+}
+
+
+/**
+ * Returns the input state of the given pin.
+ *
+ * @param[in] pin - pin number
+ * @return `LOW` or `HIGH`
+ */
+int digitalRead(uint32_t pin) {
+	if (pin == PA_4) return USBDevice.isConnected() ? HIGH : LOW;
+	if (pin < EMULATOR_PIN_COUNT) return int(pinState[pin]);
+	return LOW;
+}
+
+
+/**
+ * Constructor.
+ */
+HardwareSerial::HardwareSerial():
+	master(-1),
+	slave(-1),
+	baud(0),
+	baudFixed(false),
+	rx(),
+	tx()
+{}
+
+
+/**
+ * Destructor.
+ */
+HardwareSerial::~HardwareSerial() {
+	if (this->slave >= 0) close(this->slave);
+	if (this->master >= 0) close(this->master);
+}
+
+
+/**
+ * Creates the pseudo-terminal which is used as serial interface.
+ *
+ * @param[in] link - optional path of a symbolic link to create to the pseudo-terminal
+ * @return true on success, else false
+ */
+bool HardwareSerial::openPty(const char * link) {
+	struct termios settings;
+	this->master = posix_openpt(O_RDWR | O_NOCTTY);
+	if (this->master < 0) return false;
+	if (grantpt(this->master) != 0 || unlockpt(this->master) != 0) return false;
+	const char * name = ptsname(this->master);
+	if (name == NULL) return false;
+	/* keep the slave side open to avoid hang-ups if the controller closes it */
+	this->slave = open(name, O_RDWR | O_NOCTTY);
+	if (this->slave < 0) return false;
+	if (tcgetattr(this->slave, &settings) != 0) return false;
+	cfmakeraw(&settings);
+	if (tcsetattr(this->slave, TCSANOW, &settings) != 0) return false;
+	if (fcntl(this->master, F_SETFL, fcntl(this->master, F_GETFL) | O_NONBLOCK) != 0) return false;
+	if (link != NULL) {
+		unlink(link);
+		if (symlink(name, link) != 0) return false;
+	}
+	return true;
+}
+
+
+/**
+ * Returns the path to the pseudo-terminal.
+ *
+ * @return pseudo-terminal path
+ */
+const char * HardwareSerial::getPtyName() const {
+	return (this->master >= 0) ? ptsname(this->master) : NULL;
+}
+
+
+/**
+ * Sets the emulated baud rate. This overrides the value passed to `begin()`.
+ *
+ * @param[in] rate - baud rate or 0 for unlimited
+ */
+void HardwareSerial::setBaudRate(const unsigned long rate) {
+	this->baud = rate;
+	this->baudFixed = true;
+}
+
+
+/**
+ * Starts the serial interface.
+ *
+ * @param[in] rate - baud rate
+ */
+void HardwareSerial::begin(const unsigned long rate) {
+	if ( ! this->baudFixed ) this->baud = rate;
+}
+
+
+/**
+ * Returns the number of bytes which can be read. Waits a short time for new data if none
+ * are available to avoid busy looping in the firmware main loop.
+ *
+ * @return number of available bytes
+ */
+int HardwareSerial::available() {
+	this->pump(false);
+	if (this->rx.count > 0 && emulatorMicros() >= this->rx.doneAt) {
+		const unsigned long bt = this->byteTime();
+		if (bt == 0) return int(this->rx.count);
+		return int(VKM_EMULATOR_MIN(this->rx.count, size_t(1 + ((emulatorMicros() - this->rx.doneAt) / bt))));
+	}
+	this->pump(true);
+	return (this->rx.count > 0 && emulatorMicros() >= this->rx.doneAt) ? 1 : 0;
+}
+
+
+/**
+ * Reads a single byte.
+ *
+ * @return read byte or -1 if none is available
+ */
+int HardwareSerial::read() {
+	this->pump(false);
+	if (this->rx.count == 0 || emulatorMicros() < this->rx.doneAt) return -1;
+	const int res = this->rx.data[this->rx.first];
+	this->rx.first = (this->rx.first + 1) % BUFFER_SIZE;
+	this->rx.count--;
+	this->rx.doneAt += this->byteTime();
+	return res;
+}
+
+
+/**
+ * Writes a single byte. Blocks while the transmit buffer is full.
+ *
+ * @param[in] val - byte to write
+ * @return number of bytes written
+ */
+size_t HardwareSerial::write(const uint8_t val) {
+	this->pump(false);
+	while (this->tx.count >= BUFFER_SIZE) this->pump(true);
+	if (this->tx.count == 0) this->tx.doneAt = VKM_EMULATOR_MAX(this->tx.doneAt, emulatorMicros() + this->byteTime());
+	this->tx.data[(this->tx.first + this->tx.count) % BUFFER_SIZE] = val;
+	this->tx.count++;
+	this->pump(false);
+	return 1;
+}
+
+
+/**
+ * Waits until all bytes have been transmitted.
+ */
+void HardwareSerial::flush() {
+	this->pump(false);
+	while (this->tx.count > 0) this->pump(true);
+}
+
+
+/**
+ * Returns the time needed to transmit a single byte.
+ *
+ * @return time in microseconds or 0 for unlimited
+ */
+unsigned long HardwareSerial::byteTime() const {
+	/* 1 start bit, 8 data bits and 1 stop bit */
+	return (this->baud > 0) ? ((10000000UL + this->baud - 1) / this->baud) : 0;
+}
+
+
+/**
+ * Exchanges data with the pseudo-terminal. Bytes to the controller are passed on once
+ * their transmission time passed. Received bytes are queued with their transmission
+ * time.
+ *
+ * @param[in] wait - true to wait for the next transmission event
+ */
+void HardwareSerial::pump(const bool wait) {
+	if (this->master < 0) return;
+	const unsigned long bt = this->byteTime();
+	unsigned long now = emulatorMicros();
+	if ( wait ) {
+		/* wait for input or the next byte on the wire */
+		unsigned long timeout = SERIAL_IDLE_WAIT;
+		if (this->rx.count > 0) timeout = (this->rx.doneAt > now) ? VKM_EMULATOR_MIN(timeout, this->rx.doneAt - now) : 0;
+		if (this->tx.count > 0) timeout = (this->tx.doneAt > now) ? VKM_EMULATOR_MIN(timeout, this->tx.doneAt - now) : 0;
+		if (timeout > 0) {
+			struct pollfd pfd;
+			struct timespec ts;
+			pfd.fd = this->master;
+			pfd.events = POLLIN;
+			pfd.revents = 0;
+			ts.tv_sec = 0;
+			ts.tv_nsec = long(timeout * 1000);
+			ppoll(&pfd, 1, &ts, NULL);
+			now = emulatorMicros();
+		}
+	}
+	/* receive */
+	while (this->rx.count < BUFFER_SIZE) {
+		uint8_t buf[BUFFER_SIZE];
+		const ssize_t res = ::read(this->master, buf, BUFFER_SIZE - this->rx.count);
+		if (res <= 0) break;
+		for (ssize_t i = 0; i < res; i++) {
+			if (this->rx.count == 0) this->rx.doneAt = VKM_EMULATOR_MAX(this->rx.doneAt, now + bt);
+			this->rx.data[(this->rx.first + this->rx.count) % BUFFER_SIZE] = buf[i];
+			this->rx.count++;
+		}
+	}
+	/* transmit */
+	uint8_t buf[BUFFER_SIZE];
+	size_t len = 0;
+	while (this->tx.count > 0 && now >= this->tx.doneAt) {
+		buf[len++] = this->tx.data[this->tx.first];
+		this->tx.first = (this->tx.first + 1) % BUFFER_SIZE;
+		this->tx.count--;
+		this->tx.doneAt += bt;
+	}
+	/* data is lost if the controller does not read it (like on a real UART) */
+	if (len > 0 && ::write(this->master, buf, len) < 0) return;
+}
+
+
+/**
+ * Constructor.
+ */
+USBDeviceClass::USBDeviceClass():
+	connected(true),
+	attached(true),
+	isConfigured(false)
+{}
+
+
+/**
+ * Connects or disconnects the emulated USB host.
+ *
+ * @param[in] value - true to connect, false to disconnect
+ */
+void USBDeviceClass::setConnected(const bool value) {
+	this->connected = value;
+	if ( ! value ) this->isConfigured = false;
+}
+
+
+/**
+ * Returns whether the emulated USB host is connected.
+ *
+ * @return true if connected, else false
+ */
+bool USBDeviceClass::isConnected() const {
+	return this->connected;
+}
+
+
+/**
+ * Lets the emulated USB host enumerate the device if attached and connected.
+ * Needs to be called periodically.
+ */
+void USBDeviceClass::update() {
+	if (this->connected && this->attached && ( ! this->isConfigured )) {
+		PluggableUSB().enumerate();
+		this->isConfigured = true;
+	}
+}
+
+
+/**
+ * Returns whether the device was enumerated by the USB host.
+ *
+ * @return true if configured, else false
+ */
+bool USBDeviceClass::configured() {
+	return this->isConfigured;
+}
+
+
+/**
+ * Attaches the device to the bus.
+ */
+void USBDeviceClass::attach() {
+	this->attached = true;
+}
+
+
+/**
+ * Detaches the device from the bus.
+ */
+void USBDeviceClass::detach() {
+	this->attached = false;
+	this->isConfigured = false;
+}
+
+
+/**
+ * Returns whether the bus is suspended. This is never the case.
+ *
+ * @return false
+ */
+bool USBDeviceClass::isSuspended() {
+	return false;
+}
@@ -0,0 +1,123 @@
+/**
+ * @file Arduino.h
+ * @author Daniel Starke
+ * @copyright Copyright 2026 Daniel Starke
+ * @date 2026-10-16
+ * @version 2026-10-16
+ *
+ * Minimal Arduino core replacement to run the periphery firmware on a Linux host.
+ * `Serial1` is exposed as pseudo-terminal and the USB host side is emulated.
+ */
+#ifndef __VKM_EMULATOR_ARDUINO_H__
+#define __VKM_EMULATOR_ARDUINO_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+
+#define LOW 0
+#define HIGH 1
+
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define INPUT_PULLDOWN 3
+#define OUTPUT_OPEN_DRAIN 4
+
+
+/** Emulated pins as used by the periphery firmware. */
+enum {
+	PA_4, /**< USB2 VBUS sense input. Reflects the emulated USB connection state. */
+	PF_1, /**< Status LED output. */
+	EMULATOR_PIN_COUNT /**< Number of emulated pins. */
+};
+
+
+extern "C" {
+/* 32 bit time values like on the target */
+uint32_t millis(void);
+uint32_t micros(void);
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void pinMode(uint32_t pin, uint32_t mode);
+void digitalWrite(uint32_t pin, uint32_t val);
+int digitalRead(uint32_t pin);
+} /* extern "C" */
+
+
+unsigned long emulatorMicros(void);
+
+
+/**
+ * Serial interface which is exposed as pseudo-terminal.
+ * The transfer rate of both directions is limited to the configured baud rate with
+ * 10 bits per byte (8N1) to reproduce the timing of the UART between controller and
+ * periphery.
+ */
+class HardwareSerial {
+private:
+	enum {
+		BUFFER_SIZE = 64 /**< Receive and transmit buffer size in bytes (same as the AVR Arduino core). */
+	};
+	/** Byte ring buffer with the time at which the oldest byte left the wire. */
+	struct Ring {
+		uint8_t data[BUFFER_SIZE]; /**< Buffered bytes. */
+		size_t first; /**< Index of the oldest byte. */
+		size_t count; /**< Number of buffered bytes. */
+		unsigned long doneAt; /**< Time in microseconds at which the oldest byte completes. */
+	};
+	int master; /**< Pseudo-terminal master file descriptor. */
+	int slave; /**< Pseudo-terminal slave file descriptor (kept open to survive reconnects). */
+	unsigned long baud; /**< Emulated baud rate or 0 for unlimited. */
+	bool baudFixed; /**< True if the baud rate was set by the user and `begin()` shall not override it. */
+	Ring rx; /**< Bytes received from the controller. */
+	Ring tx; /**< Bytes to send to the controller. */
+public:
+	explicit HardwareSerial();
+	~HardwareSerial();
+
+	bool openPty(const char * link = NULL);
+	const char * getPtyName() const;
+	void setBaudRate(const unsigned long rate);
+
+	void begin(const unsigned long rate);
+	int available();
+	int read();
+	size_t write(const uint8_t val);
+	void flush();
+private:
+	unsigned long byteTime() const;
+	void pump(const bool wait);
+};
+
+
+extern HardwareSerial Serial1;
+
+
+/**
+ * Emulated USB device state. The host side is emulated by `PluggableUSB_`.
+ */
+class USBDeviceClass {
+private:
+	bool connected; /**< True if a USB host is connected (VBUS present). */
+	bool attached; /**< True if the device is attached to the bus. */
+	bool isConfigured; /**< True if the host enumerated the device. */
+public:
+	explicit USBDeviceClass();
+
+	void setConnected(const bool value);
+	bool isConnected() const;
+	void update();
+
+	bool configured();
+	void attach();
+	void detach();
+	bool isSuspended();
+};
+
+
+extern USBDeviceClass USBDevice;
+
+
+#endif /* __VKM_EMULATOR_ARDUINO_H__ */
@@ -0,0 +1,92 @@
+/**
+ * @file HidDescriptor.hpp
+ * @author Daniel Starke
+ * @copyright Copyright 2026 Daniel Starke
+ * @date 2026-10-16
+ * @version 2026-10-16
+ *
+ * Stand-in for the HidDescCTC interface used by the periphery firmware. The emulated
+ * USB host does not parse report descriptors. Hence, no descriptor gets compiled and
+ * the HidDescCTC library is not needed to build the emulator.
+ */
+#ifndef __VKM_EMULATOR_HIDDESCRIPTOR_HPP__
+#define __VKM_EMULATOR_HIDDESCRIPTOR_HPP__
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+namespace hid {
+
+
+/** Descriptor source reference. */
+struct Source {
+	const char * str; /**< HID descriptor source. */
+
+	/**
+	 * Binds a value to a named placeholder within the source. This has no effect.
+	 *
+	 * @param[in] name - placeholder name
+	 * @param[in] value - placeholder value
+	 * @return this source
+	 * @tparam T - value type
+	 */
+	template <typename T>
+	constexpr Source operator() (const char * name, const T value) const {
+		return (void)name, (void)value, *this;
+	}
+};
+
+
+/** Descriptor compilation error. */
+struct Error {
+	size_t line; /**< Line of the error. */
+	size_t column; /**< Column of the error. */
+	int message; /**< Error message identifier (0 for none). */
+};
+
+
+/**
+ * Compiled HID descriptor. It is always empty.
+ *
+ * @tparam N - buffer size
+ */
+template <size_t N>
+struct Descriptor {
+	uint8_t data[N]; /**< Descriptor data. */
+
+	constexpr explicit Descriptor(const Source &):
+		data{}
+	{}
+
+	constexpr size_t size() const {
+		return 0;
+	}
+};
+
+
+constexpr Source fromSource(const char * str) {
+	return Source{str};
+}
+
+
+constexpr Error compileError(const Source &) {
+	return Error{0, 0, 0};
+}
+
+
+constexpr size_t compiledSize(const Source &) {
+	return 1;
+}
+
+
+template <size_t line, size_t column, int message>
+constexpr size_t reporter() {
+	return 0;
+}
+
+
+} /* namespace hid */
+
+
+#endif /* __VKM_EMULATOR_HIDDESCRIPTOR_HPP__ */
@@ -0,0 +1,361 @@
+/**
+ * @file PluggableUSB.cpp
+ * @author Daniel Starke
+ * @copyright Copyright 2026 Daniel Starke
+ * @date 2026-10-16
+ * @version 2026-10-16
+ */
+#include <cstdio>
+#include <cstring>
+#include <errno.h>
+#include <time.h>
+#include <vkm-periphery/UsbKeys.hpp>
+#include "PluggableUSB.h"
+
+
+namespace {
+
+
+/** HID class request to set a report (USB HID v1.11 chapter 7.2.2). */
+#define HID_SET_REPORT 0x09
+/** HID output report type (USB HID v1.11 chapter 7.2.1). */
+#define HID_REPORT_TYPE_OUTPUT 2
+/** HID interface class/subclass/protocol of a boot keyboard (USB HID v1.11 chapter 4). */
+#define HID_SUBCLASS_BOOT_INTERFACE 1
+#define HID_PROTOCOL_KEYBOARD 1
+
+
+/**
+ * Sleeps until the given time.
+ *
+ * @param[in] until - time in microseconds
+ */
+void sleepUntil(const unsigned long until) {
+	const unsigned long now = emulatorMicros();
+	if (until <= now) return;
+	struct timespec ts;
+	ts.tv_sec = time_t((until - now) / 1000000);
+	ts.tv_nsec = long(((until - now) % 1000000) * 1000);
+	while (nanosleep(&ts, &ts) != 0 && errno == EINTR);
+}
+
+
+} /* anonymous namespace */
+
+
+/**
+ * Returns the emulated USB host instance.
+ *
+ * @return USB host
+ */
+PluggableUSB_ & PluggableUSB() {
+	static PluggableUSB_ singleton;
+	return singleton;
+}
+
+
+/**
+ * Sends the given data via the given endpoint.
+ *
+ * @param[in] ep - endpoint number and transfer flags
+ * @param[in] data - data to send
+ * @param[in] len - number of bytes to send
+ * @return number of bytes sent or -1 on error
+ */
+int USB_Send(const uint8_t ep, const void * data, const int len) {
+	return PluggableUSB().send(ep, data, len);
+}
+
+
+/**
+ * Sends the given data via the control endpoint.
+ *
+ * @param[in] flags - transfer flags
+ * @param[in] data - data to send
+ * @param[in] len - number of bytes to send
+ * @return number of bytes sent
+ */
+int USB_SendControl(const uint8_t flags, const void * data, const size_t len) {
+	return PluggableUSB().sendControl(flags, data, len);
+}
+
+
+/**
+ * Receives data from the control endpoint.
+ *
+ * @param[out] data - receives the data
+ * @param[in] len - number of bytes to receive
+ * @return number of bytes received
+ */
+int USB_RecvControl(void * data, const int len) {
+	return PluggableUSB().recvControl(data, len);
+}
+
+
+/**
+ * Constructor.
+ */
+PluggableUSB_::PluggableUSB_():
+	lastIf(0),
+	lastEp(1), /* endpoint 0 is the control endpoint */
+	rootNode(NULL),
+	ep(),
+	pollInterval(0),
+	keyboardModule(NULL),
+	keyboardInterface(0),
+	keyboardEndpoint(0),
+	keys{0},
+	leds(0),
+	controlData(NULL),
+	controlDataSize(0),
+	controlBuf{0},
+	controlSize(0),
+	capture(false),
+	verbose(false),
+	polling(false)
+{}
+
+
+/**
+ * Overrides the poll interval of all interrupt endpoints.
+ *
+ * @param[in] ms - poll interval in milliseconds or 0 to use the endpoint descriptor value
+ */
+void PluggableUSB_::setPollInterval(const unsigned long ms) {
+	this->pollInterval = ms * 1000;
+}
+
+
+/**
+ * Enables or disables the output of each report collected by the host to `stdout`.
+ *
+ * @param[in] value - true to enable, false to disable
+ */
+void PluggableUSB_::setVerbose(const bool value) {
+	this->verbose = value;
+}
+
+
+/**
+ * Plugs in the given USB function module.
+ *
+ * @param[in] node - module to add
+ * @return true on success, else false
+ */
+bool PluggableUSB_::plug(PluggableUSBModule * node) {
+	if ((this->lastEp + node->numEndpoints) > USB_ENDPOINTS) return false;
+	if (this->rootNode == NULL) {
+		this->rootNode = node;
+	} else {
+		PluggableUSBModule * current = this->rootNode;
+		while (current->next != NULL) current = current->next;
+		current->next = node;
+	}
+	node->pluggedInterface = this->lastIf;
+	node->pluggedEndpoint = this->lastEp;
+	this->lastIf = uint8_t(this->lastIf + node->numInterfaces);
+	for (uint8_t i = 0; i < node->numEndpoints; i++) {
+		this->ep[this->lastEp].module = node;
+		this->ep[this->lastEp].interval = 1;
+		this->lastEp++;
+	}
+	return true;
+}
+
+
+/**
+ * Enumerates the device. The endpoint poll intervals are taken from the interface
+ * descriptors of the plugged modules and the current keyboard LED states are sent to
+ * the device like a host operating system does.
+ */
+void PluggableUSB_::enumerate() {
+	for (uint8_t i = 0; i < USB_ENDPOINTS; i++) this->ep[i].len = 0;
+	this->keyboardModule = NULL;
+	this->keyboardEndpoint = 0;
+	memset(this->keys, 0, sizeof(this->keys));
+	for (PluggableUSBModule * node = this->rootNode; node != NULL; node = node->next) {
+		this->parseConfiguration(node);
+	}
+	this->setLeds(this->leds);
+}
+
+
+/**
+ * Collects all pending reports whose endpoint poll time has been reached.
+ */
+void PluggableUSB_::poll() {
+	if ( this->polling ) return;
+	this->polling = true;
+	const unsigned long now = emulatorMicros();
+	for (uint8_t i = 1; i < USB_ENDPOINTS; i++) {
+		if (this->ep[i].len > 0 && now >= this->ep[i].collectAt) this->collect(i);
+	}
+	this->polling = false;
+}
+
+
+/**
+ * Queues the given report on the given interrupt IN endpoint. The host collects it with
+ * its next poll of that endpoint. Blocks while the previous report was not collected,
+ * yet, like a single buffered endpoint does.
+ *
+ * @param[in] endpoint - endpoint number and transfer flags
+ * @param[in] data - report data
+ * @param[in] len - report length
+ * @return number of bytes sent or -1 on error
+ */
+int PluggableUSB_::send(const uint8_t endpoint, const void * data, const int len) {
+	const uint8_t idx = uint8_t(endpoint & 0x0F);
+	if (idx == 0 || idx >= USB_ENDPOINTS || len < 0 || size_t(len) > sizeof(this->ep[0].data)) return -1;
+	Endpoint & e = this->ep[idx];
+	if (e.module == NULL || ( ! USBDevice.configured() )) return -1;
+	this->poll();
+	while (e.len > 0) {
+		sleepUntil(e.collectAt);
+		this->poll();
+	}
+	memcpy(e.data, data, size_t(len));
+	e.len = uint8_t(len);
+	e.collectAt = this->nextPoll(e, emulatorMicros());
+	return len;
+}
+
+
+/**
+ * Handles data sent via the control endpoint. It is only recorded during enumeration.
+ *
+ * @param[in] flags - transfer flags
+ * @param[in] data - data to send
+ * @param[in] len - number of bytes to send
+ * @return number of bytes sent
+ */
+int PluggableUSB_::sendControl(const uint8_t flags, const void * data, const size_t len) {
+	(void)flags;
+	if ( this->capture ) {
+		const size_t size = (len < (sizeof(this->controlBuf) - this->controlSize)) ? len : (sizeof(this->controlBuf) - this->controlSize);
+		memcpy(this->controlBuf + this->controlSize, data, size);
+		this->controlSize += size;
+	}
+	return int(len);
+}
+
+
+/**
+ * Passes the data of the current host to device control request.
+ *
+ * @param[out] data - receives the data
+ * @param[in] len - number of bytes to receive
+ * @return number of bytes received
+ */
+int PluggableUSB_::recvControl(void * data, const int len) {
+	if (this->controlData == NULL || len <= 0) return 0;
+	const size_t size = (size_t(len) < this->controlDataSize) ? size_t(len) : this->controlDataSize;
+	memcpy(data, this->controlData, size);
+	return int(size);
+}
+
+
+/**
+ * Returns the time of the next host poll of the given endpoint.
+ *
+ * @param[in] e - endpoint
+ * @param[in] now - current time in microseconds
+ * @return poll time in microseconds
+ */
+unsigned long PluggableUSB_::nextPoll(const Endpoint & e, const unsigned long now) const {
+	const unsigned long interval = (this->pollInterval > 0) ? this->pollInterval : static_cast<unsigned long>(e.interval) * 1000;
+	return ((now / interval) + 1) * interval;
+}
+
+
+/**
+ * Reads the interface descriptors of the given module to obtain the endpoint poll
+ * intervals and the boot keyboard interface.
+ *
+ * @param[in] module - module to parse
+ */
+void PluggableUSB_::parseConfiguration(PluggableUSBModule * module) {
+	uint8_t interfaceCount = 0;
+	this->controlSize = 0;
+	this->capture = true;
+	module->getInterface(&interfaceCount);
+	this->capture = false;
+	const InterfaceDescriptor * iface = NULL;
+	for (size_t i = 0; (i + 2) <= this->controlSize && this->controlBuf[i] >= 2; i += this->controlBuf[i]) {
+		const uint8_t * desc = this->controlBuf + i;
+		if ((i + desc[0]) > this->controlSize) break;
+		if (desc[1] == USB_INTERFACE_DESCRIPTOR_TYPE && desc[0] >= sizeof(InterfaceDescriptor)) {
+			iface = reinterpret_cast<const InterfaceDescriptor *>(desc);
+		} else if (desc[1] == USB_ENDPOINT_DESCRIPTOR_TYPE && desc[0] >= sizeof(EndpointDescriptor)) {
+			const EndpointDescriptor * epDesc = reinterpret_cast<const EndpointDescriptor *>(desc);
+			const uint8_t idx = uint8_t(epDesc->addr & 0x0F);
+			if (idx == 0 || idx >= USB_ENDPOINTS) continue;
+			this->ep[idx].interval = uint8_t((epDesc->interval > 0) ? epDesc->interval : 1);
+			if (iface != NULL && iface->interfaceClass == USB_DEVICE_CLASS_HUMAN_INTERFACE && iface->interfaceSubClass == HID_SUBCLASS_BOOT_INTERFACE && iface->protocol == HID_PROTOCOL_KEYBOARD) {
+				this->keyboardModule = module;
+				this->keyboardInterface = iface->number;
+				this->keyboardEndpoint = idx;
+			}
+		}
+	}
+}
+
+
+/**
+ * Collects the pending report of the given endpoint. Newly pressed lock keys toggle the
+ * keyboard LEDs.
+ *
+ * @param[in] endpoint - endpoint number
+ */
+void PluggableUSB_::collect(const uint8_t endpoint) {
+	Endpoint & e = this->ep[endpoint];
+	if ( this->verbose ) {
+		const unsigned long at = e.collectAt;
+		printf("%lu.%03lu\tep%u\t", at / 1000, at % 1000, unsigned(endpoint));
+		for (uint8_t i = 0; i < e.len; i++) printf((i > 0) ? " %02X" : "%02X", unsigned(e.data[i]));
+		printf("\n");
+		fflush(stdout);
+	}
+	if (endpoint == this->keyboardEndpoint && e.len == 8) {
+		const uint8_t * newKeys = e.data + 2;
+		uint8_t toggle = 0;
+		for (uint8_t i = 0; i < 6; i++) {
+			if (memchr(this->keys, newKeys[i], sizeof(this->keys)) != NULL) continue;
+			switch (newKeys[i]) {
+			case USBKEY_NUM_LOCK: toggle = uint8_t(toggle | USBLED_NUM_LOCK); break;
+			case USBKEY_CAPS_LOCK: toggle = uint8_t(toggle | USBLED_CAPS_LOCK); break;
+			case USBKEY_SCROLL_LOCK: toggle = uint8_t(toggle | USBLED_SCROLL_LOCK); break;
+			case USBKEY_IME_KANA: toggle = uint8_t(toggle | USBLED_KANA); break;
+			default: break;
+			}
+		}
+		memcpy(this->keys, newKeys, sizeof(this->keys));
+		e.len = 0;
+		if (toggle != 0) this->setLeds(uint8_t(this->leds ^ toggle));
+		return;
+	}
+	e.len = 0;
+}
+
+
+/**
+ * Sends the given keyboard LED states to the device via output report.
+ *
+ * @param[in] value - new LED states
+ */
+void PluggableUSB_::setLeds(const uint8_t value) {
+	this->leds = value;
+	if (this->keyboardModule == NULL) return;
+	USBSetup setup;
+	setup.bmRequestType = REQUEST_HOSTTODEVICE_CLASS_INTERFACE;
+	setup.bRequest = HID_SET_REPORT;
+	setup.wValueL = 0; /* report ID */
+	setup.wValueH = HID_REPORT_TYPE_OUTPUT;
+	setup.wIndex = this->keyboardInterface;
+	setup.wLength = 1;
+	this->controlData = &(this->leds);
+	this->controlDataSize = sizeof(this->leds);
+	this->keyboardModule->setup(setup);
+	this->controlData = NULL;
+	this->controlDataSize = 0;
+}
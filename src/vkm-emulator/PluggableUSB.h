@@ -0,0 +1,177 @@
+/**
+ * @file PluggableUSB.h
+ * @author Daniel Starke
+ * @copyright Copyright 2026 Daniel Starke
+ * @date 2026-10-16
+ * @version 2026-10-16
+ *
+ * Minimal Arduino PluggableUSB replacement which emulates the USB host side.
+ * Interrupt IN endpoints are polled at the interval given by their endpoint descriptor
+ * and the host toggles the keyboard LEDs on lock key presses like an operating system.
+ */
+#ifndef __VKM_EMULATOR_PLUGGABLEUSB_H__
+#define __VKM_EMULATOR_PLUGGABLEUSB_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "Arduino.h"
+
+
+#define USB_ENDPOINTS 8
+
+#define TRANSFER_PGM 0x80
+#define TRANSFER_RELEASE 0x40
+#define TRANSFER_ZERO 0x20
+
+#define EP_TYPE_INTERRUPT_IN 0xC1
+
+#define USB_DEVICE_CLASS_HUMAN_INTERFACE 0x03
+#define USB_ENDPOINT_TYPE_INTERRUPT 0x03
+#define USB_ENDPOINT_IN(addr) uint8_t((addr) | 0x80)
+
+#define USB_INTERFACE_DESCRIPTOR_TYPE 4
+#define USB_ENDPOINT_DESCRIPTOR_TYPE 5
+
+#define REQUEST_HOSTTODEVICE_CLASS_INTERFACE 0x21
+#define REQUEST_DEVICETOHOST_CLASS_INTERFACE 0xA1
+#define REQUEST_DEVICETOHOST_STANDARD_INTERFACE 0x81
+
+#define D_INTERFACE(_n, _numEndpoints, _class, _subClass, _protocol) \
+	{9, USB_INTERFACE_DESCRIPTOR_TYPE, _n, 0, _numEndpoints, _class, _subClass, _protocol, 0}
+
+#define D_ENDPOINT(_addr, _attr, _packetSize, _interval) \
+	{7, USB_ENDPOINT_DESCRIPTOR_TYPE, _addr, _attr, _packetSize, _interval}
+
+
+#pragma pack(push, 1)
+/** USB 2.0 chapter 9.3 */
+struct USBSetup {
+	uint8_t bmRequestType;
+	uint8_t bRequest;
+	uint8_t wValueL;
+	uint8_t wValueH;
+	uint16_t wIndex;
+	uint16_t wLength;
+};
+
+/** USB 2.0 chapter 9.6.5 */
+struct InterfaceDescriptor {
+	uint8_t len;
+	uint8_t dtype;
+	uint8_t number;
+	uint8_t alternate;
+	uint8_t numEndpoints;
+	uint8_t interfaceClass;
+	uint8_t interfaceSubClass;
+	uint8_t protocol;
+	uint8_t iInterface;
+};
+
+/** USB 2.0 chapter 9.6.6 */
+struct EndpointDescriptor {
+	uint8_t len;
+	uint8_t dtype;
+	uint8_t addr;
+	uint8_t attr;
+	uint16_t packetSize;
+	uint8_t interval;
+};
+#pragma pack(pop)
+
+
+class PluggableUSB_;
+
+
+/**
+ * Base class for USB functions which are plugged into the emulated USB device.
+ */
+class PluggableUSBModule {
+public:
+	explicit PluggableUSBModule(const uint8_t numEps, const uint8_t numIfs, uint8_t * epType):
+		pluggedInterface(0),
+		pluggedEndpoint(0),
+		numEndpoints(numEps),
+		numInterfaces(numIfs),
+		endpointType(epType),
+		next(NULL)
+	{}
+
+	virtual ~PluggableUSBModule() {}
+protected:
+	virtual bool setup(USBSetup & setup) = 0;
+	virtual int getInterface(uint8_t * interfaceCount) = 0;
+	virtual int getDescriptor(USBSetup & setup) = 0;
+	virtual uint8_t getShortName(char * name) {
+		name[0] = char('A' + this->pluggedInterface);
+		return 1;
+	}
+
+	uint8_t pluggedInterface; /**< First interface number. */
+	uint8_t pluggedEndpoint; /**< First endpoint number. */
+	const uint8_t numEndpoints; /**< Number of used endpoints. */
+	const uint8_t numInterfaces; /**< Number of used interfaces. */
+	const uint8_t * endpointType; /**< Endpoint types. */
+	PluggableUSBModule * next; /**< Next plugged module. */
+
+	friend class PluggableUSB_;
+};
+
+
+/**
+ * Emulated USB host which enumerates the plugged modules and polls their endpoints.
+ */
+class PluggableUSB_ {
+private:
+	/** Interrupt IN endpoint state. */
+	struct Endpoint {
+		PluggableUSBModule * module; /**< Module owning this endpoint. */
+		uint8_t interval; /**< Poll interval in milliseconds from the endpoint descriptor. */
+		unsigned long collectAt; /**< Time in microseconds at which the host polls the pending report. */
+		uint8_t data[64]; /**< Pending report data. */
+		uint8_t len; /**< Pending report length (0 if none). */
+	};
+	uint8_t lastIf; /**< Next free interface number. */
+	uint8_t lastEp; /**< Next free endpoint number. */
+	PluggableUSBModule * rootNode; /**< First plugged module. */
+	Endpoint ep[USB_ENDPOINTS]; /**< Endpoint states. */
+	unsigned long pollInterval; /**< Poll interval override in microseconds or 0. */
+	PluggableUSBModule * keyboardModule; /**< Module with the boot keyboard interface or NULL. */
+	uint8_t keyboardInterface; /**< Boot keyboard interface number. */
+	uint8_t keyboardEndpoint; /**< Boot keyboard endpoint number or 0. */
+	uint8_t keys[6]; /**< Last keyboard keys seen by the host. */
+	uint8_t leds; /**< Keyboard LED states of the host. */
+	const uint8_t * controlData; /**< Host to device data for the current control request. */
+	size_t controlDataSize; /**< Number of bytes in `controlData`. */
+	uint8_t controlBuf[256]; /**< Device to host data of the current control request. */
+	size_t controlSize; /**< Number of bytes in `controlBuf`. */
+	bool capture; /**< True to record device to host control data in `controlBuf`. */
+	bool verbose; /**< Print collected reports to `stdout`. */
+	bool polling; /**< Guards `poll()` against recursion. */
+public:
+	explicit PluggableUSB_();
+
+	void setPollInterval(const unsigned long ms);
+	void setVerbose(const bool value);
+
+	bool plug(PluggableUSBModule * node);
+	void enumerate();
+	void poll();
+
+	int send(const uint8_t endpoint, const void * data, const int len);
+	int sendControl(const uint8_t flags, const void * data, const size_t len);
+	int recvControl(void * data, const int len);
+private:
+	unsigned long nextPoll(const Endpoint & e, const unsigned long now) const;
+	void parseConfiguration(PluggableUSBModule * module);
+	void collect(const uint8_t endpoint);
+	void setLeds(const uint8_t value);
+};
+
+
+PluggableUSB_ & PluggableUSB();
+int USB_Send(const uint8_t ep, const void * data, const int len);
+int USB_SendControl(const uint8_t flags, const void * data, const size_t len);
+int USB_RecvControl(void * data, const int len);
+
+
+#endif /* __VKM_EMULATOR_PLUGGABLEUSB_H__ */
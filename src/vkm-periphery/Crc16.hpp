@@ -1,15 +1,18 @@
 /**
  * @file Crc16.hpp
  * @author Daniel Starke
- * @copyright Copyright 2019-2020 Daniel Starke
+ * @copyright Copyright 2019-2026 Daniel Starke
  * @date 2019-03-07
- * @version 2020-05-31
+ * @version 2026-10-16
  *
  * CRC16-CCITT used in HDLC (see RFC 1662).
+ * Microcontroller builds (`ARDUINO`) use a 16 entry nibble table. Host builds process
+ * pointer ranges with slicing-by-8 tables which are generated on first use (4 KiB).
  */
 #ifndef __CRC16_HPP__
 #define __CRC16_HPP__
 
+#include <stddef.h>
 #include <stdint.h>
 
 
@@ -23,6 +26,12 @@
 #endif /* !__AVR__ */
 
 
+#if !defined(ARDUINO) && !defined(__AVR__)
+/** Defined if pointer ranges are processed with slicing-by-8 tables. */
+#define __CRC16_HPP__SLICING
+#endif /* !ARDUINO && !__AVR__ */
+
+
 /**
  * Table for fast CRC16 calculation (32 bytes).
  */
@@ -34,6 +43,98 @@ static const uint16_t crc16Table[16] __CRC16_HPP__ROM = {
 };
 
 
+/**
+ * Updates the given intermediate CRC16 value with a single byte via nibble table.
+ *
+ * @param[in] crc - intermediate CRC16 value
+ * @param[in] value - byte value
+ * @return updated intermediate CRC16 value
+ */
+static inline uint16_t crc16UpdateNibble(uint16_t crc, const uint8_t value) {
+	crc = uint16_t(__CRC16_HPP__ROM_READ_U16(crc16Table, (crc ^  value      ) & 0x0F) ^ (crc >> 4));
+	crc = uint16_t(__CRC16_HPP__ROM_READ_U16(crc16Table, (crc ^ (value >> 4)) & 0x0F) ^ (crc >> 4));
+	return crc;
+}
+
+
+#ifdef __CRC16_HPP__SLICING
+/**
+ * Byte wise CRC16 tables for slicing-by-8. Table `n` holds the CRC16 of a byte
+ * followed by `n` zero bytes.
+ */
+struct Crc16Tables {
+	uint16_t table[8][256]; /**< CRC16 lookup tables. */
+
+	/**
+	 * Constructor. Derives the tables from the nibble table.
+	 */
+	explicit Crc16Tables() {
+		for (size_t i = 0; i < 256; i++) {
+			this->table[0][i] = crc16UpdateNibble(0, uint8_t(i));
+		}
+		for (size_t n = 1; n < 8; n++) {
+			for (size_t i = 0; i < 256; i++) {
+				const uint16_t prev = this->table[n - 1][i];
+				this->table[n][i] = uint16_t((prev >> 8) ^ this->table[0][prev & 0xFF]);
+			}
+		}
+	}
+};
+
+
+/**
+ * Returns the shared slicing-by-8 tables. These are created on first use.
+ *
+ * @return CRC16 lookup tables
+ */
+inline const Crc16Tables & crc16Tables() {
+	static const Crc16Tables tables;
+	return tables;
+}
+
+
+/**
+ * Updates the given intermediate CRC16 value with the given data via a single
+ * 256 entry table, i.e. one lookup per byte.
+ *
+ * @param[in] crc - intermediate CRC16 value
+ * @param[in] first - beginning of the data
+ * @param[in] last - one past the end of the data
+ * @return updated intermediate CRC16 value
+ */
+static inline uint16_t crc16UpdateTable(uint16_t crc, const uint8_t * first, const uint8_t * last) {
+	const uint16_t (& t)[8][256] = crc16Tables().table;
+	while (first != last) {
+		crc = uint16_t((crc >> 8) ^ t[0][(crc ^ *first++) & 0xFF]);
+	}
+	return crc;
+}
+
+
+/**
+ * Updates the given intermediate CRC16 value with the given data via slicing-by-8,
+ * i.e. eight independent lookups per eight bytes.
+ *
+ * @param[in] crc - intermediate CRC16 value
+ * @param[in] first - beginning of the data
+ * @param[in] last - one past the end of the data
+ * @return updated intermediate CRC16 value
+ */
+static inline uint16_t crc16UpdateSlicing(uint16_t crc, const uint8_t * first, const uint8_t * last) {
+	const uint16_t (& t)[8][256] = crc16Tables().table;
+	while ((last - first) >= 8) {
+		const uint16_t x = uint16_t(crc ^ (uint16_t(first[0]) | (uint16_t(first[1]) << 8)));
+		crc = uint16_t(
+			t[7][x & 0xFF] ^ t[6][x >> 8] ^ t[5][first[2]] ^ t[4][first[3]] ^
+			t[3][first[4]] ^ t[2][first[5]] ^ t[1][first[6]] ^ t[0][first[7]]
+		);
+		first += 8;
+	}
+	return crc16UpdateTable(crc, first, last);
+}
+#endif /* __CRC16_HPP__SLICING */
+
+
 /**
  * CRC16 class. Used for easy value initialization and finalization.
  */
@@ -79,8 +180,7 @@ public:
 	 * @return calculated CRC16
 	 */
 	Crc16 & operator() (const uint8_t value) {
-		this->val = uint16_t(__CRC16_HPP__ROM_READ_U16(crc16Table, (this->val ^  value      ) & 0x0F) ^ (this->val >> 4));
-		this->val = uint16_t(__CRC16_HPP__ROM_READ_U16(crc16Table, (this->val ^ (value >> 4)) & 0x0F) ^ (this->val >> 4));
+		this->val = crc16UpdateNibble(this->val, value);
 		return *this;
 	}
 
@@ -101,6 +201,32 @@ public:
 		return *this;
 	}
 
+#ifdef __CRC16_HPP__SLICING
+	/**
+	 * Calculates the CRC16 over the given byte range.
+	 *
+	 * @param[in] first - beginning of the range
+	 * @param[in] last - one past the end of the range
+	 * @return calculated CRC16
+	 */
+	Crc16 & operator() (const uint8_t * first, const uint8_t * last) {
+		this->val = crc16UpdateSlicing(this->val, first, last);
+		return *this;
+	}
+
+	/**
+	 * Calculates the CRC16 over the given byte range.
+	 *
+	 * @param[in] first - beginning of the range
+	 * @param[in] last - one past the end of the range
+	 * @return calculated CRC16
+	 */
+	Crc16 & operator() (uint8_t * first, uint8_t * last) {
+		this->val = crc16UpdateSlicing(this->val, first, last);
+		return *this;
+	}
+#endif /* __CRC16_HPP__SLICING */
+
 	/**
 	 * Cast to actually calculated value.
 	 *
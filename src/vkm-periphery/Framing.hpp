@@ -3,12 +3,13 @@
  * @author Daniel Starke
  * @copyright Copyright 2019-2026 Daniel Starke
  * @date 2019-02-20
- * @version 2026-06-07
+ * @version 2026-10-16
  */
 #ifndef __FRAMING_HPP__
 #define __FRAMING_HPP__
 
 #include <stdint.h>
+#include <string.h>
 #include "Crc16.hpp"
 #include "Meta.hpp"
 #if defined(ARDUINO)
@@ -69,7 +70,7 @@ public:
 	/**
 	 * Constructor.
 	 *
-	 * @param[in] w - function called to send out a single byte
+	 * @param[in] w - function called to send out a single byte (may be NULL if only `encode()` is used)
 	 * @param[in,out] ua - user defined callback argument
 	 */
 	explicit Framing(WriteCallback w, void * ua = NULL):
@@ -136,6 +137,122 @@ public:
 		return true;
 	}
 
+	/**
+	 * Processes all bytes received and calls the given function for each complete frame.
+	 * Runs of unescaped payload data and data outside of a frame are skipped with `memchr()`.
+	 * A frame exceeding the buffer size is reported once and dropped up to the next separator.
+	 *
+	 * @param[in] buf - received data
+	 * @param[in] len - number of bytes in `buf`
+	 * @param[in] fn - callback function as bool fn(const uint8_t seq, uint8_t * buf, const size_t len, const bool err)
+	 * which returns false to stop processing
+	 * @param[in] errFn - callback function as void errFn() called on each buffer overrun or underrun
+	 * @return false if stopped by `fn`, else true
+	 */
+	template <typename Fn, typename ErrFn>
+	bool read(const uint8_t * buf, const size_t len, Fn fn, ErrFn errFn) {
+		const uint8_t * ptr = buf;
+		const uint8_t * const end = buf + len;
+		while (ptr < end) {
+			switch (this->state) {
+			case ST_START:
+				ptr = static_cast<const uint8_t *>(memchr(ptr, SEP, size_t(end - ptr)));
+				if (ptr == NULL) return true;
+				ptr++;
+				this->state = ST_SEP;
+				break;
+			case ST_SEP:
+				{
+					/* copy the run of payload bytes up to the next special character */
+					const uint8_t * sep = static_cast<const uint8_t *>(memchr(ptr, SEP, size_t(end - ptr)));
+					const uint8_t * runEnd = (sep != NULL) ? sep : end;
+					const uint8_t * esc = static_cast<const uint8_t *>(memchr(ptr, ESC, size_t(runEnd - ptr)));
+					if (esc != NULL) runEnd = esc;
+					const size_t runLen = size_t(runEnd - ptr);
+					if (runLen > (sizeof(this->buffer) - this->size)) {
+						this->size = 0;
+						this->state = ST_START; /* the next separator starts a new frame */
+						errFn();
+						continue;
+					}
+					memcpy(this->buffer + this->size, ptr, runLen);
+					this->size += runLen;
+					ptr = runEnd;
+					if (ptr == end) return true;
+					ptr++;
+					if (esc != NULL) {
+						this->state = ST_ESC;
+					} else if (this->size == 0) {
+						/* ignore empty frames */
+					} else if (this->size < 3) {
+						this->size = 0;
+						errFn(); /* incomplete frame */
+					} else {
+						uint8_t * crcPtr = this->buffer + this->size - 2;
+						const uint16_t containedCrc = uint16_t((uint16_t(crcPtr[0]) << 8) | uint16_t(crcPtr[1]));
+						const uint16_t calculatedCrc = Crc16(this->buffer, crcPtr);
+						this->size = 0;
+						if ( ! fn(this->buffer[0], this->buffer + 1, size_t(crcPtr - this->buffer - 1), containedCrc != calculatedCrc) ) return false;
+					}
+				}
+				break;
+			case ST_ESC:
+				this->state = ST_SEP;
+				if (*ptr == ESC || *ptr == SEP) break; /* aborted escape sequence; process again */
+				if (this->size >= sizeof(this->buffer)) {
+					this->size = 0;
+					this->state = ST_START;
+					errFn();
+					break;
+				}
+				this->buffer[this->size++] = uint8_t(*ptr ^ FLIP);
+				ptr++;
+				break;
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * Returns the maximum encoded size of a frame with the given payload size.
+	 *
+	 * @param[in] len - payload size
+	 * @return maximum number of bytes written by `encode()`
+	 */
+	static constexpr size_t maxEncodedSize(const size_t len) {
+		return 2 + (2 * (len + 3));
+	}
+
+	/**
+	 * Encodes a complete frame with the given payload into the passed buffer.
+	 * Unlike `send()`, no write callback is invoked. Runs of bytes which need no
+	 * escaping are copied as block.
+	 *
+	 * @param[out] out - output buffer
+	 * @param[in] outSize - size of the output buffer in bytes
+	 * @param[in] seq - sequence number
+	 * @param[in] buf - payload data
+	 * @param[in] len - payload size
+	 * @return number of bytes written to `out` or 0 if `outSize` is less than `maxEncodedSize(len)`
+	 */
+	size_t encode(uint8_t * out, const size_t outSize, const uint8_t seq, const uint8_t * buf, const size_t len) {
+		if (outSize < maxEncodedSize(len)) return 0;
+		const unsigned long now = millis();
+		uint8_t * ptr = out;
+		if (this->firstOut || static_cast<unsigned long>(now - this->lastOut) > 1000) *ptr++ = uint8_t(SEP);
+		this->firstOut = false;
+		this->lastOut = now;
+		Crc16 frameCrc(seq);
+		frameCrc(buf, buf + len);
+		const uint16_t finalCrc = uint16_t(frameCrc);
+		const uint8_t tail[2] = {uint8_t((finalCrc >> 8) & 0xFF), uint8_t(finalCrc & 0xFF)};
+		ptr = Framing::escape(ptr, &seq, 1);
+		ptr = Framing::escape(ptr, buf, len);
+		ptr = Framing::escape(ptr, tail, sizeof(tail));
+		*ptr++ = uint8_t(SEP);
+		return size_t(ptr - out);
+	}
+
 	/**
 	 * Ensures that the next transmission sends the frame separator at the beginning.
 	 */
@@ -324,6 +441,30 @@ public:
 		if ( ! this->write(buf, len) ) return false;
 		return this->endTransmission();
 	}
+private:
+	/**
+	 * Writes the given data escaped to the output buffer.
+	 *
+	 * @param[out] out - output buffer with space for at least `2 * len` bytes
+	 * @param[in] buf - data to escape
+	 * @param[in] len - data size
+	 * @return pointer past the last byte written
+	 */
+	static uint8_t * escape(uint8_t * out, const uint8_t * buf, const size_t len) {
+		const uint8_t * const end = buf + len;
+		while (buf < end) {
+			const uint8_t * run = buf;
+			/* two compares are cheaper here than a 256 entry lookup table (no extra load per byte) */
+			while (run < end && *run != SEP && *run != ESC) run++;
+			memcpy(out, buf, size_t(run - buf));
+			out += run - buf;
+			if (run == end) break;
+			*out++ = uint8_t(ESC);
+			*out++ = uint8_t(*run ^ FLIP);
+			buf = run + 1;
+		}
+		return out;
+	}
 };
 
 
@@ -3,18 +3,20 @@
  * @author Daniel Starke
  * @copyright Copyright 2019-2026 Daniel Starke
  * @date 2019-10-11
- * @version 2026-06-13
+ * @version 2026-10-16
  */
 #ifndef __PROTOCOL_HPP__
 #define __PROTOCOL_HPP__
 
 
 /** BCD encoded major and minor. Major steps indicate incompatible changes. */
-#define VKVM_PROT_VERSION 0x0101
+#define VKVM_PROT_VERSION 0x0102
 #define VKVM_PROT_MAJOR_MASK 0xFF00
 #define VKVM_PROT_MINOR_MASK 0x00FF
 #define VKVM_PROT_SPEED 115200
 #define VKVM_MAX_FRAME_SIZE 256
+/** Maximum number of sub-commands within a single `RequestType::SET_BATCH` request. */
+#define VKVM_MAX_BATCH_SIZE 32
 
 
 /** Namespace for the response type enumeration. */
@@ -65,6 +67,7 @@ struct RequestType {
 		SET_MOUSE_MOVE_ABS,       /**< return `ResponseType::S_OK` */
 		SET_MOUSE_MOVE_REL,       /**< return `ResponseType::S_OK` */
 		SET_MOUSE_SCROLL,         /**< return `ResponseType::S_OK` */
+		SET_BATCH,                /**< return `uint32_t` with a bitmap of the sub-commands which succeeded (LSB is the first sub-command) followed by the `uint8_t` response type of each failed one */
 		COUNT                     /**< number of possible request types */
 	};
 };
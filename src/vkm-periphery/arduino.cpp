@@ -3,7 +3,7 @@
  * @author Daniel Starke
  * @copyright Copyright 2019-2026 Daniel Starke
  * @date 2019-10-11
- * @version 2026-06-13
+ * @version 2026-10-16
  *
  * Virtual Keyboard/Mouse periphery device.
  * Tested with Arduino IDE 1.8.5 and ATmega32U4 (a.k.a. Arduino Pro Micro).
@@ -17,6 +17,7 @@
 
 
 Framing<VKVM_MAX_FRAME_SIZE> framing(handleWrite);
+ResponseType::Type * batchResponse = NULL;
 
 
 const tHandler handler[RequestType::COUNT] VKVM_ROM = {
@@ -35,7 +36,8 @@ const tHandler handler[RequestType::COUNT] VKVM_ROM = {
 	setMouseButtonPush,
 	setMouseMoveAbs,
 	setMouseMoveRel,
-	setMouseScroll
+	setMouseScroll,
+	setBatch
 };
 
 
@@ -56,7 +58,8 @@ const char * frameType[] = {
 	"SET_MOUSE_BUTTON_PUSH",
 	"SET_MOUSE_MOVE_ABS",
 	"SET_MOUSE_MOVE_REL",
-	"SET_MOUSE_SCROLL"
+	"SET_MOUSE_SCROLL",
+	"SET_BATCH"
 };
 #endif /* DEBUG */
 
@@ -453,6 +456,60 @@ void setMouseScroll(const FrameParams & fp) {
 }
 
 
+/**
+ * Handles set batch request.
+ * Expects up to `VKVM_MAX_BATCH_SIZE` sub-commands each with the following fields:
+ * - uint8_t with the length of the sub-command including the request type
+ * - uint8_t with the request type (`SET_KEYBOARD_DOWN` to `SET_MOUSE_SCROLL`)
+ * - request type specific fields
+ * Returns a bit map with the sub-commands processed successfully as uint32_t
+ * whereas the LSB is the first sub-command, followed by the uint8_t response type
+ * of each failed sub-command in sub-command order.
+ *
+ * @param[in] fp - frame parameters
+ */
+void setBatch(const FrameParams & fp) {
+	/* validate all sub-commands before processing any of them */
+	uint8_t count = 0;
+	for (size_t i = 0; i < fp.len; i = size_t(i + 1 + fp.buf[i]), count++) {
+		if (count >= VKVM_MAX_BATCH_SIZE || fp.buf[i] < 1 || size_t(i + 1 + fp.buf[i]) > fp.len) {
+			sendResponse(fp.seq, ResponseType::E_INVALID_FIELD_VALUE, count);
+			return;
+		}
+		const uint8_t type = fp.buf[i + 1];
+		if (type < RequestType::SET_KEYBOARD_DOWN || type >= RequestType::SET_BATCH) {
+			sendResponse(fp.seq, ResponseType::E_INVALID_FIELD_VALUE, count);
+			return;
+		}
+	}
+	if (count < 1) {
+		sendResponse(fp.seq, ResponseType::E_INVALID_FIELD_VALUE, uint8_t(0));
+		return;
+	}
+	/* process sub-commands and return bit field with the result for each */
+	uint32_t res = 0;
+	uint8_t errors[VKVM_MAX_BATCH_SIZE];
+	uint8_t errorCount = 0;
+	ResponseType::Type subRes;
+	batchResponse = &subRes;
+	for (size_t i = 0, n = 0; i < fp.len; i = size_t(i + 1 + fp.buf[i]), n++) {
+		const RequestType::Type type = static_cast<RequestType::Type>(fp.buf[i + 1]);
+		const tHandler fn = (tHandler)(VKVM_ROM_READ_PTR(handler, type));
+		DBG_MSG(frameType[type]);
+		subRes = ResponseType::E_INVALID_REQ_TYPE;
+		FrameParams subFp(fp.seq, type, fp.buf + i + 2, size_t(fp.buf[i] - 1));
+		fn(subFp);
+		if (subRes == ResponseType::S_OK) {
+			res |= uint32_t(uint32_t(1) << n);
+		} else {
+			errors[errorCount++] = uint8_t(subRes);
+		}
+	}
+	batchResponse = NULL;
+	sendResponse(fp.seq, ResponseType::S_OK, res, static_cast<const uint8_t *>(errors), size_t(errorCount));
+}
+
+
 #if defined(PIN_STATUS_LED) && defined(VKVM_LED_PWM)
 /** Input buffer for the DMA transfer which sets the GPIO port bits of the status LED. */
 static uint16_t statusLedDmaInput[2] = {
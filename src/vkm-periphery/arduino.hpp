@@ -1,9 +1,9 @@
 /**
  * @file arduino.hpp
  * @author Daniel Starke
- * @copyright Copyright 2019-2023 Daniel Starke
+ * @copyright Copyright 2019-2026 Daniel Starke
  * @date 2019-10-11
- * @version 2023-11-06
+ * @version 2026-10-16
  */
 #ifndef __ARDUINO_HPP__
 #define __ARDUINO_HPP__
@@ -84,6 +84,10 @@ extern Framing<VKVM_MAX_FRAME_SIZE> framing;
 extern const tHandler handler[RequestType::COUNT] VKVM_ROM;
 
 
+/** Receives the response type of the currently processed batch sub-command instead of sending it. */
+extern ResponseType::Type * batchResponse;
+
+
 /**
  * Returns an error to the host.
  *
@@ -93,6 +97,11 @@ extern const tHandler handler[RequestType::COUNT] VKVM_ROM;
  */
 template <typename ...Args>
 void sendResponse(const uint8_t seq, const ResponseType::Type type, Args... args) {
+	if (batchResponse != NULL && seq != 0) {
+		/* only record the result of batch sub-commands */
+		*batchResponse = type;
+		return;
+	}
 	framing.beginTransmission(seq);
 	framing.write(uint8_t(type));
 	framing.write(args...);
@@ -118,6 +127,7 @@ void setMouseButtonPush(const FrameParams & fp);
 void setMouseMoveAbs(const FrameParams & fp);
 void setMouseMoveRel(const FrameParams & fp);
 void setMouseScroll(const FrameParams & fp);
+void setBatch(const FrameParams & fp);
 void initStatusLed(void);
 void setStatusLed(const bool on);
 void setup(void);
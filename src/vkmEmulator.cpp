@@ -0,0 +1,142 @@
+/**
+ * @file vkmEmulator.cpp
+ * @author Daniel Starke
+ * @date 2026-10-16
+ * @version 2026-10-16
+ *
+ * Runs the periphery firmware on a Linux host. The controller side is exposed as
+ * pseudo-terminal which can be opened like the serial device of a real VKVM periphery.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <signal.h>
+#include <unistd.h>
+#include <vkm-periphery/Protocol.hpp>
+#include <vkm-emulator/Arduino.h>
+#include <vkm-emulator/PluggableUSB.h>
+
+
+/* firmware entry points */
+void setup(void);
+void loop(void);
+
+
+/** Set to terminate the main loop. */
+static volatile sig_atomic_t quit = 0;
+/** Set to toggle the USB host connection state. */
+static volatile sig_atomic_t toggleUsb = 0;
+
+
+/**
+ * Handles termination and USB toggle signals.
+ *
+ * @param[in] sig - received signal
+ */
+static void handleSignal(int sig) {
+	if (sig == SIGUSR1) {
+		toggleUsb = 1;
+	} else {
+		quit = 1;
+	}
+}
+
+
+/**
+ * Parses the given string as unsigned long value.
+ *
+ * @param[in] str - string to parse
+ * @param[out] value - receives the parsed value
+ * @return true on success, else false
+ */
+static bool parseNumber(const char * str, unsigned long & value) {
+	char * endPtr = NULL;
+	value = strtoul(str, &endPtr, 10);
+	return endPtr != NULL && endPtr != str && *endPtr == 0;
+}
+
+
+/**
+ * Prints the usage description of this program.
+ */
+static void printHelp() {
+	printf(
+		"vkmEmulator [options]\n"
+		"\n"
+		"-b <baud>  - emulated serial baud rate (default: %u, 0 for unlimited)\n"
+		"-h         - print this help\n"
+		"-l <path>  - create a symbolic link with the given path to the pseudo-terminal\n"
+		"-p <ms>    - USB poll interval in milliseconds for all endpoints\n"
+		"             (default: endpoint descriptor values)\n"
+		"-v         - print each report collected by the emulated USB host\n"
+		"\n"
+		"The path to the pseudo-terminal is printed as first line to stdout.\n"
+		"Send SIGUSR1 to toggle the emulated USB host connection.\n",
+		unsigned(VKVM_PROT_SPEED)
+	);
+}
+
+
+/**
+ * Main entry point.
+ */
+int main(int argc, char ** argv) {
+	const char * link = NULL;
+	unsigned long value;
+	int opt;
+	while ((opt = getopt(argc, argv, "b:hl:p:v")) != -1) {
+		switch (opt) {
+		case 'b':
+			if ( ! parseNumber(optarg, value) ) {
+				fprintf(stderr, "Error: Invalid baud rate \"%s\".\n", optarg);
+				return EXIT_FAILURE;
+			}
+			Serial1.setBaudRate(value);
+			break;
+		case 'h':
+			printHelp();
+			return EXIT_SUCCESS;
+		case 'l':
+			link = optarg;
+			break;
+		case 'p':
+			if ( ! parseNumber(optarg, value) || value < 1 || value > 255 ) {
+				fprintf(stderr, "Error: Invalid poll interval \"%s\".\n", optarg);
+				return EXIT_FAILURE;
+			}
+			PluggableUSB().setPollInterval(value);
+			break;
+		case 'v':
+			PluggableUSB().setVerbose(true);
+			break;
+		default:
+			printHelp();
+			return EXIT_FAILURE;
+		}
+	}
+	struct sigaction sa;
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = handleSignal;
+	sigemptyset(&sa.sa_mask);
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+	sigaction(SIGUSR1, &sa, NULL);
+	if ( ! Serial1.openPty(link) ) {
+		fprintf(stderr, "Error: Failed to create pseudo-terminal.\n");
+		return EXIT_FAILURE;
+	}
+	printf("%s\n", Serial1.getPtyName());
+	fflush(stdout);
+	setup();
+	while ( ! quit ) {
+		if ( toggleUsb ) {
+			toggleUsb = 0;
+			USBDevice.setConnected( ! USBDevice.isConnected() );
+			fprintf(stderr, "Info: USB host %s.\n", USBDevice.isConnected() ? "connected" : "disconnected");
+		}
+		USBDevice.update();
+		loop();
+	}
+	if (link != NULL) unlink(link);
+	return EXIT_SUCCESS;
+}
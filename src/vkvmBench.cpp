@@ -0,0 +1,678 @@
+/**
+ * @file vkvmBench.cpp
+ * @author Daniel Starke
+ * @date 2026-10-16
+ * @version 2026-10-16
+ *
+ * Replays input workloads through the public `VkvmDevice` API and measures the
+ * request completion latency. Works against a real periphery or `vkmEmulator`.
+ * Multiple devices replay the workload concurrently.
+ */
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <libpcf/target.h>
+#include <pcf/serial/Vkvm.hpp>
+
+
+/** Default number of events per run. */
+#define BENCH_DEFAULT_COUNT 1000
+/** Maximum number of keys per paste request. */
+#define BENCH_MAX_PASTE_KEYS 64
+/** Time in microseconds to wait before resubmitting an event rejected due to a full request queue. */
+#define BENCH_RETRY_DELAY 100
+/** Time in milliseconds to wait for the next outstanding completion after the last submission. */
+#define BENCH_DRAIN_TIMEOUT 10000
+
+
+/**
+ * Benchmark configuration.
+ */
+struct BenchConfig {
+	/** Possible input workloads. */
+	enum Workload {
+		W_TYPING, /**< Bursts of `VkvmDevice::keyboardPush()` requests. */
+		W_MOUSE, /**< Line by line sweep of `VkvmDevice::mouseMoveAbs()` requests. */
+		W_PASTE, /**< Stream of `VkvmDevice::keyboardWrite()` requests. */
+		W_COUNT
+	};
+	Workload workload; /**< Input workload to replay. */
+	size_t count; /**< Number of events to submit. */
+	size_t burst; /**< Number of events submitted back-to-back (0 for workload default). */
+	size_t rate; /**< Average submission rate in events per second (0 for unlimited). */
+	size_t keys; /**< Number of keys per paste request. */
+	size_t window; /**< Request window passed to `VkvmDevice::open()`. */
+	bool shared; /**< Serve all devices by the shared reactor. See `VkvmDevice::setSharedReactor()`. */
+	const char * trace; /**< Path of the protocol trace file written after the run or NULL. */
+	bool json; /**< Output results as JSON instead of plain text. */
+
+	/**
+	 * Returns the effective burst size.
+	 *
+	 * @return number of events submitted back-to-back
+	 */
+	size_t burstSize() const {
+		if (this->burst > 0) return this->burst;
+		return (this->workload == W_TYPING) ? 8 : 1;
+	}
+};
+
+
+/** Workload names as used on the command-line and in the output. */
+static const char * workloadStr[BenchConfig::W_COUNT] = {
+	"typing",
+	"mouse",
+	"paste"
+};
+
+
+/** Serializes the result output of concurrently running benchmarks. */
+static std::mutex outputMutex;
+
+
+/**
+ * Helper class to replay a workload and collect the completion latencies.
+ * The result is written to stdout. Errors are reported via stderr.
+ */
+class VkvmBench : public pcf::serial::VkvmCallback {
+private:
+	typedef std::chrono::steady_clock Clock;
+	/** Submitted but not yet completed event. */
+	struct Pending {
+		Clock::time_point submitted; /**< Submission time. */
+		uint32_t tag; /**< Value to match the completion callback against. */
+	};
+	pcf::serial::VkvmDevice device; /**< VKVM device instance. */
+	std::mutex running; /**< Single instance running mutex. */
+	std::thread worker; /**< Workload submission thread. */
+	const BenchConfig & config; /**< Benchmark configuration. */
+	const char * path; /**< Path to the serial connected VKVM device. */
+	std::mutex mutex; /**< Guards all fields below. */
+	std::condition_variable completion; /**< Signaled on each completion callback. */
+	std::deque<Pending> pending; /**< Events in submission order. */
+	std::vector<uint32_t> latencies; /**< Completion latencies in microseconds. */
+	Clock::time_point firstSubmit; /**< Time of the first submission. */
+	Clock::time_point lastComplete; /**< Time of the last completion. */
+	size_t submitted; /**< Number of accepted events. */
+	size_t rejected; /**< Number of events rejected at least once due to a full request queue. */
+	size_t failed; /**< Number of events completed with an error result. */
+	bool connected; /**< True while the device is connected. */
+	bool success; /**< True if the workload was replayed completely. */
+public:
+	/**
+	 * Constructor.
+	 *
+	 * @param[in] cfg - benchmark configuration
+	 */
+	explicit VkvmBench(const BenchConfig & cfg):
+		config(cfg),
+		path(NULL),
+		submitted(0),
+		rejected(0),
+		failed(0),
+		connected(false),
+		success(false)
+	{
+		this->latencies.reserve(cfg.count);
+	}
+
+	/**
+	 * Destructor.
+	 */
+	~VkvmBench() {
+		try {
+			this->join();
+			if ( this->worker.joinable() ) fprintf(stderr, "Error: Working thread is still joinable.\n");
+		} catch (const std::exception & e) {
+			fprintf(stderr, "Error: %s\n", e.what());
+		} catch (...) {
+			fprintf(stderr, "Error: Caught unknown exception in VkvmBench destructor.\n");
+		}
+	}
+
+	/**
+	 * Starts the benchmark.
+	 *
+	 * @param[in] devicePath - path to the serial connected VKVM device
+	 * @return true on success, else false
+	 */
+	bool start(const char * devicePath) {
+		if ( ! this->running.try_lock() ) return false;
+		this->path = devicePath;
+		if ( ! this->device.open(*this, devicePath, 1000, 100, this->config.window) ) {
+			this->running.unlock();
+			return false;
+		}
+		return true;
+	}
+
+	/**
+	 * Writes the binary protocol trace of the device to the given file.
+	 *
+	 * @param[in] tracePath - output file path
+	 * @return true on success, else false
+	 */
+	bool dumpTrace(const char * tracePath) const {
+		if ( this->device.dumpTrace(tracePath) ) return true;
+		fprintf(stderr, "Error: Failed to write protocol trace \"%s\".\n", tracePath);
+		return false;
+	}
+
+	/**
+	 * Waits for all operations to finish.
+	 *
+	 * @return true if the workload was replayed completely, else false
+	 */
+	bool join() {
+		if ( this->running.try_lock() ) {
+			if ( this->worker.joinable() ) this->worker.join();
+			this->running.unlock();
+			return this->success; /* not running */
+		}
+		/* wait for device to close / finish the benchmark */
+		this->running.lock();
+		if ( this->worker.joinable() ) this->worker.join();
+		this->device.close();
+		this->running.unlock();
+		return this->success;
+	}
+private:
+	/**
+	 * Handles the completed VKVM device connection event.
+	 */
+	virtual void onVkvmConnected() {
+		{
+			std::lock_guard<std::mutex> guard(this->mutex);
+			this->connected = true;
+		}
+		/* run workload submission thread */
+		this->worker = std::thread([this] () {
+			try {
+				this->replay();
+				this->report();
+			} catch (const std::exception & e) {
+				fprintf(stderr, "Error: %s\n", e.what());
+			} catch (...) {
+				fprintf(stderr, "Error: Caught unknown exception in workload thread.\n");
+			}
+			this->device.close();
+		});
+	}
+
+	/**
+	 * Submits all events of the configured workload and waits for their completion.
+	 */
+	void replay() {
+		const size_t burst = this->config.burstSize();
+		Clock::time_point due = Clock::now();
+		this->firstSubmit = due;
+		for (size_t i = 0; i < this->config.count; i++) {
+			if (this->config.rate > 0 && (i % burst) == 0) {
+				/* keep the average rate by starting each burst at its scheduled time */
+				due = this->firstSubmit + std::chrono::microseconds(uint64_t(i) * 1000000 / this->config.rate);
+				std::this_thread::sleep_until(due);
+			}
+			/* latency includes the time spent waiting for a free request queue slot */
+			const Clock::time_point attempt = Clock::now();
+			for (bool retry = false; ! this->submit(i, attempt); retry = true) {
+				if ( ! this->device.isConnected() ) {
+					fprintf(stderr, "Error: Connection lost after %u of %u events.\n", unsigned(i), unsigned(this->config.count));
+					return;
+				}
+				if ( ! retry ) {
+					std::lock_guard<std::mutex> guard(this->mutex);
+					this->rejected++;
+				}
+				/* request queue is full; retry after the periphery caught up */
+				std::this_thread::sleep_for(std::chrono::microseconds(BENCH_RETRY_DELAY));
+			}
+		}
+		std::unique_lock<std::mutex> guard(this->mutex);
+		/* a full request queue takes a while to drain; only give up if nothing completes in time */
+		bool drained = true;
+		while (drained && this->connected && ( ! this->pending.empty() )) {
+			const size_t remaining = this->pending.size();
+			drained = this->completion.wait_for(guard, std::chrono::milliseconds(BENCH_DRAIN_TIMEOUT), [this, remaining] () {
+				return this->pending.size() < remaining || ( ! this->connected );
+			});
+		}
+		if ( ! this->pending.empty() ) {
+			fprintf(stderr, "Error: %u events did not complete%s.\n", unsigned(this->pending.size()), drained ? "" : " in time");
+			return;
+		}
+		this->success = true;
+	}
+
+	/**
+	 * Submits the event with the given index.
+	 *
+	 * @param[in] i - event index
+	 * @param[in] attempt - time of the first submission attempt
+	 * @return true if the event was accepted, else false
+	 */
+	bool submit(const size_t i, const Clock::time_point attempt) {
+		uint8_t keys[BENCH_MAX_PASTE_KEYS];
+		uint16_t x = 0, y = 0;
+		Pending item;
+		switch (this->config.workload) {
+		case BenchConfig::W_TYPING:
+			item.tag = uint32_t(USBKEY_A + (i % 26));
+			break;
+		case BenchConfig::W_MOUSE:
+			/* unique coordinates per event to identify merged requests by their final value */
+			x = uint16_t((i % 1024) * 32);
+			y = uint16_t(((i / 1024) % 1024) * 32);
+			item.tag = uint32_t(x) | (uint32_t(y) << 16);
+			break;
+		case BenchConfig::W_PASTE:
+			for (size_t k = 0; k < this->config.keys; k++) keys[k] = uint8_t(USBKEY_A + ((i + k) % 26));
+			item.tag = uint32_t(this->config.keys);
+			break;
+		case BenchConfig::W_COUNT:
+			return false;
+		}
+		{
+			/* record before submission as the completion may arrive before the call returns */
+			std::lock_guard<std::mutex> guard(this->mutex);
+			item.submitted = attempt;
+			if (this->submitted == 0) this->firstSubmit = attempt;
+			this->pending.push_back(item);
+		}
+		bool res = false;
+		switch (this->config.workload) {
+		case BenchConfig::W_TYPING:
+			res = this->device.keyboardPush(uint8_t(item.tag));
+			break;
+		case BenchConfig::W_MOUSE:
+			res = this->device.mouseMoveAbs(double(x) / 32767.0, double(y) / 32767.0);
+			break;
+		case BenchConfig::W_PASTE:
+			res = this->device.keyboardWrite(0, keys, uint8_t(this->config.keys));
+			break;
+		case BenchConfig::W_COUNT:
+			break;
+		}
+		std::lock_guard<std::mutex> guard(this->mutex);
+		if ( res ) {
+			this->submitted++;
+		} else {
+			/* not queued, hence, not yet completed */
+			this->pending.pop_back();
+		}
+		return res;
+	}
+
+	/**
+	 * Completes all pending events up to the one with the given tag. Merged requests
+	 * report the value of the last merged event. All previous events are completed
+	 * by the same callback.
+	 *
+	 * @param[in] res - periphery result code
+	 * @param[in] tag - value of the completed event
+	 */
+	void complete(const PeripheryResult res, const uint32_t tag) {
+		const Clock::time_point now = Clock::now();
+		std::lock_guard<std::mutex> guard(this->mutex);
+		const auto last = std::find_if(this->pending.begin(), this->pending.end(), [tag] (const Pending & p) {
+			return p.tag == tag;
+		});
+		if (last == this->pending.end()) return;
+		const auto end = last + 1;
+		for (auto it = this->pending.begin(); it != end; ++it) {
+			this->latencies.push_back(uint32_t(std::chrono::duration_cast<std::chrono::microseconds>(now - it->submitted).count()));
+			if (res != PeripheryResult::PR_OK) this->failed++;
+		}
+		this->pending.erase(this->pending.begin(), end);
+		this->lastComplete = now;
+		this->completion.notify_all();
+	}
+
+	/**
+	 * Returns the given percentile of the sorted latency values.
+	 *
+	 * @param[in] permille - percentile in per mille
+	 * @return latency in microseconds
+	 */
+	uint32_t percentile(const size_t permille) const {
+		if ( this->latencies.empty() ) return 0;
+		/* nearest-rank method */
+		const size_t rank = (this->latencies.size() * permille + 999) / 1000;
+		return this->latencies[(rank > 0) ? (rank - 1) : 0];
+	}
+
+	/**
+	 * Writes the benchmark results to stdout.
+	 */
+	void report() {
+		const pcf::serial::VkvmStatistics stats = this->device.getStatistics();
+		std::lock_guard<std::mutex> outputGuard(outputMutex);
+		std::lock_guard<std::mutex> guard(this->mutex);
+		std::sort(this->latencies.begin(), this->latencies.end());
+		const size_t completed = this->latencies.size();
+		const uint64_t durationUs = (completed > 0) ? uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(this->lastComplete - this->firstSubmit).count()) : 0;
+		const double eventsPerSecond = (durationUs > 0) ? (double(completed) * 1000000.0 / double(durationUs)) : 0.0;
+		const uint32_t minUs = completed > 0 ? this->latencies.front() : 0;
+		const uint32_t maxUs = completed > 0 ? this->latencies.back() : 0;
+		if ( this->config.json ) {
+			printf(
+				"{\"serial\":\"%s\",\"shared\":%s,\"workload\":\"%s\",\"events\":%u,\"completed\":%u,\"failed\":%u,\"rejected\":%u,"
+				"\"window\":%u,\"burst\":%u,\"rate\":%u,\"keysPerEvent\":%u,"
+				"\"durationUs\":%llu,\"eventsPerSecond\":%.1f,"
+				"\"latencyUs\":{\"min\":%u,\"p50\":%u,\"p99\":%u,\"p999\":%u,\"max\":%u},"
+				"\"device\":{\"requests\":%llu,\"merged\":%llu,\"rejected\":%llu,\"framesSent\":%llu,\"batchesSent\":%llu,\"timeouts\":%llu,\"maxQueueDepth\":%u}}\n",
+				this->path, this->config.shared ? "true" : "false", workloadStr[this->config.workload], unsigned(this->config.count), unsigned(completed), unsigned(this->failed), unsigned(this->rejected),
+				unsigned(this->config.window), unsigned(this->config.burstSize()), unsigned(this->config.rate), unsigned((this->config.workload == BenchConfig::W_PASTE) ? this->config.keys : 1),
+				static_cast<unsigned long long>(durationUs), eventsPerSecond,
+				unsigned(minUs), unsigned(this->percentile(500)), unsigned(this->percentile(990)), unsigned(this->percentile(999)), unsigned(maxUs),
+				static_cast<unsigned long long>(stats.requests), static_cast<unsigned long long>(stats.merged), static_cast<unsigned long long>(stats.rejected),
+				static_cast<unsigned long long>(stats.framesSent), static_cast<unsigned long long>(stats.batchesSent), static_cast<unsigned long long>(stats.timeouts),
+				unsigned(stats.maxQueueDepth)
+			);
+		} else {
+			printf(
+				"serial       %s%s\n"
+				"workload     %s\n"
+				"events       %u submitted, %u completed, %u failed\n"
+				"rejected     %u events (request queue full), %llu attempts\n"
+				"duration     %.3f ms\n"
+				"throughput   %.1f events/s\n"
+				"latency      min %u us, p50 %u us, p99 %u us, p99.9 %u us, max %u us\n"
+				"device       %llu requests, %llu merged, %llu frames, %llu batches, %llu timeouts, max queue depth %u\n",
+				this->path, this->config.shared ? " (shared reactor)" : "",
+				workloadStr[this->config.workload],
+				unsigned(this->submitted), unsigned(completed), unsigned(this->failed),
+				unsigned(this->rejected), static_cast<unsigned long long>(stats.rejected),
+				double(durationUs) / 1000.0,
+				eventsPerSecond,
+				unsigned(minUs), unsigned(this->percentile(500)), unsigned(this->percentile(990)), unsigned(this->percentile(999)), unsigned(maxUs),
+				static_cast<unsigned long long>(stats.requests), static_cast<unsigned long long>(stats.merged),
+				static_cast<unsigned long long>(stats.framesSent), static_cast<unsigned long long>(stats.batchesSent),
+				static_cast<unsigned long long>(stats.timeouts), unsigned(stats.maxQueueDepth)
+			);
+		}
+		fflush(stdout);
+	}
+
+	/**
+	 * Handles `VkvmDevice::keyboardPush()` completions.
+	 *
+	 * @param[in] res - periphery result code
+	 * @param[in] key - pushed key
+	 */
+	virtual void onVkvmKeyboardPush(const PeripheryResult res, const uint8_t key) {
+		this->complete(res, key);
+	}
+
+	/**
+	 * Handles `VkvmDevice::keyboardWrite()` completions.
+	 *
+	 * @param[in] res - periphery result code
+	 * @param[in] mod - initial key modifier
+	 * @param[in] keys - written keys
+	 * @param[in] len - number of written keys
+	 */
+	virtual void onVkvmKeyboardWrite(const PeripheryResult res, const uint8_t /* mod */, const uint8_t * /* keys */, const uint8_t len) {
+		this->complete(res, len);
+	}
+
+	/**
+	 * Handles `VkvmDevice::mouseMoveAbs()` completions.
+	 *
+	 * @param[in] res - periphery result code
+	 * @param[in] x - normalized x coordinate
+	 * @param[in] y - normalized y coordinate
+	 */
+	virtual void onVkvmMouseMoveAbs(const PeripheryResult res, const double x, const double y) {
+		const uint32_t rawX = uint32_t(x * 32767.0 + 0.5);
+		const uint32_t rawY = uint32_t(y * 32767.0 + 0.5);
+		this->complete(res, rawX | (rawY << 16));
+	}
+
+	/**
+	 * Handles disconnects of the connected VKVM device.
+	 *
+	 * @param[in] reason - disconnect reason
+	 */
+	virtual void onVkvmDisconnected(const DisconnectReason reason) {
+		switch (reason) {
+		case DisconnectReason::D_USER:
+			break;
+		case DisconnectReason::D_RECV_ERROR:
+			fprintf(stderr, "Error: Failed to receive data from the VKVM device.\n");
+			break;
+		case DisconnectReason::D_SEND_ERROR:
+			fprintf(stderr, "Error: Failed to send data to the VKVM device.\n");
+			break;
+		case DisconnectReason::D_INVALID_PROTOCOL:
+			fprintf(stderr, "Error: Connected VKVM reported an unsupported protocol version.\n");
+			break;
+		case DisconnectReason::D_TIMEOUT:
+			fprintf(stderr, "Error: Connection to the VKVM device timed out.\n");
+			break;
+		case DisconnectReason::COUNT:
+			fprintf(stderr, "Error: VKVM device connection was closed for an unknown reason.\n");
+			break;
+		}
+		{
+			std::lock_guard<std::mutex> guard(this->mutex);
+			this->connected = false;
+			this->completion.notify_all();
+		}
+		this->running.unlock();
+	}
+};
+
+
+/**
+ * Checks if the given string begin with 'start'.
+ *
+ * @param[in] start - starts with this string
+ * @param[in] str - string to test against
+ * @return true if 'str' starts with 'start', else false
+ * @remarks This function uses strncmp() internally for string comparison.
+ */
+static bool startWith(const char * start, const char * str) {
+	return strncmp(start, str, strlen(start)) == 0;
+}
+
+
+/**
+ * Parses the given string as unsigned value.
+ *
+ * @param[in] str - string to parse
+ * @param[out] value - receives the parsed value
+ * @return true on success, else false
+ */
+static bool parseNumber(const char * str, size_t & value) {
+	if (str == NULL) return false;
+	char * endPtr = NULL;
+	const unsigned long res = strtoul(str, &endPtr, 10);
+	if (endPtr == NULL || endPtr == str || *endPtr != 0) return false;
+	value = size_t(res);
+	return true;
+}
+
+
+/**
+ * Prints the usage description of this program.
+ */
+static void printHelp() {
+	printf(
+		"vkvmBench [options] <serial> [<serial> ...]\n"
+		"\n"
+		"-b <count>    - events submitted back-to-back per burst (default: 8 for typing, else 1)\n"
+		"-h            - print this help\n"
+		"-j            - print the results as single line JSON object\n"
+		"-k <count>    - keys per paste request (default: 16, max: %u)\n"
+		"-n <count>    - number of events (default: %u)\n"
+		"-r <rate>     - average submission rate in events/s (default: 0 for unlimited)\n"
+		"-s            - serve all devices by a single shared I/O reactor thread\n"
+		"-t <file>     - write the protocol trace to this file after the run\n"
+		"                (the device index is appended for multiple devices)\n"
+		"-w <window>   - number of requests in flight (default: 1)\n"
+		"-W <workload> - input workload (default: typing)\n"
+		"                typing - bursts of single key pushes\n"
+		"                mouse  - absolute mouse sweeps\n"
+		"                paste  - stream of multi key writes\n"
+		"serial        - path to the serial connected VKVM device\n"
+		"\n"
+		"Latency is measured from the first submission attempt to the completion\n"
+		"callback. Events rejected due to a full request queue are resubmitted.\n"
+		"Merged mouse requests complete all events merged into them.\n"
+		"Multiple devices replay the workload concurrently and report separately.\n",
+		unsigned(BENCH_MAX_PASTE_KEYS), unsigned(BENCH_DEFAULT_COUNT)
+	);
+}
+
+
+/**
+ * Main entry point.
+ */
+#if defined(UNICODE) || defined(_UNICODE)
+int asciiMain(int argc, char ** argv) {
+#else /* ! UNICODE */
+int main(int argc, char ** argv) {
+#endif /* UNICODE */
+	BenchConfig config;
+	config.workload = BenchConfig::W_TYPING;
+	config.count = BENCH_DEFAULT_COUNT;
+	config.burst = 0;
+	config.rate = 0;
+	config.keys = 16;
+	config.window = 1;
+	config.shared = false;
+	config.trace = NULL;
+	config.json = false;
+	if (argc <= 1 || strcmp(argv[1], "-h") == 0 || startWith(argv[1], "--help")) {
+		printHelp();
+		return EXIT_SUCCESS;
+	}
+	int i = 1;
+	for (; i < argc && argv[i][0] == '-'; i++) {
+		const char * arg = argv[i];
+		const char * value = ((i + 1) < argc) ? argv[i + 1] : NULL;
+		if (strcmp(arg, "-h") == 0) {
+			printHelp();
+			return EXIT_SUCCESS;
+		} else if (strcmp(arg, "-j") == 0) {
+			config.json = true;
+			continue;
+		} else if (strcmp(arg, "-s") == 0) {
+			config.shared = true;
+			continue;
+		} else if (strcmp(arg, "-b") == 0) {
+			if ( ! parseNumber(value, config.burst) || config.burst < 1 ) {
+				fprintf(stderr, "Error: Invalid burst size \"%s\".\n", value ? value : "");
+				return EXIT_FAILURE;
+			}
+		} else if (strcmp(arg, "-k") == 0) {
+			if ( ! parseNumber(value, config.keys) || config.keys < 1 || config.keys > BENCH_MAX_PASTE_KEYS ) {
+				fprintf(stderr, "Error: Invalid number of keys per paste request \"%s\".\n", value ? value : "");
+				return EXIT_FAILURE;
+			}
+		} else if (strcmp(arg, "-n") == 0) {
+			if ( ! parseNumber(value, config.count) || config.count < 1 ) {
+				fprintf(stderr, "Error: Invalid number of events \"%s\".\n", value ? value : "");
+				return EXIT_FAILURE;
+			}
+		} else if (strcmp(arg, "-r") == 0) {
+			if ( ! parseNumber(value, config.rate) ) {
+				fprintf(stderr, "Error: Invalid rate \"%s\".\n", value ? value : "");
+				return EXIT_FAILURE;
+			}
+		} else if (strcmp(arg, "-w") == 0) {
+			if ( ! parseNumber(value, config.window) || config.window < 1 ) {
+				fprintf(stderr, "Error: Invalid window size \"%s\".\n", value ? value : "");
+				return EXIT_FAILURE;
+			}
+		} else if (strcmp(arg, "-t") == 0) {
+			if (value == NULL || *value == 0) {
+				fprintf(stderr, "Error: Missing protocol trace file path.\n");
+				return EXIT_FAILURE;
+			}
+			config.trace = value;
+		} else if (strcmp(arg, "-W") == 0) {
+			int w = 0;
+			while (w < BenchConfig::W_COUNT && (value == NULL || strcmp(value, workloadStr[w]) != 0)) w++;
+			if (w >= BenchConfig::W_COUNT) {
+				fprintf(stderr, "Error: Unknown workload \"%s\".\n", value ? value : "");
+				return EXIT_FAILURE;
+			}
+			config.workload = BenchConfig::Workload(w);
+		} else {
+			fprintf(stderr, "Error: Unknown option \"%s\".\n", arg);
+			return EXIT_FAILURE;
+		}
+		i++; /* skip option value */
+	}
+	if (i >= argc) {
+		fprintf(stderr, "Error: Missing serial device path.\n");
+		return EXIT_FAILURE;
+	}
+	if (config.shared && ( ! pcf::serial::VkvmDevice::setSharedReactor(true) )) {
+		fprintf(stderr, "Error: The shared reactor is not supported on this platform.\n");
+		return EXIT_FAILURE;
+	}
+	try {
+		std::vector<std::unique_ptr<VkvmBench>> benches;
+		bool success = true;
+		for (; i < argc; i++) {
+			benches.emplace_back(new VkvmBench(config));
+			if ( ! benches.back()->start(argv[i]) ) {
+				fprintf(stderr, "Error: Failed to open serial device \"%s\". Invalid port?\n", argv[i]);
+				success = false;
+				break;
+			}
+		}
+		for (auto & bench : benches) {
+			if ( ! bench->join() ) success = false;
+		}
+		if (config.trace != NULL && benches.size() == 1) {
+			if ( ! benches.front()->dumpTrace(config.trace) ) success = false;
+		} else if (config.trace != NULL) {
+			std::string tracePath;
+			for (size_t n = 0; n < benches.size(); n++) {
+				tracePath = std::string(config.trace) + "." + std::to_string(n + 1);
+				if ( ! benches[n]->dumpTrace(tracePath.c_str()) ) success = false;
+			}
+		}
+		if ( ! success ) return EXIT_FAILURE;
+	} catch (const std::exception & e) {
+		fprintf(stderr, "Error: %s\n", e.what());
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
+
+
+/**
+ * Use ASCII mode even for Unicode targets.
+ */
+#if defined(UNICODE) || defined(_UNICODE)
+extern "C" {
+#ifdef __TINYC__
+int _CRT_glob = 0;
+#else
+extern int _CRT_glob;
+#endif
+extern void __getmainargs(int *, char ***, char ***, int, int *);
+
+int wmain() {
+	char ** enpv, ** argv;
+	int argc, si = 0;
+	/* this also creates the global variable __argv */
+	__getmainargs(&argc, &argv, &enpv, _CRT_glob, &si);
+	return asciiMain(argc, argv);
+}
+} /* extern "C" */
+#endif /* UNICODE */